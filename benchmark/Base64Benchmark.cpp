@@ -0,0 +1,194 @@
+/**
+ * Compare the table-driven, vectorized Base64 codec against the previous
+ * std::map and std::stringstream based implementation.
+ */
+#include "Base64.hpp"
+#include "BenchmarkHelper.hpp"
+#include "CpuDispatch.hpp"
+
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+	const char LEGACY_ENCODING_TABLE[65] =
+	    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	/**
+	 * The std::map based decoding table this module used to have.
+	 */
+	std::map<char, uint8_t> make_legacy_decoding_map()
+	{
+		std::map<char, uint8_t> decoding_map;
+		for (uint8_t i = 0; i < 64; ++i)
+		{
+			decoding_map[LEGACY_ENCODING_TABLE[i]] = i;
+		}
+		return decoding_map;
+	}
+
+	const std::map<char, uint8_t> LEGACY_DECODING_MAP =
+	    make_legacy_decoding_map();
+
+	std::string legacy_encode(const std::string& unencoded_string)
+	{
+		std::vector<uint8_t> bytes_sequence(unencoded_string.begin(),
+		                                    unencoded_string.end());
+		size_t bits = 0;
+		uint16_t buffer = 0;
+		std::stringstream output;
+		for (auto byte : bytes_sequence)
+		{
+			buffer <<= 8;
+			buffer += static_cast<uint16_t>(byte);
+			bits += 8;
+			while (bits >= 6)
+			{
+				output << LEGACY_ENCODING_TABLE[(buffer >> (bits - 6)) & 0x3f];
+				buffer &= ~(0x3f << (bits - 6));
+				bits -= 6;
+			}
+		}
+		if (unencoded_string.size() % 3 == 1)
+		{
+			buffer <<= 4;
+			output << LEGACY_ENCODING_TABLE[buffer & 0x3f] << "==";
+		}
+		else if (unencoded_string.size() % 3 == 2)
+		{
+			buffer <<= 2;
+			output << LEGACY_ENCODING_TABLE[buffer & 0x3f] << '=';
+		}
+		return output.str();
+	}
+
+	std::string legacy_decode(const std::string& encoded_string)
+	{
+		std::vector<uint8_t> bytes_sequence(encoded_string.begin(),
+		                                    encoded_string.end());
+		std::stringstream output;
+		size_t bits = 0;
+		uint16_t buffer = 0;
+		for (auto character : bytes_sequence)
+		{
+			uint8_t group = 0;
+			if (LEGACY_DECODING_MAP.find(character) !=
+			    LEGACY_DECODING_MAP.end())
+			{
+				group = LEGACY_DECODING_MAP.find(character)->second;
+			}
+			buffer <<= 6;
+			bits += 6;
+			buffer += group;
+			if (bits >= 8)
+			{
+				if (character != '=')
+				{
+					output << static_cast<char>(buffer >> (bits - 8));
+				}
+				buffer &= ~(0xff << (bits - 8));
+				bits -= 8;
+			}
+		}
+		return output.str();
+	}
+
+	constexpr size_t ITERATIONS = 20;
+} // namespace
+
+int main()
+{
+	// a Basic auth credential, a WebSocket key, and a large payload
+	for (size_t size : {24, 20, 1 << 20})
+	{
+		const std::string input = BenchmarkHelper::random_string(size);
+		const std::string encoded = Base64::encode(input);
+		const size_t iterations = ITERATIONS * ((1 << 20) / size);
+
+		std::cout << "encode/decode of " << size << " bytes\n";
+
+		double legacy_encode_ms = BenchmarkHelper::measure(
+		    "legacy encode()", iterations, size, [&input]() {
+			    auto output = legacy_encode(input);
+			    BenchmarkHelper::do_not_optimize(output);
+		    });
+		double encode_ms = BenchmarkHelper::measure(
+		    "Base64::encode()", iterations, size, [&input]() {
+			    auto output = Base64::encode(input);
+			    BenchmarkHelper::do_not_optimize(output);
+		    });
+
+		std::vector<char> encode_buffer(Base64::encoded_length(size));
+		BenchmarkHelper::measure(
+		    "Base64::encode_into()", iterations, size, [&]() {
+			    size_t length = Base64::encode_into(input.data(), input.size(),
+			                                        encode_buffer.data());
+			    BenchmarkHelper::do_not_optimize(length);
+		    });
+
+		double legacy_decode_ms = BenchmarkHelper::measure(
+		    "legacy decode()", iterations, size, [&encoded]() {
+			    auto output = legacy_decode(encoded);
+			    BenchmarkHelper::do_not_optimize(output);
+		    });
+		double decode_ms = BenchmarkHelper::measure(
+		    "Base64::decode()", iterations, size, [&encoded]() {
+			    auto output = Base64::decode(encoded);
+			    BenchmarkHelper::do_not_optimize(output);
+		    });
+
+		std::vector<uint8_t> decode_buffer(
+		    Base64::decoded_length(encoded.size()));
+		BenchmarkHelper::measure(
+		    "Base64::decode_into()", iterations, size, [&]() {
+			    size_t decoded_size = 0;
+			    bool is_valid = Base64::decode_into(
+			        encoded.data(), encoded.size(), decode_buffer.data(),
+			        decoded_size);
+			    BenchmarkHelper::do_not_optimize(is_valid);
+		    });
+
+		std::cout << "encode speedup: " << legacy_encode_ms / encode_ms
+		          << "x, decode speedup: " << legacy_decode_ms / decode_ms
+		          << "x\n\n";
+	}
+
+	// A/B the kernels of every instruction set this CPU can run
+	const size_t size = 1 << 20;
+	const std::string input = BenchmarkHelper::random_string(size);
+	const std::string encoded = Base64::encode(input);
+	std::vector<char> encode_buffer(encoded.size());
+	std::vector<uint8_t> decode_buffer(Base64::decoded_length(encoded.size()));
+
+	std::cout << "encode_into()/decode_into() of " << size
+	          << " bytes per instruction set\n";
+	for (size_t i = 0; i < CpuDispatch::NUMBER_OF_ISAS; ++i)
+	{
+		auto isa = static_cast<CpuDispatch::Isa>(i);
+		if (isa > CpuDispatch::get_detected_isa())
+		{
+			break;
+		}
+		CpuDispatch::force_isa(isa);
+
+		BenchmarkHelper::measure(
+		    std::string("encode_into() ") + CpuDispatch::get_isa_name(isa),
+		    ITERATIONS, size, [&]() {
+			    size_t length = Base64::encode_into(input.data(), input.size(),
+			                                        encode_buffer.data());
+			    BenchmarkHelper::do_not_optimize(length);
+		    });
+		BenchmarkHelper::measure(
+		    std::string("decode_into() ") + CpuDispatch::get_isa_name(isa),
+		    ITERATIONS, size, [&]() {
+			    size_t decoded_size = 0;
+			    bool is_valid = Base64::decode_into(
+			        encoded.data(), encoded.size(), decode_buffer.data(),
+			        decoded_size);
+			    BenchmarkHelper::do_not_optimize(is_valid);
+		    });
+	}
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Timer.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace BenchmarkHelper
+{
+	/**
+	 * Keep the compiler from optimizing away a computed value.
+	 */
+	template <typename T> inline void do_not_optimize(const T& value)
+	{
+		asm volatile("" : : "g"(&value) : "memory");
+	}
+
+	/**
+	 * Generate random bytes drawn from the given alphabet.
+	 *
+	 * @param[in] size
+	 *      Number of bytes.
+	 *
+	 * @param[in] alphabet
+	 *      Characters to draw from. Every byte value if empty.
+	 *
+	 * @return
+	 *      Random string.
+	 */
+	inline std::string random_string(size_t size,
+	                                 const std::string& alphabet = {})
+	{
+		std::mt19937 generator(42); // NOLINT
+		std::uniform_int_distribution<int> distribution(
+		    0, alphabet.empty() ? 255 : static_cast<int>(alphabet.size()) - 1);
+
+		std::string result(size, '\0');
+		for (auto& character : result)
+		{
+			int index = distribution(generator);
+			character = alphabet.empty() ? static_cast<char>(index)
+			                             : alphabet[index];
+		}
+		return result;
+	}
+
+	/**
+	 * Run @b function @b iterations times and print the mean time per
+	 * iteration, plus the throughput if @b bytes_per_iteration is given.
+	 *
+	 * @return
+	 *      Mean milliseconds per iteration.
+	 */
+	template <typename Function>
+	double measure(const std::string& name, size_t iterations,
+	               size_t bytes_per_iteration, Function function)
+	{
+		// warm up caches and branch predictors
+		function();
+
+		Timer timer;
+		timer.reset_start_time();
+		for (size_t i = 0; i < iterations; ++i)
+		{
+			function();
+		}
+		double milliseconds = timer.get_elapsed_time().count() /
+		                      static_cast<double>(iterations);
+
+		std::cout << std::left << std::setw(40) << name << std::right
+		          << std::fixed << std::setprecision(4) << std::setw(12)
+		          << milliseconds << " ms/iter";
+		if (bytes_per_iteration != 0)
+		{
+			std::cout << std::setw(12) << std::setprecision(1)
+			          << (static_cast<double>(bytes_per_iteration) /
+			              (1024.0 * 1024.0)) /
+			                 (milliseconds / 1000.0)
+			          << " MB/s";
+		}
+		std::cout << '\n';
+
+		return milliseconds;
+	}
+} // namespace BenchmarkHelper
@@ -0,0 +1,190 @@
+/**
+ * Compare the hit ratios of the LRU and TinyLFU cache policies at the same
+ * memory, for the in-process and the shared cache.
+ *
+ * Replays the queries of the server logs given as arguments, or a
+ * synthetic workload of Zipf distributed queries interrupted by scans of
+ * one-off ones:
+ *   ./benchmark/cache_replay_benchmark /home/word-finder/logs/2026-10-19.log
+ */
+#include "FrequencySketch.hpp"
+#include "LocalCache.hpp"
+#include "SharedCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr size_t NUMBER_OF_QUERIES = 100000;
+	constexpr size_t NUMBER_OF_REQUESTS = 1000000;
+	constexpr double ZIPF_EXPONENT = 0.9;
+
+	// Every SCAN_INTERVAL requests, a scan of SCAN_LENGTH one-off queries.
+	constexpr size_t SCAN_INTERVAL = 100000;
+	constexpr size_t SCAN_LENGTH = 20000;
+
+	constexpr size_t CAPACITIES_MB[] = {2, 8, 32};
+
+	// Server log lines naming a query: searches, and hits at debug level.
+	const std::string QUERY_MARKER = "user query: ";
+	const std::string HIT_MARKER = "cache hit: q=";
+
+	void read_queries(const std::string& file_path,
+	                  std::vector<std::string>& queries)
+	{
+		std::ifstream log(file_path);
+		std::string line;
+		while (std::getline(log, line))
+		{
+			for (const std::string& marker : {QUERY_MARKER, HIT_MARKER})
+			{
+				size_t position = line.find(marker);
+				if (position != std::string::npos)
+				{
+					queries.push_back(line.substr(position + marker.size()));
+					break;
+				}
+			}
+		}
+	}
+
+	std::vector<std::string> generate_queries()
+	{
+		std::vector<double> distribution(NUMBER_OF_QUERIES);
+		double sum = 0;
+		for (size_t i = 0; i < NUMBER_OF_QUERIES; ++i)
+		{
+			sum += 1.0 / std::pow(static_cast<double>(i + 1), ZIPF_EXPONENT);
+			distribution[i] = sum;
+		}
+
+		std::mt19937 generator(42); // NOLINT
+		std::uniform_real_distribution<double> uniform(0, sum);
+
+		std::vector<std::string> queries;
+		queries.reserve(NUMBER_OF_REQUESTS);
+		size_t number_of_scanned = 0;
+		while (queries.size() < NUMBER_OF_REQUESTS)
+		{
+			if (queries.size() % SCAN_INTERVAL == SCAN_INTERVAL - 1)
+			{
+				for (size_t i = 0; i < SCAN_LENGTH; ++i)
+				{
+					queries.push_back("scan" +
+					                  std::to_string(number_of_scanned++));
+				}
+			}
+
+			auto rank = std::lower_bound(
+			    distribution.begin(), distribution.end(), uniform(generator));
+			queries.push_back(
+			    "word" + std::to_string(rank - distribution.begin()));
+		}
+		return queries;
+	}
+
+	/**
+	 * Size of the cached response to a query, the same in every run: from
+	 * 256 bytes to 16 KiB, small ones more likely.
+	 */
+	size_t get_response_size(const std::string& query)
+	{
+		size_t hash = std::hash<std::string>()(query);
+		return static_cast<size_t>(512) << (hash % 6) >> (hash / 6 % 2);
+	}
+
+	/**
+	 * Look every query up, inserting its response on misses like the
+	 * server does.
+	 *
+	 * @return
+	 *      Hit ratio in percent.
+	 */
+	double replay(const std::vector<std::string>& queries,
+	              std::function<bool(const std::string&)> get,
+	              std::function<void(const std::string&, size_t)> insert)
+	{
+		size_t hits = 0;
+		for (const std::string& query : queries)
+		{
+			std::string key = "/?q=" + query;
+			if (get(key))
+			{
+				++hits;
+				continue;
+			}
+			insert(key, get_response_size(query));
+		}
+		return 100.0 * static_cast<double>(hits) /
+		       static_cast<double>(queries.size());
+	}
+
+	void print_row(const std::string& name, size_t capacity_mb,
+	               double lru_hit_ratio, double tiny_lfu_hit_ratio)
+	{
+		std::cout << std::left << std::setw(16) << name << std::right
+		          << std::setw(6) << capacity_mb << " MB" << std::fixed
+		          << std::setprecision(2) << std::setw(10) << lru_hit_ratio
+		          << " %" << std::setw(10) << tiny_lfu_hit_ratio << " %\n";
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> queries;
+	for (int i = 1; i < argc; ++i)
+	{
+		read_queries(argv[i], queries);
+	}
+	if (queries.empty())
+	{
+		queries = generate_queries();
+	}
+
+	std::cout << "replaying " << queries.size() << " queries\n";
+	std::cout << std::left << std::setw(25) << "cache" << std::right
+	          << std::setw(12) << "lru" << std::setw(12) << "tinylfu" << '\n';
+
+	std::string value;
+	for (size_t capacity_mb : CAPACITIES_MB)
+	{
+		const size_t capacity = capacity_mb * 1024 * 1024;
+		double hit_ratios[2] = {};
+		for (HTTP::CachePolicy policy :
+		     {HTTP::CachePolicy::LRU, HTTP::CachePolicy::TINY_LFU})
+		{
+			// the shard count of the server's configuration
+			HTTP::LocalCache cache(capacity, 8, policy);
+			hit_ratios[static_cast<int>(policy)] = replay(
+			    queries,
+			    [&](const std::string& key) { return cache.get(key, value); },
+			    [&](const std::string& key, size_t size) {
+				    cache.insert(key, std::string(size, 'v'));
+			    });
+		}
+		print_row("LocalCache", capacity_mb, hit_ratios[0], hit_ratios[1]);
+
+		for (HTTP::CachePolicy policy :
+		     {HTTP::CachePolicy::LRU, HTTP::CachePolicy::TINY_LFU})
+		{
+			SharedCache::create(capacity, "", policy);
+			hit_ratios[static_cast<int>(policy)] = replay(
+			    queries,
+			    [&](const std::string& key) {
+				    return SharedCache::get(key, value);
+			    },
+			    [&](const std::string& key, size_t size) {
+				    SharedCache::insert(key, std::string(size, 'v'));
+			    });
+			SharedCache::destroy();
+		}
+		print_row("SharedCache", capacity_mb, hit_ratios[0], hit_ratios[1]);
+	}
+}
@@ -0,0 +1,78 @@
+/**
+ * Compare the bitmap CharacterSet against the previous std::set<char> based
+ * implementation on the hot path of PercentEncoding::encode.
+ */
+#include "BenchmarkHelper.hpp"
+#include "CharacterSet.hpp"
+#include "PercentEncoding.hpp"
+
+#include <set>
+
+namespace
+{
+	/**
+	 * The std::set<char> based CharacterSet this module used to be.
+	 */
+	class LegacyCharacterSet
+	{
+	public:
+		LegacyCharacterSet(std::initializer_list<const char> characters)
+		    : m_character_set(characters.begin(), characters.end())
+		{
+		}
+
+		bool is_contains(char c) const
+		{
+			return m_character_set.find(c) != m_character_set.cend();
+		}
+
+	private:
+		std::set<char> m_character_set;
+	};
+
+	const LegacyCharacterSet LEGACY_RESERVED{':', '/', '?', '#', '[', ']',
+	                                         '@', '!', '$', '&', '\'', '(',
+	                                         ')', '*', '+', ',', ';',  '='};
+
+	constexpr size_t INPUT_SIZE = 1 << 20;
+	constexpr size_t ITERATIONS = 50;
+} // namespace
+
+int main()
+{
+	const std::string input = BenchmarkHelper::random_string(
+	    INPUT_SIZE, "abcdefghijklmnopqrstuvwxyz0123456789:/?#[]@!$&'()*+,;= ");
+
+	std::cout << "is_contains() over " << INPUT_SIZE << " bytes\n";
+
+	double legacy_ms = BenchmarkHelper::measure(
+	    "std::set<char>", ITERATIONS, INPUT_SIZE, [&input]() {
+		    size_t count = 0;
+		    for (char c : input)
+		    {
+			    count += LEGACY_RESERVED.is_contains(c) ? 1 : 0;
+		    }
+		    BenchmarkHelper::do_not_optimize(count);
+	    });
+
+	double bitmap_ms = BenchmarkHelper::measure(
+	    "256-bit bitmap", ITERATIONS, INPUT_SIZE, [&input]() {
+		    size_t count = 0;
+		    for (char c : input)
+		    {
+			    count += Rfc3986::RESERVED.is_contains(c) ? 1 : 0;
+		    }
+		    BenchmarkHelper::do_not_optimize(count);
+	    });
+
+	std::cout << "speedup: " << legacy_ms / bitmap_ms << "x\n\n";
+
+	PercentEncoding percent_encoding;
+	BenchmarkHelper::measure("PercentEncoding::encode()", ITERATIONS,
+	                         INPUT_SIZE, [&]() {
+		                         auto encoded = percent_encoding.encode(input);
+		                         BenchmarkHelper::do_not_optimize(encoded);
+	                         });
+
+	return 0;
+}
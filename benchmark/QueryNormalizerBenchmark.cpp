@@ -0,0 +1,186 @@
+/**
+ * Compare the hit ratios of the search cache keyed by raw queries and by
+ * normalized ones, at the same memory.
+ *
+ * Replays the queries of server logs written before queries were
+ * normalized, given as arguments, or a synthetic workload of Zipf
+ * distributed queries typed in varying case and spacing, some with
+ * parameters the search ignores:
+ *   ./benchmark/query_normalizer_benchmark \
+ *       /home/word-finder/logs/2026-10-19.log
+ */
+#include "LocalCache.hpp"
+#include "QueryNormalizer.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr size_t NUMBER_OF_QUERIES = 100000;
+	constexpr size_t NUMBER_OF_REQUESTS = 1000000;
+	constexpr double ZIPF_EXPONENT = 0.9;
+
+	constexpr size_t CAPACITIES_MB[] = {2, 8, 32};
+
+	// Size of a cached result page.
+	constexpr size_t RESPONSE_SIZE = 4096;
+
+	const std::string QUERY_MARKER = "user query: ";
+
+	/**
+	 * A search request: the "q" parameter as typed, and the rest of the
+	 * query string.
+	 */
+	struct Request
+	{
+		std::string keyword;
+		std::string other_parameters;
+	};
+
+	void read_requests(const std::string& file_path,
+	                   std::vector<Request>& requests)
+	{
+		std::ifstream log(file_path);
+		std::string line;
+		while (std::getline(log, line))
+		{
+			size_t position = line.find(QUERY_MARKER);
+			if (position != std::string::npos)
+			{
+				requests.push_back(
+				    Request{line.substr(position + QUERY_MARKER.size()), ""});
+			}
+		}
+	}
+
+	/**
+	 * Type a query like users do: mostly as is, sometimes capitalized,
+	 * shouted or padded, and now and then with a tracking parameter.
+	 */
+	Request vary(const std::string& query, std::mt19937& generator)
+	{
+		std::uniform_int_distribution<int> percent(0, 99);
+		Request request{query, ""};
+
+		int typing = percent(generator);
+		if (typing < 20)
+		{
+			request.keyword[0] = static_cast<char>(
+			    std::toupper(static_cast<unsigned char>(request.keyword[0])));
+		}
+		else if (typing < 25)
+		{
+			std::transform(request.keyword.begin(), request.keyword.end(),
+			               request.keyword.begin(), ::toupper);
+		}
+		if (percent(generator) < 10)
+		{
+			request.keyword = " " + request.keyword + "  ";
+		}
+		if (percent(generator) < 10)
+		{
+			request.other_parameters =
+			    "&utm_source=" + std::to_string(percent(generator) % 5);
+		}
+		return request;
+	}
+
+	std::vector<Request> generate_requests()
+	{
+		std::vector<double> distribution(NUMBER_OF_QUERIES);
+		double sum = 0;
+		for (size_t i = 0; i < NUMBER_OF_QUERIES; ++i)
+		{
+			sum += 1.0 / std::pow(static_cast<double>(i + 1), ZIPF_EXPONENT);
+			distribution[i] = sum;
+		}
+
+		std::mt19937 generator(42); // NOLINT
+		std::uniform_real_distribution<double> uniform(0, sum);
+
+		std::vector<Request> requests;
+		requests.reserve(NUMBER_OF_REQUESTS);
+		while (requests.size() < NUMBER_OF_REQUESTS)
+		{
+			auto rank = std::lower_bound(
+			    distribution.begin(), distribution.end(), uniform(generator));
+			requests.push_back(vary(
+			    "word" + std::to_string(rank - distribution.begin()) + " news",
+			    generator));
+		}
+		return requests;
+	}
+
+	/**
+	 * Look every request up, inserting its page on misses like the server
+	 * does.
+	 *
+	 * @return
+	 *      Hit ratio in percent.
+	 */
+	double replay(const std::vector<Request>& requests, size_t capacity,
+	              std::function<std::string(const Request&)> make_key)
+	{
+		// the shard count of the server's configuration
+		HTTP::LocalCache cache(capacity, 8, HTTP::CachePolicy::TINY_LFU);
+		const std::string page(RESPONSE_SIZE, 'v');
+		std::string value;
+		size_t hits = 0;
+		for (const Request& request : requests)
+		{
+			std::string key = make_key(request);
+			if (cache.get(key, value))
+			{
+				++hits;
+				continue;
+			}
+			cache.insert(key, page);
+		}
+		return 100.0 * static_cast<double>(hits) /
+		       static_cast<double>(requests.size());
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	std::vector<Request> requests;
+	for (int i = 1; i < argc; ++i)
+	{
+		read_requests(argv[i], requests);
+	}
+	if (requests.empty())
+	{
+		requests = generate_requests();
+	}
+
+	std::cout << "replaying " << requests.size() << " queries\n";
+	std::cout << std::left << std::setw(12) << "capacity" << std::right
+	          << std::setw(12) << "raw" << std::setw(14) << "normalized"
+	          << '\n';
+
+	for (size_t capacity_mb : CAPACITIES_MB)
+	{
+		const size_t capacity = capacity_mb * 1024 * 1024;
+		double raw_hit_ratio =
+		    replay(requests, capacity, [](const Request& request) {
+			    return "/?q=" + request.keyword + request.other_parameters;
+		    });
+		double normalized_hit_ratio =
+		    replay(requests, capacity, [](const Request& request) {
+			    return "/?q=" + QueryNormalizer::normalize(request.keyword);
+		    });
+
+		std::cout << std::right << std::setw(6) << capacity_mb << " MB"
+		          << std::fixed << std::setprecision(2) << std::setw(13)
+		          << raw_hit_ratio << " %" << std::setw(12)
+		          << normalized_hit_ratio << " %\n";
+	}
+}
@@ -0,0 +1,93 @@
+/**
+ * Compare the buffer reusing response serializer against the previous
+ * std::ostringstream based implementation.
+ */
+#include "BenchmarkHelper.hpp"
+#include "Response.hpp"
+#include "StatusHandler.hpp"
+
+#include <map>
+#include <sstream>
+
+namespace
+{
+	/**
+	 * The std::ostringstream based generate_response() this module used to
+	 * have.
+	 */
+	std::string
+	legacy_generate_response(int status_code, const std::string& reason_phrase,
+	                         const std::map<std::string, std::string>& headers,
+	                         const std::string& body)
+	{
+		std::ostringstream response;
+
+		response << "HTTP/1.1"
+		         << " " << std::to_string(status_code) << " " << reason_phrase
+		         << "\r\n";
+
+		for (auto position = headers.cbegin(); position != headers.cend();
+		     ++position)
+		{
+			std::string name = position->first.c_str();
+			std::string value = position->second.c_str();
+
+			response << name << ": " << value << "\r\n";
+		}
+
+		response << "\r\n" << body;
+		return response.str();
+	}
+
+	constexpr size_t ITERATIONS = 200000;
+} // namespace
+
+int main()
+{
+	// a typical search result and a small static file
+	for (size_t size : {512, 16384})
+	{
+		auto response = std::make_shared<Message::Response>();
+		response->set_body(BenchmarkHelper::random_string(size, "abcdef"));
+		response->set_content_type("text/html");
+		StatusHandler::handle_status_code(response, 200);
+
+		std::map<std::string, std::string> headers;
+		for (const auto& name :
+		     {"Content-Length", "Content-Type", "Date", "Host", "Server"})
+		{
+			headers[name] = response->get_header(name);
+		}
+		const std::string body = response->get_body();
+		const size_t response_size = response->generate_response().size();
+
+		std::cout << "generate_response() of " << size << " byte body\n";
+
+		double legacy_ms = BenchmarkHelper::measure(
+		    "legacy generate_response()", ITERATIONS, response_size, [&]() {
+			    auto output =
+			        legacy_generate_response(200, "OK", headers, body);
+			    BenchmarkHelper::do_not_optimize(output);
+		    });
+		double generate_ms = BenchmarkHelper::measure(
+		    "Response::generate_response()", ITERATIONS, response_size,
+		    [&]() {
+			    const std::string& output = response->generate_response();
+			    BenchmarkHelper::do_not_optimize(output);
+		    });
+
+		std::cout << "speedup: " << legacy_ms / generate_ms << "x\n\n";
+	}
+
+	// a scanner probing for missing paths
+	auto response = std::make_shared<Message::Response>();
+	BenchmarkHelper::measure(
+	    "404 from template", ITERATIONS, 0, [&response]() {
+		    response->clear_up();
+		    StatusHandler::handle_status_code(response, 404);
+		    const std::string& output = response->generate_response();
+		    BenchmarkHelper::do_not_optimize(output);
+	    });
+
+	return 0;
+}
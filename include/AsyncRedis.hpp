@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+
+namespace HTTP
+{
+	/**
+	 * @brief Non-blocking Redis client driven by the worker's event loop.
+	 *
+	 * Speaks just enough RESP for a cache: commands are arrays of bulk
+	 * strings and replies are read in order from one connection.
+	 *
+	 * Commands are only appended to an output buffer. The event loop calls
+	 * flush() once per batch of events, so the lookups of every connection
+	 * served in the batch leave in a single write, and calls
+	 * handle_events() when the Redis socket is ready. Writes (SET, DEL)
+	 * never have their replies waited for.
+	 *
+	 * Any error, or a reply overdue by more than a second, fails the
+	 * outstanding lookups as misses, closes the connection and skips Redis
+	 * for a second before connecting again.
+	 *
+	 * The database of the URI, if any, is selected first on every
+	 * connection. Failing to select it is such an error.
+	 */
+	class AsyncRedis
+	{
+	public:
+		/**
+		 * Called with the value of a key, or with @b is_found false if the
+		 * key is missing or Redis is unavailable.
+		 */
+		using GetCallback =
+		    std::function<void(bool is_found, const std::string& value)>;
+
+		struct Statistics
+		{
+			uint64_t commands = 0;
+			uint64_t replies = 0;
+
+			// Writes to the socket, each carrying one or more commands.
+			uint64_t writes = 0;
+
+			uint64_t errors = 0;
+
+			// Commands dropped while backing off or backed up.
+			uint64_t dropped_commands = 0;
+		};
+
+		/**
+		 * @param[in] uri
+		 *      "tcp://host[:port][/db]" or "unix://path". The first flush()
+		 *      after attach() connects.
+		 */
+		explicit AsyncRedis(const std::string& uri);
+
+		/**
+		 * Close the connection. Outstanding callbacks are dropped without
+		 * being called.
+		 */
+		~AsyncRedis();
+
+		AsyncRedis(const AsyncRedis& other) = delete;
+		AsyncRedis& operator=(const AsyncRedis& other) = delete;
+
+		AsyncRedis(AsyncRedis&& other) = delete;
+		AsyncRedis& operator=(AsyncRedis&& other) = delete;
+
+		/**
+		 * Register the connection with an epoll instance; commands are
+		 * dropped before. The loop must then call handle_events() for
+		 * get_fd(), flush() after each batch of events and check_timeout()
+		 * after each wait of at most get_poll_timeout() milliseconds.
+		 */
+		void attach(int epoll_fd);
+
+		/**
+		 * Whether commands can be sent: attached, with a valid address and
+		 * not backing off after an error.
+		 */
+		bool is_usable() const;
+
+		/**
+		 * Look up a key. @b callback runs from handle_events(), or right
+		 * away with a miss if Redis isn't usable.
+		 */
+		void get(const std::string& key, GetCallback callback);
+
+		/**
+		 * Store a value, without waiting for the reply.
+		 *
+		 * @param[in] time_to_live
+		 *      Optional. Seconds until Redis drops the key, 0 for never.
+		 */
+		void set(const std::string& key, const std::string& value,
+		         uint32_t time_to_live = 0);
+
+		/**
+		 * Delete a key, without waiting for the reply.
+		 */
+		void del(const std::string& key);
+
+		/**
+		 * Send any command, e.g. CONFIG SET, and ignore its reply.
+		 */
+		void command(const std::vector<std::string>& arguments);
+
+		/**
+		 * Write the queued commands, connecting first if needed.
+		 */
+		void flush();
+
+		/**
+		 * Handle epoll events of get_fd().
+		 */
+		void handle_events(uint32_t events);
+
+		/**
+		 * @return
+		 *      The socket, -1 when not connected.
+		 */
+		int get_fd() const;
+
+		/**
+		 * @return
+		 *      Milliseconds until the oldest reply is overdue, -1 if none
+		 *      is awaited.
+		 */
+		int get_poll_timeout() const;
+
+		/**
+		 * Fail the connection if a reply is overdue.
+		 */
+		void check_timeout();
+
+		Statistics get_statistics() const;
+
+	private:
+		enum class State
+		{
+			DISCONNECTED,
+			CONNECTING,
+			CONNECTED,
+		};
+
+		struct PendingReply
+		{
+			// Empty for commands whose reply is ignored.
+			GetCallback callback;
+
+			// Coarse monotonic time the reply is overdue at.
+			int64_t deadline;
+		};
+
+		/**
+		 * Append a command to the output buffer.
+		 *
+		 * @param[in] callback
+		 *      Moved from only if the command is queued.
+		 *
+		 * @return
+		 *      False if Redis isn't usable or too much output is queued.
+		 */
+		bool queue_command(const std::vector<const std::string*>& arguments,
+		                   GetCallback&& callback);
+
+		bool connect_to_server();
+
+		/**
+		 * Write as much of the output buffer as the socket takes.
+		 */
+		bool write_output();
+
+		/**
+		 * Read the available replies and run their callbacks.
+		 */
+		bool read_replies();
+
+		/**
+		 * Watch the socket for writability while output is pending.
+		 */
+		void update_events();
+
+		/**
+		 * Close the connection, fail the outstanding lookups as misses and
+		 * back off.
+		 */
+		void handle_error(const std::string& reason);
+
+		void close_connection();
+
+		sockaddr_storage m_address{};
+		socklen_t m_address_length = 0;
+
+		// Database index of the URI, empty for the default one.
+		std::string m_database;
+
+		// Set by the reply to SELECT if Redis refused it.
+		bool m_is_selection_failed = false;
+
+		int m_epoll_fd = -1;
+		int m_fd = -1;
+		State m_state = State::DISCONNECTED;
+
+		// Events currently registered for m_fd.
+		uint32_t m_events = 0;
+
+		std::string m_output_buffer;
+		size_t m_output_position = 0;
+		std::string m_input_buffer;
+
+		std::deque<PendingReply> m_pending_replies;
+
+		// Coarse monotonic time before which Redis is skipped.
+		int64_t m_retry_time = 0;
+
+		Statistics m_statistics;
+	};
+} // namespace HTTP
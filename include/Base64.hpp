@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -43,9 +45,11 @@ namespace Base64
 	 *      Base64 string.
 	 *
 	 * @param[in] has_padding
-	 *      Whether has padding. Default is true.
+	 *      Whether has padding, i.e. is a multiple of 4 characters long;
+	 *      otherwise it must not end with '='. Default is true.
 	 *
-	 * @return  The unencoded/decoded string.
+	 * @return  The unencoded/decoded string, empty if the input is not valid
+	 *          Base64.
 	 */
 	std::string decode(const std::string& encoded_string,
 	                   bool has_padding = true);
@@ -72,10 +76,97 @@ namespace Base64
 	 *      The encoded URL string.
 	 *
 	 * @param[in] has_padding
-	 *      Whether has padding. Default is true.
+	 *      Whether has padding, i.e. is a multiple of 4 characters long;
+	 *      otherwise it must not end with '='. Default is true.
 	 *
-	 * @return  The decoded URL string.
+	 * @return  The decoded URL string, empty if the input is not valid
+	 *          Base64.
 	 */
 	std::string decode_url(const std::string& encoded_url_string,
 	                       bool has_padding = true);
-} // namespace Base64
\ No newline at end of file
+
+	/**
+	 * Number of characters encode_into() writes for the given input size.
+	 *
+	 * @param[in] size
+	 *      Number of raw bytes.
+	 *
+	 * @param[in] has_padding
+	 *      Whether has padding. Default is true.
+	 *
+	 * @return
+	 *      Length of the encoded string.
+	 */
+	size_t encoded_length(size_t size, bool has_padding = true);
+
+	/**
+	 * Upper bound of the number of bytes decode_into() writes for the given
+	 * input size.
+	 *
+	 * @param[in] size
+	 *      Number of Base64 characters, padding included.
+	 *
+	 * @return
+	 *      Size of the output buffer to provide to decode_into().
+	 */
+	size_t decoded_length(size_t size);
+
+	/**
+	 * Encode raw bytes into a caller-provided buffer.
+	 *
+	 * Large inputs are encoded 24 or 12 bytes at a time with AVX2 or SSSE3
+	 * when the CPU supports them.
+	 *
+	 * @param[in] data
+	 *      Raw bytes.
+	 *
+	 * @param[in] size
+	 *      Number of raw bytes.
+	 *
+	 * @param[out] output
+	 *      Buffer of at least encoded_length(size, has_padding) characters.
+	 *      No null terminator is written.
+	 *
+	 * @param[in] has_padding
+	 *      Whether has padding. Default is true.
+	 *
+	 * @param[in] is_url
+	 *      Whether to use the URL and filename safe alphabet. Default is
+	 *      false.
+	 *
+	 * @return
+	 *      Number of characters written.
+	 */
+	size_t encode_into(const void* data, size_t size, char* output,
+	                   bool has_padding = true, bool is_url = false);
+
+	/**
+	 * Decode Base64 characters into a caller-provided buffer.
+	 *
+	 * Trailing padding is optional. Large standard-alphabet inputs are
+	 * validated and decoded 32 or 16 characters at a time with AVX2 or SSSE3
+	 * when the CPU supports them.
+	 *
+	 * @param[in] data
+	 *      Base64 characters.
+	 *
+	 * @param[in] size
+	 *      Number of Base64 characters.
+	 *
+	 * @param[out] output
+	 *      Buffer of at least decoded_length(size) bytes.
+	 *
+	 * @param[out] decoded_size
+	 *      Number of bytes written.
+	 *
+	 * @param[in] is_url
+	 *      Whether to use the URL and filename safe alphabet. Default is
+	 *      false.
+	 *
+	 * @return
+	 *      False if the input contains a character outside the alphabet or
+	 *      has an impossible length.
+	 */
+	bool decode_into(const char* data, size_t size, uint8_t* output,
+	                 size_t& decoded_size, bool is_url = false);
+} // namespace Base64
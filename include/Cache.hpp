@@ -1,12 +1,29 @@
 #pragma once
 
-#include <sw/redis++/redis++.h>
+#include "AsyncRedis.hpp"
+#include "LocalCache.hpp"
+#include "NegativeCache.hpp"
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace HTTP
 {
+	/**
+	 * How long a cached resource may be served.
+	 */
+	struct Freshness
+	{
+		// Seconds it is served as is, 0 for as long as it's cached.
+		uint32_t time_to_live = 0;
+
+		// Seconds past that, or past a new generation, it is still served
+		// while one lookup recomputes it.
+		uint32_t stale_while_revalidate = 0;
+	};
+
 	/**
 	 * @brief LRU for recently visited resource.
 	 *
@@ -14,6 +31,30 @@ namespace HTTP
 	 *      1. Queries into databse;
 	 *      2. Files (e.g. HTML, CSS, Javascript files);
 	 *
+	 * Lookups check the worker's LocalCache first, then the SharedCache of
+	 * all workers and only then Redis; the latter two are optional. Hits
+	 * are copied into the levels in front of the one that had the entry.
+	 * Sizes and the Redis server are taken from the ServerConfiguration.
+	 *
+	 * Redis is reached through an AsyncRedis connection in the worker's
+	 * event loop: only the asynchronous get() asks it, and insertions and
+	 * erasures reach it behind the request.
+	 *
+	 * An asynchronous miss leases the resource in the SharedCache, so the
+	 * caller computes it while lookups of other workers wait for it to be
+	 * inserted instead of computing it too.
+	 *
+	 * Resources are inserted with a Freshness and stamped with the time and
+	 * the data generation, see set_generation(). Past its time to live, or
+	 * once the generation moved on, a resource is stale: asynchronous
+	 * lookups still answer with it during its stale-while-revalidate
+	 * window, and the one that leases it recomputes it. Past that window it
+	 * is a miss.
+	 *
+	 * Resources known not to exist, e.g. searches without results, are
+	 * remembered for a short while in a NegativeCache of the worker, until
+	 * the generation changes.
+	 *
 	 * @see https://redis.io/topics/lru-cache
 	 */
 	class Cache
@@ -30,12 +71,236 @@ namespace HTTP
 
 		explicit Cache(int cache_capacity);
 
+		/**
+		 * Outcome of an asynchronous lookup.
+		 */
+		enum class Lookup
+		{
+			HIT,
+
+			// A stale resource: answer with it, then compute it again and
+			// insert() it, or release() it.
+			REVALIDATE,
+
+			// Compute the resource and insert() it, or release() it.
+			MISS,
+		};
+
+		/**
+		 * Called with the resource of a lookup, empty on a miss.
+		 */
+		using LookupCallback =
+		    std::function<void(Lookup lookup, const std::string& resource)>;
+
+		/**
+		 * Look up the in-process and shared levels only.
+		 *
+		 * @return
+		 *      The resource, empty on a miss or if it is stale.
+		 */
 		std::string get(const std::string& uri);
-		bool insert(const std::string& uri, const std::string& resource);
+
+		/**
+		 * Look up every level. @b callback runs right away unless Redis is
+		 * asked or another worker is computing the resource, then from the
+		 * event loop.
+		 */
+		void get(const std::string& uri, LookupCallback callback);
+
+		/**
+		 * Insert a resource, ending the lease of a miss or revalidation on
+		 * it.
+		 *
+		 * @param[in] freshness
+		 *      Optional. Served as is until the generation changes, by
+		 *      default.
+		 */
+		bool insert(const std::string& uri, const std::string& resource,
+		            const Freshness& freshness = Freshness());
 		bool erase(const std::string& uri);
 
+		/**
+		 * End the lease of a miss or revalidation without a resource, so
+		 * that waiting workers compute it themselves.
+		 */
+		void release(const std::string& uri);
+
+		/**
+		 * Remember that a resource doesn't exist and end the lease of a
+		 * miss or revalidation on it, see is_known_missing().
+		 */
+		void insert_missing(const std::string& uri);
+
+		/**
+		 * Whether a resource was found not to exist in this worker since
+		 * the generation last changed, less than the negative cache time
+		 * to live ago. Checked before looking it up or computing it.
+		 */
+		bool is_known_missing(const std::string& uri);
+
+		/**
+		 * Set the generation of the data resources are computed from, e.g.
+		 * bumped as news are added. Resources of other generations are
+		 * stale; those of later ones, inserted by workers that noticed
+		 * first, are not.
+		 */
+		void set_generation(uint64_t generation);
+		uint64_t get_generation() const;
+
+		/**
+		 * Register the Redis connection with the worker's epoll instance.
+		 * Without it, lookups never wait for Redis.
+		 *
+		 * @see AsyncRedis::attach()
+		 */
+		void attach(int epoll_fd);
+
+		/**
+		 * Handle epoll events of @b fd if it is the Redis connection.
+		 *
+		 * @return
+		 *      True if @b fd belongs to the cache.
+		 */
+		bool handle_events(int fd, uint32_t events);
+
+		/**
+		 * Send the Redis commands queued while handling a batch of events,
+		 * give up on overdue replies and check on the resources other
+		 * workers are computing.
+		 */
+		void flush();
+
+		/**
+		 * @return
+		 *      Longest wait for events before flush() is due again, -1 for
+		 *      no limit.
+		 */
+		int get_poll_timeout() const;
+
+		/**
+		 * Get the hit, miss and eviction counters and the size of the
+		 * LocalCache.
+		 */
+		LocalCache::Statistics get_statistics() const;
+
+		/**
+		 * Policy of the LocalCache.
+		 */
+		CachePolicy get_policy() const;
+
+		/**
+		 * Whether Redis backs the LocalCache.
+		 */
+		bool has_redis() const;
+
+		/**
+		 * Get the command, write and error counters of the Redis
+		 * connection; all zero without Redis.
+		 */
+		AsyncRedis::Statistics get_redis_statistics() const;
+
+		/**
+		 * Number of lookups that waited for another worker to compute
+		 * their resource.
+		 */
+		uint64_t get_number_of_lease_waits() const;
+
+		/**
+		 * Number of lookups answered with a stale resource, and how many of
+		 * them were told to revalidate it.
+		 */
+		uint64_t get_number_of_stale_hits() const;
+		uint64_t get_number_of_revalidations() const;
+
+		/**
+		 * Get the hit and insertion counters of the NegativeCache.
+		 */
+		NegativeCache::Statistics get_negative_statistics() const;
+
 	private:
-		std::unique_ptr<sw::redis::Redis> m_cache;
+		/**
+		 * A lookup waiting for another worker to insert its resource.
+		 */
+		struct LeaseWaiter
+		{
+			std::string uri;
+			LookupCallback callback;
+		};
+
+		/**
+		 * Whether a stored resource is fresh, stale or past its
+		 * stale-while-revalidate window, the latter also if it isn't
+		 * stamped.
+		 */
+		enum class State
+		{
+			FRESH,
+			STALE,
+			EXPIRED,
+		};
+
+		/**
+		 * Judge a stored resource by its stamp.
+		 */
+		State read_stamp(const std::string& stored) const;
+
+		/**
+		 * Judge a stored resource and strip its stamp.
+		 *
+		 * @param[out] resource
+		 *      The resource unless EXPIRED.
+		 */
+		State read_stored(const std::string& stored,
+		                  std::string& resource) const;
+
+		/**
+		 * Like the above, but move the resource out of @b stored.
+		 */
+		State read_stored(std::string&& stored, std::string& resource) const;
+
+		/**
+		 * Look up the in-process and shared levels, preferring a fresh
+		 * resource of the shared level over a stale one of this process.
+		 */
+		State find(const std::string& uri, std::string& resource);
+
+		/**
+		 * Answer with a found resource, telling the caller to revalidate a
+		 * stale one unless someone else does.
+		 */
+		void answer(const std::string& uri, State state,
+		            const std::string& resource,
+		            const LookupCallback& callback);
+
+		/**
+		 * Lease a missing resource and tell the caller to compute it, or
+		 * wait for the worker holding the lease.
+		 */
+		void lease_or_wait(const std::string& uri, LookupCallback callback);
+
+		/**
+		 * Answer the waiters whose resource was inserted or whose lease
+		 * ended.
+		 */
+		void check_lease_waiters();
+
+		LocalCache m_local_cache;
+		NegativeCache m_negative_cache;
+
+		std::vector<LeaseWaiter> m_lease_waiters;
+		uint64_t m_number_of_lease_waits = 0;
+
+		uint64_t m_generation = 0;
+
+		// Coarse realtime seconds this worker saw the generation change at,
+		// which outdated resources are stale since.
+		int64_t m_generation_changed_at = 0;
+
+		uint64_t m_number_of_stale_hits = 0;
+		uint64_t m_number_of_revalidations = 0;
+
+		// Null if Redis is disabled.
+		std::unique_ptr<AsyncRedis> m_redis;
 
 		/**
 		 * If cache size is greater than m_cache_capacity,
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Uri.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace HTTP
+{
+	/**
+	 * Content codings a cached body is kept in.
+	 */
+	enum class ContentEncoding : uint8_t
+	{
+		IDENTITY = 0,
+		DEFLATE = 1,
+	};
+
+	/**
+	 * @brief Binary format of cached responses.
+	 *
+	 * An entry holds one serialized response per content coding of the same
+	 * resource, so a single key answers every client whatever it accepts.
+	 * Integers are little endian and every field is length-prefixed:
+	 *
+	 *      "WFC1"                  magic and format version
+	 *      u8                      number of variants
+	 *      then for each variant:
+	 *          u8                  ContentEncoding
+	 *          u32                 offset of the Date value in the message
+	 *          u32                 length of the message
+	 *          message             complete HTTP/1.1 response
+	 *
+	 * A hit only walks the prefixes to find its variant; the message is
+	 * copied to the connection's output buffer as is, with the current Date
+	 * patched in.
+	 */
+	namespace CacheEntry
+	{
+		/**
+		 * A serialized response, pointing into a message or an entry.
+		 */
+		struct Variant
+		{
+			ContentEncoding encoding = ContentEncoding::IDENTITY;
+			const char* message = nullptr;
+			size_t length = 0;
+			size_t date_offset = 0;
+		};
+
+		/**
+		 * Build the cache key of a request: the path and the query
+		 * parameters sorted by name, so neither their order nor their
+		 * percent-encoding splits one resource over several keys.
+		 */
+		std::string make_key(Uri& uri);
+
+		/**
+		 * Build the cache key of the path of a request with other query
+		 * parameters, e.g. only those the resource depends on, normalized.
+		 */
+		std::string make_key(Uri& uri, const Uri::QueryParameters& parameters);
+
+		/**
+		 * Choose the content coding of a response from the Accept-Encoding
+		 * header of the request.
+		 *
+		 * @return
+		 *      DEFLATE if accepted with a non-zero quality, else IDENTITY.
+		 */
+		ContentEncoding
+		negotiate_encoding(const std::string& accept_encoding);
+
+		/**
+		 * Serialize variants into an entry.
+		 *
+		 * @note
+		 *      Throws std::length_error for more than 255 variants or a
+		 *      message of 4 GiB or more.
+		 */
+		std::string encode(const std::vector<Variant>& variants);
+
+		/**
+		 * Find the variant of a content coding in an entry, without copying
+		 * it.
+		 *
+		 * @param[out] variant
+		 *      Points into @b entry, valid as long as it is.
+		 *
+		 * @return
+		 *      False if @b entry has no such variant or is malformed.
+		 */
+		bool find_variant(const std::string& entry, ContentEncoding encoding,
+		                  Variant& variant);
+	} // namespace CacheEntry
+} // namespace HTTP
@@ -1,15 +1,60 @@
 #pragma once
 
+#include <cstdint>
 #include <initializer_list>
 #include <memory>
 #include <set>
 #include <string>
 
+namespace CharacterSetDetail
+{
+	/**
+	 * Bits of the inclusive byte range [first, last] that fall into the given
+	 * 64-bit word of a 256-bit character bitmap.
+	 */
+	constexpr uint64_t range_word(unsigned first, unsigned last, unsigned word)
+	{
+		return (last < word * 64 || first > word * 64 + 63)
+		           ? 0
+		           : ((~uint64_t{0}) >>
+		              (63 - ((last > word * 64 + 63 ? word * 64 + 63 : last) -
+		                     word * 64))) &
+		                 ((~uint64_t{0})
+		                  << ((first < word * 64 ? word * 64 : first) -
+		                      word * 64));
+	}
+
+	/**
+	 * Bits of a null-terminated character list that fall into the given
+	 * 64-bit word of a 256-bit character bitmap.
+	 */
+	constexpr uint64_t characters_word(const char* characters, unsigned word)
+	{
+		return *characters == '\0'
+		           ? 0
+		           : (range_word(static_cast<unsigned char>(*characters),
+		                         static_cast<unsigned char>(*characters),
+		                         word) |
+		              characters_word(characters + 1, word));
+	}
+} // namespace CharacterSetDetail
+
+/**
+ * A set of 8-bit characters stored as a 256-bit bitmap.
+ *
+ * Every membership test is a single shift-and-mask of one 64-bit word, and
+ * all the single character, range and union constructors are constexpr, so
+ * fixed character classes (see namespace Rfc3986 below) are built at compile
+ * time.
+ */
 class CharacterSet
 {
 public:
 	~CharacterSet() = default;
-	CharacterSet() = default;
+	constexpr CharacterSet()
+	    : m_bits{0, 0, 0, 0}
+	{
+	}
 
 	CharacterSet(const CharacterSet&) = default;
 	CharacterSet& operator=(const CharacterSet&) = default;
@@ -17,8 +62,16 @@ public:
 	CharacterSet(CharacterSet&&) = default;
 	CharacterSet& operator=(CharacterSet&&) = default;
 
-	bool operator==(const CharacterSet& other) const;
-	bool operator!=(const CharacterSet& other) const;
+	constexpr bool operator==(const CharacterSet& other) const
+	{
+		return m_bits[0] == other.m_bits[0] && m_bits[1] == other.m_bits[1] &&
+		       m_bits[2] == other.m_bits[2] && m_bits[3] == other.m_bits[3];
+	}
+
+	constexpr bool operator!=(const CharacterSet& other) const
+	{
+		return !(*this == other);
+	}
 
 	/**
 	 * Construct one character.
@@ -26,7 +79,10 @@ public:
 	 * @param[in] c
 	 * 		A character.
 	 */
-	explicit CharacterSet(char c);
+	constexpr explicit CharacterSet(char c)
+	    : CharacterSet(c, c)
+	{
+	}
 
 	/**
 	 * Construct a list of characters.
@@ -53,7 +109,51 @@ public:
 	 * @param[in] last
 	 * 		Last character.
 	 */
-	CharacterSet(char first, char last);
+	constexpr CharacterSet(char first, char last)
+	    : CharacterSet(static_cast<unsigned char>(first) <=
+	                           static_cast<unsigned char>(last)
+	                       ? static_cast<unsigned char>(first)
+	                       : static_cast<unsigned char>(last),
+	                   static_cast<unsigned char>(first) <=
+	                           static_cast<unsigned char>(last)
+	                       ? static_cast<unsigned char>(last)
+	                       : static_cast<unsigned char>(first),
+	                   0)
+	{
+	}
+
+	/**
+	 * Build a set from a null-terminated list of characters at compile time.
+	 *
+	 * @param[in] characters
+	 * 		Characters to be inserted into set, e.g. ":/?#[]@".
+	 *
+	 * @return
+	 * 		Set of the given characters.
+	 */
+	static constexpr CharacterSet from_characters(const char* characters)
+	{
+		return CharacterSet(CharacterSetDetail::characters_word(characters, 0),
+		                    CharacterSetDetail::characters_word(characters, 1),
+		                    CharacterSetDetail::characters_word(characters, 2),
+		                    CharacterSetDetail::characters_word(characters, 3));
+	}
+
+	/**
+	 * Union of two sets.
+	 *
+	 * @param[in] other
+	 * 		The other set.
+	 *
+	 * @return
+	 * 		Set that contains characters of both sets.
+	 */
+	constexpr CharacterSet operator|(const CharacterSet& other) const
+	{
+		return CharacterSet(
+		    m_bits[0] | other.m_bits[0], m_bits[1] | other.m_bits[1],
+		    m_bits[2] | other.m_bits[2], m_bits[3] | other.m_bits[3]);
+	}
 
 	/**
 	 * Is contain given character?
@@ -64,7 +164,12 @@ public:
 	 * @return
 	 * 		True if contain c.
 	 */
-	bool is_contains(char c) const;
+	constexpr bool is_contains(char c) const
+	{
+		return ((m_bits[static_cast<unsigned char>(c) >> 6] >>
+		         (static_cast<unsigned char>(c) & 63)) &
+		        1) != 0;
+	}
 
 	/**
 	 * @brief Get the character set object
@@ -74,5 +179,59 @@ public:
 	std::set<char> get_character_set() const;
 
 private:
-	std::set<char> m_character_set;
-};
\ No newline at end of file
+	constexpr CharacterSet(unsigned first, unsigned last, int /* tag */)
+	    : m_bits{CharacterSetDetail::range_word(first, last, 0),
+	             CharacterSetDetail::range_word(first, last, 1),
+	             CharacterSetDetail::range_word(first, last, 2),
+	             CharacterSetDetail::range_word(first, last, 3)}
+	{
+	}
+
+	constexpr CharacterSet(uint64_t word_0, uint64_t word_1, uint64_t word_2,
+	                       uint64_t word_3)
+	    : m_bits{word_0, word_1, word_2, word_3}
+	{
+	}
+
+	// bit (c & 63) of m_bits[c >> 6] is set if c is in the set.
+	uint64_t m_bits[4];
+};
+
+/**
+ * Character classes of RFC 3986, built at compile time.
+ *
+ * @see https://tools.ietf.org/html/rfc3986#appendix-A
+ */
+namespace Rfc3986
+{
+	constexpr CharacterSet ALPHA = CharacterSet('a', 'z') |
+	                               CharacterSet('A', 'Z');
+
+	constexpr CharacterSet DIGIT = CharacterSet('0', '9');
+
+	constexpr CharacterSet HEXDIG = DIGIT | CharacterSet('A', 'F') |
+	                                CharacterSet('a', 'f');
+
+	constexpr CharacterSet UNRESERVED =
+	    ALPHA | DIGIT | CharacterSet::from_characters("-._~");
+
+	// General delimiters
+	constexpr CharacterSet GEN_DELIMS =
+	    CharacterSet::from_characters(":/?#[]@");
+
+	// Subcomponents delimiters
+	constexpr CharacterSet SUB_DELIMS =
+	    CharacterSet::from_characters("!$&'()*+,;=");
+
+	constexpr CharacterSet RESERVED = GEN_DELIMS | SUB_DELIMS;
+
+	/**
+	 * Characters allowed literally in a path segment. '%' is not included;
+	 * percent-encoded triplets are validated separately.
+	 */
+	constexpr CharacterSet PCHAR =
+	    UNRESERVED | SUB_DELIMS | CharacterSet::from_characters(":@");
+
+	// Characters allowed literally in a query (and in a fragment).
+	constexpr CharacterSet QUERY = PCHAR | CharacterSet::from_characters("/?");
+} // namespace Rfc3986
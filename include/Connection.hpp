@@ -2,6 +2,7 @@
 
 #include "Request.hpp"
 #include "Response.hpp"
+#include "Router.hpp"
 
 #include <memory>
 
@@ -29,11 +30,17 @@ namespace HTTP
 		RequestPtr& get_request();
 		ResponsePtr& get_response();
 
+		/**
+		 * Get the route of the current request, filled in by Router::route().
+		 */
+		RouteMatch& get_route_match();
+
 		bool operator==(const Connection& other) const;
 		bool operator!=(const Connection& other) const;
 
 	private:
 		RequestPtr m_request;
 		ResponsePtr m_response;
+		RouteMatch m_route_match;
 	};
 } // namespace HTTP
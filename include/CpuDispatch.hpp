@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Kernels with instruction set specific variants are compiled into the same
+ * binary with per-function target attributes, so the build needs no -m
+ * flags and runs on any x86-64 CPU.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_DISPATCH_X86 1
+#define CPU_DISPATCH_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+/**
+ * Pick the widest instruction set variant of a kernel at runtime.
+ *
+ * The instruction sets supported by the CPU are detected once with cpuid.
+ * The active instruction set can be capped below that, e.g. to compare
+ * variants of the same binary in A/B benchmarks.
+ */
+namespace CpuDispatch
+{
+	/**
+	 * Instruction set levels, each implying the ones before it.
+	 */
+	enum class Isa
+	{
+		SCALAR,
+		SSE2,
+		SSSE3,
+		SSE42,
+		AVX2
+	};
+
+	constexpr size_t NUMBER_OF_ISAS = 5;
+
+	/**
+	 * Get the widest instruction set level the CPU and OS support.
+	 */
+	Isa get_detected_isa();
+
+	/**
+	 * Get the instruction set level kernels are currently dispatched to.
+	 */
+	Isa get_active_isa();
+
+	/**
+	 * Whether the SHA extensions are supported and enabled, which requires
+	 * an active level of at least SSE42.
+	 */
+	bool has_sha_extensions();
+
+	/**
+	 * Cap the active instruction set level. Levels above the detected one
+	 * are clamped to it.
+	 *
+	 * @param[in] isa
+	 *      Widest level to dispatch to.
+	 */
+	void force_isa(Isa isa);
+
+	/**
+	 * Cap the active instruction set level by name.
+	 *
+	 * @param[in] isa_name
+	 *      One of "scalar", "sse2", "ssse3", "sse4.2", "avx2", or empty to
+	 *      restore the detected level.
+	 *
+	 * @return
+	 *      False if the name is unknown, in which case nothing changes.
+	 */
+	bool force_isa(const std::string& isa_name);
+
+	/**
+	 * Get the name of an instruction set level as accepted by force_isa().
+	 */
+	const char* get_isa_name(Isa isa);
+
+	/**
+	 * A kernel with one function per instruction set level.
+	 *
+	 * Levels without their own variant fall back to the nearest narrower
+	 * one, so only the scalar variant is mandatory. Constant initialized,
+	 * hence safe to call from other static initializers.
+	 */
+	template <typename Function> class Kernel
+	{
+	public:
+		constexpr explicit Kernel(Function scalar, Function sse2 = nullptr,
+		                          Function ssse3 = nullptr,
+		                          Function sse42 = nullptr,
+		                          Function avx2 = nullptr)
+		    : m_variants{scalar, pick(sse2, scalar),
+		                 pick(ssse3, pick(sse2, scalar)),
+		                 pick(sse42, pick(ssse3, pick(sse2, scalar))),
+		                 pick(avx2,
+		                      pick(sse42, pick(ssse3, pick(sse2, scalar))))}
+		{
+		}
+
+		/**
+		 * Get the variant of the active instruction set level.
+		 */
+		Function get() const
+		{
+			return m_variants[static_cast<size_t>(get_active_isa())];
+		}
+
+	private:
+		static constexpr Function pick(Function variant, Function fallback)
+		{
+			return variant != nullptr ? variant : fallback;
+		}
+
+		Function m_variants[NUMBER_OF_ISAS];
+	};
+} // namespace CpuDispatch
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <sqlite3.h>
+#include <string>
+
+/**
+ * A copy of the news database in shared memory, searched by every worker
+ * instead of the file.
+ *
+ * The master loads the image into a sealed memfd and maps it read-only
+ * before forking, so workers inherit the mapping and share its physical
+ * pages, which SQLite reads in place. The image is a snapshot: news added
+ * to the file afterwards aren't searched until the server restarts.
+ */
+namespace DatabaseImage
+{
+	/**
+	 * Load a database, replacing the image of this process.
+	 *
+	 * @param[in] database_path
+	 *      Database file to copy.
+	 *
+	 * @return
+	 *      True if succeeds; there's no image otherwise.
+	 */
+	bool create(const std::string& database_path);
+
+	/**
+	 * Unmap the image of this process.
+	 */
+	void destroy();
+
+	/**
+	 * Whether this process has an image.
+	 */
+	bool is_loaded();
+
+	/**
+	 * Get the size of the image in bytes, 0 without one.
+	 */
+	size_t get_size();
+
+	/**
+	 * Open a read-only connection on the image.
+	 *
+	 * @return
+	 *      Null without an image, or if it can't be opened.
+	 */
+	sqlite3* open();
+} // namespace DatabaseImage
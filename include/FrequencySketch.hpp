@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace HTTP
+{
+	/**
+	 * Which entries a full cache keeps.
+	 */
+	enum class CachePolicy
+	{
+		// Admit every entry and evict the least recently used one.
+		LRU,
+
+		// Admit an entry only if its key is used more often than the keys
+		// of the entries it would evict, see FrequencySketch.
+		TINY_LFU,
+	};
+
+	/**
+	 * Look up a policy by name.
+	 *
+	 * @return
+	 *      CachePolicy::LRU for "lru", CachePolicy::TINY_LFU otherwise.
+	 */
+	CachePolicy to_cache_policy(const std::string& policy_name);
+
+	/**
+	 * @return
+	 *      "lru" or "tinylfu".
+	 */
+	const char* get_cache_policy_name(CachePolicy policy);
+
+	/**
+	 * @brief Approximate recent access frequencies of keys, for TinyLFU
+	 * cache admission.
+	 *
+	 * A count-min sketch of 4-bit counters: each key hash picks four
+	 * counters, and its frequency is the smallest of them, so collisions
+	 * only ever overestimate. Once the sketch has counted ten accesses per
+	 * word of counters, every counter is halved, so that keys popular long
+	 * ago fade out.
+	 *
+	 * The counters may live in memory shared between processes. Updates
+	 * are plain atomic loads and stores: a concurrent update may get lost,
+	 * which only makes the estimate a little lower.
+	 *
+	 * @see https://arxiv.org/abs/1512.00727
+	 */
+	class FrequencySketch
+	{
+	public:
+		/**
+		 * Sketch in memory of its own.
+		 *
+		 * @param[in] number_of_entries
+		 *      Entries the cache is expected to hold at most.
+		 */
+		explicit FrequencySketch(size_t number_of_entries);
+
+		/**
+		 * Sketch in @b table, e.g. in shared memory, zero-filled when new.
+		 *
+		 * @param[in] table
+		 *      get_table_size() words.
+		 */
+		FrequencySketch(std::atomic<uint64_t>* table,
+		                size_t number_of_entries);
+
+		~FrequencySketch();
+
+		FrequencySketch(const FrequencySketch& other) = delete;
+		FrequencySketch& operator=(const FrequencySketch& other) = delete;
+
+		FrequencySketch(FrequencySketch&& other) = delete;
+		FrequencySketch& operator=(FrequencySketch&& other) = delete;
+
+		/**
+		 * @return
+		 *      Words of the table of a sketch for @b number_of_entries.
+		 */
+		static size_t get_table_size(size_t number_of_entries);
+
+		/**
+		 * Count an access to a key.
+		 */
+		void increment(uint64_t key_hash);
+
+		/**
+		 * @return
+		 *      Estimated recent accesses to a key, at most 15.
+		 */
+		unsigned estimate(uint64_t key_hash) const;
+
+		/**
+		 * Whether a new entry deserves the place of a victim: only if its
+		 * key is used more often.
+		 */
+		bool admit(uint64_t candidate_hash, uint64_t victim_hash) const;
+
+	private:
+		/**
+		 * Halve every counter.
+		 */
+		void age();
+
+		std::unique_ptr<std::atomic<uint64_t>[]> m_owned_table;
+
+		// Counters, followed by the number of accesses counted since the
+		// last aging.
+		std::atomic<uint64_t>* m_table;
+		size_t m_mask;
+		uint64_t m_sample_size;
+	};
+} // namespace HTTP
@@ -2,6 +2,7 @@
 
 #include "Connection.hpp"
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -21,12 +22,43 @@ public:
 	virtual bool
 	fetch_resource(std::shared_ptr<HTTP::Connection> connection) = 0;
 
+	/**
+	 * Called with the result of fetch_resource_async().
+	 */
+	using FetchCallback = std::function<void(bool is_fetched)>;
+
+	/**
+	 * Fetch resource like fetch_resource(), but possibly finish later from
+	 * the worker's event loop, e.g. after a Redis round-trip.
+	 *
+	 * @param[in] callback
+	 *      Called exactly once, possibly before this returns.
+	 */
+	virtual void
+	fetch_resource_async(std::shared_ptr<HTTP::Connection> connection,
+	                     FetchCallback callback)
+	{
+		callback(fetch_resource(std::move(connection)));
+	}
+
 	IResourceHandler() noexcept = default;
-	~IResourceHandler() = default;
+	virtual ~IResourceHandler() = default;
 
 	IResourceHandler(const IResourceHandler& other) = delete;
 	IResourceHandler& operator=(const IResourceHandler& other) = delete;
 
 	IResourceHandler(IResourceHandler&& other) = delete;
 	IResourceHandler& operator=(IResourceHandler&& other) = delete;
+
+protected:
+	/**
+	 * Whether to answer with the headers only. HEAD requests reach the
+	 * handlers of GET routes, which may then skip the work that only
+	 * produces the body, e.g. reading files.
+	 */
+	static bool
+	is_head_request(const std::shared_ptr<HTTP::Connection>& connection)
+	{
+		return connection->get_request()->get_method() == HTTP::Method::HEAD;
+	}
 };
\ No newline at end of file
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "FrequencySketch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HTTP
+{
+	/**
+	 * @brief Size-bounded in-process cache of serialized responses.
+	 *
+	 * Keys are spread over shards, each evicting with the CLOCK algorithm
+	 * (second chance LRU approximation) once it outgrows its share of the
+	 * capacity. A hit only sets a reference bit, so lookups never reorder
+	 * anything.
+	 *
+	 * Each worker process owns its cache and uses it from its event loop
+	 * only, so shards aren't locked. They keep rehashing and eviction
+	 * sweeps short.
+	 *
+	 * With CachePolicy::TINY_LFU (W-TinyLFU), new entries first go to a
+	 * window of 1% of each shard. An entry leaving the window only gets
+	 * into the rest of the shard if its key is used more often than the
+	 * key of each entry the CLOCK hand would evict to make room, so a scan
+	 * of one-off queries can't flush the popular ones. Accesses are
+	 * counted in a FrequencySketch.
+	 */
+	class LocalCache
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evictions = 0;
+
+			// Entries dropped from the window for keys used less often than
+			// those of the entries they would have evicted.
+			uint64_t rejections = 0;
+
+			// Keys, values and per-entry bookkeeping.
+			size_t size_in_bytes = 0;
+			size_t number_of_entries = 0;
+		};
+
+		/**
+		 * @param[in] capacity_in_bytes
+		 *      Upper bound of the size of all entries, see
+		 *      Statistics::size_in_bytes.
+		 *
+		 * @param[in] number_of_shards
+		 *      At least one.
+		 *
+		 * @param[in] policy
+		 *      Optional. Which entries to keep once full.
+		 */
+		LocalCache(size_t capacity_in_bytes, size_t number_of_shards,
+		           CachePolicy policy = CachePolicy::LRU);
+		~LocalCache();
+
+		LocalCache(const LocalCache& other) = delete;
+		LocalCache& operator=(const LocalCache& other) = delete;
+
+		LocalCache(LocalCache&& other) = delete;
+		LocalCache& operator=(LocalCache&& other) = delete;
+
+		/**
+		 * Look up an entry.
+		 *
+		 * @param[out] value
+		 *      Value of the entry if found.
+		 *
+		 * @return
+		 *      True on a hit.
+		 */
+		bool get(const std::string& key, std::string& value);
+
+		/**
+		 * Insert or replace an entry, evicting others if needed.
+		 *
+		 * @return
+		 *      False if the entry is larger than a shard, or is rejected by
+		 *      the policy right away, and isn't cached.
+		 */
+		bool insert(const std::string& key, const std::string& value);
+
+		/**
+		 * @return
+		 *      True if the entry existed.
+		 */
+		bool erase(const std::string& key);
+
+		void clear();
+
+		Statistics get_statistics() const;
+
+		size_t get_capacity() const;
+
+		CachePolicy get_policy() const;
+
+	private:
+		struct Entry
+		{
+			// Key of the index node; nullptr for a free entry.
+			const std::string* key = nullptr;
+			std::string value;
+			size_t key_hash = 0;
+
+			// Set on hits, cleared as the CLOCK hand passes.
+			bool is_referenced = false;
+
+			// Not admitted past the window yet.
+			bool is_in_window = false;
+		};
+
+		struct Shard
+		{
+			std::unordered_map<std::string, size_t> index;
+			std::vector<Entry> entries;
+			std::vector<size_t> free_entries;
+			size_t hand = 0;
+			Statistics statistics;
+
+			// Positions of the window entries, oldest first.
+			std::deque<size_t> window;
+			size_t window_size_in_bytes = 0;
+		};
+
+		Shard& get_shard(size_t key_hash);
+
+		/**
+		 * Free the entry at @b position and account for it.
+		 */
+		static void remove_entry(Shard& shard, size_t position);
+
+		/**
+		 * Advance the CLOCK hand to the first unreferenced entry outside
+		 * the window, clearing reference bits on the way.
+		 *
+		 * @return
+		 *      Position of the entry.
+		 */
+		static size_t find_victim(Shard& shard);
+
+		/**
+		 * Evict the entry find_victim() picks.
+		 */
+		static void evict_one(Shard& shard);
+
+		/**
+		 * Move the oldest window entry into the rest of the shard, if its
+		 * key is used more often than those of the entries it evicts, or
+		 * drop it.
+		 *
+		 * @return
+		 *      False if the entry was dropped.
+		 */
+		bool admit_from_window(Shard& shard);
+
+		std::vector<Shard> m_shards;
+
+		size_t m_capacity;
+		size_t m_shard_capacity;
+
+		CachePolicy m_policy;
+
+		// Of every shard, 0 with CachePolicy::LRU.
+		size_t m_window_capacity;
+
+		// Null with CachePolicy::LRU.
+		std::unique_ptr<FrequencySketch> m_sketch;
+	};
+} // namespace HTTP
@@ -15,7 +15,17 @@
 
 namespace
 {
-	std::string m_log_directory_path = {};
+	/**
+	 * Get the log directory path, read from the configuration on first use.
+	 * The initialization of a local static is thread-safe, so threads of a
+	 * ThreadPool may log as well.
+	 */
+	inline const std::string& read_log_directory_path()
+	{
+		static const std::string log_directory_path =
+		    ServerConfiguration::instance()->get_log_directory_path();
+		return log_directory_path;
+	}
 
 	enum class LogLevel
 	{
@@ -40,20 +50,15 @@ namespace
 	inline void log(const LogLevel& log_level, const std::string& log_message,
 	                const int log_errno)
 	{
-		if (m_log_directory_path.empty())
-		{
-			m_log_directory_path =
-			    ServerConfiguration::instance()->get_log_directory_path();
-		}
-
-		std::ofstream log_file(m_log_directory_path + get_date() + ".log",
+		std::ofstream log_file(read_log_directory_path() +
+		                           Timer::get_cached_date() + ".log",
 		                       std::ios_base::app);
 		if (!log_file.is_open())
 		{
 			return;
 		}
 
-		log_file << get_current_time();
+		log_file << Timer::get_cached_log_time();
 		if (log_level == LogLevel::INFO)
 		{
 			log_file << " [info] ";
@@ -136,11 +141,6 @@ namespace Logger
 	 */
 	inline std::string get_log_directory_path()
 	{
-		if (m_log_directory_path.empty())
-		{
-			m_log_directory_path =
-			    ServerConfiguration::instance()->get_log_directory_path();
-		}
-		return m_log_directory_path;
+		return read_log_directory_path();
 	}
 } // namespace Logger
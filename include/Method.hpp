@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace HTTP
+{
+	/**
+	 * Request methods, interned once when the request line is parsed so that
+	 * dispatching compares integers instead of strings.
+	 */
+	enum class Method
+	{
+		GET,
+		HEAD,
+		POST,
+		PUT,
+		DELETE,
+		CONNECT,
+		OPTIONS,
+		TRACE,
+		PATCH,
+		UNKNOWN
+	};
+
+	// Number of known methods, i.e. all but UNKNOWN.
+	constexpr size_t NUMBER_OF_METHODS = 9;
+
+	/**
+	 * Intern a method name.
+	 *
+	 * @param[in] method_name
+	 *      Method token of a request line. Method names are case-sensitive.
+	 *
+	 * @return
+	 *      The method, or Method::UNKNOWN.
+	 */
+	Method to_method(const std::string& method_name);
+
+	/**
+	 * Get the name of a method.
+	 *
+	 * @return
+	 *      Method name, e.g. "GET", or "" for Method::UNKNOWN.
+	 */
+	const char* get_method_name(Method method);
+} // namespace HTTP
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Cache.hpp"
+#include "IResourceHandler.hpp"
+#include "StatementCache.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Report the worker's cache counters and the scoreboard in the Prometheus
+ * text format, answering "/metrics".
+ *
+ * Caches are per worker, so their series are labelled with the pid of the
+ * worker that answered.
+ */
+class MetricsHandler : public IResourceHandler
+{
+public:
+	/**
+	 * @param[in] cache
+	 *      Cache to report on.
+	 *
+	 * @param[in] statement_caches
+	 *      Optional. Prepared statements of the search to report on, summed
+	 *      over its connections.
+	 */
+	explicit MetricsHandler(
+	    std::shared_ptr<HTTP::Cache> cache,
+	    std::vector<std::shared_ptr<const HTTP::StatementCache>>
+	        statement_caches = {});
+	~MetricsHandler() override = default;
+
+	bool fetch_resource(std::shared_ptr<HTTP::Connection> connection) override;
+
+private:
+	/**
+	 * Read the memory usage of the workers, unless it was read less than
+	 * a few seconds ago; scrapes are answered on the event loop.
+	 */
+	void sample_memory_usage();
+
+	std::shared_ptr<HTTP::Cache> m_cache;
+	std::vector<std::shared_ptr<const HTTP::StatementCache>>
+	    m_statement_caches;
+
+	// Memory usage of the workers at the last sample, in bytes.
+	int64_t m_memory_sampled_at = 0;
+	uint64_t m_resident_bytes = 0;
+	uint64_t m_proportional_bytes = 0;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace HTTP
+{
+	/**
+	 * @brief Short-lived memory of keys known to have no resource, e.g.
+	 * searches without results, so that they aren't computed again.
+	 *
+	 * Only a 64-bit hash of each key is kept, with its expiry time: 16
+	 * bytes per entry whatever the key. The table is a fixed number of
+	 * sets of 4 entries; a new key replaces an expired entry of its set, or
+	 * the one expiring first. A key whose hash collides with a remembered
+	 * one would be missed for a while; with 64-bit hashes, that doesn't
+	 * happen in practice.
+	 *
+	 * Like the LocalCache, it belongs to a worker's event loop and isn't
+	 * locked.
+	 */
+	class NegativeCache
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t hits = 0;
+			uint64_t insertions = 0;
+
+			// Unexpired entries replaced by others of their set.
+			uint64_t evictions = 0;
+		};
+
+		/**
+		 * @param[in] number_of_entries
+		 *      Rounded up to a power of 2.
+		 * @param[in] time_to_live_ms
+		 *      How long a key is remembered, 0 disabling the cache.
+		 */
+		NegativeCache(size_t number_of_entries, int64_t time_to_live_ms);
+
+		/**
+		 * @return
+		 *      True if @b key was inserted less than the time to live ago.
+		 */
+		bool contains(const std::string& key);
+
+		void insert(const std::string& key);
+		void erase(const std::string& key);
+
+		/**
+		 * Forget every key, e.g. once the data changed.
+		 */
+		void clear();
+
+		Statistics get_statistics() const;
+
+	private:
+		struct Entry
+		{
+			// 0 for an empty entry.
+			uint64_t key_hash = 0;
+			int64_t expires_at = 0;
+		};
+
+		/**
+		 * Find the entry of a key hash.
+		 *
+		 * @return
+		 *      Null if it isn't in the table.
+		 */
+		Entry* find(uint64_t key_hash);
+
+		std::vector<Entry> m_entries;
+		size_t m_set_mask;
+		int64_t m_time_to_live_ms;
+		Statistics m_statistics;
+	};
+} // namespace HTTP
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <map>
+#include <cstddef>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -39,6 +39,75 @@ public:
 	 */
 	std::string decode(const std::string& encoded_string);
 
+	/**
+	 * Find the first byte that decoding has to rewrite: a '%', or a '+' if
+	 * @b plus_as_space is set. Scans 16 or 32 bytes at a time with SSE2 or
+	 * AVX2, whichever CpuDispatch selects.
+	 *
+	 * @param[in] data
+	 * 		Encoded bytes.
+	 *
+	 * @param[in] size
+	 * 		Number of bytes.
+	 *
+	 * @param[in] plus_as_space
+	 * 		Whether '+' stands for a space (application/x-www-form-urlencoded).
+	 *
+	 * @return
+	 * 		Index of the first such byte, or @b size if there is none.
+	 */
+	static size_t find_escape(const char* data, size_t size,
+	                          bool plus_as_space = false);
+
+	/**
+	 * Whether decoding would change the given string at all.
+	 *
+	 * @param[in] encoded_string
+	 * 		String that may have been encoded.
+	 *
+	 * @param[in] plus_as_space
+	 * 		Whether '+' stands for a space.
+	 *
+	 * @return
+	 * 		True if it contains any escape.
+	 */
+	static bool needs_decoding(const std::string& encoded_string,
+	                           bool plus_as_space = false);
+
+	/**
+	 * Decode the given bytes in place. Decoding never grows the data, so
+	 * the result always fits into the input buffer. Input without escapes
+	 * is scanned but never written.
+	 *
+	 * Malformed escapes (a '%' not followed by two hexadecimal digits) are
+	 * kept literally.
+	 *
+	 * @param[in, out] data
+	 * 		Encoded bytes; holds the decoded bytes on return.
+	 *
+	 * @param[in] size
+	 * 		Number of encoded bytes.
+	 *
+	 * @param[in] plus_as_space
+	 * 		Whether '+' stands for a space.
+	 *
+	 * @return
+	 * 		Number of decoded bytes.
+	 */
+	static size_t decode_in_place(char* data, size_t size,
+	                              bool plus_as_space = false);
+
+	/**
+	 * Decode the given string in place.
+	 *
+	 * @param[in, out] text
+	 * 		Encoded string; holds the decoded string on return.
+	 *
+	 * @param[in] plus_as_space
+	 * 		Whether '+' stands for a space.
+	 */
+	static void decode_in_place(std::string& text, bool plus_as_space = false);
+
 private:
 	/**
 	 * Convert decimal integer to corresponding hexadecimal character.
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+/**
+ * Normalization of search queries, so that queries the full-text index
+ * answers alike share one cache entry, e.g. "Fly", "fly" and " fly ".
+ *
+ * A normalized query is also what SQLite is asked: it matches the same
+ * news, since the index folds case and splits words on whitespace itself.
+ * FTS5 operators (the barewords AND, OR, NOT and NEAR outside strings)
+ * are case-sensitive, so they keep their case.
+ */
+namespace QueryNormalizer
+{
+	/**
+	 * Normalize a UTF-8 query:
+	 *      1. fold its case, see Utf8::FoldCase();
+	 *      2. trim whitespace, and collapse runs of it into single spaces;
+	 *      3. sort combining marks canonically, see
+	 *         Utf8::OrderCanonically().
+	 *
+	 * @param[in] query
+	 *      Percent-decoded "q" parameter of a request.
+	 *
+	 * @return
+	 *      The normalized query.
+	 */
+	std::string normalize(const std::string& query);
+} // namespace QueryNormalizer
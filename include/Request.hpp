@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Logger.hpp"
+#include "Method.hpp"
 #include "Uri.hpp"
 
 #include <algorithm>
@@ -97,6 +98,15 @@ namespace Message
 
 		std::string get_raw_request();
 		std::string get_request_method();
+
+		/**
+		 * Get the request method interned when it was parsed or set.
+		 *
+		 * @return
+		 * 		The method, or HTTP::Method::UNKNOWN.
+		 */
+		HTTP::Method get_method() const;
+
 		std::shared_ptr<Uri> get_request_uri();
 		std::string get_request_uri_string();
 		std::string get_http_version();
@@ -124,6 +134,7 @@ namespace Message
 
 		// Request method. e.g. GET, POST
 		std::string m_method;
+		HTTP::Method m_method_id = HTTP::Method::UNKNOWN;
 
 		// Request uri string
 		std::string m_request_uri;
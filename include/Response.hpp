@@ -179,29 +179,85 @@ namespace Message
 
 		/**
 		 * Assemble response string from member variables.
+		 *
+		 * The message is written into a buffer owned by this response and
+		 * reused across requests, so steady-state serialization doesn't
+		 * allocate.
+		 *
+		 * @return
+		 * 		The response message, valid until the next call.
 		 */
-		std::string generate_response();
+		const std::string& generate_response();
 
 		/**
-		 * Clear up all fields.
+		 * Answer with a fully serialized message instead of the fields.
+		 *
+		 * Until clear_up(), generate_response() copies @b message into the
+		 * output buffer and overwrites its Date header value with the
+		 * current HTTP Date, without allocating.
+		 *
+		 * @param[in] message
+		 * 		Serialized response; must outlive this response's use of it.
+		 *
+		 * @param[in] date_offset
+		 * 		Offset of the 29-byte Date header value in @b message.
 		 */
-		void clear_up();
+		void set_prebuilt_message(const std::string& message,
+		                          size_t date_offset);
 
 		/**
-		 * @brief Serialize headers for the purpose of caching.
+		 * Answer with a serialized message, e.g. a cache hit.
 		 *
-		 * @return std::string
+		 * The message is copied into the output buffer right away, so it
+		 * needn't outlive this call, and its Date header value is
+		 * overwritten with the current HTTP Date by generate_response().
+		 *
+		 * @param[in] message
+		 * 		Serialized response of @b length bytes.
+		 *
+		 * @param[in] date_offset
+		 * 		Offset of the 29-byte Date header value in @b message.
 		 */
-		std::string serialize_headers();
+		void set_serialized_message(const char* message, size_t length,
+		                            size_t date_offset);
 
 		/**
-		 * @brief Deserialize caches message to generate the response.
+		 * Like the above, but take over the buffer the message is part of
+		 * instead of copying it.
 		 *
-		 * @param message Serialized respone obtained from cache.
+		 * @param[in] buffer
+		 * 		Holds the message at @b offset; swapped with the output
+		 * 		buffer.
+		 */
+		void set_serialized_message(std::string&& buffer, size_t offset,
+		                            size_t length, size_t date_offset);
+
+		/**
+		 * Set the Content-Length header of a body that isn't set, e.g. to
+		 * answer HEAD requests.
+		 *
+		 * @param[in] content_length
+		 * 		Size of the body in bytes.
+		 */
+		void set_content_length(size_t content_length);
+
+		/**
+		 * Leave the body out of the message, e.g. to answer HEAD requests.
+		 * The headers, Content-Length included, still describe the body.
+		 */
+		void omit_body();
+
+		/**
+		 * Clear up all fields.
 		 */
-		void deserialize(const std::string& message);
+		void clear_up();
 
 	private:
+		/**
+		 * Set the Content-Length header to the size of m_body.
+		 */
+		void set_content_length();
+
 		std::shared_ptr<Uri> m_uri;
 
 		// Status code of response
@@ -211,7 +267,11 @@ namespace Message
 		std::string m_protocol_version;
 
 		// Reason phrase for specific status code.
-		std::string m_reason_phrase;
+		const char* m_reason_phrase = "";
+
+		// Prebuilt HTTP/1.1 status line of m_status_code, if known.
+		const char* m_status_line = nullptr;
+		size_t m_status_line_length = 0;
 
 		// Header fields
 		std::map<std::string, std::string> m_headers;
@@ -221,5 +281,18 @@ namespace Message
 
 		// Content type
 		std::string m_content_type;
+
+		// Serialized message emitted instead of the fields, if any.
+		const std::string* m_prebuilt_message = nullptr;
+		size_t m_prebuilt_date_offset = 0;
+
+		// Whether the output buffer already holds a serialized message.
+		bool m_is_output_serialized = false;
+
+		// Whether generate_response() stops after the headers.
+		bool m_is_body_omitted = false;
+
+		// Reusable output buffer of generate_response().
+		std::string m_output_buffer;
 	};
 } // namespace Message
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "Method.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class IResourceHandler;
+class Uri;
+
+namespace HTTP
+{
+	/**
+	 * Outcome of routing one request: the handler and the values of the
+	 * path parameters, which point into the request's Uri.
+	 */
+	class RouteMatch
+	{
+	public:
+		// Most path parameters a route can have.
+		static constexpr size_t MAX_PARAMETERS = 8;
+
+		/**
+		 * Get the handler of the matched route.
+		 *
+		 * @return
+		 *      The handler, or nullptr if nothing matched.
+		 */
+		IResourceHandler* get_handler() const;
+
+		/**
+		 * Get the path segment matched by a parameter.
+		 *
+		 * @param[in] name
+		 *      Parameter name, without the ':' of the pattern.
+		 *
+		 * @return
+		 *      The path segment, or nullptr if the route has no such
+		 *      parameter.
+		 */
+		const std::string* get_parameter(const std::string& name) const;
+
+		/**
+		 * Get the methods the path has routes of, for the Allow header of a
+		 * 405 response.
+		 *
+		 * @return
+		 *      Comma separated method names, e.g. "GET, HEAD". HEAD is
+		 *      listed wherever GET is.
+		 */
+		std::string get_allowed_methods() const;
+
+		/**
+		 * Clear up the handler, parameters and allowed methods.
+		 */
+		void clear_up();
+
+	private:
+		friend class Router;
+
+		IResourceHandler* m_handler = nullptr;
+		size_t m_number_of_parameters = 0;
+		const std::string* m_parameter_names[MAX_PARAMETERS] = {};
+		const std::string* m_parameter_values[MAX_PARAMETERS] = {};
+
+		// Bit per Method of the routes of the path, set when it isn't found.
+		unsigned int m_allowed_methods = 0;
+	};
+
+	/**
+	 * Dispatch requests to the handlers registered for their method and path.
+	 *
+	 * Routes are compiled into a trie of path segments as they are added at
+	 * startup. Routing walks the trie over the already split path of the
+	 * Uri and doesn't allocate.
+	 *
+	 * Patterns are made of '/' separated segments:
+	 *      "/healthz"          exact path;
+	 *      "/assets/<rest>"    prefix, written with a '*' last segment that
+	 *                          matches any remaining path, including none;
+	 *      "/api/sentences/:id" a ':' segment matches any one non-empty
+	 *                          segment and captures it as a parameter.
+	 * Exact segments take precedence over parameters, which take precedence
+	 * over prefixes. HEAD requests are served by the GET routes of a path
+	 * that has no HEAD routes.
+	 */
+	class Router
+	{
+	public:
+		enum class Result
+		{
+			FOUND,
+			NOT_FOUND,
+			METHOD_NOT_ALLOWED
+		};
+
+		Router();
+		~Router();
+
+		Router(const Router& other) = delete;
+		Router& operator=(const Router& other) = delete;
+
+		Router(Router&& other) = delete;
+		Router& operator=(Router&& other) = delete;
+
+		/**
+		 * Register a handler.
+		 *
+		 * @param[in] method
+		 *      Request method the route serves.
+		 *
+		 * @param[in] pattern
+		 *      Path pattern, see the class comment.
+		 *
+		 * @param[in] handler
+		 *      Handler of matching requests. A handler may serve many routes.
+		 *
+		 * @param[in] query_parameter
+		 *      Optional. Only match requests whose query has this parameter,
+		 *      e.g. "q" for "/?q=". Such routes take precedence over the one
+		 *      without a query parameter on the same method and pattern.
+		 *
+		 * @note
+		 *      Throws std::runtime_error on a malformed pattern or a route
+		 *      that is already registered.
+		 */
+		void add_route(Method method, const std::string& pattern,
+		               const std::shared_ptr<IResourceHandler>& handler,
+		               const std::string& query_parameter = "");
+
+		/**
+		 * Find the handler of a request.
+		 *
+		 * @param[in] method
+		 *      Request method.
+		 *
+		 * @param[in] uri
+		 *      Request Uri. Must outlive the use of @b route_match's
+		 *      parameters.
+		 *
+		 * @param[out] route_match
+		 *      Handler and path parameters if found.
+		 *
+		 * @return
+		 *      FOUND, NOT_FOUND, or METHOD_NOT_ALLOWED if the path only has
+		 *      routes of other methods, which @b route_match then lists.
+		 */
+		Result route(Method method, Uri& uri, RouteMatch& route_match) const;
+
+	private:
+		// Index of a missing node.
+		static constexpr size_t NO_NODE = static_cast<size_t>(-1);
+
+		struct Endpoint
+		{
+			std::string query_parameter;
+			IResourceHandler* handler;
+		};
+
+		struct Node
+		{
+			// Exact segment children, sorted by segment.
+			std::vector<std::pair<std::string, size_t>> children;
+
+			// The ':' child, whose segment is its parameter name.
+			size_t parameter_child = NO_NODE;
+			std::string parameter_name;
+
+			// Endpoints of the path ending here and of its "*" prefix.
+			std::vector<Endpoint> endpoints[NUMBER_OF_METHODS];
+			std::vector<Endpoint> prefix_endpoints[NUMBER_OF_METHODS];
+		};
+
+		/**
+		 * Walk the trie from @b node over the segments from @b index on.
+		 *
+		 * @param[out] is_path_found
+		 *      Set if the path has routes of any method.
+		 *
+		 * @return
+		 *      True if a route of @b method matches.
+		 */
+		bool match_from(size_t node, const std::vector<std::string>& segments,
+		                size_t index, Method method, Uri& uri,
+		                RouteMatch& route_match, bool& is_path_found) const;
+
+		std::vector<Node> m_nodes;
+
+		// Handlers are owned here and referenced by the endpoints.
+		std::vector<std::shared_ptr<IResourceHandler>> m_handlers;
+	};
+} // namespace HTTP
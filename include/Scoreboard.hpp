@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <sys/types.h>
+
+/**
+ * Per-worker status shared by the master and every worker process.
+ *
+ * The master maps the scoreboard before forking, so workers inherit it and
+ * each one writes only its own cache line sized slot. Any process can read
+ * every slot, e.g. to answer readiness probes without asking the master.
+ */
+namespace Scoreboard
+{
+	enum class State : int32_t
+	{
+		EMPTY,
+		STARTING,
+		READY
+	};
+
+	/**
+	 * Map a scoreboard of @b number_of_slots empty slots, replacing the
+	 * previous one of this process.
+	 *
+	 * @note
+	 *      Throws std::runtime_error if the memory can't be mapped.
+	 */
+	void create(size_t number_of_slots);
+
+	/**
+	 * Unmap the scoreboard of this process.
+	 */
+	void destroy();
+
+	/**
+	 * Reserve an empty slot for a worker about to be forked.
+	 *
+	 * @return
+	 *      Index of the slot, now STARTING, or -1 if every slot is taken.
+	 */
+	int claim_slot();
+
+	/**
+	 * Record the process id of the worker owning @b slot.
+	 */
+	void set_pid(size_t slot, pid_t pid);
+
+	/**
+	 * Get the process id of the worker owning @b slot.
+	 *
+	 * @return
+	 *      0 if the slot is empty.
+	 */
+	pid_t get_pid(size_t slot);
+
+	/**
+	 * Empty the slot of a worker that has exited.
+	 *
+	 * @note
+	 *      Async-signal-safe, for SIGCHLD handlers.
+	 */
+	void release(pid_t pid);
+
+	/**
+	 * Make @b slot the one the calling worker process reports to.
+	 */
+	void attach(size_t slot);
+
+	/**
+	 * Set the state of the attached slot, if any.
+	 */
+	void set_state(State state);
+
+	/**
+	 * Count a request served by the attached slot, if any.
+	 */
+	void count_request();
+
+	/**
+	 * Get the number of slots.
+	 *
+	 * @return
+	 *      0 if this process has no scoreboard.
+	 */
+	size_t get_number_of_slots();
+
+	/**
+	 * Get the number of workers in @b state.
+	 */
+	size_t get_number_of_workers(State state);
+
+	/**
+	 * Get the number of requests served by all workers.
+	 */
+	uint64_t get_number_of_requests();
+
+	/**
+	 * Whether the forked workers are ready for requests.
+	 *
+	 * @return
+	 *      True if a worker is READY and none is STARTING; always true
+	 *      without a scoreboard, e.g. for a worker run on its own.
+	 */
+	bool is_ready();
+} // namespace Scoreboard
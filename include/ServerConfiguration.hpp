@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 class ServerConfiguration
@@ -21,6 +22,127 @@ public:
 	std::string get_root_directory_path() const;
 	std::string get_resource_directory_path() const;
 	std::string get_log_directory_path() const;
+
+	/**
+	 * Widest instruction set the string and codec kernels may use, see
+	 * CpuDispatch::force_isa(). Read from the WORD_FINDER_CPU_ISA
+	 * environment variable; empty means the widest one detected.
+	 */
+	std::string get_cpu_isa() const;
+	void set_cpu_isa(const std::string& cpu_isa);
+
+	/**
+	 * Values of the Server and Host headers of every response.
+	 */
+	std::string get_server_name() const;
+	void set_server_name(const std::string& server_name);
+	std::string get_host_name() const;
+	void set_host_name(const std::string& host_name);
+
+	/**
+	 * Directory of custom error pages. A file named after a status code,
+	 * e.g. "404.html", replaces the built-in body of that status. Read once
+	 * by StatusHandler::prebuild_responses().
+	 */
+	std::string get_error_page_directory_path() const;
+	void set_error_page_directory_path(const std::string& directory_path);
+
+	/**
+	 * Capacity in bytes and number of shards of each worker's in-process
+	 * response cache. Read from the WORD_FINDER_LOCAL_CACHE_MB and
+	 * WORD_FINDER_LOCAL_CACHE_SHARDS environment variables.
+	 */
+	size_t get_local_cache_capacity() const;
+	void set_local_cache_capacity(size_t capacity_in_bytes);
+	size_t get_local_cache_shards() const;
+	void set_local_cache_shards(size_t number_of_shards);
+
+	/**
+	 * Capacity in bytes of the cache shared by the workers, 0 disabling
+	 * it, and the file backing it, empty for anonymous memory. Read from
+	 * the WORD_FINDER_SHARED_CACHE_MB and WORD_FINDER_SHARED_CACHE_PATH
+	 * environment variables.
+	 */
+	size_t get_shared_cache_capacity() const;
+	void set_shared_cache_capacity(size_t capacity_in_bytes);
+	std::string get_shared_cache_path() const;
+	void set_shared_cache_path(const std::string& file_path);
+
+	/**
+	 * Which entries the local and shared caches keep once full, "lru" or
+	 * "tinylfu". Read from the WORD_FINDER_CACHE_POLICY environment
+	 * variable.
+	 */
+	std::string get_cache_policy() const;
+	void set_cache_policy(const std::string& policy_name);
+
+	/**
+	 * Seconds a cached search result is served as is, 0 until the news
+	 * change, and seconds it is still served afterwards while it is
+	 * searched again. Read from the WORD_FINDER_SEARCH_CACHE_TTL and
+	 * WORD_FINDER_SEARCH_CACHE_STALE environment variables.
+	 */
+	size_t get_search_cache_ttl() const;
+	void set_search_cache_ttl(size_t seconds);
+	size_t get_search_cache_stale_ttl() const;
+	void set_search_cache_stale_ttl(size_t seconds);
+
+	/**
+	 * Seconds a search without results is remembered as such, 0 disabling
+	 * it. Read from the WORD_FINDER_NEGATIVE_CACHE_TTL environment
+	 * variable.
+	 */
+	size_t get_negative_cache_ttl() const;
+	void set_negative_cache_ttl(size_t seconds);
+
+	/**
+	 * File of the filter of the words in the news, which the workers map
+	 * to turn down searches for other words before SQLite; empty disables
+	 * it. Read from the WORD_FINDER_VOCABULARY_FILTER_PATH environment
+	 * variable.
+	 */
+	std::string get_vocabulary_filter_path() const;
+	void set_vocabulary_filter_path(const std::string& file_path);
+
+	/**
+	 * How the workers open the news database for searching:
+	 *      "read_write": one connection with SQLite's defaults;
+	 *      "read_only": a read-only connection mapping the whole file, and
+	 *                   another one for writes;
+	 *      "immutable": like "read_only", but SQLite assumes the file never
+	 *                   changes, so searches miss news added meanwhile;
+	 *      "memory": like "immutable", but searching a DatabaseImage the
+	 *                master loads at startup.
+	 * Read from the WORD_FINDER_DATABASE_PROFILE environment variable.
+	 */
+	std::string get_database_profile() const;
+	void set_database_profile(const std::string& profile_name);
+
+	/**
+	 * Capacity in bytes of the page cache of each worker's read-only
+	 * connection. Read from the WORD_FINDER_DATABASE_CACHE_MB environment
+	 * variable.
+	 */
+	size_t get_database_cache_capacity() const;
+	void set_database_cache_capacity(size_t capacity_in_bytes);
+
+	/**
+	 * Threads of each worker searching the news database, each with a
+	 * connection of its own, so that the event loop doesn't wait on
+	 * SQLite; 0 searches on the event loop. Read from the
+	 * WORD_FINDER_SEARCH_THREADS environment variable.
+	 */
+	size_t get_search_threads() const;
+	void set_search_threads(size_t number_of_threads);
+
+	/**
+	 * Redis server backing the in-process caches, e.g.
+	 * "tcp://127.0.0.1:6379". Read from the WORD_FINDER_REDIS_URI
+	 * environment variable; empty disables Redis.
+	 */
+	std::string get_redis_uri() const;
+	void set_redis_uri(const std::string& redis_uri);
+
 	static ServerConfiguration* instance();
 
 private:
@@ -28,5 +150,22 @@ private:
 	std::string m_resource_root_directory_path;
 	std::string m_log_directory_path;
 	std::string m_database_path;
+	std::string m_cpu_isa;
+	std::string m_server_name;
+	std::string m_host_name;
+	std::string m_error_page_directory_path;
+	size_t m_local_cache_capacity;
+	size_t m_local_cache_shards;
+	size_t m_shared_cache_capacity;
+	std::string m_shared_cache_path;
+	std::string m_cache_policy;
+	size_t m_search_cache_ttl;
+	size_t m_search_cache_stale_ttl;
+	size_t m_negative_cache_ttl;
+	std::string m_vocabulary_filter_path;
+	std::string m_database_profile;
+	size_t m_database_cache_capacity;
+	size_t m_search_threads;
+	std::string m_redis_uri;
 	static ServerConfiguration* m_instance;
 };
\ No newline at end of file
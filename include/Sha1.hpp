@@ -60,4 +60,80 @@ namespace Sha1
 	 *      The message digest bytes sequence.
 	 */
 	std::vector<uint8_t> sha1_encrypt_into_bytes(const std::string& data);
+
+	// Size of a raw SHA-1 message digest in bytes.
+	constexpr size_t DIGEST_SIZE = 20;
+
+	/**
+	 * Incremental SHA-1 hasher.
+	 *
+	 * Feed data in pieces of any size with update(), then call final() to get
+	 * the raw 20-byte digest. Whole 64-byte blocks are compressed with the
+	 * x86 SHA extensions when the CPU has them, and with an unrolled scalar
+	 * implementation otherwise.
+	 */
+	class Hasher
+	{
+	public:
+		Hasher();
+
+		/**
+		 * Reset to the initial state to hash a new message.
+		 */
+		void init();
+
+		/**
+		 * Append data to the message.
+		 *
+		 * @param[in] data
+		 *      Bytes to be hashed.
+		 *
+		 * @param[in] size
+		 *      Number of bytes.
+		 */
+		void update(const void* data, size_t size);
+
+		/**
+		 * Pad the message and write its digest. The hasher must be init()ed
+		 * again before hashing another message.
+		 *
+		 * @param[out] digest
+		 *      Buffer of DIGEST_SIZE bytes.
+		 */
+		void final(uint8_t* digest);
+
+	private:
+		uint32_t m_state[5];
+
+		// Bytes of the message that don't fill a whole block yet.
+		uint8_t m_block[64];
+		size_t m_block_size;
+
+		uint64_t m_message_size;
+	};
+
+	/**
+	 * Hash a whole message at once.
+	 *
+	 * @param[in] data
+	 *      Bytes to be hashed.
+	 *
+	 * @param[in] size
+	 *      Number of bytes.
+	 *
+	 * @param[out] digest
+	 *      Buffer of DIGEST_SIZE bytes.
+	 */
+	void sha1_digest(const void* data, size_t size, uint8_t* digest);
+
+	/**
+	 * Format a raw digest as lowercase hexadecimal.
+	 *
+	 * @param[in] digest
+	 *      DIGEST_SIZE bytes.
+	 *
+	 * @return
+	 *      40 hexadecimal characters.
+	 */
+	std::string digest_to_hex_string(const uint8_t* digest);
 } // namespace Sha1
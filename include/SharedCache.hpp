@@ -0,0 +1,152 @@
+#pragma once
+
+#include "FrequencySketch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Response cache in memory shared by the master and every worker process.
+ *
+ * The master maps the cache before forking, so all workers share one hot
+ * set and a respawned worker starts warm. Backed by a file, the cache also
+ * survives server restarts.
+ *
+ * The region holds a fixed-size open addressing hash table and a slab
+ * store of values. Values go into chunks of the smallest of a few size
+ * classes that fits them. Each class hands out its chunks round-robin, so
+ * a class evicts its oldest entries first. Buckets and chunks are guarded
+ * by sequence locks:
+ *      - readers never write to the region and retry or miss if a writer
+ *        got in the way;
+ *      - a writer claims a bucket or chunk by making its sequence odd, and
+ *        backs off if another writer holds it.
+ * A bucket refers to its chunk by index and by the chunk's sequence. A
+ * reused chunk therefore turns the old entry into a miss instead of
+ * returning someone else's value. A writer dying with a lock held only
+ * loses that bucket or chunk until the cache is created again.
+ *
+ * A small table of leases lets one process claim computing a missing
+ * value while the others wait for it to show up, instead of all computing
+ * it at once.
+ *
+ * With CachePolicy::TINY_LFU, a FrequencySketch in the region counts the
+ * lookups of every process, and a new entry only replaces the entry of the
+ * chunk it would reuse if its key is looked up more often.
+ *
+ * Functions are no-ops, or misses, in a process without a cache.
+ */
+namespace SharedCache
+{
+	/**
+	 * Lookup counters of the calling process, and the cache size.
+	 */
+	struct Statistics
+	{
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t insertions = 0;
+
+		// Insertions given up: too large, raced by another writer or not
+		// admitted by the policy.
+		uint64_t rejections = 0;
+
+		size_t capacity_in_bytes = 0;
+	};
+
+	/**
+	 * Map a cache, replacing the previous one of this process.
+	 *
+	 * @param[in] capacity_in_bytes
+	 *      Size of the slab store; the hash table comes on top of it.
+	 *
+	 * @param[in] file_path
+	 *      Optional. File to back the cache with. Its entries are kept if
+	 *      it was written by a cache of the same capacity, and discarded
+	 *      otherwise.
+	 *
+	 * @param[in] policy
+	 *      Optional. Which entries to keep once full; every process using
+	 *      the region should pick the same.
+	 *
+	 * @note
+	 *      Throws std::runtime_error if the memory or the file can't be
+	 *      mapped.
+	 */
+	void create(size_t capacity_in_bytes, const std::string& file_path = "",
+	            HTTP::CachePolicy policy = HTTP::CachePolicy::LRU);
+
+	/**
+	 * Unmap the cache of this process.
+	 */
+	void destroy();
+
+	/**
+	 * Whether this process has a cache.
+	 */
+	bool is_enabled();
+
+	/**
+	 * Policy the cache was created with.
+	 */
+	HTTP::CachePolicy get_policy();
+
+	/**
+	 * Look up an entry.
+	 *
+	 * @param[out] value
+	 *      Value of the entry if found.
+	 *
+	 * @return
+	 *      True on a hit.
+	 */
+	bool get(const std::string& key, std::string& value);
+
+	/**
+	 * Insert or replace an entry.
+	 *
+	 * @return
+	 *      False if the entry is larger than the largest chunk, another
+	 *      writer holds its bucket or chunk, or TinyLFU doesn't admit it.
+	 */
+	bool insert(const std::string& key, const std::string& value);
+
+	/**
+	 * @return
+	 *      True if the entry existed.
+	 */
+	bool erase(const std::string& key);
+
+	/**
+	 * Claim computing the value of @b key, to be inserted by the caller.
+	 *
+	 * @param[in] timeout_ms
+	 *      How long the claim holds unless released first, e.g. if its
+	 *      process dies.
+	 *
+	 * @return
+	 *      False if the key is claimed already. True otherwise, including
+	 *      without a cache or when the claim can't be recorded because its
+	 *      slot holds another key.
+	 */
+	bool acquire_lease(const std::string& key, int64_t timeout_ms);
+
+	/**
+	 * Whether someone is computing the value of @b key.
+	 */
+	bool is_leased(const std::string& key);
+
+	/**
+	 * Give up the claim on @b key, after inserting its value or failing to
+	 * compute it.
+	 */
+	void release_lease(const std::string& key);
+
+	Statistics get_statistics();
+
+	/**
+	 * Count the live entries by scanning the hash table.
+	 */
+	size_t get_number_of_entries();
+} // namespace SharedCache
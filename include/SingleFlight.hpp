@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HTTP
+{
+	/**
+	 * @brief Coalesces concurrent computations of the same key.
+	 *
+	 * The first caller to join() a key starts a flight and computes the
+	 * value; callers joining the key while it is in flight only wait. Once
+	 * the first one lands the flight, every caller gets the same result,
+	 * so a burst of identical requests costs a single computation.
+	 *
+	 * Meant for one event loop: nothing is locked, and callbacks run from
+	 * land().
+	 */
+	class SingleFlight
+	{
+	public:
+		/**
+		 * Called with the computed value, or with @b is_found false if
+		 * there's none.
+		 */
+		using Callback =
+		    std::function<void(bool is_found, const std::string& value)>;
+
+		struct Statistics
+		{
+			uint64_t flights = 0;
+
+			// Callers that waited for a flight instead of starting one.
+			uint64_t coalesced = 0;
+		};
+
+		/**
+		 * Wait for the value of @b key.
+		 *
+		 * @return
+		 *      True if no flight for @b key was in progress: the caller
+		 *      started one and must land() it.
+		 */
+		bool join(const std::string& key, Callback callback);
+
+		/**
+		 * End the flight of @b key, calling back its callers in the order
+		 * they joined. Callers joining from a callback start a new flight.
+		 */
+		void land(const std::string& key, bool is_found,
+		          const std::string& value);
+
+		bool is_in_flight(const std::string& key) const;
+
+		Statistics get_statistics() const;
+
+	private:
+		std::unordered_map<std::string, std::vector<Callback>> m_flights;
+		Statistics m_statistics;
+	};
+} // namespace HTTP
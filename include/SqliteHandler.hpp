@@ -1,12 +1,19 @@
 #pragma once
 
 #include "Cache.hpp"
+#include "CacheEntry.hpp"
 #include "IResourceHandler.hpp"
 #include "Logger.hpp"
 #include "Sentence.hpp"
 #include "ServerConfiguration.hpp"
+#include "SingleFlight.hpp"
+#include "StatementCache.hpp"
+#include "ThreadPool.hpp"
+#include "VocabularyFilter.hpp"
 
 #include <cstdio>
+#include <functional>
+#include <memory>
 #include <sqlite3.h>
 #include <string>
 #include <vector>
@@ -30,20 +37,86 @@ struct UserInfo
 	         std::string email);
 };
 
+/**
+ * Full-text search over the news database, answering "/?q=" queries.
+ *
+ * Queries are normalized by the QueryNormalizer, and result pages are
+ * cached by the normalized query alone, whatever other parameters the
+ * request has.
+ *
+ * Result pages are cached with the Freshness of the route, and with the
+ * generation the triggers on the news table bump in the cache_generation
+ * table. The generation is polled every second, so that adding news
+ * lazily makes older results stale.
+ *
+ * A VocabularyFilter of the terms of the news, rebuilt for every
+ * generation, turns down searches for words that occur nowhere before
+ * SQLite prepares a statement.
+ *
+ * Statements are prepared once per handler and kept in a StatementCache
+ * by their SQL text.
+ *
+ * The database profile of the ServerConfiguration decides how the news
+ * are opened. Read-only profiles search through a connection of their
+ * own, and keep another one for the user table and the schema.
+ *
+ * Once attached to an event loop, fetch_resource_async() searches and
+ * renders pages on a ThreadPool, each thread with a connection and a
+ * StatementCache of its own, and caches them when the loop is woken.
+ * Searches run on the loop while the pool is busy, or without threads.
+ *
+ * HEAD requests take the same lookup as GET, and the worker leaves the
+ * body out, so both agree on whether a search finds anything.
+ */
 class SqliteHandler : public IResourceHandler
 {
 public:
 	SqliteHandler();
 	~SqliteHandler();
 
-	SqliteHandler(const SqliteHandler& other);
-	SqliteHandler& operator=(const SqliteHandler& other);
+	/**
+	 * @param[in] cache
+	 *      Cache of search results, shared with whoever reports on it.
+	 *
+	 * @param[in] freshness
+	 *      Optional. How long results are served from the cache.
+	 */
+	explicit SqliteHandler(
+	    std::shared_ptr<HTTP::Cache> cache,
+	    const HTTP::Freshness& freshness = HTTP::Freshness());
+
+	SqliteHandler(const SqliteHandler& other) = delete;
+	SqliteHandler& operator=(const SqliteHandler& other) = delete;
 
 	SqliteHandler(SqliteHandler&& other) = delete;
 	SqliteHandler& operator=(SqliteHandler&& other) = delete;
 
 	bool fetch_resource(std::shared_ptr<HTTP::Connection> connection) override;
 
+	/**
+	 * Like fetch_resource(), but also asks Redis before searching, and
+	 * answers with stale results while searching again. Identical searches
+	 * arriving meanwhile wait for this one, as do those of other workers
+	 * through the Cache.
+	 */
+	void fetch_resource_async(std::shared_ptr<HTTP::Connection> connection,
+	                          FetchCallback callback) override;
+
+	/**
+	 * Watch the search threads with @b epoll_fd, so that
+	 * fetch_resource_async() hands searches to them.
+	 */
+	void attach(int epoll_fd);
+
+	/**
+	 * Cache the pages of the searches done, if @b fd is the one of the
+	 * search threads.
+	 *
+	 * @return
+	 *      True if @b fd belongs to the search threads.
+	 */
+	bool handle_events(int fd, uint32_t events);
+
 	/**
 	 * Whether the table exists?
 	 *
@@ -127,17 +200,31 @@ public:
 	 */
 	std::vector<Sentence> search_sentence(const std::string& keyword);
 
+	/**
+	 * @return
+	 *      The prepared statements of the handler and of each search
+	 *      thread, to report on.
+	 */
+	std::vector<std::shared_ptr<const HTTP::StatementCache>>
+	get_statement_caches() const;
+
 private:
 	/**
-	 * Prepare Sqlite3 statement.
+	 * Make the statement of the given SQL the current one, preparing it
+	 * unless it is cached. Its parameters are unbound.
 	 *
 	 * @param[in] statement
 	 *      Statement to be prepared.
 	 *
+	 * @param[in] is_write
+	 *      Optional. Whether the statement writes, so goes through the
+	 *      connection for writes.
+	 *
 	 * @return
 	 *      True if succeeds.
 	 */
-	bool prepare_statement(const std::string& statement);
+	bool prepare_statement(const std::string& statement,
+	                       bool is_write = false);
 
 	/**
 	 * Replace placeholder with data with type of text.
@@ -158,8 +245,94 @@ private:
 	bool bind_text_data(const std::string& placeholder,
 	                    const std::string& text_data);
 
+	/**
+	 * Search for the keyword and serialize the result page into a cache
+	 * entry.
+	 *
+	 * @return
+	 *      The cache entry, empty if nothing matches.
+	 */
+	std::string build_cache_entry(const std::string& keyword);
+
+	/**
+	 * Like build_cache_entry(), but on a search thread when one is free.
+	 * @b callback runs on the event loop with the cache entry.
+	 */
+	void build_cache_entry_async(
+	    const std::string& keyword,
+	    const std::function<void(const std::string&)>& callback);
+
+	/**
+	 * Pass the generation of the news to the cache, reading it at most
+	 * once a second.
+	 */
+	void refresh_generation();
+
+	/**
+	 * Map the vocabulary filter of the generation of the cache, building
+	 * it unless another worker did.
+	 */
+	void refresh_vocabulary_filter();
+
+	/**
+	 * Read the terms of the news index through an fts5vocab table.
+	 *
+	 * @return
+	 *      True if succeeds.
+	 */
+	bool read_vocabulary(std::vector<uint64_t>& term_hashes);
+
+	/**
+	 * Answer with the variant of a cache entry in the negotiated content
+	 * coding, falling back to the identity one.
+	 *
+	 * @return
+	 *      False if @b cache_entry is malformed.
+	 */
+	bool send_cache_entry(const std::shared_ptr<HTTP::Connection>& connection,
+	                      const std::string& cache_entry,
+	                      HTTP::ContentEncoding encoding);
+
+	/**
+	 * Like the above, but hand the cache entry over to the response
+	 * instead of copying the variant out of it.
+	 */
+	bool send_cache_entry(const std::shared_ptr<HTTP::Connection>& connection,
+	                      std::string&& cache_entry,
+	                      HTTP::ContentEncoding encoding);
+
 	sqlite3* m_connection = nullptr;
+
+	// The current statement, owned by the statement cache.
 	sqlite3_stmt* m_statement = nullptr;
-	std::string m_resource_root_directory_path;
-	std::unique_ptr<HTTP::Cache> m_cache;
+	std::shared_ptr<HTTP::StatementCache> m_statement_cache;
+
+	// A connection of a search thread, used by no other.
+	struct SearchContext
+	{
+		sqlite3* connection;
+		std::shared_ptr<HTTP::StatementCache> statement_cache;
+	};
+
+	// By thread index; no pool without search threads.
+	std::vector<SearchContext> m_search_contexts;
+	std::unique_ptr<HTTP::ThreadPool> m_search_pool;
+
+	// Null if writes go through m_connection.
+	sqlite3* m_write_connection = nullptr;
+	HTTP::StatementCache m_write_statement_cache;
+
+	std::shared_ptr<HTTP::Cache> m_cache;
+	HTTP::Freshness m_freshness;
+
+	// Null if the database has no generation.
+	sqlite3_stmt* m_generation_statement = nullptr;
+	int64_t m_generation_read_at = 0;
+
+	// Empty if the news aren't indexed with the default tokenizer.
+	std::string m_vocabulary_filter_path;
+	HTTP::VocabularyFilter m_vocabulary_filter;
+
+	// Searches in progress by cache key.
+	HTTP::SingleFlight m_single_flight;
 };
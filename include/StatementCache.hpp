@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <sqlite3.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace HTTP
+{
+	/**
+	 * @brief The prepared statements of a database connection, by SQL
+	 * text, so that each is compiled once rather than on every query.
+	 *
+	 * A statement is reset and its parameters cleared whenever it is handed
+	 * out again, so callers bind every parameter they use and needn't
+	 * reset it themselves. The least recently used statement is finalized
+	 * once there are more than the capacity, which bounds the statements
+	 * of SQL built from arguments, e.g. a table name.
+	 *
+	 * Like its connection, it is used by one thread at a time and isn't
+	 * locked; only its statistics may be read from other threads. A
+	 * statement must not be asked for again while it is still stepped.
+	 */
+	class StatementCache
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evictions = 0;
+
+			// Time spent compiling statements on misses.
+			uint64_t prepare_microseconds = 0;
+		};
+
+		/**
+		 * @param[in] capacity
+		 *      Number of statements kept prepared.
+		 */
+		explicit StatementCache(size_t capacity = 16);
+		~StatementCache();
+
+		StatementCache(const StatementCache&) = delete;
+		StatementCache& operator=(const StatementCache&) = delete;
+
+		/**
+		 * Finalize the statements of the previous connection, and prepare
+		 * the following ones on @b connection.
+		 */
+		void attach(sqlite3* connection);
+
+		/**
+		 * Get the statement of @b sql, preparing it if it isn't cached.
+		 *
+		 * @return
+		 *      Null if it can't be prepared.
+		 */
+		sqlite3_stmt* get(const std::string& sql);
+
+		/**
+		 * Finalize every statement, e.g. before closing the connection.
+		 */
+		void clear();
+
+		size_t get_number_of_statements() const;
+
+		Statistics get_statistics() const;
+
+	private:
+		using Entry = std::pair<std::string, sqlite3_stmt*>;
+
+		sqlite3* m_connection = nullptr;
+		size_t m_capacity;
+
+		// Most recently used first.
+		std::list<Entry> m_entries;
+		std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+
+		std::atomic<uint64_t> m_hits{0};
+		std::atomic<uint64_t> m_misses{0};
+		std::atomic<uint64_t> m_evictions{0};
+		std::atomic<uint64_t> m_prepare_microseconds{0};
+		std::atomic<size_t> m_number_of_statements{0};
+	};
+} // namespace HTTP
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "IResourceHandler.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+/**
+ * Serve the files under the resource directory, "/" being its index.html.
+ *
+ * Files are tagged with the SHA-1 digest of their content, hashed once per
+ * modification, and requests whose If-None-Match lists the tag are answered
+ * with 304 and no body. The deflated representation has a tag of its own,
+ * suffixed with "-deflate".
+ */
+class StaticFileHandler : public IResourceHandler
+{
+public:
+	StaticFileHandler();
+	~StaticFileHandler() override = default;
+
+	/**
+	 * @param[in] resource_root_directory_path
+	 *      Directory to serve, ending with '/'.
+	 */
+	explicit StaticFileHandler(std::string resource_root_directory_path);
+
+	bool fetch_resource(std::shared_ptr<HTTP::Connection> connection) override;
+
+private:
+	struct CachedEtag
+	{
+		int64_t modified_at;
+		off_t size;
+		std::string etag;
+	};
+
+	/**
+	 * Get the entity tag of a file, hashing it unless it is cached for the
+	 * modification time and size in @b file_status.
+	 *
+	 * @return
+	 *      True if succeeds.
+	 */
+	bool get_etag(const std::string& resource_path,
+	              const struct stat& file_status, std::string& etag);
+
+	std::string m_resource_root_directory_path;
+
+	// Entity tags by file path, of the files served so far.
+	std::unordered_map<std::string, CachedEtag> m_etags;
+};
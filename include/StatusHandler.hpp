@@ -1,6 +1,8 @@
 #pragma once
 
+#include <map>
 #include <memory>
+#include <string>
 
 #include "Response.hpp"
 #include "Timer.hpp"
@@ -11,6 +13,16 @@
  */
 namespace StatusHandler
 {
+	/**
+	 * A response serialized once, with the offset of its Date value.
+	 */
+	struct PrebuiltResponse
+	{
+		int status_code;
+		std::string message;
+		size_t date_offset;
+	};
+
 	/**
 	 * Add appropriate fields to response message based on given status code.
 	 *
@@ -20,11 +32,58 @@ namespace StatusHandler
 	 * @param[in] status_code
 	 * 		Status code integer.
 	 *
-	 * @param[in] variadic arguments
-	 * 		Possible arguments of specific status code for the convenience of
-	 * processing status.
+	 * @param[in] additional_info
+	 * 		Optional. The Location of a 3xx status code or the Allow methods
+	 * 		of 405, e.g. "GET, HEAD".
 	 */
 	void handle_status_code(const std::shared_ptr<Message::Response>& response,
 	                        int status_code,
 	                        const std::string& additional_info = "");
+
+	/**
+	 * Serialize the responses of every 4xx and 5xx status code once.
+	 *
+	 * handle_status_code() answers those status codes with their template
+	 * when there is no @b additional_info, so only the Date is patched in
+	 * per response. Bodies come from the configured error page directory
+	 * if it has one for the status code.
+	 *
+	 * @note
+	 * 		Runs on first use if not called at startup. Calling it again
+	 * 		picks up configuration changes and invalidates templates held by
+	 * 		responses that haven't been cleared up.
+	 */
+	void prebuild_responses();
+
+	/**
+	 * Serialize a response with the usual headers of @b status_code and the
+	 * given body, to be sent many times by use_prebuilt_response().
+	 *
+	 * @param[in] content_type
+	 * 		Content type of @b body.
+	 *
+	 * @param[in] body
+	 * 		Response body.
+	 *
+	 * @param[in] headers
+	 * 		Optional. Further headers, e.g. Content-Encoding.
+	 *
+	 * @return
+	 * 		The serialized response.
+	 */
+	PrebuiltResponse
+	prebuild_response(int status_code, const std::string& content_type,
+	                  const std::string& body,
+	                  const std::map<std::string, std::string>& headers = {});
+
+	/**
+	 * Answer with a prebuilt response; only its Date is patched in when
+	 * the response is generated.
+	 *
+	 * @param[in] prebuilt_response
+	 * 		Must outlive the use of @b response.
+	 */
+	void use_prebuilt_response(
+	    const std::shared_ptr<Message::Response>& response,
+	    const PrebuiltResponse& prebuilt_response);
 } // namespace StatusHandler
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HTTP
+{
+	/**
+	 * @brief A fixed number of threads running tasks for an event loop,
+	 * which is woken through an eventfd once they are done.
+	 *
+	 * Each task comes with a completion, which runs on the event loop from
+	 * handle_events() after the task, so that only completions touch what
+	 * the loop owns. Tasks wait in a bounded queue: once it is full,
+	 * submit() fails and the caller does the work itself.
+	 *
+	 * Tasks still queued when the pool is destroyed are dropped, and so are
+	 * the completions of those that ran.
+	 */
+	class ThreadPool
+	{
+	public:
+		/**
+		 * Runs on a pool thread, given the index of the thread, e.g. to use
+		 * resources of its own.
+		 */
+		using Task = std::function<void(size_t thread_index)>;
+
+		/**
+		 * Runs on the event loop once its task is done.
+		 */
+		using Completion = std::function<void()>;
+
+		/**
+		 * @param[in] number_of_threads
+		 *      Threads started right away.
+		 *
+		 * @param[in] queue_capacity
+		 *      Tasks that may wait for a thread.
+		 *
+		 * @note
+		 *      Throws std::runtime_error if the eventfd can't be created.
+		 */
+		ThreadPool(size_t number_of_threads, size_t queue_capacity);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/**
+		 * Watch the eventfd with @b epoll_fd. Tasks are only accepted
+		 * afterwards, as their completions couldn't run before.
+		 *
+		 * @note
+		 *      Throws std::runtime_error if the eventfd can't be added.
+		 */
+		void attach(int epoll_fd);
+
+		/**
+		 * Queue a task.
+		 *
+		 * @return
+		 *      False if the queue is full or the pool isn't attached; the
+		 *      task and its completion are dropped.
+		 */
+		bool submit(Task task, Completion completion);
+
+		/**
+		 * Run the completions of the tasks done, if @b fd is the eventfd.
+		 *
+		 * @return
+		 *      True if @b fd is the eventfd.
+		 */
+		bool handle_events(int fd, uint32_t events);
+
+		int get_fd() const;
+
+		size_t get_number_of_threads() const;
+
+	private:
+		struct Job
+		{
+			Task task;
+			Completion completion;
+		};
+
+		void run(size_t thread_index);
+
+		int m_event_fd = -1;
+		bool m_is_attached = false;
+		size_t m_queue_capacity;
+
+		std::mutex m_mutex;
+		std::condition_variable m_has_jobs;
+		bool m_is_stopping = false;
+		std::deque<Job> m_jobs;
+		std::vector<Completion> m_completions;
+
+		std::vector<std::thread> m_threads;
+	};
+} // namespace HTTP
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <ctime>
 #include <string>
 
+#include <time.h>
+
 class Timer
 {
 public:
@@ -12,6 +15,12 @@ public:
 	using clock_type = std::chrono::high_resolution_clock;
 	using milisecond_duration_type = std::chrono::duration<double, std::milli>;
 
+	/**
+	 * Reads a clock like clock_gettime(), which the coarse clocks use by
+	 * default.
+	 */
+	using TimeSource = int (*)(clockid_t clock_id, timespec* time);
+
 	/**
 	 * Get current time.
 	 *
@@ -27,6 +36,69 @@ public:
 	 */
 	static std::string get_current_http_time();
 
+	/**
+	 * Advance the calling thread's coarse clock.
+	 *
+	 * Event loops call this once per iteration, right after waking up, and
+	 * every response and log line of the iteration reuses the strings it
+	 * cached. They are only reformatted when the second changes.
+	 *
+	 * @note
+	 *      Threads that never tick advance their clock on every read
+	 *      instead, which is still cheap but reads the clock each time.
+	 */
+	static void tick();
+
+	/**
+	 * Get the HTTP Date of the coarse clock.
+	 *
+	 * @return
+	 *      HTTP Date string, e.g. "Wed, 26 Aug 2020 14:17:49 GMT".
+	 */
+	static const std::string& get_cached_http_time();
+
+	/**
+	 * Get the log line timestamp of the coarse clock.
+	 *
+	 * @return
+	 *      Timestamp in the form of "[2021-01-31 20:05:58]".
+	 */
+	static const std::string& get_cached_log_time();
+
+	/**
+	 * Get the date of the coarse clock.
+	 *
+	 * @return
+	 *      Date in the form of "2021-02-10".
+	 */
+	static const std::string& get_cached_date();
+
+	/**
+	 * Get the coarse monotonic time, for timeouts and expiry.
+	 *
+	 * @return
+	 *      Milliseconds since an unspecified starting point.
+	 */
+	static int64_t get_coarse_monotonic_milliseconds();
+
+	/**
+	 * Get the coarse wall-clock time, for ages that other processes and
+	 * restarts have to agree on.
+	 *
+	 * @return
+	 *      Seconds since the Unix epoch.
+	 */
+	static int64_t get_coarse_realtime_seconds();
+
+	/**
+	 * Read the coarse clocks from @b time_source from now on, e.g. a fake
+	 * clock in tests. Null restores clock_gettime().
+	 *
+	 * @note
+	 *      Set it before other threads read the clocks.
+	 */
+	static void set_time_source(TimeSource time_source);
+
 	/**
 	 * Get elapsed time in millisecond ( 1/1000s ).
 	 *
@@ -45,6 +117,30 @@ public:
 	void reset_start_time();
 
 private:
+	/**
+	 * Per-thread coarse clock with its preformatted strings.
+	 */
+	struct CoarseClock
+	{
+		// Whether an event loop drives this clock through tick().
+		bool is_ticked = false;
+
+		time_t realtime_seconds = -1;
+		int64_t monotonic_milliseconds = 0;
+
+		std::string http_time;
+		std::string log_time;
+		std::string date;
+	};
+
+	static CoarseClock& get_coarse_clock();
+
+	static TimeSource& get_time_source();
+
+	static void advance(CoarseClock& clock);
+
+	static const CoarseClock& read_coarse_clock();
+
 	clock_type::time_point start_time;
 };
 
@@ -61,6 +157,101 @@ inline std::string Timer::get_current_http_time()
 	return std::string(current_time_string);
 }
 
+inline Timer::CoarseClock& Timer::get_coarse_clock()
+{
+	static thread_local CoarseClock clock;
+	return clock;
+}
+
+inline Timer::TimeSource& Timer::get_time_source()
+{
+	static TimeSource time_source = clock_gettime;
+	return time_source;
+}
+
+inline void Timer::set_time_source(TimeSource time_source)
+{
+	get_time_source() = time_source != nullptr ? time_source : clock_gettime;
+}
+
+inline void Timer::advance(CoarseClock& clock)
+{
+	/**
+	 * The coarse clocks are read from the vDSO without a system call, at
+	 * the resolution of the kernel tick, which is plenty for HTTP dates
+	 * and logs.
+	 */
+	TimeSource time_source = get_time_source();
+	timespec now{};
+	time_source(CLOCK_MONOTONIC_COARSE, &now);
+	clock.monotonic_milliseconds =
+	    static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+
+	time_source(CLOCK_REALTIME_COARSE, &now);
+	if (now.tv_sec == clock.realtime_seconds)
+	{
+		return;
+	}
+	clock.realtime_seconds = now.tv_sec;
+
+	tm current_time{};
+	gmtime_r(&now.tv_sec, &current_time);
+
+	char buffer[30]; // NOLINT
+	// NOLINTNEXTLINE
+	clock.http_time.assign(buffer, std::strftime(buffer, sizeof(buffer),
+	                                             "%a, %d %b %Y %H:%M:%S GMT",
+	                                             &current_time));
+	// NOLINTNEXTLINE
+	clock.log_time.assign(buffer,
+	                      std::strftime(buffer, sizeof(buffer),
+	                                    "[%Y-%m-%d %H:%M:%S]", &current_time));
+	// the date is the log timestamp's "YYYY-mm-dd"
+	clock.date.assign(clock.log_time, 1, 10);
+}
+
+inline const Timer::CoarseClock& Timer::read_coarse_clock()
+{
+	CoarseClock& clock = get_coarse_clock();
+	if (!clock.is_ticked)
+	{
+		advance(clock);
+	}
+	return clock;
+}
+
+inline void Timer::tick()
+{
+	CoarseClock& clock = get_coarse_clock();
+	clock.is_ticked = true;
+	advance(clock);
+}
+
+inline const std::string& Timer::get_cached_http_time()
+{
+	return read_coarse_clock().http_time;
+}
+
+inline const std::string& Timer::get_cached_log_time()
+{
+	return read_coarse_clock().log_time;
+}
+
+inline const std::string& Timer::get_cached_date()
+{
+	return read_coarse_clock().date;
+}
+
+inline int64_t Timer::get_coarse_monotonic_milliseconds()
+{
+	return read_coarse_clock().monotonic_milliseconds;
+}
+
+inline int64_t Timer::get_coarse_realtime_seconds()
+{
+	return static_cast<int64_t>(read_coarse_clock().realtime_seconds);
+}
+
 inline void Timer::reset_start_time() { start_time = clock_type::now(); }
 
 inline Timer::milisecond_duration_type Timer::get_elapsed_time() const
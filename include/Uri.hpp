@@ -59,6 +59,14 @@ public:
 	 */
 	std::vector<std::string> get_path();
 
+	/**
+	 * Get path segments of Uri without copying them.
+	 *
+	 * @return
+	 * 		Path segments; the path "/" is one empty segment.
+	 */
+	const std::vector<std::string>& get_path_segments() const;
+
 	/**
 	 * Get path string of Uri.
 	 *
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <ostream>
 #include <stdint.h>
@@ -26,6 +27,69 @@ namespace Utf8
 	 */
 	std::vector<UnicodeCodePoint> AsciiToUnicode(const std::string& ascii);
 
+	/**
+	 * Whether the given bytes are well-formed UTF-8 (RFC 3629).
+	 *
+	 * ASCII runs are skipped 16 or 32 bytes at a time with SSE2 or AVX2, and
+	 * multibyte sequences are checked by a table-driven automaton. Overlong
+	 * encodings, surrogates and code points after U+10FFFF are rejected.
+	 * No code points are materialized.
+	 *
+	 * @param[in] data
+	 *      Bytes to be checked.
+	 *
+	 * @param[in] size
+	 *      Number of bytes.
+	 *
+	 * @return
+	 *      True if the whole input is valid UTF-8.
+	 */
+	bool IsValid(const char* data, size_t size);
+
+	/**
+	 * Whether the given string is well-formed UTF-8 (RFC 3629).
+	 *
+	 * @param[in] encoding
+	 *      Bytes to be checked.
+	 *
+	 * @return
+	 *      True if the whole input is valid UTF-8.
+	 */
+	bool IsValid(const std::string& encoding);
+
+	/**
+	 * Fold the case of a code point, following the simple case folding of
+	 * Unicode for the Basic Latin, Latin-1 Supplement, Latin Extended-A,
+	 * Latin Extended Additional, Greek and Cyrillic letters and the
+	 * fullwidth Latin ones. Other code points are returned as is.
+	 *
+	 * @param[in] code_point
+	 *      Code point to be folded, e.g. 'A' or U+0416.
+	 *
+	 * @return
+	 *      The folded code point, e.g. 'a' or U+0436.
+	 */
+	UnicodeCodePoint FoldCase(UnicodeCodePoint code_point);
+
+	/**
+	 * Get the canonical combining class of a code point, known for the
+	 * combining diacritical marks (U+0300 through U+036F).
+	 *
+	 * @return
+	 *      The class, 0 for starters and other code points.
+	 */
+	unsigned GetCombiningClass(UnicodeCodePoint code_point);
+
+	/**
+	 * Apply the canonical ordering algorithm of Unicode: sort each run of
+	 * combining marks by combining class, keeping the order of marks of
+	 * the same class, so that equivalent sequences of marks compare equal.
+	 *
+	 * @param[in,out] code_points
+	 *      Code points to be reordered.
+	 */
+	void OrderCanonically(std::vector<UnicodeCodePoint>& code_points);
+
 	/**
 	 * This class is used to encode or decode Unicode "code points",
 	 * or characters from many different international character sets,
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace HTTP
+{
+	/**
+	 * @brief Bloom filter of the terms of a full-text index, telling
+	 * queries that can't match anything from those that may.
+	 *
+	 * The filter is a file of about 10 to 20 bits per term, written once
+	 * per generation of the data and renamed into place. Every process maps
+	 * it read-only, so the workers share one copy in the page cache.
+	 * Whoever finds it missing or outdated builds it under a lock on a
+	 * file next to it; the others go without a filter meanwhile.
+	 *
+	 * Terms are hashed with FNV-1a, which is stable across builds unlike
+	 * std::hash, so that a filter stays valid for a respawned worker.
+	 *
+	 * Query terms are looked up as SQLite's default "unicode61" tokenizer
+	 * would index them; queries it can't split the same way are never
+	 * turned down.
+	 */
+	class VocabularyFilter
+	{
+	public:
+		/**
+		 * Append the hash of every term of the index.
+		 *
+		 * @return
+		 *      False if the terms can't be read.
+		 */
+		using TermReader = std::function<bool(std::vector<uint64_t>& hashes)>;
+
+		VocabularyFilter() = default;
+		~VocabularyFilter();
+
+		VocabularyFilter(const VocabularyFilter& other) = delete;
+		VocabularyFilter& operator=(const VocabularyFilter& other) = delete;
+
+		VocabularyFilter(VocabularyFilter&& other) = delete;
+		VocabularyFilter& operator=(VocabularyFilter&& other) = delete;
+
+		/**
+		 * Hash a term for TermReader.
+		 */
+		static uint64_t hash_term(const char* term, size_t length);
+
+		/**
+		 * Write a filter of terms, replacing the file atomically.
+		 *
+		 * @return
+		 *      True if succeeds.
+		 */
+		static bool write(const std::string& file_path, uint64_t generation,
+		                  const std::vector<uint64_t>& term_hashes);
+
+		/**
+		 * Map the filter of @b generation, building it with @b read_terms
+		 * unless it is there already.
+		 *
+		 * @return
+		 *      True if the filter is mapped. False if it can't be built, in
+		 *      which case it isn't tried again for this generation, or if
+		 *      another process is building it: without a filter, every
+		 *      query may match.
+		 */
+		bool load(const std::string& file_path, uint64_t generation,
+		          const TermReader& read_terms);
+
+		/**
+		 * Map an existing filter read-only.
+		 *
+		 * @return
+		 *      True if the file holds a filter.
+		 */
+		bool open(const std::string& file_path);
+		void close();
+
+		bool is_open() const;
+
+		/**
+		 * @return
+		 *      Generation of the mapped filter.
+		 */
+		uint64_t get_generation() const;
+
+		/**
+		 * Whether a term, as indexed, may be in the filter.
+		 */
+		bool may_contain(const std::string& term) const;
+
+		/**
+		 * Whether an FTS5 query may match: false only if it requires a
+		 * term that is definitely not indexed.
+		 *
+		 * @return
+		 *      True as well without a filter.
+		 */
+		bool may_match(const std::string& query) const;
+
+		/**
+		 * Split an FTS5 query into the terms every match must contain:
+		 * words and phrases, optionally joined by AND.
+		 *
+		 * @param[out] terms
+		 *      Lowercase terms.
+		 *
+		 * @return
+		 *      False if the query uses other syntax, or characters beyond
+		 *      ASCII, which the tokenizer may fold differently.
+		 */
+		static bool get_required_terms(const std::string& query,
+		                               std::vector<std::string>& terms);
+
+	private:
+		const uint64_t* m_words = nullptr;
+		uint64_t m_bit_mask = 0;
+		uint32_t m_number_of_probes = 0;
+		uint64_t m_generation = 0;
+
+		// Null if no filter is mapped.
+		void* m_region = nullptr;
+		size_t m_region_size = 0;
+
+		// Generation this process couldn't build a filter of.
+		bool m_has_failed = false;
+		uint64_t m_failed_generation = 0;
+	};
+} // namespace HTTP
@@ -3,10 +3,17 @@
 #include "Cache.hpp"
 #include "Connection.hpp"
 #include "IResourceHandler.hpp"
+#include "Router.hpp"
 #include "ServerConfiguration.hpp"
+#include "SqliteHandler.hpp"
+#include "StatusHandler.hpp"
 #include "WorkerSocket.hpp"
 
+#include <deque>
+#include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include <semaphore.h>
 
@@ -74,21 +81,94 @@ public:
 	 * @param[in] raw_request_string
 	 * 		Raw request string.
 	 *
+	 * @param[in] on_answered
+	 * 		Called once the response is complete, possibly before this
+	 * 		returns or later from the event loop.
+	 *
 	 * @note This is currently the core function to handler either static or
 	 * dynamic request.
 	 */
-	void request_core_handler(const std::string& raw_request_string);
+	void request_core_handler(const std::string& raw_request_string,
+	                          const std::function<void()>& on_answered);
 
 	void event_loop();
 
 private:
+	/**
+	 * A request being answered, possibly waiting for Redis.
+	 */
+	struct ActiveRequest
+	{
+		// Tells a late answer from one to a new client on the same socket.
+		uint64_t request_id = 0;
+
+		std::shared_ptr<HTTP::Connection> connection;
+
+		// Requests received on the same socket meanwhile, answered next.
+		std::deque<std::string> backlog;
+	};
+
+	/**
+	 * Read a request from a client and answer it, or queue it behind the
+	 * client's active request.
+	 */
+	void receive_request(int client_socket);
+
+	/**
+	 * Answer a request on a pooled connection.
+	 */
+	void start_request(int client_socket,
+	                   const std::string& raw_request_string);
+
+	/**
+	 * Send the response of an answered request, then start on the
+	 * client's backlog.
+	 */
+	void finish_request(int client_socket, uint64_t request_id);
+
+	/**
+	 * Answer a request, body included even for HEAD requests.
+	 *
+	 * @param[in] raw_request_string
+	 * 		Raw request string.
+	 *
+	 * @param[in] on_answered
+	 * 		Called once the response is complete if this returns false.
+	 *
+	 * @return
+	 * 		True if the response is already complete.
+	 */
+	bool answer_request(const std::string& raw_request_string,
+	                    const std::function<void()>& on_answered);
+
+	/**
+	 * Answer "/healthz" probes from preserialized responses, without
+	 * touching SQLite, Redis, or the caches. "/healthz?ready" also reports
+	 * readiness from the scoreboard with 503 while workers are starting.
+	 *
+	 * @return
+	 * 		True if the request is a probe and has been answered.
+	 */
+	bool answer_health_check();
+
 	int m_epfd;
 
 	int m_worker_socket;
 
 	std::unique_ptr<WorkerSocket> m_worker_socket_handler;
+
+	// Connection of the request being handled.
 	std::shared_ptr<HTTP::Connection> m_connection;
+
+	std::vector<std::shared_ptr<HTTP::Connection>> m_idle_connections;
+	std::unordered_map<int, ActiveRequest> m_active_requests;
+	uint64_t m_last_request_id = 0;
+
+	std::shared_ptr<HTTP::Cache> m_cache;
+	std::shared_ptr<SqliteHandler> m_search_handler;
 	std::unique_ptr<WorkerSocket> m_server_socket;
-	std::unique_ptr<IResourceHandler> m_resource_handler;
+	HTTP::Router m_router;
+	StatusHandler::PrebuiltResponse m_alive_response;
+	StatusHandler::PrebuiltResponse m_not_ready_response;
 	std::map<std::string, std::string> post_data_map;
 };
\ No newline at end of file
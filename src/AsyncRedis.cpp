@@ -0,0 +1,718 @@
+#include "AsyncRedis.hpp"
+#include "Logger.hpp"
+#include "Timer.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+	const int64_t RETRY_INTERVAL_MS = 1000;
+
+	const int64_t REPLY_TIMEOUT_MS = 1000;
+
+	// Beyond this much unsent output, Redis is considered backed up.
+	const size_t MAX_OUTPUT_BUFFER_SIZE = 8 * 1024 * 1024;
+
+	const size_t READ_CHUNK_SIZE = 16 * 1024;
+
+	// Nesting of array replies, which a cache never gets anyway.
+	const int MAX_REPLY_DEPTH = 8;
+
+	const char DEFAULT_PORT[] = "6379";
+
+	const std::string GET_COMMAND = "GET";
+	const std::string SET_COMMAND = "SET";
+	const std::string EXPIRE_IN_SECONDS = "EX";
+	const std::string DEL_COMMAND = "DEL";
+	const std::string SELECT_COMMAND = "SELECT";
+
+	enum class ParseResult
+	{
+		COMPLETE,
+		INCOMPLETE,
+		MALFORMED,
+	};
+
+	struct Reply
+	{
+		// False for null replies.
+		bool is_found = false;
+		bool is_error = false;
+
+		// Simple string, error message, integer or bulk string.
+		std::string value;
+	};
+
+	bool parse_integer(const std::string& buffer, size_t begin, size_t end,
+	                   int64_t& integer)
+	{
+		bool is_negative = begin < end && buffer[begin] == '-';
+		if (is_negative)
+		{
+			++begin;
+		}
+		if (begin == end || end - begin > 18)
+		{
+			return false;
+		}
+
+		integer = 0;
+		for (size_t i = begin; i < end; ++i)
+		{
+			if (buffer[i] < '0' || buffer[i] > '9')
+			{
+				return false;
+			}
+			integer = integer * 10 + (buffer[i] - '0');
+		}
+		if (is_negative)
+		{
+			integer = -integer;
+		}
+		return true;
+	}
+
+	/**
+	 * Parse one RESP reply starting at @b position.
+	 *
+	 * @param[in,out] position
+	 *      Advanced past the reply if it is complete.
+	 */
+	ParseResult parse_reply(const std::string& buffer, size_t& position,
+	                        Reply& reply, int depth = 0)
+	{
+		if (position >= buffer.size())
+		{
+			return ParseResult::INCOMPLETE;
+		}
+
+		size_t line_end = buffer.find("\r\n", position + 1);
+		if (line_end == std::string::npos)
+		{
+			return ParseResult::INCOMPLETE;
+		}
+
+		const char type = buffer[position];
+		const size_t line_begin = position + 1;
+		size_t cursor = line_end + 2;
+
+		switch (type)
+		{
+		case '+':
+		case '-':
+		case ':':
+		{
+			reply.is_found = type != '-';
+			reply.is_error = type == '-';
+			reply.value.assign(buffer, line_begin, line_end - line_begin);
+			break;
+		}
+
+		case '$':
+		{
+			int64_t length = 0;
+			if (!parse_integer(buffer, line_begin, line_end, length) ||
+			    length < -1)
+			{
+				return ParseResult::MALFORMED;
+			}
+			if (length == -1)
+			{
+				reply.is_found = false;
+				break;
+			}
+
+			auto size = static_cast<size_t>(length);
+			if (buffer.size() - cursor < size + 2)
+			{
+				return ParseResult::INCOMPLETE;
+			}
+			if (buffer.compare(cursor + size, 2, "\r\n") != 0)
+			{
+				return ParseResult::MALFORMED;
+			}
+
+			reply.is_found = true;
+			reply.value.assign(buffer, cursor, size);
+			cursor += size + 2;
+			break;
+		}
+
+		case '*':
+		{
+			int64_t count = 0;
+			if (!parse_integer(buffer, line_begin, line_end, count) ||
+			    count < -1 || depth >= MAX_REPLY_DEPTH)
+			{
+				return ParseResult::MALFORMED;
+			}
+
+			// elements are skipped, the cache only sends scalar commands
+			for (int64_t i = 0; i < count; ++i)
+			{
+				Reply element;
+				ParseResult result =
+				    parse_reply(buffer, cursor, element, depth + 1);
+				if (result != ParseResult::COMPLETE)
+				{
+					return result;
+				}
+			}
+			reply.is_found = count != -1;
+			break;
+		}
+
+		default:
+		{
+			return ParseResult::MALFORMED;
+		}
+		}
+
+		position = cursor;
+		return ParseResult::COMPLETE;
+	}
+
+	/**
+	 * Append a command, an array of bulk strings, to @b buffer.
+	 */
+	void append_command(std::string& buffer,
+	                    const std::vector<const std::string*>& arguments)
+	{
+		buffer += '*';
+		buffer += std::to_string(arguments.size());
+		buffer += "\r\n";
+		for (const std::string* argument : arguments)
+		{
+			buffer += '$';
+			buffer += std::to_string(argument->size());
+			buffer += "\r\n";
+			buffer += *argument;
+			buffer += "\r\n";
+		}
+	}
+
+	/**
+	 * Resolve "tcp://host[:port][/db]" or "unix://path".
+	 *
+	 * @param[out] database
+	 *      The database index of the URI, empty if it has none.
+	 */
+	bool resolve_address(const std::string& uri, sockaddr_storage& address,
+	                     socklen_t& address_length, std::string& database)
+	{
+		database.clear();
+
+		const std::string unix_scheme = "unix://";
+		const std::string tcp_scheme = "tcp://";
+
+		if (uri.compare(0, unix_scheme.size(), unix_scheme) == 0)
+		{
+			std::string path = uri.substr(unix_scheme.size());
+			sockaddr_un unix_address{};
+			if (path.empty() || path.size() >= sizeof(unix_address.sun_path))
+			{
+				return false;
+			}
+
+			unix_address.sun_family = AF_UNIX;
+			std::memcpy(unix_address.sun_path, path.c_str(), path.size() + 1);
+			std::memcpy(&address, &unix_address, sizeof(unix_address));
+			address_length = sizeof(unix_address);
+			return true;
+		}
+
+		if (uri.compare(0, tcp_scheme.size(), tcp_scheme) != 0)
+		{
+			return false;
+		}
+
+		std::string authority = uri.substr(tcp_scheme.size());
+		size_t slash = authority.find('/');
+		if (slash != std::string::npos)
+		{
+			database = authority.substr(slash + 1);
+			authority.erase(slash);
+			if (database.empty() ||
+			    database.find_first_not_of("0123456789") != std::string::npos)
+			{
+				return false;
+			}
+		}
+
+		std::string host = authority;
+		std::string port = DEFAULT_PORT;
+		if (!authority.empty() && authority[0] == '[')
+		{
+			// [IPv6 address]:port
+			size_t bracket = authority.find(']');
+			if (bracket == std::string::npos)
+			{
+				return false;
+			}
+			host = authority.substr(1, bracket - 1);
+			if (authority.compare(bracket + 1, 1, ":") == 0)
+			{
+				port = authority.substr(bracket + 2);
+			}
+		}
+		else
+		{
+			size_t colon = authority.find(':');
+			if (colon != std::string::npos)
+			{
+				host = authority.substr(0, colon);
+				port = authority.substr(colon + 1);
+			}
+		}
+
+		addrinfo hints{};
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+
+		addrinfo* addresses = nullptr;
+		if (host.empty() ||
+		    getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0)
+		{
+			return false;
+		}
+
+		std::memcpy(&address, addresses->ai_addr, addresses->ai_addrlen);
+		address_length = addresses->ai_addrlen;
+		freeaddrinfo(addresses);
+		return true;
+	}
+} // namespace
+
+namespace HTTP
+{
+	AsyncRedis::AsyncRedis(const std::string& uri)
+	{
+		if (!resolve_address(uri, m_address, m_address_length, m_database))
+		{
+			Logger::error("can't resolve redis address: " + uri);
+			m_address_length = 0;
+		}
+	}
+
+	AsyncRedis::~AsyncRedis() { close_connection(); }
+
+	void AsyncRedis::attach(int epoll_fd)
+	{
+		close_connection();
+		m_epoll_fd = epoll_fd;
+	}
+
+	bool AsyncRedis::is_usable() const
+	{
+		return m_epoll_fd != -1 && m_address_length != 0 &&
+		       Timer::get_coarse_monotonic_milliseconds() >= m_retry_time;
+	}
+
+	void AsyncRedis::get(const std::string& key, GetCallback callback)
+	{
+		if (!queue_command({&GET_COMMAND, &key}, std::move(callback)))
+		{
+			// queue_command() leaves the callback alone when it fails
+			callback(false, "");
+		}
+	}
+
+	void AsyncRedis::set(const std::string& key, const std::string& value,
+	                     uint32_t time_to_live)
+	{
+		if (time_to_live == 0)
+		{
+			queue_command({&SET_COMMAND, &key, &value}, nullptr);
+			return;
+		}
+
+		const std::string seconds = std::to_string(time_to_live);
+		queue_command(
+		    {&SET_COMMAND, &key, &value, &EXPIRE_IN_SECONDS, &seconds},
+		    nullptr);
+	}
+
+	void AsyncRedis::del(const std::string& key)
+	{
+		queue_command({&DEL_COMMAND, &key}, nullptr);
+	}
+
+	void AsyncRedis::command(const std::vector<std::string>& arguments)
+	{
+		std::vector<const std::string*> argument_pointers;
+		argument_pointers.reserve(arguments.size());
+		for (const std::string& argument : arguments)
+		{
+			argument_pointers.push_back(&argument);
+		}
+		queue_command(argument_pointers, nullptr);
+	}
+
+	bool
+	AsyncRedis::queue_command(const std::vector<const std::string*>& arguments,
+	                          GetCallback&& callback)
+	{
+		int64_t now = Timer::get_coarse_monotonic_milliseconds();
+		if (!is_usable() || m_output_buffer.size() - m_output_position >
+		                        MAX_OUTPUT_BUFFER_SIZE)
+		{
+			++m_statistics.dropped_commands;
+			return false;
+		}
+
+		append_command(m_output_buffer, arguments);
+		m_pending_replies.push_back(
+		    PendingReply{std::move(callback), now + REPLY_TIMEOUT_MS});
+		++m_statistics.commands;
+		return true;
+	}
+
+	void AsyncRedis::flush()
+	{
+		if (m_epoll_fd == -1 || m_output_position == m_output_buffer.size())
+		{
+			return;
+		}
+
+		if (m_fd == -1)
+		{
+			if (Timer::get_coarse_monotonic_milliseconds() < m_retry_time ||
+			    !connect_to_server())
+			{
+				return;
+			}
+		}
+
+		if (m_state == State::CONNECTED && !write_output())
+		{
+			return;
+		}
+
+		update_events();
+	}
+
+	void AsyncRedis::handle_events(uint32_t events)
+	{
+		if (m_fd == -1)
+		{
+			return;
+		}
+
+		if (m_state == State::CONNECTING)
+		{
+			int error = 0;
+			socklen_t error_length = sizeof(error);
+			if (getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &error,
+			               &error_length) == -1 ||
+			    error != 0)
+			{
+				handle_error(std::string("can't connect: ") +
+				             std::strerror(error != 0 ? error : errno));
+				return;
+			}
+			if (!(events & (EPOLLOUT | EPOLLERR | EPOLLHUP)))
+			{
+				return;
+			}
+			m_state = State::CONNECTED;
+		}
+
+		if ((events & EPOLLIN) && !read_replies())
+		{
+			return;
+		}
+
+		if (events & (EPOLLERR | EPOLLHUP))
+		{
+			handle_error("connection closed");
+			return;
+		}
+
+		if (m_output_position != m_output_buffer.size() && !write_output())
+		{
+			return;
+		}
+
+		update_events();
+	}
+
+	int AsyncRedis::get_fd() const { return m_fd; }
+
+	int AsyncRedis::get_poll_timeout() const
+	{
+		if (m_pending_replies.empty() || m_epoll_fd == -1)
+		{
+			return -1;
+		}
+
+		int64_t timeout = m_pending_replies.front().deadline -
+		                  Timer::get_coarse_monotonic_milliseconds();
+		return timeout > 0 ? static_cast<int>(timeout) : 0;
+	}
+
+	void AsyncRedis::check_timeout()
+	{
+		if (m_epoll_fd != -1 && !m_pending_replies.empty() &&
+		    Timer::get_coarse_monotonic_milliseconds() >=
+		        m_pending_replies.front().deadline)
+		{
+			handle_error("reply timed out");
+		}
+	}
+
+	AsyncRedis::Statistics AsyncRedis::get_statistics() const
+	{
+		return m_statistics;
+	}
+
+	bool AsyncRedis::connect_to_server()
+	{
+		const int family = m_address.ss_family;
+		m_fd = socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (m_fd == -1)
+		{
+			handle_error(std::string("can't create socket: ") +
+			             std::strerror(errno));
+			return false;
+		}
+
+		if (family != AF_UNIX)
+		{
+			// pipelined commands are already batched per event loop pass
+			int is_enabled = 1;
+			setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &is_enabled,
+			           sizeof(is_enabled));
+		}
+
+		m_state = State::CONNECTED;
+		if (connect(m_fd, reinterpret_cast<const sockaddr*>(&m_address),
+		            m_address_length) == -1)
+		{
+			if (errno != EINPROGRESS)
+			{
+				handle_error(std::string("can't connect: ") +
+				             std::strerror(errno));
+				return false;
+			}
+			m_state = State::CONNECTING;
+		}
+
+		epoll_event event{};
+		event.events = EPOLLIN | EPOLLOUT;
+		event.data.fd = m_fd;
+		if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_fd, &event) == -1)
+		{
+			handle_error(std::string("can't watch socket: ") +
+			             std::strerror(errno));
+			return false;
+		}
+		m_events = event.events;
+
+		// the database is selected ahead of the commands queued meanwhile,
+		// none of which are written before connecting
+		m_is_selection_failed = false;
+		if (!m_database.empty())
+		{
+			std::string select_command;
+			append_command(select_command, {&SELECT_COMMAND, &m_database});
+			m_output_buffer.insert(m_output_position, select_command);
+			m_pending_replies.push_front(PendingReply{
+			    [this](bool is_selected, const std::string&) {
+				    m_is_selection_failed = !is_selected;
+			    },
+			    Timer::get_coarse_monotonic_milliseconds() +
+			        REPLY_TIMEOUT_MS});
+			++m_statistics.commands;
+		}
+		return true;
+	}
+
+	bool AsyncRedis::write_output()
+	{
+		while (m_output_position < m_output_buffer.size())
+		{
+			ssize_t written =
+			    send(m_fd, m_output_buffer.data() + m_output_position,
+			         m_output_buffer.size() - m_output_position, MSG_NOSIGNAL);
+			if (written > 0)
+			{
+				m_output_position += static_cast<size_t>(written);
+				++m_statistics.writes;
+				continue;
+			}
+
+			if (written == -1 && errno == EINTR)
+			{
+				continue;
+			}
+			if (written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			{
+				return true;
+			}
+
+			handle_error(std::string("can't write: ") + std::strerror(errno));
+			return false;
+		}
+
+		m_output_buffer.clear();
+		m_output_position = 0;
+		return true;
+	}
+
+	bool AsyncRedis::read_replies()
+	{
+		char chunk[READ_CHUNK_SIZE];
+		for (;;)
+		{
+			ssize_t received = recv(m_fd, chunk, sizeof(chunk), 0);
+			if (received > 0)
+			{
+				m_input_buffer.append(chunk, static_cast<size_t>(received));
+				continue;
+			}
+
+			if (received == 0)
+			{
+				handle_error("connection closed by server");
+				return false;
+			}
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+
+			handle_error(std::string("can't read: ") + std::strerror(errno));
+			return false;
+		}
+
+		size_t position = 0;
+		while (!m_pending_replies.empty())
+		{
+			Reply reply;
+			ParseResult result = parse_reply(m_input_buffer, position, reply);
+			if (result == ParseResult::INCOMPLETE)
+			{
+				break;
+			}
+			if (result == ParseResult::MALFORMED)
+			{
+				handle_error("malformed reply");
+				return false;
+			}
+
+			PendingReply pending_reply = std::move(m_pending_replies.front());
+			m_pending_replies.pop_front();
+			++m_statistics.replies;
+
+			if (reply.is_error)
+			{
+				Logger::debug("redis error reply: " + reply.value);
+			}
+			if (pending_reply.callback)
+			{
+				pending_reply.callback(reply.is_found && !reply.is_error,
+				                       reply.value);
+			}
+
+			// the replies that follow would be of another database
+			if (m_is_selection_failed)
+			{
+				m_is_selection_failed = false;
+				handle_error("can't select database " + m_database);
+				return false;
+			}
+		}
+		m_input_buffer.erase(0, position);
+
+		if (m_pending_replies.empty() && !m_input_buffer.empty())
+		{
+			handle_error("unexpected reply");
+			return false;
+		}
+		return true;
+	}
+
+	void AsyncRedis::update_events()
+	{
+		if (m_fd == -1)
+		{
+			return;
+		}
+
+		uint32_t events = EPOLLIN;
+		if (m_state == State::CONNECTING ||
+		    m_output_position != m_output_buffer.size())
+		{
+			events |= EPOLLOUT;
+		}
+		if (events == m_events)
+		{
+			return;
+		}
+
+		epoll_event event{};
+		event.events = events;
+		event.data.fd = m_fd;
+		if (epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, m_fd, &event) == -1)
+		{
+			handle_error(std::string("can't watch socket: ") +
+			             std::strerror(errno));
+			return;
+		}
+		m_events = events;
+	}
+
+	void AsyncRedis::handle_error(const std::string& reason)
+	{
+		Logger::warn("redis error, retry in a second: " + reason);
+		++m_statistics.errors;
+
+		close_connection();
+		m_retry_time =
+		    Timer::get_coarse_monotonic_milliseconds() + RETRY_INTERVAL_MS;
+		m_output_buffer.clear();
+		m_output_position = 0;
+		m_input_buffer.clear();
+
+		// callbacks may queue commands, which are dropped while backing off
+		std::deque<PendingReply> failed_replies;
+		failed_replies.swap(m_pending_replies);
+		for (PendingReply& pending_reply : failed_replies)
+		{
+			if (pending_reply.callback)
+			{
+				pending_reply.callback(false, "");
+			}
+		}
+	}
+
+	void AsyncRedis::close_connection()
+	{
+		if (m_fd == -1)
+		{
+			return;
+		}
+
+		if (m_epoll_fd != -1)
+		{
+			epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, m_fd, nullptr);
+		}
+		close(m_fd);
+		m_fd = -1;
+		m_state = State::DISCONNECTED;
+		m_events = 0;
+	}
+} // namespace HTTP
@@ -1,12 +1,13 @@
 #include "Base64.hpp"
-#include "Logger.hpp"
+#include "CpuDispatch.hpp"
 
-#include <bitset>
-#include <iostream>
-#include <map>
-#include <sstream>
+#include <cstring>
 #include <vector>
 
+#if defined(CPU_DISPATCH_X86)
+#include <immintrin.h>
+#endif
+
 namespace
 {
 	/**
@@ -14,53 +15,98 @@ namespace
 	 * Convert one 6-bit input group(in the form of decimal number)
 	 * to its corresponding Base64 character.
 	 */
-	const char encoding_table[65] =
+	constexpr char ENCODING_TABLE[65] =
 	    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-	/**
-	 * For general Base64 decoding.
-	 * Map a encoded Base64 character to its corresponding 6-bit group(in the
-	 * form of decimal number)
-	 */
-	const std::map<char, uint8_t> decoding_map{
-	    {'A', 0},  {'B', 1},  {'C', 2},  {'D', 3},  {'E', 4},  {'F', 5},
-	    {'G', 6},  {'H', 7},  {'I', 8},  {'J', 9},  {'K', 10}, {'L', 11},
-	    {'M', 12}, {'N', 13}, {'O', 14}, {'P', 15}, {'Q', 16}, {'R', 17},
-	    {'S', 18}, {'T', 19}, {'U', 20}, {'V', 21}, {'W', 22}, {'X', 23},
-	    {'Y', 24}, {'Z', 25}, {'a', 26}, {'b', 27}, {'c', 28}, {'d', 29},
-	    {'e', 30}, {'f', 31}, {'g', 32}, {'h', 33}, {'i', 34}, {'j', 35},
-	    {'k', 36}, {'l', 37}, {'m', 38}, {'n', 39}, {'o', 40}, {'p', 41},
-	    {'q', 42}, {'r', 43}, {'s', 44}, {'t', 45}, {'u', 46}, {'v', 47},
-	    {'w', 48}, {'x', 49}, {'y', 50}, {'z', 51}, {'0', 52}, {'1', 53},
-	    {'2', 54}, {'3', 55}, {'4', 56}, {'5', 57}, {'6', 58}, {'7', 59},
-	    {'8', 60}, {'9', 61}, {'+', 62}, {'/', 63},
-	};
-
 	/**
 	 * Only for URL Base64 encoding.
 	 * Convert one 6-bit input group(in the form of decimal number)
 	 * to its corresponding Base64 character.
 	 */
-	const char url_encoding_table[65] =
+	constexpr char URL_ENCODING_TABLE[65] =
 	    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
 
+	// Marks a byte that is not part of the alphabet in the decoding tables.
+	constexpr uint8_t INVALID = 0xFF;
+
+	/**
+	 * For general Base64 decoding.
+	 * Map every byte to its 6-bit group, INVALID if it is not a Base64
+	 * character.
+	 */
+	constexpr uint8_t DECODING_TABLE[256] = {
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+	    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
+	    0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+	    0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+	    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+	    0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,
+	    0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+	    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
+	    0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	};
+
 	/**
 	 * Only for URL Base64 decoding.
-	 * Map a encoded Base64 character to its corresponding 6-bit group(in the
-	 * form of decimal number)
+	 * Map every byte to its 6-bit group, INVALID if it is not a Base64 URL
+	 * character.
 	 */
-	const std::map<char, uint8_t> url_decoding_map{
-	    {'A', 0},  {'B', 1},  {'C', 2},  {'D', 3},  {'E', 4},  {'F', 5},
-	    {'G', 6},  {'H', 7},  {'I', 8},  {'J', 9},  {'K', 10}, {'L', 11},
-	    {'M', 12}, {'N', 13}, {'O', 14}, {'P', 15}, {'Q', 16}, {'R', 17},
-	    {'S', 18}, {'T', 19}, {'U', 20}, {'V', 21}, {'W', 22}, {'X', 23},
-	    {'Y', 24}, {'Z', 25}, {'a', 26}, {'b', 27}, {'c', 28}, {'d', 29},
-	    {'e', 30}, {'f', 31}, {'g', 32}, {'h', 33}, {'i', 34}, {'j', 35},
-	    {'k', 36}, {'l', 37}, {'m', 38}, {'n', 39}, {'o', 40}, {'p', 41},
-	    {'q', 42}, {'r', 43}, {'s', 44}, {'t', 45}, {'u', 46}, {'v', 47},
-	    {'w', 48}, {'x', 49}, {'y', 50}, {'z', 51}, {'0', 52}, {'1', 53},
-	    {'2', 54}, {'3', 55}, {'4', 56}, {'5', 57}, {'6', 58}, {'7', 59},
-	    {'8', 60}, {'9', 61}, {'-', 62}, {'_', 63},
+	constexpr uint8_t URL_DECODING_TABLE[256] = {
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF,
+	    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
+	    0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+	    0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+	    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+	    0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F,
+	    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,
+	    0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+	    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
+	    0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
 	};
 
 	/**
@@ -102,218 +148,512 @@ namespace
 	}
 
 	/**
-	 * Encode the given unencoded ASCII string.
+	 * Encode whole 3-byte groups with the scalar table lookup.
 	 *
-	 * @param[in] unencoded_string
-	 *      The unencoded ASCII string.
-	 * @param[in] is_url_encoding
-	 *      Whether is url encoding. Default is false.
-	 * @param[in] is_hex_string
-	 *      Whether is hexadecimal string. Default is false.
-	 * @param[in] has_padding
-	 *      Whether has padding. Default is ture.
+	 * @return
+	 *      Number of input bytes consumed.
 	 */
-	std::string encode_implementation(const std::string& unencoded_string,
-	                                  bool is_url_encoding = false,
-	                                  bool is_hex_string = false,
-	                                  bool has_padding = true)
+	size_t encode_blocks_scalar(const uint8_t* input, size_t size,
+	                            char* output, const char* table)
 	{
-		size_t number_of_bytes = unencoded_string.size();
-		std::vector<uint8_t> bytes_sequence;
-		if (!is_hex_string)
+		size_t i = 0;
+		for (; i + 3 <= size; i += 3)
 		{
-			for (auto character : unencoded_string)
+			uint32_t group = (uint32_t{input[i]} << 16) |
+			                 (uint32_t{input[i + 1]} << 8) | input[i + 2];
+			*output++ = table[(group >> 18) & 0x3f];
+			*output++ = table[(group >> 12) & 0x3f];
+			*output++ = table[(group >> 6) & 0x3f];
+			*output++ = table[group & 0x3f];
+		}
+		return i;
+	}
+
+	/**
+	 * Decode whole 4-character groups with the scalar table lookup.
+	 *
+	 * @return
+	 *      Number of input characters consumed, or SIZE_MAX if an invalid
+	 *      character is found.
+	 */
+	size_t decode_blocks_scalar(const char* input, size_t size,
+	                            uint8_t* output, const uint8_t* table)
+	{
+		size_t i = 0;
+		for (; i + 4 <= size; i += 4)
+		{
+			uint32_t a = table[static_cast<uint8_t>(input[i])];
+			uint32_t b = table[static_cast<uint8_t>(input[i + 1])];
+			uint32_t c = table[static_cast<uint8_t>(input[i + 2])];
+			uint32_t d = table[static_cast<uint8_t>(input[i + 3])];
+			if (((a | b | c | d) & 0x80) != 0)
 			{
-				bytes_sequence.push_back(character);
+				return SIZE_MAX;
 			}
+
+			uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+			*output++ = static_cast<uint8_t>(group >> 16);
+			*output++ = static_cast<uint8_t>(group >> 8);
+			*output++ = static_cast<uint8_t>(group);
 		}
-		else // is hexadecimal string
+		return i;
+	}
+
+#if defined(CPU_DISPATCH_X86)
+	/**
+	 * Vector kernels after W. Mula and D. Lemire, "Faster Base64 Encoding and
+	 * Decoding Using AVX2 Instructions".
+	 *
+	 * Encoding: shuffle each 3-byte group into a 32-bit lane, move the four
+	 * 6-bit fields into separate bytes with a mulhi/mullo pair, then turn the
+	 * indices into characters by adding a per-range offset looked up with
+	 * pshufb. The offsets of index 62 and 63 select the alphabet.
+	 *
+	 * Decoding (standard alphabet only): classify every character by its low
+	 * and high nibble, reject any character whose two classes don't overlap,
+	 * add the per-range offset, and pack the 6-bit fields with maddubs/madd.
+	 */
+
+	CPU_DISPATCH_TARGET("ssse3") inline __m128i
+	encode_indices_ssse3(__m128i input)
+	{
+		input = _mm_shuffle_epi8(
+		    input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0,
+		                        1));
+		const __m128i t0 = _mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00));
+		const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+		const __m128i t2 = _mm_and_si128(input, _mm_set1_epi32(0x003f03f0));
+		const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+		return _mm_or_si128(t1, t3);
+	}
+
+	CPU_DISPATCH_TARGET("ssse3") inline __m128i
+	indices_to_characters_ssse3(__m128i indices, __m128i offsets)
+	{
+		__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+		const __m128i is_upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+		range = _mm_or_si128(range, _mm_and_si128(is_upper, _mm_set1_epi8(13)));
+		return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+	}
+
+	CPU_DISPATCH_TARGET("ssse3") size_t
+	encode_blocks_ssse3(const uint8_t* input, size_t size, char* output,
+	                    const char* table)
+	{
+		const __m128i offsets = _mm_setr_epi8(
+		    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		    static_cast<char>(table[62] - 62),
+		    static_cast<char>(table[63] - 63), 'A', 0, 0);
+
+		size_t i = 0;
+		// 16-byte loads, of which 12 bytes are encoded
+		for (; i + 16 <= size; i += 12)
 		{
-			/**
-			 * If is hexadecimal string, each char is 4-bit,
-			 * So the string's length should be string.size() / 2.
-			 */
-			number_of_bytes = unencoded_string.size() / 2;
-			bytes_sequence = hex_string_to_byte_array(unencoded_string);
+			__m128i indices = encode_indices_ssse3(
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output),
+			                 indices_to_characters_ssse3(indices, offsets));
+			output += 16;
 		}
+		return i + encode_blocks_scalar(input + i, size - i, output, table);
+	}
 
-		size_t bits = 0;
-		uint16_t buffer = 0;
-		std::stringstream output;
+	CPU_DISPATCH_TARGET("avx2") size_t
+	encode_blocks_avx2(const uint8_t* input, size_t size, char* output,
+	                   const char* table)
+	{
+		const __m256i shuffle = _mm256_setr_epi8(
+		    1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4,
+		    3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+		const __m256i offsets = _mm256_setr_epi8(
+		    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		    static_cast<char>(table[62] - 62),
+		    static_cast<char>(table[63] - 63), 'A', 0, 0, 'a' - 26, '0' - 52,
+		    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		    '0' - 52, '0' - 52, '0' - 52, static_cast<char>(table[62] - 62),
+		    static_cast<char>(table[63] - 63), 'A', 0, 0);
 
-		for (auto byte : bytes_sequence)
+		size_t i = 0;
+		// two 16-byte loads 12 bytes apart, of which 24 bytes are encoded
+		for (; i + 28 <= size; i += 24)
 		{
-			buffer <<= 8;
-			buffer += (uint16_t)byte;
-			bits += 8;
-			while (bits >= 6)
-			{
-				if (is_url_encoding)
-				{
-					/**
-					 * 0x3f is 0011 1111
-					 * 1101 0101 & 0x3f => 0001 0101 (reserve the most
-					 * significant 6 bits of 1101 0101) 1101 0101 >> 2 => 0011
-					 * 0101 (drop the least significant 2 bits)
-					 */
-					output << url_encoding_table[(buffer >> (bits - 6)) & 0x3f];
-				}
-				else
-				{
-					output << encoding_table[(buffer >> (bits - 6)) & 0x3f];
-				}
+			__m256i data = _mm256_inserti128_si256(
+			    _mm256_castsi128_si256(_mm_loadu_si128(
+			        reinterpret_cast<const __m128i*>(input + i))),
+			    _mm_loadu_si128(
+			        reinterpret_cast<const __m128i*>(input + i + 12)),
+			    1);
+			data = _mm256_shuffle_epi8(data, shuffle);
 
-				/**
-				 * clear most significant 6 bits of buffer.
-				 */
-				buffer &= ~(0x3f << (bits - 6));
-				bits -= 6;
-			}
+			const __m256i t0 =
+			    _mm256_and_si256(data, _mm256_set1_epi32(0x0fc0fc00));
+			const __m256i t1 =
+			    _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+			const __m256i t2 =
+			    _mm256_and_si256(data, _mm256_set1_epi32(0x003f03f0));
+			const __m256i t3 =
+			    _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+			const __m256i indices = _mm256_or_si256(t1, t3);
+
+			__m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+			const __m256i is_upper =
+			    _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+			range = _mm256_or_si256(
+			    range, _mm256_and_si256(is_upper, _mm256_set1_epi8(13)));
+
+			_mm256_storeu_si256(
+			    reinterpret_cast<__m256i*>(output),
+			    _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range)));
+			output += 32;
 		}
+		// avoid the AVX to SSE transition penalty in the SSSE3 tail
+		_mm256_zeroupper();
+		return i + encode_blocks_ssse3(input + i, size - i, output, table);
+	}
 
-		/**
-		 * If after main loop, there are still (1 byte - 6 bits = 2 bit)
-		 * Shift left 4 bits to form a new 6-bit character
-		 * and add padding(=) if needed.
-		 */
-		if (number_of_bytes % 3 == 1)
+	CPU_DISPATCH_TARGET("ssse3") size_t
+	decode_blocks_ssse3(const char* input, size_t size, uint8_t* output,
+	                    const uint8_t* table)
+	{
+		const __m128i lut_lo =
+		    _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+		                  0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+		const __m128i lut_hi =
+		    _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10,
+		                  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+		const __m128i lut_roll =
+		    _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0,
+		                  0, 0);
+		const __m128i mask_2f = _mm_set1_epi8(0x2f);
+		const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13,
+		                                   12, -1, -1, -1, -1);
+
+		size_t i = 0;
+		// 16 characters decode to 12 bytes, but the store writes 16.
+		for (; i + 24 <= size; i += 16)
 		{
-			buffer <<= 4;
-			if (is_url_encoding)
+			__m128i data =
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+
+			const __m128i hi_nibbles =
+			    _mm_and_si128(_mm_srli_epi32(data, 4), mask_2f);
+			const __m128i lo_nibbles = _mm_and_si128(data, mask_2f);
+			const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+			const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi),
+			                                     _mm_setzero_si128())) !=
+			    0xFFFF)
 			{
-				output << url_encoding_table[buffer & 0x3f];
-				if (has_padding)
-				{
-					output << "==";
-				}
+				break;
 			}
-			else // is not URL encoding
+
+			const __m128i is_slash = _mm_cmpeq_epi8(data, mask_2f);
+			const __m128i roll = _mm_shuffle_epi8(
+			    lut_roll, _mm_add_epi8(is_slash, hi_nibbles));
+			data = _mm_add_epi8(data, roll);
+
+			data = _mm_maddubs_epi16(data, _mm_set1_epi32(0x01400140));
+			data = _mm_madd_epi16(data, _mm_set1_epi32(0x00011000));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output),
+			                 _mm_shuffle_epi8(data, pack));
+			output += 12;
+		}
+
+		// The scalar loop also pinpoints an invalid block found above.
+		size_t consumed =
+		    decode_blocks_scalar(input + i, size - i, output, table);
+		return consumed == SIZE_MAX ? SIZE_MAX : i + consumed;
+	}
+
+	CPU_DISPATCH_TARGET("avx2") size_t
+	decode_blocks_avx2(const char* input, size_t size, uint8_t* output,
+	                   const uint8_t* table)
+	{
+		const __m256i lut_lo = _mm256_setr_epi8(
+		    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13,
+		    0x1A, 0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11,
+		    0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+		const __m256i lut_hi = _mm256_setr_epi8(
+		    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10,
+		    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08,
+		    0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+		const __m256i lut_roll = _mm256_setr_epi8(
+		    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16,
+		    19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+		const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+		const __m256i pack = _mm256_setr_epi8(
+		    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6,
+		    5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+		const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+		size_t i = 0;
+		// 32 characters decode to 24 bytes, but the store writes 32.
+		for (; i + 44 <= size; i += 32)
+		{
+			__m256i data =
+			    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+
+			const __m256i hi_nibbles =
+			    _mm256_and_si256(_mm256_srli_epi32(data, 4), mask_2f);
+			const __m256i lo_nibbles = _mm256_and_si256(data, mask_2f);
+			const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+			const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+			if (!_mm256_testz_si256(lo, hi))
 			{
-				output << encoding_table[buffer & 0x3f];
-				if (has_padding)
-				{
-					output << "==";
-				}
+				break;
 			}
+
+			const __m256i is_slash = _mm256_cmpeq_epi8(data, mask_2f);
+			const __m256i roll = _mm256_shuffle_epi8(
+			    lut_roll, _mm256_add_epi8(is_slash, hi_nibbles));
+			data = _mm256_add_epi8(data, roll);
+
+			data = _mm256_maddubs_epi16(data, _mm256_set1_epi32(0x01400140));
+			data = _mm256_madd_epi16(data, _mm256_set1_epi32(0x00011000));
+			data = _mm256_shuffle_epi8(data, pack);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output),
+			                    _mm256_permutevar8x32_epi32(data, lanes));
+			output += 24;
+		}
+
+		_mm256_zeroupper();
+		size_t consumed =
+		    decode_blocks_ssse3(input + i, size - i, output, table);
+		return consumed == SIZE_MAX ? SIZE_MAX : i + consumed;
+	}
+#endif
+
+	using EncodeBlocks = size_t (*)(const uint8_t*, size_t, char*,
+	                                const char*);
+	using DecodeBlocks = size_t (*)(const char*, size_t, uint8_t*,
+	                                const uint8_t*);
+
+#if defined(CPU_DISPATCH_X86)
+	constexpr CpuDispatch::Kernel<EncodeBlocks> encode_blocks{
+	    encode_blocks_scalar, nullptr, encode_blocks_ssse3, nullptr,
+	    encode_blocks_avx2};
+	constexpr CpuDispatch::Kernel<DecodeBlocks> decode_blocks{
+	    decode_blocks_scalar, nullptr, decode_blocks_ssse3, nullptr,
+	    decode_blocks_avx2};
+#else
+	constexpr CpuDispatch::Kernel<EncodeBlocks> encode_blocks{
+	    encode_blocks_scalar};
+	constexpr CpuDispatch::Kernel<DecodeBlocks> decode_blocks{
+	    decode_blocks_scalar};
+#endif
+
+	/**
+	 * Whether the input is padded as the caller expects: to a multiple of
+	 * 4 characters, or not at all.
+	 */
+	bool has_expected_padding(const std::string& encoded_string,
+	                          bool has_padding)
+	{
+		if (has_padding)
+		{
+			return encoded_string.size() % 4 == 0;
 		}
-		else if (number_of_bytes % 3 == 2)
+		return encoded_string.empty() || encoded_string.back() != '=';
+	}
+} // namespace
+
+namespace Base64
+{
+	size_t encoded_length(size_t size, bool has_padding)
+	{
+		if (has_padding)
 		{
-			/**
-			 * If after main loop, there are still (2 bytes - 12 bits = 4 bit)
-			 * Shift left 2 bits to form a new 6-bit character.
-			 * and add padding if needed.
-			 */
-			buffer <<= 2;
-			if (is_url_encoding)
+			return (size + 2) / 3 * 4;
+		}
+
+		// 2 characters for a trailing byte, 3 for two trailing bytes
+		return size / 3 * 4 + (size % 3 == 0 ? 0 : size % 3 + 1);
+	}
+
+	size_t decoded_length(size_t size) { return (size + 3) / 4 * 3; }
+
+	size_t encode_into(const void* data, size_t size, char* output,
+	                   bool has_padding, bool is_url)
+	{
+		const auto* input = static_cast<const uint8_t*>(data);
+		const char* table = is_url ? URL_ENCODING_TABLE : ENCODING_TABLE;
+
+		size_t consumed = encode_blocks.get()(input, size, output, table);
+		char* cursor = output + consumed / 3 * 4;
+
+		/**
+		 * One trailing byte leaves 8 bits = 6 + 2 bits, shifted left 4 bits
+		 * to form the second character; two trailing bytes leave 16 bits =
+		 * 6 + 6 + 4 bits, shifted left 2 bits to form the third character.
+		 */
+		size_t remaining = size - consumed;
+		if (remaining == 1)
+		{
+			uint32_t group = input[consumed];
+			*cursor++ = table[group >> 2];
+			*cursor++ = table[(group << 4) & 0x3f];
+			if (has_padding)
 			{
-				output << url_encoding_table[buffer & 0x3f];
-				if (has_padding)
-				{
-					output << '=';
-				}
+				*cursor++ = '=';
+				*cursor++ = '=';
 			}
-			else // is not URL encoding
+		}
+		else if (remaining == 2)
+		{
+			uint32_t group =
+			    (uint32_t{input[consumed]} << 8) | input[consumed + 1];
+			*cursor++ = table[group >> 10];
+			*cursor++ = table[(group >> 4) & 0x3f];
+			*cursor++ = table[(group << 2) & 0x3f];
+			if (has_padding)
 			{
-				output << encoding_table[buffer & 0x3f];
-				if (has_padding)
-				{
-					output << '=';
-				}
+				*cursor++ = '=';
 			}
 		}
 
-		return output.str();
+		return static_cast<size_t>(cursor - output);
 	}
 
-	/**
-	 * Decode the given encoded Base64 string.
-	 *
-	 * @param[in] encoded_string
-	 *      The encoded Base64 string.
-	 * @param[in] is_url_encoding
-	 *      Default is false.
-	 * @param[in] has_padding
-	 *      Default is ture.
-	 */
-	std::string decode_implementation(const std::string& encoded_string,
-	                                  bool is_url_decoding = false,
-	                                  bool has_padding = true)
+	bool decode_into(const char* data, size_t size, uint8_t* output,
+	                 size_t& decoded_size, bool is_url)
 	{
-		std::vector<uint8_t> bytes_sequence;
-		for (auto character : encoded_string)
+		decoded_size = 0;
+
+		// Padding is optional; at most two '=' may end the input.
+		if (size > 0 && data[size - 1] == '=')
 		{
-			bytes_sequence.push_back(character);
+			--size;
+			if (size > 0 && data[size - 1] == '=')
+			{
+				--size;
+			}
+		}
+		if (size % 4 == 1)
+		{
+			return false;
 		}
 
-		std::stringstream output;
-		size_t bits = 0;
-		uint16_t buffer = 0;
-		for (auto character : bytes_sequence)
+		const uint8_t* table = is_url ? URL_DECODING_TABLE : DECODING_TABLE;
+		size_t consumed = is_url
+		                      ? decode_blocks_scalar(data, size, output, table)
+		                      : decode_blocks.get()(data, size, output, table);
+		if (consumed == SIZE_MAX)
 		{
+			return false;
+		}
+		uint8_t* cursor = output + consumed / 4 * 3;
 
-			// group: 6 bits group
-			uint8_t group = 0;
-			if (is_url_decoding)
+		size_t remaining = size - consumed;
+		if (remaining != 0)
+		{
+			uint32_t group = 0;
+			for (size_t i = consumed; i < size; ++i)
 			{
-				if (url_decoding_map.find(character) != url_decoding_map.end())
+				uint8_t value = table[static_cast<uint8_t>(data[i])];
+				if (value == INVALID)
 				{
-					group = url_decoding_map.find(character)->second;
+					return false;
 				}
+				group = (group << 6) | value;
 			}
-			else
+
+			// 2 characters carry 1 byte, 3 characters carry 2 bytes.
+			if (remaining == 2)
 			{
-				if (decoding_map.find(character) != decoding_map.end())
-				{
-					group = decoding_map.find(character)->second;
-				}
+				*cursor++ = static_cast<uint8_t>(group >> 4);
 			}
-
-			buffer <<= 6;
-			bits += 6;
-			buffer += group;
-			if (bits >= 8)
+			else
 			{
-				if (character != '=')
-				{
-					output << (char)(buffer >> (bits - 8));
-				}
-				buffer &= ~(0xff << (bits - 8));
-				bits -= 8;
+				*cursor++ = static_cast<uint8_t>(group >> 10);
+				*cursor++ = static_cast<uint8_t>(group >> 2);
 			}
 		}
-		return output.str();
+
+		decoded_size = static_cast<size_t>(cursor - output);
+		return true;
 	}
-} // namespace
 
-namespace Base64
-{
 	std::string encode(const std::string& unencoded_string, bool has_padding)
 	{
-		return encode_implementation(unencoded_string, false, false,
-		                             has_padding);
+		std::string output(
+		    encoded_length(unencoded_string.size(), has_padding), '\0');
+		if (!output.empty())
+		{
+			encode_into(unencoded_string.data(), unencoded_string.size(),
+			            &output[0], has_padding);
+		}
+		return output;
 	}
 
 	std::string encode_hex_string(const std::string& hex_string,
 	                              bool has_padding)
 	{
-		return encode_implementation(hex_string, false, true, has_padding);
+		std::vector<uint8_t> byte_sequence =
+		    hex_string_to_byte_array(hex_string);
+
+		std::string output(encoded_length(byte_sequence.size(), has_padding),
+		                   '\0');
+		if (!output.empty())
+		{
+			encode_into(byte_sequence.data(), byte_sequence.size(), &output[0],
+			            has_padding);
+		}
+		return output;
 	}
 
 	std::string decode(const std::string& encoded_string, bool has_padding)
 	{
-		return decode_implementation(encoded_string, false, has_padding);
+		if (!has_expected_padding(encoded_string, has_padding))
+		{
+			return {};
+		}
+
+		std::string output(decoded_length(encoded_string.size()), '\0');
+		size_t decoded_size = 0;
+		if (!output.empty() &&
+		    !decode_into(encoded_string.data(), encoded_string.size(),
+		                 reinterpret_cast<uint8_t*>(&output[0]), decoded_size))
+		{
+			return {};
+		}
+		output.resize(decoded_size);
+		return output;
 	}
 
 	std::string encode_url(const std::string& unencoded_url_string,
 	                       bool has_padding)
 	{
-		return encode_implementation(unencoded_url_string, true, false,
-		                             has_padding);
+		std::string output(
+		    encoded_length(unencoded_url_string.size(), has_padding), '\0');
+		if (!output.empty())
+		{
+			encode_into(unencoded_url_string.data(),
+			            unencoded_url_string.size(), &output[0], has_padding,
+			            true);
+		}
+		return output;
 	}
 
 	std::string decode_url(const std::string& encoded_url_string,
 	                       bool has_padding)
 	{
-		return decode_implementation(encoded_url_string, true, has_padding);
+		if (!has_expected_padding(encoded_url_string, has_padding))
+		{
+			return {};
+		}
+
+		std::string output(decoded_length(encoded_url_string.size()), '\0');
+		size_t decoded_size = 0;
+		if (!output.empty() &&
+		    !decode_into(encoded_url_string.data(), encoded_url_string.size(),
+		                 reinterpret_cast<uint8_t*>(&output[0]), decoded_size,
+		                 true))
+		{
+			return {};
+		}
+		output.resize(decoded_size);
+		return output;
 	}
 } // namespace Base64
@@ -1,8 +1,58 @@
 #include "Cache.hpp"
+#include "ServerConfiguration.hpp"
+#include "SharedCache.hpp"
+#include "Timer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
 
 namespace
 {
 	const int REDIS_CACHE_MAX_MB = 8;
+
+	// Resources remembered as missing, 16 bytes each.
+	const size_t NEGATIVE_CACHE_ENTRIES = 64 * 1024;
+
+	// How long other workers wait for a leased resource at most, in case
+	// the worker computing it dies.
+	const int64_t LEASE_TIMEOUT_MS = 1000;
+
+	// How often waiting workers look for a leased resource.
+	const int LEASE_POLL_INTERVAL_MS = 2;
+
+	/**
+	 * Stamp in front of every stored resource. In host byte order: every
+	 * worker, and every server sharing Redis, runs the same build.
+	 */
+	struct Stamp
+	{
+		char magic[4];
+		uint32_t time_to_live;
+		uint64_t generation;
+		int64_t stored_at;
+		uint32_t stale_while_revalidate;
+		uint32_t reserved;
+	};
+
+	constexpr char STAMP_MAGIC[] = {'W', 'F', 'S', '1'};
+
+	std::string stamp(const std::string& resource, uint64_t generation,
+	                  const HTTP::Freshness& freshness)
+	{
+		Stamp header{};
+		std::memcpy(header.magic, STAMP_MAGIC, sizeof(STAMP_MAGIC));
+		header.time_to_live = freshness.time_to_live;
+		header.generation = generation;
+		header.stored_at = Timer::get_coarse_realtime_seconds();
+		header.stale_while_revalidate = freshness.stale_while_revalidate;
+
+		std::string stored;
+		stored.reserve(sizeof(header) + resource.size());
+		stored.append(reinterpret_cast<const char*>(&header), sizeof(header));
+		stored += resource;
+		return stored;
+	}
 } // namespace
 
 namespace HTTP
@@ -13,31 +63,381 @@ namespace HTTP
 	}
 
 	Cache::Cache(const int cache_capacity)
-	    : m_cache{new sw::redis::Redis("tcp://127.0.0.1:6379")}
+	    : m_local_cache{
+	          ServerConfiguration::instance()->get_local_cache_capacity(),
+	          ServerConfiguration::instance()->get_local_cache_shards(),
+	          to_cache_policy(
+	              ServerConfiguration::instance()->get_cache_policy())}
+	    , m_negative_cache{
+	          NEGATIVE_CACHE_ENTRIES,
+	          static_cast<int64_t>(
+	              ServerConfiguration::instance()->get_negative_cache_ttl()) *
+	              1000}
 	    , m_cache_capacity{cache_capacity}
 	{
-		// set LRU mode of redis instance
-		m_cache->command("config", "set", "maxmemory",
-		                 std::to_string(m_cache_capacity) + "mb");
-		m_cache->command("config", "set", "maxmemory-policy", "allkeys-lru");
+		const std::string redis_uri =
+		    ServerConfiguration::instance()->get_redis_uri();
+		if (redis_uri.empty())
+		{
+			return;
+		}
+
+		m_redis.reset(new AsyncRedis(redis_uri));
 	}
 
 	std::string Cache::get(const std::string& uri)
 	{
-		auto result = m_cache->get(uri);
-
-		if (!result)
+		std::string resource;
+		if (find(uri, resource) != State::FRESH)
 		{
 			return "";
 		}
+		return resource;
+	}
+
+	void Cache::get(const std::string& uri, LookupCallback callback)
+	{
+		std::string resource;
+		State state = find(uri, resource);
+		if (state != State::EXPIRED)
+		{
+			answer(uri, state, resource, callback);
+			return;
+		}
+
+		if (m_redis == nullptr || !m_redis->is_usable())
+		{
+			lease_or_wait(uri, std::move(callback));
+			return;
+		}
+
+		// the cache owns the connection, so it outlives the callback
+		m_redis->get(uri, [this, uri, callback](bool is_found,
+		                                       const std::string& value) {
+			std::string resource;
+			State state = is_found ? read_stored(value, resource)
+			                       : State::EXPIRED;
+			if (state == State::EXPIRED)
+			{
+				lease_or_wait(uri, callback);
+				return;
+			}
+
+			SharedCache::insert(uri, value);
+			m_local_cache.insert(uri, value);
+			answer(uri, state, resource, callback);
+		});
+	}
+
+	Cache::State Cache::read_stamp(const std::string& stored) const
+	{
+		Stamp header{};
+		if (stored.size() < sizeof(header))
+		{
+			return State::EXPIRED;
+		}
+
+		std::memcpy(&header, stored.data(), sizeof(header));
+		if (std::memcmp(header.magic, STAMP_MAGIC, sizeof(STAMP_MAGIC)) != 0)
+		{
+			return State::EXPIRED;
+		}
+
+		int64_t now = Timer::get_coarse_realtime_seconds();
+		bool is_current = header.generation >= m_generation;
+		bool is_outlived = header.time_to_live != 0 &&
+		                   now - header.stored_at >= header.time_to_live;
+		if (!is_current || is_outlived)
+		{
+			// stale since it outlived its time to live or the generation
+			// changed, whichever came first
+			int64_t stale_since =
+			    is_outlived ? header.stored_at + header.time_to_live : now;
+			if (!is_current)
+			{
+				stale_since =
+				    std::min(stale_since, std::max(m_generation_changed_at,
+				                                   header.stored_at));
+			}
+			return now < stale_since + header.stale_while_revalidate
+			           ? State::STALE
+			           : State::EXPIRED;
+		}
+		return State::FRESH;
+	}
+
+	Cache::State Cache::read_stored(const std::string& stored,
+	                                std::string& resource) const
+	{
+		State state = read_stamp(stored);
+		if (state != State::EXPIRED)
+		{
+			resource.assign(stored, sizeof(Stamp), std::string::npos);
+		}
+		return state;
+	}
+
+	Cache::State Cache::read_stored(std::string&& stored,
+	                                std::string& resource) const
+	{
+		State state = read_stamp(stored);
+		if (state != State::EXPIRED)
+		{
+			// shifted in place rather than copied to a new buffer
+			stored.erase(0, sizeof(Stamp));
+			resource.swap(stored);
+		}
+		return state;
+	}
+
+	Cache::State Cache::find(const std::string& uri, std::string& resource)
+	{
+		State state = State::EXPIRED;
+		std::string stored;
+		if (m_local_cache.get(uri, stored))
+		{
+			state = read_stored(std::move(stored), resource);
+			if (state == State::FRESH)
+			{
+				return state;
+			}
+		}
+
+		// another worker may have revalidated it
+		std::string shared_resource;
+		if (SharedCache::get(uri, stored))
+		{
+			State shared_state = read_stored(stored, shared_resource);
+			if (shared_state == State::FRESH ||
+			    (shared_state == State::STALE && state == State::EXPIRED))
+			{
+				m_local_cache.insert(uri, stored);
+				resource.swap(shared_resource);
+				state = shared_state;
+			}
+		}
+		return state;
+	}
+
+	void Cache::answer(const std::string& uri, State state,
+	                   const std::string& resource,
+	                   const LookupCallback& callback)
+	{
+		if (state == State::FRESH)
+		{
+			callback(Lookup::HIT, resource);
+			return;
+		}
+
+		// one lookup of all workers recomputes it, the others needn't wait
+		++m_number_of_stale_hits;
+		if (!SharedCache::acquire_lease(uri, LEASE_TIMEOUT_MS))
+		{
+			callback(Lookup::HIT, resource);
+			return;
+		}
+
+		++m_number_of_revalidations;
+		callback(Lookup::REVALIDATE, resource);
+	}
+
+	void Cache::lease_or_wait(const std::string& uri, LookupCallback callback)
+	{
+		if (SharedCache::acquire_lease(uri, LEASE_TIMEOUT_MS))
+		{
+			callback(Lookup::MISS, "");
+			return;
+		}
+
+		++m_number_of_lease_waits;
+		m_lease_waiters.push_back(LeaseWaiter{uri, std::move(callback)});
+	}
+
+	void Cache::check_lease_waiters()
+	{
+		// callbacks may start waiting again
+		std::vector<LeaseWaiter> lease_waiters;
+		lease_waiters.swap(m_lease_waiters);
+
+		for (LeaseWaiter& lease_waiter : lease_waiters)
+		{
+			if (SharedCache::is_leased(lease_waiter.uri))
+			{
+				m_lease_waiters.push_back(std::move(lease_waiter));
+				continue;
+			}
+
+			// whatever the other worker inserted is as fresh as it gets
+			std::string stored;
+			std::string resource;
+			if (SharedCache::get(lease_waiter.uri, stored) &&
+			    read_stored(stored, resource) != State::EXPIRED)
+			{
+				m_local_cache.insert(lease_waiter.uri, stored);
+				lease_waiter.callback(Lookup::HIT, resource);
+				continue;
+			}
+
+			// released without a resource, or expired
+			lease_or_wait(lease_waiter.uri, std::move(lease_waiter.callback));
+		}
+	}
+
+	bool Cache::insert(const std::string& uri, const std::string& resource,
+	                   const Freshness& freshness)
+	{
+		m_negative_cache.erase(uri);
+
+		const std::string stored = stamp(resource, m_generation, freshness);
+		bool is_inserted = m_local_cache.insert(uri, stored);
+		is_inserted = SharedCache::insert(uri, stored) || is_inserted;
+		SharedCache::release_lease(uri);
+
+		if (m_redis != nullptr)
+		{
+			// Redis may drop it once it can't be served anymore
+			uint32_t time_to_live = 0;
+			if (freshness.time_to_live != 0)
+			{
+				time_to_live =
+				    freshness.time_to_live + freshness.stale_while_revalidate;
+			}
+			m_redis->set(uri, stored, time_to_live);
+		}
+
+		return is_inserted;
+	}
+
+	bool Cache::erase(const std::string& uri)
+	{
+		bool is_erased = m_local_cache.erase(uri);
+		is_erased = SharedCache::erase(uri) || is_erased;
+
+		if (m_redis != nullptr)
+		{
+			m_redis->del(uri);
+		}
+
+		return is_erased;
+	}
+
+	void Cache::release(const std::string& uri)
+	{
+		SharedCache::release_lease(uri);
+	}
+
+	void Cache::insert_missing(const std::string& uri)
+	{
+		m_negative_cache.insert(uri);
+		SharedCache::release_lease(uri);
+	}
 
-		return *result;
+	bool Cache::is_known_missing(const std::string& uri)
+	{
+		return m_negative_cache.contains(uri);
 	}
 
-	bool Cache::insert(const std::string& uri, const std::string& resource)
+	void Cache::set_generation(uint64_t generation)
 	{
-		return m_cache->set(uri, resource);
+		// new data may have what was missing
+		if (generation != m_generation)
+		{
+			m_negative_cache.clear();
+			m_generation_changed_at = Timer::get_coarse_realtime_seconds();
+		}
+		m_generation = generation;
 	}
 
-	bool Cache::erase(const std::string& uri) { return m_cache->del(uri) == 1; }
+	uint64_t Cache::get_generation() const { return m_generation; }
+
+	void Cache::attach(int epoll_fd)
+	{
+		if (m_redis == nullptr)
+		{
+			return;
+		}
+
+		m_redis->attach(epoll_fd);
+
+		// redis has no admission policy, its LFU eviction is the closest
+		bool is_lfu = m_local_cache.get_policy() == CachePolicy::TINY_LFU;
+		m_redis->command({"CONFIG", "SET", "maxmemory",
+		                  std::to_string(m_cache_capacity) + "mb"});
+		m_redis->command({"CONFIG", "SET", "maxmemory-policy",
+		                  is_lfu ? "allkeys-lfu" : "allkeys-lru"});
+	}
+
+	bool Cache::handle_events(int fd, uint32_t events)
+	{
+		if (m_redis == nullptr || fd == -1 || fd != m_redis->get_fd())
+		{
+			return false;
+		}
+
+		m_redis->handle_events(events);
+		return true;
+	}
+
+	void Cache::flush()
+	{
+		if (!m_lease_waiters.empty())
+		{
+			check_lease_waiters();
+		}
+
+		if (m_redis != nullptr)
+		{
+			m_redis->check_timeout();
+			m_redis->flush();
+		}
+	}
+
+	int Cache::get_poll_timeout() const
+	{
+		int timeout = m_redis != nullptr ? m_redis->get_poll_timeout() : -1;
+		if (m_lease_waiters.empty())
+		{
+			return timeout;
+		}
+		return timeout == -1 ? LEASE_POLL_INTERVAL_MS
+		                     : std::min(timeout, LEASE_POLL_INTERVAL_MS);
+	}
+
+	LocalCache::Statistics Cache::get_statistics() const
+	{
+		return m_local_cache.get_statistics();
+	}
+
+	CachePolicy Cache::get_policy() const
+	{
+		return m_local_cache.get_policy();
+	}
+
+	bool Cache::has_redis() const { return m_redis != nullptr; }
+
+	AsyncRedis::Statistics Cache::get_redis_statistics() const
+	{
+		return m_redis != nullptr ? m_redis->get_statistics()
+		                          : AsyncRedis::Statistics();
+	}
+
+	uint64_t Cache::get_number_of_lease_waits() const
+	{
+		return m_number_of_lease_waits;
+	}
+
+	uint64_t Cache::get_number_of_stale_hits() const
+	{
+		return m_number_of_stale_hits;
+	}
+
+	uint64_t Cache::get_number_of_revalidations() const
+	{
+		return m_number_of_revalidations;
+	}
+
+	NegativeCache::Statistics Cache::get_negative_statistics() const
+	{
+		return m_negative_cache.get_statistics();
+	}
 } // namespace HTTP
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "CacheEntry.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+	constexpr char MAGIC[] = {'W', 'F', 'C', '1'};
+	constexpr size_t MAGIC_SIZE = sizeof(MAGIC);
+
+	// Encoding, date offset and message length.
+	constexpr size_t VARIANT_HEADER_SIZE = 1 + 4 + 4;
+
+	constexpr size_t MAX_VARIANTS = 0xFF;
+	constexpr uint64_t MAX_FIELD = 0xFFFFFFFF;
+
+	void append_u32(std::string& output, uint32_t value)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			output.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+		}
+	}
+
+	uint32_t read_u32(const char* data)
+	{
+		uint32_t value = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i]))
+			         << (8 * i);
+		}
+		return value;
+	}
+
+	/**
+	 * Append @b text as "<length>:<text>", which delimits itself whatever
+	 * @b text contains.
+	 */
+	void append_field(std::string& output, const std::string& text)
+	{
+		output += std::to_string(text.size());
+		output.push_back(':');
+		output += text;
+	}
+
+	std::string trim(const std::string& text)
+	{
+		size_t begin = text.find_first_not_of(" \t");
+		if (begin == std::string::npos)
+		{
+			return "";
+		}
+		size_t end = text.find_last_not_of(" \t");
+		return text.substr(begin, end - begin + 1);
+	}
+
+	/**
+	 * Whether a coding of Accept-Encoding, e.g. "deflate;q=0.5", names
+	 * @b coding with a non-zero quality.
+	 */
+	bool accepts(const std::string& element, const std::string& coding)
+	{
+		size_t parameters = element.find(';');
+		std::string name = trim(element.substr(0, parameters));
+		for (char& character : name)
+		{
+			character = static_cast<char>(
+			    std::tolower(static_cast<unsigned char>(character)));
+		}
+		if (name != coding && name != "*")
+		{
+			return false;
+		}
+
+		if (parameters == std::string::npos)
+		{
+			return true;
+		}
+
+		std::string parameter = trim(element.substr(parameters + 1));
+		if (parameter.size() < 2 ||
+		    std::tolower(static_cast<unsigned char>(parameter[0])) != 'q' ||
+		    parameter[1] != '=')
+		{
+			return true;
+		}
+		return std::strtod(parameter.c_str() + 2, nullptr) > 0;
+	}
+} // namespace
+
+namespace HTTP
+{
+	namespace CacheEntry
+	{
+		std::string make_key(Uri& uri)
+		{
+			return make_key(uri, uri.get_query_paramters());
+		}
+
+		std::string make_key(Uri& uri, const Uri::QueryParameters& parameters)
+		{
+			std::string key;
+			for (const std::string& segment : uri.get_path_segments())
+			{
+				key.push_back('/');
+				append_field(key, segment);
+			}
+
+			std::vector<std::pair<std::string, std::string>> sorted(
+			    parameters.cbegin(), parameters.cend());
+			std::sort(sorted.begin(), sorted.end());
+
+			key.push_back('?');
+			for (const auto& parameter : sorted)
+			{
+				append_field(key, parameter.first);
+				append_field(key, parameter.second);
+			}
+			return key;
+		}
+
+		ContentEncoding negotiate_encoding(const std::string& accept_encoding)
+		{
+			size_t begin = 0;
+			while (begin <= accept_encoding.size())
+			{
+				size_t end = accept_encoding.find(',', begin);
+				if (end == std::string::npos)
+				{
+					end = accept_encoding.size();
+				}
+
+				if (accepts(accept_encoding.substr(begin, end - begin),
+				            "deflate"))
+				{
+					return ContentEncoding::DEFLATE;
+				}
+				begin = end + 1;
+			}
+			return ContentEncoding::IDENTITY;
+		}
+
+		std::string encode(const std::vector<Variant>& variants)
+		{
+			if (variants.size() > MAX_VARIANTS)
+			{
+				throw std::length_error("too many cache entry variants");
+			}
+
+			size_t size = MAGIC_SIZE + 1;
+			for (const Variant& variant : variants)
+			{
+				if (variant.length > MAX_FIELD ||
+				    variant.date_offset > MAX_FIELD)
+				{
+					throw std::length_error("cache entry variant too large");
+				}
+				size += VARIANT_HEADER_SIZE + variant.length;
+			}
+
+			std::string entry;
+			entry.reserve(size);
+			entry.append(MAGIC, MAGIC_SIZE);
+			entry.push_back(static_cast<char>(variants.size()));
+			for (const Variant& variant : variants)
+			{
+				entry.push_back(static_cast<char>(variant.encoding));
+				append_u32(entry, static_cast<uint32_t>(variant.date_offset));
+				append_u32(entry, static_cast<uint32_t>(variant.length));
+				entry.append(variant.message, variant.length);
+			}
+			return entry;
+		}
+
+		bool find_variant(const std::string& entry, ContentEncoding encoding,
+		                  Variant& variant)
+		{
+			if (entry.size() < MAGIC_SIZE + 1 ||
+			    entry.compare(0, MAGIC_SIZE, MAGIC, MAGIC_SIZE) != 0)
+			{
+				return false;
+			}
+
+			const char* data = entry.data();
+			size_t number_of_variants = static_cast<uint8_t>(data[MAGIC_SIZE]);
+			size_t position = MAGIC_SIZE + 1;
+			for (size_t i = 0; i < number_of_variants; ++i)
+			{
+				if (entry.size() - position < VARIANT_HEADER_SIZE)
+				{
+					return false;
+				}
+
+				auto variant_encoding =
+				    static_cast<ContentEncoding>(data[position]);
+				size_t date_offset = read_u32(data + position + 1);
+				size_t length = read_u32(data + position + 5);
+				position += VARIANT_HEADER_SIZE;
+
+				if (entry.size() - position < length)
+				{
+					return false;
+				}
+
+				if (variant_encoding == encoding)
+				{
+					// the Date value is 29 bytes long
+					if (date_offset > length || length - date_offset < 29)
+					{
+						return false;
+					}
+
+					variant.encoding = variant_encoding;
+					variant.message = data + position;
+					variant.length = length;
+					variant.date_offset = date_offset;
+					return true;
+				}
+				position += length;
+			}
+			return false;
+		}
+	} // namespace CacheEntry
+} // namespace HTTP
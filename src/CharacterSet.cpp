@@ -1,56 +1,37 @@
 #include "CharacterSet.hpp"
 
-CharacterSet::CharacterSet(char c) { m_character_set.insert(c); }
-
 CharacterSet::CharacterSet(
     std::initializer_list<const CharacterSet> character_sets)
+    : CharacterSet()
 {
 	for (const auto& character_set : character_sets)
 	{
-		for (const auto& character : character_set.get_character_set())
+		for (int i = 0; i < 4; ++i)
 		{
-			m_character_set.insert(character);
+			m_bits[i] |= character_set.m_bits[i];
 		}
 	}
 }
 
-CharacterSet::CharacterSet(char first, char last)
-{
-	if (first > last)
-	{
-		std::swap(first, last);
-	}
-
-	for (char c = first; c <= last; ++c)
-	{
-		m_character_set.insert(c);
-	}
-}
-
 CharacterSet::CharacterSet(std::initializer_list<const char> characters)
+    : CharacterSet()
 {
 	for (const auto character : characters)
 	{
-		m_character_set.insert(character);
+		auto byte = static_cast<unsigned char>(character);
+		m_bits[byte >> 6] |= uint64_t{1} << (byte & 63);
 	}
 }
 
-bool CharacterSet::operator==(const CharacterSet& other) const
-{
-	return this->m_character_set == other.m_character_set;
-}
-
-bool CharacterSet::operator!=(const CharacterSet& other) const
-{
-	return this->m_character_set != other.m_character_set;
-}
-
-bool CharacterSet::is_contains(char c) const
-{
-	return m_character_set.find(c) != m_character_set.cend();
-}
-
 std::set<char> CharacterSet::get_character_set() const
 {
-	return m_character_set;
-}
\ No newline at end of file
+	std::set<char> character_set;
+	for (int byte = 0; byte < 256; ++byte)
+	{
+		if (is_contains(static_cast<char>(byte)))
+		{
+			character_set.insert(static_cast<char>(byte));
+		}
+	}
+	return character_set;
+}
@@ -28,6 +28,8 @@ namespace HTTP
 
 	Connection::ResponsePtr& Connection::get_response() { return m_response; }
 
+	RouteMatch& Connection::get_route_match() { return m_route_match; }
+
 	bool Connection::operator==(const Connection& other) const
 	{
 		return (this->m_request == other.m_request) &&
@@ -0,0 +1,132 @@
+#include "CpuDispatch.hpp"
+
+#if defined(CPU_DISPATCH_X86)
+#include <cpuid.h>
+#endif
+
+namespace
+{
+	struct CpuFeatures
+	{
+		CpuDispatch::Isa isa = CpuDispatch::Isa::SCALAR;
+		bool has_sha = false;
+	};
+
+	CpuFeatures detect_cpu_features()
+	{
+		CpuFeatures features;
+
+#if defined(CPU_DISPATCH_X86)
+		unsigned eax = 0;
+		unsigned ebx = 0;
+		unsigned ecx = 0;
+		unsigned edx = 0;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		{
+			return features;
+		}
+
+		const bool has_sse2 = (edx & bit_SSE2) != 0;
+		const bool has_ssse3 = has_sse2 && (ecx & bit_SSSE3) != 0;
+		const bool has_sse42 =
+		    has_ssse3 && (ecx & bit_SSE4_1) != 0 && (ecx & bit_SSE4_2) != 0;
+
+		/**
+		 * AVX registers are only usable if the OS saves their upper halves
+		 * on context switches, i.e. XCR0 has both the SSE and AVX state bits.
+		 */
+		bool has_avx = false;
+		if ((ecx & bit_OSXSAVE) != 0 && (ecx & bit_AVX) != 0)
+		{
+			unsigned xcr0_low = 0;
+			unsigned xcr0_high = 0;
+			__asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+			has_avx = (xcr0_low & 0x6) == 0x6;
+		}
+
+		bool has_avx2 = false;
+		if (__get_cpuid_max(0, nullptr) >= 7)
+		{
+			__cpuid_count(7, 0, eax, ebx, ecx, edx);
+			has_avx2 = has_sse42 && has_avx && (ebx & bit_AVX2) != 0;
+			features.has_sha = has_sse42 && (ebx & bit_SHA) != 0;
+		}
+
+		if (has_avx2)
+		{
+			features.isa = CpuDispatch::Isa::AVX2;
+		}
+		else if (has_sse42)
+		{
+			features.isa = CpuDispatch::Isa::SSE42;
+		}
+		else if (has_ssse3)
+		{
+			features.isa = CpuDispatch::Isa::SSSE3;
+		}
+		else if (has_sse2)
+		{
+			features.isa = CpuDispatch::Isa::SSE2;
+		}
+#endif
+
+		return features;
+	}
+
+	const CpuFeatures& get_cpu_features()
+	{
+		static const CpuFeatures features = detect_cpu_features();
+		return features;
+	}
+
+	CpuDispatch::Isa& get_active_isa_storage()
+	{
+		static CpuDispatch::Isa active_isa = get_cpu_features().isa;
+		return active_isa;
+	}
+
+	const char* const ISA_NAMES[CpuDispatch::NUMBER_OF_ISAS] = {
+	    "scalar", "sse2", "ssse3", "sse4.2", "avx2"};
+} // namespace
+
+namespace CpuDispatch
+{
+	Isa get_detected_isa() { return get_cpu_features().isa; }
+
+	Isa get_active_isa() { return get_active_isa_storage(); }
+
+	bool has_sha_extensions()
+	{
+		return get_cpu_features().has_sha && get_active_isa() >= Isa::SSE42;
+	}
+
+	void force_isa(Isa isa)
+	{
+		get_active_isa_storage() =
+		    isa < get_detected_isa() ? isa : get_detected_isa();
+	}
+
+	bool force_isa(const std::string& isa_name)
+	{
+		if (isa_name.empty())
+		{
+			force_isa(get_detected_isa());
+			return true;
+		}
+
+		for (size_t i = 0; i < NUMBER_OF_ISAS; ++i)
+		{
+			if (isa_name == ISA_NAMES[i])
+			{
+				force_isa(static_cast<Isa>(i));
+				return true;
+			}
+		}
+		return false;
+	}
+
+	const char* get_isa_name(Isa isa)
+	{
+		return ISA_NAMES[static_cast<size_t>(isa)];
+	}
+} // namespace CpuDispatch
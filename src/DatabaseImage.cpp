@@ -0,0 +1,161 @@
+#include "DatabaseImage.hpp"
+#include "Logger.hpp"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+	// Offsets of the file format write and read versions in the header.
+	constexpr size_t WRITE_VERSION_OFFSET = 18;
+	constexpr size_t READ_VERSION_OFFSET = 19;
+
+	// Version of databases in WAL mode, which SQLite can't deserialize.
+	constexpr unsigned char WAL_VERSION = 2;
+	constexpr unsigned char ROLLBACK_VERSION = 1;
+
+	unsigned char* image = nullptr;
+	size_t image_size = 0;
+
+	/**
+	 * Write a whole buffer.
+	 *
+	 * @return
+	 *      True if succeeds.
+	 */
+	bool write_all(int fd, const unsigned char* data, size_t size)
+	{
+		while (size != 0)
+		{
+			ssize_t written = write(fd, data, size);
+			if (written == -1)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return false;
+			}
+			data += written;
+			size -= static_cast<size_t>(written);
+		}
+		return true;
+	}
+} // namespace
+
+namespace DatabaseImage
+{
+	bool create(const std::string& database_path)
+	{
+		destroy();
+
+		sqlite3* source = nullptr;
+		if (sqlite3_open_v2(database_path.c_str(), &source,
+		                    SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+		{
+			Logger::error("can't open database to load: " +
+			              std::string(sqlite3_errmsg(source)));
+			sqlite3_close(source);
+			return false;
+		}
+
+		// a consistent copy, even while another process writes the file
+		sqlite3_int64 size = 0;
+		unsigned char* data = sqlite3_serialize(source, "main", &size, 0);
+		sqlite3_close(source);
+		if (data == nullptr || size == 0)
+		{
+			Logger::error("can't copy database: " + database_path);
+			sqlite3_free(data);
+			return false;
+		}
+
+		if (static_cast<size_t>(size) > READ_VERSION_OFFSET &&
+		    data[WRITE_VERSION_OFFSET] == WAL_VERSION)
+		{
+			data[WRITE_VERSION_OFFSET] = ROLLBACK_VERSION;
+			data[READ_VERSION_OFFSET] = ROLLBACK_VERSION;
+		}
+
+		int fd = memfd_create("word-finder-database",
+		                      MFD_CLOEXEC | MFD_ALLOW_SEALING);
+		if (fd == -1)
+		{
+			Logger::error("memfd_create() error", errno);
+			sqlite3_free(data);
+			return false;
+		}
+
+		// sealed, so that no worker can change what the others search
+		bool is_written =
+		    write_all(fd, data, static_cast<size_t>(size)) &&
+		    fcntl(fd, F_ADD_SEALS,
+		          F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) !=
+		        -1;
+		sqlite3_free(data);
+		if (!is_written)
+		{
+			Logger::error("can't write database image", errno);
+			close(fd);
+			return false;
+		}
+
+		void* memory = mmap(nullptr, static_cast<size_t>(size), PROT_READ,
+		                    MAP_SHARED, fd, 0);
+		close(fd);
+		if (memory == MAP_FAILED)
+		{
+			Logger::error("mmap() database image error", errno);
+			return false;
+		}
+
+		image = static_cast<unsigned char*>(memory);
+		image_size = static_cast<size_t>(size);
+		Logger::info("database loaded into memory: " +
+		             std::to_string(image_size) + " bytes");
+		return true;
+	}
+
+	void destroy()
+	{
+		if (image != nullptr)
+		{
+			munmap(image, image_size);
+			image = nullptr;
+			image_size = 0;
+		}
+	}
+
+	bool is_loaded() { return image != nullptr; }
+
+	size_t get_size() { return image_size; }
+
+	sqlite3* open()
+	{
+		if (image == nullptr)
+		{
+			return nullptr;
+		}
+
+		// SQLite reads the pages in place and fails writes, which the
+		// mapping forbids
+		sqlite3* connection = nullptr;
+		if (sqlite3_open_v2(":memory:", &connection,
+		                    SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX,
+		                    nullptr) != SQLITE_OK ||
+		    sqlite3_deserialize(connection, "main", image,
+		                        static_cast<sqlite3_int64>(image_size),
+		                        static_cast<sqlite3_int64>(image_size),
+		                        SQLITE_DESERIALIZE_READONLY) != SQLITE_OK)
+		{
+			Logger::error("can't open database image because " +
+			              std::string(sqlite3_errmsg(connection)));
+			sqlite3_close(connection);
+			return nullptr;
+		}
+		return connection;
+	}
+} // namespace DatabaseImage
@@ -0,0 +1,155 @@
+#include "FrequencySketch.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	// Smallest table of counters, in words; tables are powers of 2.
+	constexpr size_t MIN_NUMBER_OF_WORDS = 64;
+
+	// Accesses counted per word of counters before they are halved.
+	constexpr uint64_t SAMPLES_PER_WORD = 10;
+
+	constexpr int NUMBER_OF_ROWS = 4;
+
+	// Odd multipliers spreading a key hash differently for each row.
+	constexpr uint64_t SEEDS[NUMBER_OF_ROWS] = {
+	    0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL,
+	    0x9e3779b97f4a7c15ULL};
+
+	constexpr uint64_t MAX_COUNT = 15;
+
+	// Clears the bit each counter gets from its neighbour when shifted.
+	constexpr uint64_t HALVING_MASK = 0x7777777777777777ULL;
+
+	size_t get_number_of_words(size_t number_of_entries)
+	{
+		size_t number_of_words = MIN_NUMBER_OF_WORDS;
+		while (number_of_words < number_of_entries)
+		{
+			number_of_words *= 2;
+		}
+		return number_of_words;
+	}
+
+	/**
+	 * Find the counter of a key in a row: a word, and the shift of the
+	 * 4 bits within it.
+	 */
+	void locate(uint64_t key_hash, int row, size_t mask, size_t& word,
+	            unsigned& shift)
+	{
+		uint64_t hash = key_hash * SEEDS[row];
+		hash ^= hash >> 32;
+		word = static_cast<size_t>(hash) & mask;
+		shift = static_cast<unsigned>(hash >> 60) * 4;
+	}
+} // namespace
+
+namespace HTTP
+{
+	CachePolicy to_cache_policy(const std::string& policy_name)
+	{
+		return policy_name == "lru" ? CachePolicy::LRU : CachePolicy::TINY_LFU;
+	}
+
+	const char* get_cache_policy_name(CachePolicy policy)
+	{
+		return policy == CachePolicy::LRU ? "lru" : "tinylfu";
+	}
+
+	FrequencySketch::FrequencySketch(size_t number_of_entries)
+	    : m_owned_table{new std::atomic<uint64_t>[get_table_size(
+	          number_of_entries)]()}
+	    , m_table{m_owned_table.get()}
+	    , m_mask{get_number_of_words(number_of_entries) - 1}
+	    , m_sample_size{SAMPLES_PER_WORD *
+	                    get_number_of_words(number_of_entries)}
+	{
+	}
+
+	FrequencySketch::FrequencySketch(std::atomic<uint64_t>* table,
+	                                 size_t number_of_entries)
+	    : m_table{table}
+	    , m_mask{get_number_of_words(number_of_entries) - 1}
+	    , m_sample_size{SAMPLES_PER_WORD *
+	                    get_number_of_words(number_of_entries)}
+	{
+	}
+
+	FrequencySketch::~FrequencySketch() = default;
+
+	size_t FrequencySketch::get_table_size(size_t number_of_entries)
+	{
+		// the sample count follows the counters
+		return get_number_of_words(number_of_entries) + 1;
+	}
+
+	void FrequencySketch::increment(uint64_t key_hash)
+	{
+		bool is_incremented = false;
+		for (int row = 0; row < NUMBER_OF_ROWS; ++row)
+		{
+			size_t word = 0;
+			unsigned shift = 0;
+			locate(key_hash, row, m_mask, word, shift);
+
+			uint64_t counters = m_table[word].load(std::memory_order_relaxed);
+			if (((counters >> shift) & MAX_COUNT) != MAX_COUNT)
+			{
+				m_table[word].store(counters + (1ULL << shift),
+				                    std::memory_order_relaxed);
+				is_incremented = true;
+			}
+		}
+
+		if (!is_incremented)
+		{
+			return;
+		}
+
+		std::atomic<uint64_t>& samples = m_table[m_mask + 1];
+		uint64_t number_of_samples =
+		    samples.load(std::memory_order_relaxed) + 1;
+		samples.store(number_of_samples, std::memory_order_relaxed);
+		if (number_of_samples >= m_sample_size)
+		{
+			age();
+		}
+	}
+
+	unsigned FrequencySketch::estimate(uint64_t key_hash) const
+	{
+		uint64_t frequency = MAX_COUNT;
+		for (int row = 0; row < NUMBER_OF_ROWS; ++row)
+		{
+			size_t word = 0;
+			unsigned shift = 0;
+			locate(key_hash, row, m_mask, word, shift);
+
+			uint64_t counters = m_table[word].load(std::memory_order_relaxed);
+			frequency = std::min(frequency, (counters >> shift) & MAX_COUNT);
+		}
+		return static_cast<unsigned>(frequency);
+	}
+
+	bool FrequencySketch::admit(uint64_t candidate_hash,
+	                            uint64_t victim_hash) const
+	{
+		return estimate(candidate_hash) > estimate(victim_hash);
+	}
+
+	void FrequencySketch::age()
+	{
+		for (size_t word = 0; word <= m_mask; ++word)
+		{
+			uint64_t counters = m_table[word].load(std::memory_order_relaxed);
+			m_table[word].store((counters >> 1) & HALVING_MASK,
+			                    std::memory_order_relaxed);
+		}
+
+		std::atomic<uint64_t>& samples = m_table[m_mask + 1];
+		samples.store(samples.load(std::memory_order_relaxed) / 2,
+		              std::memory_order_relaxed);
+	}
+} // namespace HTTP
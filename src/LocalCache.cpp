@@ -0,0 +1,292 @@
+#include "LocalCache.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+	/**
+	 * Bookkeeping charged to every entry besides its key and value: index
+	 * node, entry slot and string headers.
+	 */
+	constexpr size_t ENTRY_OVERHEAD = 96;
+
+	// Share of each shard new entries wait in before admission, in
+	// percent.
+	constexpr size_t WINDOW_PERCENTAGE = 1;
+
+	// Entry size the frequency sketch is sized for: a search result page
+	// with its deflated variant.
+	constexpr size_t TYPICAL_ENTRY_SIZE = 4096;
+
+	size_t get_entry_size(const std::string& key, const std::string& value)
+	{
+		return key.size() + value.size() + ENTRY_OVERHEAD;
+	}
+} // namespace
+
+namespace HTTP
+{
+	LocalCache::LocalCache(size_t capacity_in_bytes, size_t number_of_shards,
+	                       CachePolicy policy)
+	    : m_shards(number_of_shards == 0 ? 1 : number_of_shards)
+	    , m_capacity{capacity_in_bytes}
+	    , m_shard_capacity{capacity_in_bytes / m_shards.size()}
+	    , m_policy{policy}
+	    , m_window_capacity{0}
+	{
+		if (m_policy == CachePolicy::TINY_LFU)
+		{
+			m_window_capacity = m_shard_capacity * WINDOW_PERCENTAGE / 100;
+			m_sketch.reset(new FrequencySketch(
+			    std::max<size_t>(capacity_in_bytes / TYPICAL_ENTRY_SIZE, 1)));
+		}
+	}
+
+	LocalCache::~LocalCache() = default;
+
+	bool LocalCache::get(const std::string& key, std::string& value)
+	{
+		size_t key_hash = std::hash<std::string>()(key);
+		Shard& shard = get_shard(key_hash);
+		if (m_sketch != nullptr)
+		{
+			m_sketch->increment(key_hash);
+		}
+
+		auto position = shard.index.find(key);
+		if (position == shard.index.end())
+		{
+			++shard.statistics.misses;
+			return false;
+		}
+
+		Entry& entry = shard.entries[position->second];
+		entry.is_referenced = true;
+		value = entry.value;
+		++shard.statistics.hits;
+		return true;
+	}
+
+	bool LocalCache::insert(const std::string& key, const std::string& value)
+	{
+		size_t key_hash = std::hash<std::string>()(key);
+		Shard& shard = get_shard(key_hash);
+
+		auto position = shard.index.find(key);
+		if (position != shard.index.end())
+		{
+			remove_entry(shard, position->second);
+		}
+
+		size_t entry_size = get_entry_size(key, value);
+		if (entry_size > m_shard_capacity)
+		{
+			return false;
+		}
+
+		// with TinyLFU, admission makes room once the entry leaves the
+		// window
+		while (m_policy == CachePolicy::LRU &&
+		       shard.statistics.size_in_bytes + entry_size > m_shard_capacity)
+		{
+			evict_one(shard);
+		}
+
+		size_t entry_position = shard.entries.size();
+		if (!shard.free_entries.empty())
+		{
+			entry_position = shard.free_entries.back();
+			shard.free_entries.pop_back();
+		}
+		else
+		{
+			shard.entries.emplace_back();
+		}
+
+		auto index_node = shard.index.emplace(key, entry_position).first;
+
+		Entry& entry = shard.entries[entry_position];
+		entry.key = &index_node->first;
+		entry.value = value;
+		entry.key_hash = key_hash;
+
+		// new entries get one sweep to prove themselves
+		entry.is_referenced = false;
+
+		shard.statistics.size_in_bytes += entry_size;
+		++shard.statistics.number_of_entries;
+
+		if (m_policy == CachePolicy::LRU)
+		{
+			return true;
+		}
+
+		entry.is_in_window = true;
+		shard.window.push_back(entry_position);
+		shard.window_size_in_bytes += entry_size;
+
+		bool is_cached = true;
+		while (shard.window_size_in_bytes > m_window_capacity)
+		{
+			bool is_new_entry = shard.window.front() == entry_position;
+			if (!admit_from_window(shard) && is_new_entry)
+			{
+				is_cached = false;
+			}
+		}
+		return is_cached;
+	}
+
+	bool LocalCache::erase(const std::string& key)
+	{
+		Shard& shard = get_shard(std::hash<std::string>()(key));
+
+		auto position = shard.index.find(key);
+		if (position == shard.index.end())
+		{
+			return false;
+		}
+
+		remove_entry(shard, position->second);
+		return true;
+	}
+
+	void LocalCache::clear()
+	{
+		for (Shard& shard : m_shards)
+		{
+			shard.index.clear();
+			shard.entries.clear();
+			shard.free_entries.clear();
+			shard.hand = 0;
+			shard.statistics.size_in_bytes = 0;
+			shard.statistics.number_of_entries = 0;
+			shard.window.clear();
+			shard.window_size_in_bytes = 0;
+		}
+	}
+
+	LocalCache::Statistics LocalCache::get_statistics() const
+	{
+		Statistics statistics;
+		for (const Shard& shard : m_shards)
+		{
+			statistics.hits += shard.statistics.hits;
+			statistics.misses += shard.statistics.misses;
+			statistics.evictions += shard.statistics.evictions;
+			statistics.rejections += shard.statistics.rejections;
+			statistics.size_in_bytes += shard.statistics.size_in_bytes;
+			statistics.number_of_entries += shard.statistics.number_of_entries;
+		}
+		return statistics;
+	}
+
+	size_t LocalCache::get_capacity() const { return m_capacity; }
+
+	CachePolicy LocalCache::get_policy() const { return m_policy; }
+
+	LocalCache::Shard& LocalCache::get_shard(size_t key_hash)
+	{
+		return m_shards[key_hash % m_shards.size()];
+	}
+
+	void LocalCache::remove_entry(Shard& shard, size_t position)
+	{
+		Entry& entry = shard.entries[position];
+
+		size_t entry_size = get_entry_size(*entry.key, entry.value);
+		shard.statistics.size_in_bytes -= entry_size;
+		--shard.statistics.number_of_entries;
+
+		if (entry.is_in_window)
+		{
+			// the window is small, and removals mostly come from its front
+			shard.window.erase(std::find(shard.window.begin(),
+			                             shard.window.end(), position));
+			shard.window_size_in_bytes -= entry_size;
+			entry.is_in_window = false;
+		}
+
+		// the key lives in the index node, so erase the node last
+		auto index_node = shard.index.find(*entry.key);
+		entry.key = nullptr;
+		entry.is_referenced = false;
+		std::string().swap(entry.value);
+		shard.index.erase(index_node);
+
+		shard.free_entries.push_back(position);
+	}
+
+	size_t LocalCache::find_victim(Shard& shard)
+	{
+		// Every entry is passed at most twice: once to clear its bit.
+		for (;;)
+		{
+			if (shard.hand >= shard.entries.size())
+			{
+				shard.hand = 0;
+			}
+
+			size_t position = shard.hand++;
+			Entry& entry = shard.entries[position];
+			if (entry.key == nullptr || entry.is_in_window)
+			{
+				continue;
+			}
+
+			if (entry.is_referenced)
+			{
+				entry.is_referenced = false;
+				continue;
+			}
+
+			return position;
+		}
+	}
+
+	void LocalCache::evict_one(Shard& shard)
+	{
+		remove_entry(shard, find_victim(shard));
+		++shard.statistics.evictions;
+	}
+
+	bool LocalCache::admit_from_window(Shard& shard)
+	{
+		size_t candidate = shard.window.front();
+		const Entry& entry = shard.entries[candidate];
+		size_t entry_size = get_entry_size(*entry.key, entry.value);
+		size_t main_capacity = m_shard_capacity - m_window_capacity;
+
+		// Evict as many entries as the candidate needs room for, each of
+		// them used less often. Entries evicted before a loss stay evicted.
+		while (shard.statistics.size_in_bytes - shard.window_size_in_bytes +
+		           entry_size >
+		       main_capacity)
+		{
+			if (entry_size > main_capacity)
+			{
+				remove_entry(shard, candidate);
+				++shard.statistics.rejections;
+				return false;
+			}
+
+			size_t victim = find_victim(shard);
+			if (!m_sketch->admit(entry.key_hash,
+			                     shard.entries[victim].key_hash))
+			{
+				remove_entry(shard, candidate);
+				++shard.statistics.rejections;
+				return false;
+			}
+
+			remove_entry(shard, victim);
+			++shard.statistics.evictions;
+		}
+
+		shard.window.pop_front();
+		shard.window_size_in_bytes -= entry_size;
+		shard.entries[candidate].is_in_window = false;
+		return true;
+	}
+} // namespace HTTP
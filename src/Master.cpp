@@ -1,4 +1,9 @@
+#include "DatabaseImage.hpp"
 #include "Master.hpp"
+#include "Scoreboard.hpp"
+#include "ServerConfiguration.hpp"
+#include "SharedCache.hpp"
+#include "Timer.hpp"
 #include "UnixDomainHelper.hpp"
 #include "Worker.hpp"
 #include "WorkerSocket.hpp"
@@ -69,6 +74,8 @@ namespace
 				throw std::runtime_error("socketpair() error");
 			}
 
+			int slot = Scoreboard::claim_slot();
+
 			pid_t child_pid = 0;
 			switch (child_pid = fork())
 			{
@@ -80,6 +87,11 @@ namespace
 
 			case 0:
 			{
+				if (slot != -1)
+				{
+					Scoreboard::attach(static_cast<size_t>(slot));
+				}
+
 				try
 				{
 					Worker worker(fds[1]);
@@ -97,6 +109,11 @@ namespace
 
 			default:
 			{
+				if (slot != -1)
+				{
+					Scoreboard::set_pid(static_cast<size_t>(slot), child_pid);
+				}
+
 				m_worker_channels.emplace_back(
 				    Channel{fds[0], fds[1], child_pid});
 				break;
@@ -112,8 +129,11 @@ namespace
 		    0};
 		for (;;)
 		{
-			switch (sum = epoll_wait(m_epfd, triggered_events,
-			                         EPOLL_INTEREST_LIST_SIZE, -1))
+			sum = epoll_wait(m_epfd, triggered_events,
+			                 EPOLL_INTEREST_LIST_SIZE, -1);
+			Timer::tick();
+
+			switch (sum)
 			{
 			case -1:
 			{
@@ -248,6 +268,8 @@ namespace // signal handlers
 				// child has died
 				if (WIFEXITED(status) || WIFSIGNALED(status))
 				{
+					Scoreboard::release(died_child_pid);
+
 					for (auto iter = m_worker_channels.begin();
 					     iter != m_worker_channels.end(); ++iter)
 					{
@@ -288,6 +310,38 @@ namespace Master
 
 		register_signal();
 
+		// workers report their state to the scoreboard they inherit, and
+		// share the responses they cache
+		Scoreboard::create(m_cpu_cores);
+		size_t shared_cache_capacity =
+		    ServerConfiguration::instance()->get_shared_cache_capacity();
+		if (shared_cache_capacity != 0)
+		{
+			SharedCache::create(
+			    shared_cache_capacity,
+			    ServerConfiguration::instance()->get_shared_cache_path(),
+			    HTTP::to_cache_policy(
+			        ServerConfiguration::instance()->get_cache_policy()));
+		}
+
+		// the database may have been replaced since the last run, so the
+		// first worker builds the vocabulary filter anew
+		const std::string vocabulary_filter_path =
+		    ServerConfiguration::instance()->get_vocabulary_filter_path();
+		if (!vocabulary_filter_path.empty())
+		{
+			unlink(vocabulary_filter_path.c_str());
+		}
+
+		// workers inherit the image and share its pages
+		if (ServerConfiguration::instance()->get_database_profile() ==
+		        "memory" &&
+		    !DatabaseImage::create(
+		        ServerConfiguration::instance()->get_database_path()))
+		{
+			Logger::warn("workers search the database file instead of "
+			             "memory");
+		}
 		spawn_worker(m_cpu_cores);
 
 		m_listening_socket =
@@ -358,5 +412,8 @@ namespace Master
 			kill(worker_channel.get_worker_pid(), SIGKILL);
 		}
 		wait(NULL);
+		Scoreboard::destroy();
+		SharedCache::destroy();
+		DatabaseImage::destroy();
 	}
 } // namespace Master
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "Method.hpp"
+
+namespace
+{
+	const char* const METHOD_NAMES[HTTP::NUMBER_OF_METHODS] = {
+	    "GET",     "HEAD",    "POST",  "PUT",  "DELETE",
+	    "CONNECT", "OPTIONS", "TRACE", "PATCH"};
+} // namespace
+
+namespace HTTP
+{
+	Method to_method(const std::string& method_name)
+	{
+		for (size_t i = 0; i < NUMBER_OF_METHODS; ++i)
+		{
+			if (method_name == METHOD_NAMES[i])
+			{
+				return static_cast<Method>(i);
+			}
+		}
+		return Method::UNKNOWN;
+	}
+
+	const char* get_method_name(Method method)
+	{
+		if (method == Method::UNKNOWN)
+		{
+			return "";
+		}
+		return METHOD_NAMES[static_cast<size_t>(method)];
+	}
+} // namespace HTTP
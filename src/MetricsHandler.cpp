@@ -0,0 +1,222 @@
+#include "DatabaseImage.hpp"
+#include "MetricsHandler.hpp"
+#include "Scoreboard.hpp"
+#include "SharedCache.hpp"
+#include "Timer.hpp"
+
+#include <fstream>
+
+#include <unistd.h>
+
+namespace
+{
+	// How long the memory usage of the workers is reported from one
+	// reading of their smaps, which takes a while with many workers.
+	const int64_t MEMORY_SAMPLE_INTERVAL_MS = 5000;
+
+	/**
+	 * Append one sample of a metric, with its type line.
+	 *
+	 * @param[in] labels
+	 *      Labels without the braces, may be empty.
+	 */
+	void append_metric(std::string& body, const std::string& name,
+	                   const char* type, const std::string& labels,
+	                   uint64_t value)
+	{
+		body += "# TYPE " + name + " " + type + "\n";
+		body += name;
+		if (!labels.empty())
+		{
+			body += "{" + labels + "}";
+		}
+		body += " " + std::to_string(value) + "\n";
+	}
+
+	/**
+	 * Add the resident set size of a process, and its proportional one,
+	 * in which pages shared with n processes count for 1/n.
+	 */
+	void add_memory_usage(pid_t pid, uint64_t& resident_bytes,
+	                      uint64_t& proportional_bytes)
+	{
+		std::ifstream rollup("/proc/" + std::to_string(pid) +
+		                     "/smaps_rollup");
+		std::string field;
+		uint64_t kilobytes = 0;
+		while (rollup >> field)
+		{
+			if (field == "Rss:" && rollup >> kilobytes)
+			{
+				resident_bytes += kilobytes * 1024;
+			}
+			else if (field == "Pss:" && rollup >> kilobytes)
+			{
+				proportional_bytes += kilobytes * 1024;
+			}
+		}
+	}
+} // namespace
+
+MetricsHandler::MetricsHandler(
+    std::shared_ptr<HTTP::Cache> cache,
+    std::vector<std::shared_ptr<const HTTP::StatementCache>> statement_caches)
+    : m_cache{std::move(cache)}
+    , m_statement_caches{std::move(statement_caches)}
+{
+}
+
+bool MetricsHandler::fetch_resource(
+    std::shared_ptr<HTTP::Connection> connection)
+{
+	const HTTP::LocalCache::Statistics statistics = m_cache->get_statistics();
+	const std::string worker = "worker=\"" + std::to_string(getpid()) + "\"";
+
+	// hit ratios are only comparable between workers of the same policy
+	const std::string local_labels =
+	    worker + ",policy=\"" +
+	    HTTP::get_cache_policy_name(m_cache->get_policy()) + "\"";
+
+	std::string body;
+	append_metric(body, "word_finder_local_cache_hits_total", "counter",
+	              local_labels, statistics.hits);
+	append_metric(body, "word_finder_local_cache_misses_total", "counter",
+	              local_labels, statistics.misses);
+	append_metric(body, "word_finder_local_cache_evictions_total", "counter",
+	              worker, statistics.evictions);
+	append_metric(body, "word_finder_local_cache_rejections_total", "counter",
+	              local_labels, statistics.rejections);
+	append_metric(body, "word_finder_local_cache_bytes", "gauge", worker,
+	              statistics.size_in_bytes);
+	append_metric(body, "word_finder_local_cache_entries", "gauge", worker,
+	              statistics.number_of_entries);
+	append_metric(body, "word_finder_cache_stale_hits_total", "counter",
+	              worker, m_cache->get_number_of_stale_hits());
+	append_metric(body, "word_finder_cache_revalidations_total", "counter",
+	              worker, m_cache->get_number_of_revalidations());
+	append_metric(body, "word_finder_cache_generation", "gauge", worker,
+	              m_cache->get_generation());
+
+	const HTTP::NegativeCache::Statistics negative_statistics =
+	    m_cache->get_negative_statistics();
+	append_metric(body, "word_finder_negative_cache_hits_total", "counter",
+	              worker, negative_statistics.hits);
+	append_metric(body, "word_finder_negative_cache_insertions_total",
+	              "counter", worker, negative_statistics.insertions);
+	append_metric(body, "word_finder_negative_cache_evictions_total",
+	              "counter", worker, negative_statistics.evictions);
+
+	if (!m_statement_caches.empty())
+	{
+		HTTP::StatementCache::Statistics statement_statistics;
+		size_t number_of_statements = 0;
+		for (const auto& statement_cache : m_statement_caches)
+		{
+			const HTTP::StatementCache::Statistics statistics =
+			    statement_cache->get_statistics();
+			statement_statistics.hits += statistics.hits;
+			statement_statistics.misses += statistics.misses;
+			statement_statistics.evictions += statistics.evictions;
+			statement_statistics.prepare_microseconds +=
+			    statistics.prepare_microseconds;
+			number_of_statements +=
+			    statement_cache->get_number_of_statements();
+		}
+		append_metric(body, "word_finder_statement_cache_hits_total",
+		              "counter", worker, statement_statistics.hits);
+		append_metric(body, "word_finder_statement_cache_misses_total",
+		              "counter", worker, statement_statistics.misses);
+		append_metric(body, "word_finder_statement_cache_evictions_total",
+		              "counter", worker, statement_statistics.evictions);
+		append_metric(
+		    body, "word_finder_statement_cache_prepare_microseconds_total",
+		    "counter", worker, statement_statistics.prepare_microseconds);
+		append_metric(body, "word_finder_statement_cache_statements",
+		              "gauge", worker, number_of_statements);
+	}
+
+	append_metric(body, "word_finder_redis_enabled", "gauge", worker,
+	              m_cache->has_redis() ? 1 : 0);
+
+	if (m_cache->has_redis())
+	{
+		const HTTP::AsyncRedis::Statistics redis_statistics =
+		    m_cache->get_redis_statistics();
+		append_metric(body, "word_finder_redis_commands_total", "counter",
+		              worker, redis_statistics.commands);
+		append_metric(body, "word_finder_redis_writes_total", "counter",
+		              worker, redis_statistics.writes);
+		append_metric(body, "word_finder_redis_errors_total", "counter",
+		              worker, redis_statistics.errors);
+		append_metric(body, "word_finder_redis_dropped_commands_total",
+		              "counter", worker, redis_statistics.dropped_commands);
+	}
+
+	if (SharedCache::is_enabled())
+	{
+		const SharedCache::Statistics shared_statistics =
+		    SharedCache::get_statistics();
+		const std::string shared_labels =
+		    worker + ",policy=\"" +
+		    HTTP::get_cache_policy_name(SharedCache::get_policy()) + "\"";
+		append_metric(body, "word_finder_shared_cache_hits_total", "counter",
+		              shared_labels, shared_statistics.hits);
+		append_metric(body, "word_finder_shared_cache_misses_total",
+		              "counter", shared_labels, shared_statistics.misses);
+		append_metric(body, "word_finder_shared_cache_insertions_total",
+		              "counter", worker, shared_statistics.insertions);
+		append_metric(body, "word_finder_shared_cache_rejections_total",
+		              "counter", worker, shared_statistics.rejections);
+		append_metric(body, "word_finder_shared_cache_lease_waits_total",
+		              "counter", worker, m_cache->get_number_of_lease_waits());
+		append_metric(body, "word_finder_shared_cache_capacity_bytes",
+		              "gauge", "", shared_statistics.capacity_in_bytes);
+		append_metric(body, "word_finder_shared_cache_entries", "gauge", "",
+		              SharedCache::get_number_of_entries());
+	}
+
+	// workers sharing the database image don't each hold a copy, which
+	// only the proportional sizes tell
+	sample_memory_usage();
+	append_metric(body, "word_finder_workers_resident_bytes", "gauge", "",
+	              m_resident_bytes);
+	append_metric(body, "word_finder_workers_proportional_resident_bytes",
+	              "gauge", "", m_proportional_bytes);
+	append_metric(body, "word_finder_database_image_bytes", "gauge", "",
+	              DatabaseImage::get_size());
+
+	append_metric(body, "word_finder_requests_total", "counter", "",
+	              Scoreboard::get_number_of_requests());
+	append_metric(body, "word_finder_ready_workers", "gauge", "",
+	              Scoreboard::get_number_of_workers(Scoreboard::State::READY));
+
+	connection->get_response()->set_content_type("text/plain; version=0.0.4");
+	connection->get_response()->set_body(std::move(body));
+	return true;
+}
+
+void MetricsHandler::sample_memory_usage()
+{
+	int64_t now = Timer::get_coarse_monotonic_milliseconds();
+	if (m_memory_sampled_at != 0 &&
+	    now - m_memory_sampled_at < MEMORY_SAMPLE_INTERVAL_MS)
+	{
+		return;
+	}
+	m_memory_sampled_at = now;
+
+	m_resident_bytes = 0;
+	m_proportional_bytes = 0;
+	if (Scoreboard::get_number_of_slots() == 0)
+	{
+		add_memory_usage(getpid(), m_resident_bytes, m_proportional_bytes);
+	}
+	for (size_t i = 0; i < Scoreboard::get_number_of_slots(); ++i)
+	{
+		pid_t pid = Scoreboard::get_pid(i);
+		if (pid != 0)
+		{
+			add_memory_usage(pid, m_resident_bytes, m_proportional_bytes);
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#include "NegativeCache.hpp"
+#include "Timer.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+	constexpr size_t ENTRIES_PER_SET = 4;
+
+	uint64_t hash_key(const std::string& key)
+	{
+		uint64_t key_hash = std::hash<std::string>()(key);
+
+		// 0 marks empty entries
+		return key_hash != 0 ? key_hash : 1;
+	}
+} // namespace
+
+namespace HTTP
+{
+	NegativeCache::NegativeCache(size_t number_of_entries,
+	                             int64_t time_to_live_ms)
+	    : m_time_to_live_ms{time_to_live_ms}
+	{
+		size_t number_of_sets = 1;
+		while (number_of_sets * ENTRIES_PER_SET < number_of_entries)
+		{
+			number_of_sets *= 2;
+		}
+		m_entries.resize(number_of_sets * ENTRIES_PER_SET);
+		m_set_mask = number_of_sets - 1;
+	}
+
+	bool NegativeCache::contains(const std::string& key)
+	{
+		if (m_time_to_live_ms == 0)
+		{
+			return false;
+		}
+
+		Entry* entry = find(hash_key(key));
+		if (entry == nullptr)
+		{
+			return false;
+		}
+
+		if (entry->expires_at <= Timer::get_coarse_monotonic_milliseconds())
+		{
+			*entry = Entry();
+			return false;
+		}
+
+		++m_statistics.hits;
+		return true;
+	}
+
+	void NegativeCache::insert(const std::string& key)
+	{
+		if (m_time_to_live_ms == 0)
+		{
+			return;
+		}
+
+		const uint64_t key_hash = hash_key(key);
+		const int64_t now = Timer::get_coarse_monotonic_milliseconds();
+		++m_statistics.insertions;
+
+		Entry* entry = find(key_hash);
+		if (entry == nullptr)
+		{
+			// the entry that would be forgotten first
+			entry = &m_entries[(key_hash & m_set_mask) * ENTRIES_PER_SET];
+			for (size_t i = 1; i < ENTRIES_PER_SET; ++i)
+			{
+				Entry& candidate = entry[i];
+				if (candidate.expires_at < entry->expires_at)
+				{
+					entry = &candidate;
+				}
+			}
+
+			if (entry->key_hash != 0 && entry->expires_at > now)
+			{
+				++m_statistics.evictions;
+			}
+		}
+
+		entry->key_hash = key_hash;
+		entry->expires_at = now + m_time_to_live_ms;
+	}
+
+	void NegativeCache::erase(const std::string& key)
+	{
+		Entry* entry = find(hash_key(key));
+		if (entry != nullptr)
+		{
+			*entry = Entry();
+		}
+	}
+
+	void NegativeCache::clear()
+	{
+		std::fill(m_entries.begin(), m_entries.end(), Entry());
+	}
+
+	NegativeCache::Statistics NegativeCache::get_statistics() const
+	{
+		return m_statistics;
+	}
+
+	NegativeCache::Entry* NegativeCache::find(uint64_t key_hash)
+	{
+		Entry* set = &m_entries[(key_hash & m_set_mask) * ENTRIES_PER_SET];
+		for (size_t i = 0; i < ENTRIES_PER_SET; ++i)
+		{
+			if (set[i].key_hash == key_hash)
+			{
+				return &set[i];
+			}
+		}
+		return nullptr;
+	}
+} // namespace HTTP
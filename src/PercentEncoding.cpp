@@ -1,25 +1,133 @@
 #include "PercentEncoding.hpp"
 #include "CharacterSet.hpp"
+#include "CpuDispatch.hpp"
 
-namespace
-{
-	// General delimiters
-	const CharacterSet GEN_DELIMS{':', '/', '?', '#', '[', ']', '@'};
-
-	// Subcomponents delimiters
-	const CharacterSet SUB_DELIMS{'!', '$', '&', '\'', '(', ')',
-	                              '*', '+', ',', ';',  '='};
+#include <cstdint>
+#include <cstring>
 
-	const CharacterSet RESERVED{GEN_DELIMS, SUB_DELIMS};
+#if defined(CPU_DISPATCH_X86)
+#include <immintrin.h>
+#endif
 
+namespace
+{
 	/**
 	 * Uri producers and normalizers should use uppercase hexadecimal digits
 	 * for all percent-encodings.
 	 */
-	const std::map<int, char> hex_mapper{
-	    {0, '0'},  {1, '1'},  {2, '2'},  {3, '3'}, {4, '4'},  {5, '5'},
-	    {6, '6'},  {7, '7'},  {8, '8'},  {9, '9'}, {10, 'A'}, {11, 'B'},
-	    {12, 'C'}, {13, 'D'}, {14, 'E'}, {15, 'F'}};
+	constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+	// Marks a byte that is not a hexadecimal digit in HEX_VALUES.
+	constexpr uint8_t NOT_HEX = 0xFF;
+
+	/**
+	 * Value of every byte read as a hexadecimal digit, NOT_HEX otherwise.
+	 */
+	constexpr uint8_t HEX_VALUES[256] = {
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	    0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	};
+
+	size_t find_escape_scalar(const char* data, size_t size, char plus)
+	{
+		for (size_t i = 0; i < size; ++i)
+		{
+			if (data[i] == '%' || data[i] == plus)
+			{
+				return i;
+			}
+		}
+		return size;
+	}
+
+#if defined(CPU_DISPATCH_X86)
+	CPU_DISPATCH_TARGET("sse2")
+	size_t find_escape_sse2(const char* data, size_t size, char plus)
+	{
+		const __m128i percent_signs = _mm_set1_epi8('%');
+		const __m128i plus_signs = _mm_set1_epi8(plus);
+
+		size_t i = 0;
+		for (; i + 16 <= size; i += 16)
+		{
+			__m128i chunk =
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			int mask = _mm_movemask_epi8(
+			    _mm_or_si128(_mm_cmpeq_epi8(chunk, percent_signs),
+			                 _mm_cmpeq_epi8(chunk, plus_signs)));
+			if (mask != 0)
+			{
+				return i + static_cast<size_t>(__builtin_ctz(mask));
+			}
+		}
+		return i + find_escape_scalar(data + i, size - i, plus);
+	}
+
+	CPU_DISPATCH_TARGET("avx2")
+	size_t find_escape_avx2(const char* data, size_t size, char plus)
+	{
+		const __m256i percent_signs = _mm256_set1_epi8('%');
+		const __m256i plus_signs = _mm256_set1_epi8(plus);
+
+		size_t i = 0;
+		for (; i + 32 <= size; i += 32)
+		{
+			__m256i chunk =
+			    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+			int mask = _mm256_movemask_epi8(
+			    _mm256_or_si256(_mm256_cmpeq_epi8(chunk, percent_signs),
+			                    _mm256_cmpeq_epi8(chunk, plus_signs)));
+			if (mask != 0)
+			{
+				_mm256_zeroupper();
+				return i + static_cast<size_t>(__builtin_ctz(mask));
+			}
+		}
+		_mm256_zeroupper();
+		return i + find_escape_sse2(data + i, size - i, plus);
+	}
+#endif
+
+	using FindEscape = size_t (*)(const char*, size_t, char);
+
+#if defined(CPU_DISPATCH_X86)
+	constexpr CpuDispatch::Kernel<FindEscape> find_escape_kernel{
+	    find_escape_scalar, find_escape_sse2, nullptr, nullptr,
+	    find_escape_avx2};
+#else
+	constexpr CpuDispatch::Kernel<FindEscape> find_escape_kernel{
+	    find_escape_scalar};
+#endif
 } // namespace
 
 std::string PercentEncoding::encode(const std::string& unencoded_string)
@@ -35,22 +143,35 @@ std::string PercentEncoding::encode(const std::string& unencoded_string)
 	 * 	2. Convert each byte that is not an ASCII letter or digit to %HH, where
 	 * HH is the hexadecimal value of the byte.
 	 */
-	std::string encoded_string;
-	for (size_t i = 0; i < unencoded_string.size(); ++i)
+	size_t reserved_characters = 0;
+	for (char character : unencoded_string)
+	{
+		reserved_characters +=
+		    Rfc3986::RESERVED.is_contains(character) ? 1 : 0;
+	}
+
+	if (reserved_characters == 0)
+	{
+		return unencoded_string;
+	}
+
+	std::string encoded_string(unencoded_string.size() +
+	                               2 * reserved_characters,
+	                           '\0');
+	char* output = &encoded_string[0];
+	for (char character : unencoded_string)
 	{
 		// only encode reserved characters
-		if (RESERVED.is_contains(unencoded_string[i]))
+		if (Rfc3986::RESERVED.is_contains(character))
 		{
-			int second = unencoded_string[i] % 16; // NOLINT
-			int first = (unencoded_string[i] - second) / 16;
-
-			encoded_string.push_back('%');
-			encoded_string.push_back(convert_decimal_to_hexo_character(first));
-			encoded_string.push_back(convert_decimal_to_hexo_character(second));
+			auto byte = static_cast<unsigned char>(character);
+			*output++ = '%';
+			*output++ = convert_decimal_to_hexo_character(byte / 16);
+			*output++ = convert_decimal_to_hexo_character(byte % 16);
 		}
 		else
 		{
-			encoded_string.push_back(unencoded_string[i]);
+			*output++ = character;
 		}
 	}
 	return encoded_string;
@@ -58,61 +179,93 @@ std::string PercentEncoding::encode(const std::string& unencoded_string)
 
 std::string PercentEncoding::decode(const std::string& encoded_string)
 {
-	if (encoded_string.find('%') == std::string::npos)
+	if (!needs_decoding(encoded_string))
 	{
 		return encoded_string;
 	}
 
-	std::string decoded_uri_string;
-	for (size_t i = 0; i < encoded_string.size(); ++i)
+	std::string decoded_uri_string = encoded_string;
+	decode_in_place(decoded_uri_string);
+	return decoded_uri_string;
+}
+
+size_t PercentEncoding::find_escape(const char* data, size_t size,
+                                    bool plus_as_space)
+{
+	// '%' twice keeps the second comparison harmless when '+' is literal.
+	return find_escape_kernel.get()(data, size, plus_as_space ? '+' : '%');
+}
+
+bool PercentEncoding::needs_decoding(const std::string& encoded_string,
+                                     bool plus_as_space)
+{
+	return find_escape(encoded_string.data(), encoded_string.size(),
+	                   plus_as_space) != encoded_string.size();
+}
+
+size_t PercentEncoding::decode_in_place(char* data, size_t size,
+                                        bool plus_as_space)
+{
+	size_t read = find_escape(data, size, plus_as_space);
+	if (read == size)
+	{
+		return size;
+	}
+
+	size_t write = read;
+	while (read < size)
 	{
 		/**
-		 * Each character is in the form of: %[1][2]
-		 * We do this:  [1]*16 + [2]
-		 * Use this method, we get the decimal number,
-		 * Then we directly convert it to char.
+		 * data[read] is an escape. Each escape is in the form of %[1][2],
+		 * which decodes to the byte [1]*16 + [2].
 		 */
-		if (encoded_string[i] == '%')
+		if (data[read] == '%')
 		{
-			char first = encoded_string[i + 1];
-			char second = encoded_string[i + 2];
-			i = i + 2;
-			if (first >= 'A')
-			{
-				first = first - 'A' + 10;
-			}
-			else if (first >= '0')
-			{
-				first = first - '0';
-			}
+			bool is_complete = read + 2 < size;
+			uint8_t first =
+			    is_complete ? HEX_VALUES[static_cast<uint8_t>(data[read + 1])]
+			                : NOT_HEX;
+			uint8_t second =
+			    is_complete ? HEX_VALUES[static_cast<uint8_t>(data[read + 2])]
+			                : NOT_HEX;
 
-			if (second >= 'A')
+			if (first != NOT_HEX && second != NOT_HEX)
 			{
-				second = second - 'A' + 10;
+				data[write++] = static_cast<char>(first * 16 + second);
+				read += 3;
 			}
-			else if (second >= '0')
+			else
 			{
-				second = second - '0';
+				data[write++] = data[read++];
 			}
-
-			// decimal number
-			int decimal = first * 16 + second;
-			char decodedChar = char(first * 16 + second);
-
-			// add to decoded string
-			decoded_uri_string.push_back(decodedChar);
-			decodedChar = '\0';
 		}
 		else
 		{
-			decoded_uri_string.push_back(encoded_string[i]);
+			data[write++] = ' ';
+			++read;
 		}
+
+		// copy the clean run up to the next escape in bulk
+		size_t run = find_escape(data + read, size - read, plus_as_space);
+		std::memmove(data + write, data + read, run);
+		read += run;
+		write += run;
 	}
 
-	return decoded_uri_string;
+	return write;
+}
+
+void PercentEncoding::decode_in_place(std::string& text, bool plus_as_space)
+{
+	if (text.empty())
+	{
+		return;
+	}
+
+	text.resize(decode_in_place(&text[0], text.size(), plus_as_space));
 }
 
 char PercentEncoding::convert_decimal_to_hexo_character(int n)
 {
-	return hex_mapper.find(n)->second;
+	return HEX_DIGITS[n & 0xF];
 }
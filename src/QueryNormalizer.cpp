@@ -0,0 +1,129 @@
+#include "QueryNormalizer.hpp"
+#include "Utf8.hpp"
+
+#include <vector>
+
+namespace
+{
+	using Utf8::UnicodeCodePoint;
+
+	/**
+	 * Whether a code point is white space (Unicode White_Space).
+	 */
+	bool is_space(UnicodeCodePoint code_point)
+	{
+		return (code_point >= 0x09 && code_point <= 0x0D) ||
+		       code_point == 0x20 || code_point == 0x85 ||
+		       code_point == 0xA0 || code_point == 0x1680 ||
+		       (code_point >= 0x2000 && code_point <= 0x200A) ||
+		       code_point == 0x2028 || code_point == 0x2029 ||
+		       code_point == 0x202F || code_point == 0x205F ||
+		       code_point == 0x3000;
+	}
+
+	/**
+	 * Whether a code point ends an FTS5 bareword.
+	 */
+	bool is_delimiter(UnicodeCodePoint code_point)
+	{
+		switch (code_point)
+		{
+		case ' ':
+		case '"':
+		case '(':
+		case ')':
+		case ':':
+		case '*':
+		case '^':
+		case '+':
+		case ',':
+		case '{':
+		case '}':
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	/**
+	 * Whether the bareword between @b begin and @b end is an FTS5
+	 * operator.
+	 */
+	bool is_operator(const std::vector<UnicodeCodePoint>& code_points,
+	                 size_t begin, size_t end)
+	{
+		std::string bareword;
+		for (size_t i = begin; i < end; ++i)
+		{
+			if (code_points[i] >= 0x80)
+			{
+				return false;
+			}
+			bareword.push_back(static_cast<char>(code_points[i]));
+		}
+		return bareword == "AND" || bareword == "OR" || bareword == "NOT" ||
+		       bareword == "NEAR";
+	}
+} // namespace
+
+namespace QueryNormalizer
+{
+	std::string normalize(const std::string& query)
+	{
+		Utf8::Utf8 utf8;
+		const std::vector<UnicodeCodePoint> code_points = utf8.Decode(query);
+
+		std::vector<UnicodeCodePoint> normalized;
+		normalized.reserve(code_points.size());
+		for (UnicodeCodePoint code_point : code_points)
+		{
+			if (!is_space(code_point))
+			{
+				normalized.push_back(code_point);
+			}
+			else if (!normalized.empty() && normalized.back() != ' ')
+			{
+				normalized.push_back(' ');
+			}
+		}
+		if (!normalized.empty() && normalized.back() == ' ')
+		{
+			normalized.pop_back();
+		}
+
+		// fold every bareword but the operators, and the strings
+		bool is_in_string = false;
+		size_t begin = 0;
+		while (begin < normalized.size())
+		{
+			if (normalized[begin] == '"')
+			{
+				is_in_string = !is_in_string;
+				++begin;
+				continue;
+			}
+
+			size_t end = begin;
+			while (end < normalized.size() &&
+			       (is_in_string ? normalized[end] != '"'
+			                     : !is_delimiter(normalized[end])))
+			{
+				++end;
+			}
+
+			if (is_in_string || !is_operator(normalized, begin, end))
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					normalized[i] = Utf8::FoldCase(normalized[i]);
+				}
+			}
+			begin = end == begin ? end + 1 : end;
+		}
+
+		Utf8::OrderCanonically(normalized);
+
+		const std::vector<uint8_t> encoding = Utf8::Utf8::Encode(normalized);
+		return std::string(encoding.begin(), encoding.end());
+	}
+} // namespace QueryNormalizer
@@ -162,6 +162,7 @@ namespace Message
 		auto second_space_position = request_line.find_last_of(' ');
 
 		m_method = request_line.substr(0, first_space_position);
+		m_method_id = HTTP::to_method(m_method);
 
 		m_request_uri = request_line.substr(
 		    first_space_position + 1,
@@ -170,6 +171,7 @@ namespace Message
 		{
 			m_request_uri.clear();
 			m_method.clear();
+			m_method_id = HTTP::Method::UNKNOWN;
 			return false;
 		}
 
@@ -194,6 +196,7 @@ namespace Message
 	void Message::Request::set_method(std::string new_method)
 	{
 		m_method = std::move(new_method);
+		m_method_id = HTTP::to_method(m_method);
 	}
 
 	void Message::Request::set_http_version(std::string new_http_version)
@@ -208,6 +211,8 @@ namespace Message
 
 	std::string Message::Request::get_request_method() { return m_method; }
 
+	HTTP::Method Message::Request::get_method() const { return m_method_id; }
+
 	std::string Message::Request::get_request_uri_string()
 	{
 		return m_request_uri;
@@ -255,6 +260,7 @@ namespace Message
 		m_headers.clear();
 		m_raw_request.clear();
 		m_method.clear();
+		m_method_id = HTTP::Method::UNKNOWN;
 		m_headers_map.clear();
 		m_body.clear();
 	}
@@ -2,82 +2,201 @@
 #include "Logger.hpp"
 #include "Timer.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
 namespace
 {
-	// only response has status code.
-	std::map<int, std::string> status_code_map = {
+	/**
+	 * A status code with its reason phrase and the complete HTTP/1.1 status
+	 * line, e.g. "HTTP/1.1 404 Not Found\r\n", assembled at compile time.
+	 */
+	struct StatusLine
+	{
+		int status_code;
+		const char* reason_phrase;
+		const char* status_line;
+		size_t status_line_length;
+	};
+
+#define STATUS_LINE(status_code, reason_phrase)                                \
+	{                                                                          \
+		status_code, reason_phrase,                                            \
+		    "HTTP/1.1 " #status_code " " reason_phrase "\r\n",                 \
+		    sizeof("HTTP/1.1 " #status_code " " reason_phrase "\r\n") - 1      \
+	}
+
+	// only response has status code, sorted by it for binary search.
+	constexpr StatusLine STATUS_LINES[] = {
 	    // 100-199: Informational status codes
-	    {100, "Continue"},
-	    {101, "Switching Protocol"},
-	    {102, "Processing"},
-	    {103, "Early Hints"},
+	    STATUS_LINE(100, "Continue"),
+	    STATUS_LINE(101, "Switching Protocol"),
+	    STATUS_LINE(102, "Processing"),
+	    STATUS_LINE(103, "Early Hints"),
 
 	    // 200-299: Success status codes
-	    {200, "OK"},
-	    {201, "Created"},
-	    {202, "Accepted"},
-	    {203, "Non-Authoritative Information"},
-	    {204, "No Content"},
-	    {205, "Reset Content"},
-	    {206, "Partial Content"},
-	    {207, "Multi-Status"},
-	    {208, "Already Reported"},
-	    {226, "IM Used"},
+	    STATUS_LINE(200, "OK"),
+	    STATUS_LINE(201, "Created"),
+	    STATUS_LINE(202, "Accepted"),
+	    STATUS_LINE(203, "Non-Authoritative Information"),
+	    STATUS_LINE(204, "No Content"),
+	    STATUS_LINE(205, "Reset Content"),
+	    STATUS_LINE(206, "Partial Content"),
+	    STATUS_LINE(207, "Multi-Status"),
+	    STATUS_LINE(208, "Already Reported"),
+	    STATUS_LINE(226, "IM Used"),
 
 	    // 300-399: Redirection status codes
-	    {300, "Multiple Choice"},
-	    {301, "Moved Permanently"},
-	    {302, "Found"},
-	    {303, "See Other"},
-	    {304, "Not Modified"},
-	    {305, "Use Proxy"},
-	    {306, "unused"},
-	    {307, "Temporary Redirect"},
-	    {308, "Permanent Redirect"},
+	    STATUS_LINE(300, "Multiple Choice"),
+	    STATUS_LINE(301, "Moved Permanently"),
+	    STATUS_LINE(302, "Found"),
+	    STATUS_LINE(303, "See Other"),
+	    STATUS_LINE(304, "Not Modified"),
+	    STATUS_LINE(305, "Use Proxy"),
+	    STATUS_LINE(306, "unused"),
+	    STATUS_LINE(307, "Temporary Redirect"),
+	    STATUS_LINE(308, "Permanent Redirect"),
 
 	    // 400-499: Client error status codes
-	    {400, "Bad Request"},
-	    {401, "Unauthorized"},
-	    {402, "Payment Required"},
-	    {403, "Forbidden"},
-	    {404, "Not Found"},
-	    {405, "Method Not Allowed"},
-	    {406, "Not Acceptable"},
-	    {407, "Proxy Authentication Required"},
-	    {408, "Request Timeout"},
-	    {409, "Conflict"},
-	    {410, "Gone"},
-	    {411, "Length Required"},
-	    {412, "Precondition Failed"},
-	    {413, "Payload Too Large"},
-	    {414, "Uri Too Long"},
-	    {415, "Unsupported Media Type"},
-	    {416, "Range Not Satisfiable"},
-	    {417, "Expectation Failed"},
-	    {418, "I'm a teapot"},
-	    {421, "Misdirected Request"},
-	    {422, "Unprocessable Entity"},
-	    {423, "Locked"},
-	    {424, "Failed Dependency"},
-	    {425, "Too Early"},
-	    {426, "Upgrade Required"},
-	    {428, "Precondition Required"},
-	    {429, "Too Many Requests"},
-	    {431, "Request Header Fields Too Large"},
-	    {451, "Unavailable For Legal Reasons"},
+	    STATUS_LINE(400, "Bad Request"),
+	    STATUS_LINE(401, "Unauthorized"),
+	    STATUS_LINE(402, "Payment Required"),
+	    STATUS_LINE(403, "Forbidden"),
+	    STATUS_LINE(404, "Not Found"),
+	    STATUS_LINE(405, "Method Not Allowed"),
+	    STATUS_LINE(406, "Not Acceptable"),
+	    STATUS_LINE(407, "Proxy Authentication Required"),
+	    STATUS_LINE(408, "Request Timeout"),
+	    STATUS_LINE(409, "Conflict"),
+	    STATUS_LINE(410, "Gone"),
+	    STATUS_LINE(411, "Length Required"),
+	    STATUS_LINE(412, "Precondition Failed"),
+	    STATUS_LINE(413, "Payload Too Large"),
+	    STATUS_LINE(414, "Uri Too Long"),
+	    STATUS_LINE(415, "Unsupported Media Type"),
+	    STATUS_LINE(416, "Range Not Satisfiable"),
+	    STATUS_LINE(417, "Expectation Failed"),
+	    STATUS_LINE(418, "I'm a teapot"),
+	    STATUS_LINE(421, "Misdirected Request"),
+	    STATUS_LINE(422, "Unprocessable Entity"),
+	    STATUS_LINE(423, "Locked"),
+	    STATUS_LINE(424, "Failed Dependency"),
+	    STATUS_LINE(425, "Too Early"),
+	    STATUS_LINE(426, "Upgrade Required"),
+	    STATUS_LINE(428, "Precondition Required"),
+	    STATUS_LINE(429, "Too Many Requests"),
+	    STATUS_LINE(431, "Request Header Fields Too Large"),
+	    STATUS_LINE(451, "Unavailable For Legal Reasons"),
 
 	    // 500-599: Server error status codes
-	    {500, "Internal Server Error"},
-	    {501, "Not Implemented"},
-	    {502, "Bad Gateway"},
-	    {503, "Service Unavailable"},
-	    {504, "Gateway Timeout"},
-	    {505, "HTTP Version Not Supported"},
-	    {506, "Variant Also Negotiates"},
-	    {507, "Insufficient Storage"},
-	    {508, "Loop Detected"},
-	    {510, "Not Extended"},
-	    {511, "Network Authentication Required"}};
+	    STATUS_LINE(500, "Internal Server Error"),
+	    STATUS_LINE(501, "Not Implemented"),
+	    STATUS_LINE(502, "Bad Gateway"),
+	    STATUS_LINE(503, "Service Unavailable"),
+	    STATUS_LINE(504, "Gateway Timeout"),
+	    STATUS_LINE(505, "HTTP Version Not Supported"),
+	    STATUS_LINE(506, "Variant Also Negotiates"),
+	    STATUS_LINE(507, "Insufficient Storage"),
+	    STATUS_LINE(508, "Loop Detected"),
+	    STATUS_LINE(510, "Not Extended"),
+	    STATUS_LINE(511, "Network Authentication Required"),
+	};
+
+#undef STATUS_LINE
+
+	constexpr size_t NUMBER_OF_STATUS_LINES =
+	    sizeof(STATUS_LINES) / sizeof(STATUS_LINES[0]);
+
+	constexpr bool is_sorted_from(size_t index)
+	{
+		return index + 1 >= NUMBER_OF_STATUS_LINES ||
+		       (STATUS_LINES[index].status_code <
+		            STATUS_LINES[index + 1].status_code &&
+		        is_sorted_from(index + 1));
+	}
+
+	static_assert(is_sorted_from(0), "STATUS_LINES must be sorted by code");
+
+	/**
+	 * Find the status line of a status code.
+	 *
+	 * @return
+	 *      The status line, or nullptr for an unknown status code.
+	 */
+	const StatusLine* find_status_line(int status_code)
+	{
+		const StatusLine* last = std::end(STATUS_LINES);
+		const StatusLine* position = std::lower_bound(
+		    std::begin(STATUS_LINES), last, status_code,
+		    [](const StatusLine& status_line, int code) {
+			    return status_line.status_code < code;
+		    });
+
+		if (position == last || position->status_code != status_code)
+		{
+			return nullptr;
+		}
+		return position;
+	}
+
+	// Two ASCII digits for each of 00..99.
+	constexpr char DIGIT_PAIRS[] =
+	    "0001020304050607080910111213141516171819"
+	    "2021222324252627282930313233343536373839"
+	    "4041424344454647484950515253545556575859"
+	    "6061626364656667686970717273747576777879"
+	    "8081828384858687888990919293949596979899";
+
+	// Enough for the 20 digits of the largest 64-bit unsigned integer.
+	constexpr size_t MAX_DECIMAL_DIGITS = 20;
+
+	/**
+	 * Format an unsigned integer in decimal, two digits per division.
+	 *
+	 * @param[in] value
+	 *      Integer to format.
+	 *
+	 * @param[out] output
+	 *      At least MAX_DECIMAL_DIGITS chars, not null-terminated.
+	 *
+	 * @return
+	 *      Number of digits written.
+	 */
+	size_t format_decimal(uint64_t value, char* output)
+	{
+		char digits[MAX_DECIMAL_DIGITS];
+		char* const end = digits + MAX_DECIMAL_DIGITS;
+		char* begin = end;
+
+		while (value >= 100)
+		{
+			size_t pair = static_cast<size_t>(value % 100) * 2;
+			value /= 100;
+			*--begin = DIGIT_PAIRS[pair + 1];
+			*--begin = DIGIT_PAIRS[pair];
+		}
+		if (value >= 10)
+		{
+			size_t pair = static_cast<size_t>(value) * 2;
+			*--begin = DIGIT_PAIRS[pair + 1];
+			*--begin = DIGIT_PAIRS[pair];
+		}
+		else
+		{
+			*--begin = static_cast<char>('0' + value);
+		}
+
+		size_t length = static_cast<size_t>(end - begin);
+		std::memcpy(output, begin, length);
+		return length;
+	}
+
+	/**
+	 * Most responses fit in this without growing the output buffer; larger
+	 * ones grow it once and keep the capacity for the connection's lifetime.
+	 */
+	constexpr size_t INITIAL_OUTPUT_BUFFER_SIZE = 4096;
 } // namespace
 
 namespace Message
@@ -88,16 +207,24 @@ namespace Message
 	    : m_uri(std::make_shared<Uri>())
 	    , m_protocol_version("HTTP/1.1")
 	{
+		m_output_buffer.reserve(INITIAL_OUTPUT_BUFFER_SIZE);
 	}
 
 	Message::Response::Response(const Response& other)
 	{
 		m_uri = std::make_shared<Uri>(*(other.m_uri));
 		m_status_code = other.m_status_code;
+		m_protocol_version = other.m_protocol_version;
 		m_reason_phrase = other.m_reason_phrase;
+		m_status_line = other.m_status_line;
+		m_status_line_length = other.m_status_line_length;
 		m_headers = other.m_headers;
 		m_body = other.m_body;
 		m_content_type = other.m_content_type;
+		m_prebuilt_message = other.m_prebuilt_message;
+		m_prebuilt_date_offset = other.m_prebuilt_date_offset;
+		m_is_body_omitted = other.m_is_body_omitted;
+		m_output_buffer.reserve(INITIAL_OUTPUT_BUFFER_SIZE);
 	}
 
 	Response& Message::Response::operator=(const Response& other)
@@ -106,10 +233,16 @@ namespace Message
 		{
 			m_uri = std::make_shared<Uri>(*(other.m_uri));
 			m_status_code = other.m_status_code;
+			m_protocol_version = other.m_protocol_version;
 			m_reason_phrase = other.m_reason_phrase;
+			m_status_line = other.m_status_line;
+			m_status_line_length = other.m_status_line_length;
 			m_headers = other.m_headers;
 			m_body = other.m_body;
 			m_content_type = other.m_content_type;
+			m_prebuilt_message = other.m_prebuilt_message;
+			m_prebuilt_date_offset = other.m_prebuilt_date_offset;
+			m_is_body_omitted = other.m_is_body_omitted;
 		}
 		return *this;
 	}
@@ -141,7 +274,8 @@ namespace Message
 	std::string
 	Message::Response::get_status_code_reason_string(const int status_code)
 	{
-		return status_code_map[status_code];
+		const StatusLine* status_line = find_status_line(status_code);
+		return status_line != nullptr ? status_line->reason_phrase : "";
 	}
 
 	std::string Message::Response::get_content_type() { return m_content_type; }
@@ -149,7 +283,12 @@ namespace Message
 	bool Message::Response::set_status(int status_code)
 	{
 		m_status_code = status_code;
-		m_reason_phrase = status_code_map[status_code];
+		if (!set_reason_phrase(status_code))
+		{
+			m_reason_phrase = "";
+			m_status_line = nullptr;
+			m_status_line_length = 0;
+		}
 		return true;
 	}
 
@@ -163,13 +302,27 @@ namespace Message
 	void Message::Response::set_body(const std::string& body)
 	{
 		m_body = body;
-		add_header("Content-Length", std::to_string(m_body.size()));
+		set_content_length();
 	}
 
 	void Message::Response::set_body(std::string&& body)
 	{
 		m_body = std::move(body);
-		add_header("Content-Length", std::to_string(m_body.size()));
+		set_content_length();
+	}
+
+	void Message::Response::set_content_length()
+	{
+		set_content_length(m_body.size());
+	}
+
+	void Message::Response::set_content_length(size_t content_length)
+	{
+		char digits[MAX_DECIMAL_DIGITS];
+		size_t length = format_decimal(content_length, digits);
+
+		std::string& value = m_headers["Content-Length"];
+		value.assign(digits, length);
 	}
 
 	void Message::Response::set_content_type(const std::string& content_type)
@@ -189,50 +342,145 @@ namespace Message
 
 	bool Message::Response::set_reason_phrase(const int new_stauts_code)
 	{
-		auto header_position = status_code_map.find(new_stauts_code);
-		if (header_position == status_code_map.cend())
+		const StatusLine* status_line = find_status_line(new_stauts_code);
+		if (status_line == nullptr)
 		{
 			return false;
 		}
 
-		m_reason_phrase = header_position->second;
+		m_reason_phrase = status_line->reason_phrase;
+		m_status_line = status_line->status_line;
+		m_status_line_length = status_line->status_line_length;
 		return true;
 	}
 
-	std::string Message::Response::generate_response()
+	void Message::Response::set_prebuilt_message(const std::string& message,
+	                                             size_t date_offset)
+	{
+		m_prebuilt_message = &message;
+		m_prebuilt_date_offset = date_offset;
+	}
+
+	void Message::Response::set_serialized_message(const char* message,
+	                                               size_t length,
+	                                               size_t date_offset)
 	{
-		std::ostringstream response;
+		m_output_buffer.assign(message, length);
+		m_prebuilt_date_offset = date_offset;
+		m_is_output_serialized = true;
+	}
 
-		// Set first line of response string.
-		response << m_protocol_version << " " << std::to_string(m_status_code)
-		         << " " << m_reason_phrase << "\r\n";
+	void Message::Response::set_serialized_message(std::string&& buffer,
+	                                               size_t offset,
+	                                               size_t length,
+	                                               size_t date_offset)
+	{
+		m_output_buffer.swap(buffer);
+		m_output_buffer.resize(offset + length);
+		m_output_buffer.erase(0, offset);
+		m_prebuilt_date_offset = date_offset;
+		m_is_output_serialized = true;
+	}
+
+	const std::string& Message::Response::generate_response()
+	{
+		if (m_is_output_serialized)
+		{
+			const std::string& date = Timer::get_cached_http_time();
+			m_output_buffer.replace(m_prebuilt_date_offset, date.size(), date);
+			if (m_is_body_omitted)
+			{
+				m_output_buffer.resize(m_output_buffer.find("\r\n\r\n") + 4);
+			}
+			return m_output_buffer;
+		}
 
-		// Iterate m_headers map and add to respoinse string.
-		for (auto position = m_headers.cbegin(); position != m_headers.cend();
-		     ++position)
+		if (m_prebuilt_message != nullptr)
 		{
-			std::string name = position->first.c_str();
-			std::string value = position->second.c_str();
+			const std::string& date = Timer::get_cached_http_time();
 
-			response << name << ": " << value << "\r\n";
+			size_t message_length = m_prebuilt_message->size();
+			if (m_is_body_omitted)
+			{
+				message_length = m_prebuilt_message->find("\r\n\r\n") + 4;
+			}
+
+			m_output_buffer.assign(*m_prebuilt_message, 0, message_length);
+			m_output_buffer.replace(m_prebuilt_date_offset, date.size(), date);
+			return m_output_buffer;
+		}
+
+		/**
+		 * Known status codes of HTTP/1.1 responses copy their prebuilt
+		 * status line, everything else is assembled field by field.
+		 */
+		bool is_prebuilt =
+		    m_status_line != nullptr && m_protocol_version == "HTTP/1.1";
+
+		char status_code_digits[MAX_DECIMAL_DIGITS];
+		size_t status_code_length = 0;
+		size_t reason_phrase_length = 0;
+
+		size_t response_size = 0;
+		if (is_prebuilt)
+		{
+			response_size += m_status_line_length;
+		}
+		else
+		{
+			status_code_length = format_decimal(
+			    static_cast<uint64_t>(std::max(m_status_code, 0)),
+			    status_code_digits);
+			reason_phrase_length = std::strlen(m_reason_phrase);
+			response_size += m_protocol_version.size() + 1 +
+			                 status_code_length + 1 + reason_phrase_length + 2;
+		}
+
+		for (const auto& header : m_headers)
+		{
+			response_size += header.first.size() + 2 + header.second.size() + 2;
 		}
+		response_size += 2 + (m_is_body_omitted ? 0 : m_body.size());
+
+		// reuse the buffer, which only reallocates to outgrow its capacity
+		m_output_buffer.clear();
+		m_output_buffer.reserve(response_size);
 
-		// Set m_body content.
-		if (m_body.empty())
+		if (is_prebuilt)
 		{
-			response << "\r\n";
+			m_output_buffer.append(m_status_line, m_status_line_length);
 		}
 		else
 		{
-			response << "\r\n" << m_body;
+			m_output_buffer.append(m_protocol_version);
+			m_output_buffer.push_back(' ');
+			m_output_buffer.append(status_code_digits, status_code_length);
+			m_output_buffer.push_back(' ');
+			m_output_buffer.append(m_reason_phrase, reason_phrase_length);
+			m_output_buffer.append("\r\n", 2);
+		}
 
-			// Do not put '\r\n' at the end of the http message-m_body.
-			// see: https://stackoverflow.com/a/13821352/11850070
+		for (const auto& header : m_headers)
+		{
+			m_output_buffer.append(header.first);
+			m_output_buffer.append(": ", 2);
+			m_output_buffer.append(header.second);
+			m_output_buffer.append("\r\n", 2);
 		}
 
-		return response.str();
+		// Do not put '\r\n' at the end of the http message-m_body.
+		// see: https://stackoverflow.com/a/13821352/11850070
+		m_output_buffer.append("\r\n", 2);
+		if (!m_is_body_omitted)
+		{
+			m_output_buffer.append(m_body);
+		}
+
+		return m_output_buffer;
 	}
 
+	void Message::Response::omit_body() { m_is_body_omitted = true; }
+
 	bool Message::Response::has_header(const std::string& name)
 	{
 		return m_headers.find(name) != m_headers.cend();
@@ -240,56 +488,15 @@ namespace Message
 
 	void Message::Response::clear_up()
 	{
+		m_status_code = 0;
 		m_headers.clear();
 		m_body.clear();
 		m_content_type.clear();
-		m_reason_phrase.clear();
-	}
-
-	std::string Message::Response::serialize_headers()
-	{
-		std::string serialized_headers_string;
-
-		for (const auto& header : m_headers)
-		{
-			if (header.first == "Date" || header.first == "Host" ||
-			    header.first == "Server")
-				continue;
-
-			serialized_headers_string +=
-			    (header.first + ":" + header.second + "\n");
-		}
-
-		// custom end delimiter
-		serialized_headers_string += "\n\n\n\n";
-
-		return serialized_headers_string;
-	}
-
-	void Message::Response::deserialize(const std::string& message)
-	{
-		auto headers_end_delimiter = message.find("\n\n\n\n");
-
-		if (headers_end_delimiter == std::string::npos)
-			return;
-
-		for (unsigned int i = 0; i < headers_end_delimiter; ++i)
-		{
-			unsigned int r = i;
-
-			std::string header_key, header_value;
-
-			while (r < headers_end_delimiter && message[r] != ':')
-				header_key += message[r++];
-			++r;
-			while (r < headers_end_delimiter && message[r] != '\n')
-				header_value += message[r++];
-
-			i = r;
-
-			add_header(header_key, header_value);
-		}
-
-		set_body(message.substr(headers_end_delimiter + 5));
+		m_reason_phrase = "";
+		m_status_line = nullptr;
+		m_status_line_length = 0;
+		m_prebuilt_message = nullptr;
+		m_is_output_serialized = false;
+		m_is_body_omitted = false;
 	}
 } // namespace Message
@@ -0,0 +1,344 @@
+#include "Router.hpp"
+#include "Logger.hpp"
+#include "Uri.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	/**
+	 * Split a route pattern into its segments: "/" has none, "/a/:b" has
+	 * "a" and ":b".
+	 */
+	std::vector<std::string> split_pattern(const std::string& pattern)
+	{
+		std::vector<std::string> segments;
+		if (pattern == "/")
+		{
+			return segments;
+		}
+
+		size_t segment_begin = 1;
+		for (;;)
+		{
+			size_t segment_end = pattern.find('/', segment_begin);
+			if (segment_end == std::string::npos)
+			{
+				segments.push_back(pattern.substr(segment_begin));
+				return segments;
+			}
+			segments.push_back(
+			    pattern.substr(segment_begin, segment_end - segment_begin));
+			segment_begin = segment_end + 1;
+		}
+	}
+
+	void throw_route_error(const std::string& message)
+	{
+		Logger::error(message);
+		throw std::runtime_error(message);
+	}
+
+	/**
+	 * Pick the first endpoint whose query parameter, if any, is in the
+	 * query of @b uri.
+	 */
+	template <typename Endpoints>
+	IResourceHandler* pick_endpoint(const Endpoints& endpoints, Uri& uri)
+	{
+		for (const auto& endpoint : endpoints)
+		{
+			if (endpoint.query_parameter.empty() ||
+			    (uri.has_query() &&
+			     uri.get_query_paramters().count(endpoint.query_parameter) !=
+			         0))
+			{
+				return endpoint.handler;
+			}
+		}
+		return nullptr;
+	}
+
+	/**
+	 * Get the endpoints serving @b method. HEAD requests are served by the
+	 * GET endpoints unless there are HEAD ones.
+	 */
+	template <typename Endpoints>
+	const Endpoints&
+	get_endpoints(const Endpoints (&endpoints)[HTTP::NUMBER_OF_METHODS],
+	              HTTP::Method method)
+	{
+		const Endpoints& method_endpoints =
+		    endpoints[static_cast<size_t>(method)];
+		if (method == HTTP::Method::HEAD && method_endpoints.empty())
+		{
+			return endpoints[static_cast<size_t>(HTTP::Method::GET)];
+		}
+		return method_endpoints;
+	}
+
+	/**
+	 * Get a bit per method that has endpoints; HEAD's is set with GET's.
+	 */
+	template <typename Endpoints>
+	unsigned int
+	get_endpoint_methods(const Endpoints (&endpoints)[HTTP::NUMBER_OF_METHODS])
+	{
+		unsigned int methods = 0;
+		for (size_t i = 0; i < HTTP::NUMBER_OF_METHODS; ++i)
+		{
+			if (!endpoints[i].empty())
+			{
+				methods |= 1u << i;
+			}
+		}
+		if ((methods & 1u << static_cast<size_t>(HTTP::Method::GET)) != 0)
+		{
+			methods |= 1u << static_cast<size_t>(HTTP::Method::HEAD);
+		}
+		return methods;
+	}
+} // namespace
+
+namespace HTTP
+{
+	IResourceHandler* RouteMatch::get_handler() const { return m_handler; }
+
+	const std::string* RouteMatch::get_parameter(const std::string& name) const
+	{
+		for (size_t i = 0; i < m_number_of_parameters; ++i)
+		{
+			if (*m_parameter_names[i] == name)
+			{
+				return m_parameter_values[i];
+			}
+		}
+		return nullptr;
+	}
+
+	std::string RouteMatch::get_allowed_methods() const
+	{
+		std::string allowed_methods;
+		for (size_t i = 0; i < NUMBER_OF_METHODS; ++i)
+		{
+			if ((m_allowed_methods & 1u << i) != 0)
+			{
+				if (!allowed_methods.empty())
+				{
+					allowed_methods += ", ";
+				}
+				allowed_methods += get_method_name(static_cast<Method>(i));
+			}
+		}
+		return allowed_methods;
+	}
+
+	void RouteMatch::clear_up()
+	{
+		m_handler = nullptr;
+		m_number_of_parameters = 0;
+		m_allowed_methods = 0;
+	}
+
+	Router::Router() : m_nodes(1) {}
+
+	Router::~Router() = default;
+
+	void Router::add_route(Method method, const std::string& pattern,
+	                       const std::shared_ptr<IResourceHandler>& handler,
+	                       const std::string& query_parameter)
+	{
+		if (method == Method::UNKNOWN || !handler || pattern.empty() ||
+		    pattern[0] != '/')
+		{
+			throw_route_error("invalid route: " + pattern);
+		}
+
+		const std::vector<std::string> segments = split_pattern(pattern);
+
+		size_t node = 0;
+		size_t number_of_parameters = 0;
+		bool is_prefix = false;
+		for (size_t i = 0; i < segments.size(); ++i)
+		{
+			const std::string& segment = segments[i];
+
+			if (segment == "*")
+			{
+				if (i + 1 != segments.size())
+				{
+					throw_route_error("'*' must end route: " + pattern);
+				}
+				is_prefix = true;
+				break;
+			}
+
+			if (!segment.empty() && segment[0] == ':')
+			{
+				std::string parameter_name = segment.substr(1);
+				if (parameter_name.empty() ||
+				    ++number_of_parameters > RouteMatch::MAX_PARAMETERS)
+				{
+					throw_route_error("invalid route parameter: " + pattern);
+				}
+
+				if (m_nodes[node].parameter_child == NO_NODE)
+				{
+					m_nodes[node].parameter_child = m_nodes.size();
+					m_nodes.emplace_back();
+					m_nodes.back().parameter_name = std::move(parameter_name);
+				}
+				else if (m_nodes[m_nodes[node].parameter_child]
+				             .parameter_name != parameter_name)
+				{
+					throw_route_error("conflicting route parameter: " +
+					                  pattern);
+				}
+				node = m_nodes[node].parameter_child;
+				continue;
+			}
+
+			auto& children = m_nodes[node].children;
+			auto child = std::lower_bound(
+			    children.begin(), children.end(), segment,
+			    [](const std::pair<std::string, size_t>& child_node,
+			       const std::string& child_segment) {
+				    return child_node.first < child_segment;
+			    });
+			if (child == children.end() || child->first != segment)
+			{
+				child = children.insert(child, {segment, m_nodes.size()});
+				m_nodes.emplace_back();
+			}
+			node = child->second;
+		}
+
+		auto& endpoints =
+		    is_prefix
+		        ? m_nodes[node].prefix_endpoints[static_cast<size_t>(method)]
+		        : m_nodes[node].endpoints[static_cast<size_t>(method)];
+		for (const auto& endpoint : endpoints)
+		{
+			if (endpoint.query_parameter == query_parameter)
+			{
+				throw_route_error(std::string("duplicate route: ") +
+				                  get_method_name(method) + " " + pattern);
+			}
+		}
+
+		// routes with a query parameter are tried first
+		Endpoint endpoint{query_parameter, handler.get()};
+		if (query_parameter.empty())
+		{
+			endpoints.push_back(std::move(endpoint));
+		}
+		else
+		{
+			endpoints.insert(endpoints.begin(), std::move(endpoint));
+		}
+
+		if (std::find(m_handlers.begin(), m_handlers.end(), handler) ==
+		    m_handlers.end())
+		{
+			m_handlers.push_back(handler);
+		}
+	}
+
+	Router::Result Router::route(Method method, Uri& uri,
+	                             RouteMatch& route_match) const
+	{
+		route_match.clear_up();
+
+		// The path "/" is split into one empty segment.
+		const std::vector<std::string>& segments = uri.get_path_segments();
+		size_t first_segment =
+		    segments.size() == 1 && segments[0].empty() ? 1 : 0;
+
+		bool is_path_found = false;
+		if (match_from(0, segments, first_segment, method, uri, route_match,
+		               is_path_found))
+		{
+			return Result::FOUND;
+		}
+
+		unsigned int allowed_methods = route_match.m_allowed_methods;
+		route_match.clear_up();
+		route_match.m_allowed_methods = allowed_methods;
+		return is_path_found ? Result::METHOD_NOT_ALLOWED : Result::NOT_FOUND;
+	}
+
+	bool Router::match_from(size_t node,
+	                        const std::vector<std::string>& segments,
+	                        size_t index, Method method, Uri& uri,
+	                        RouteMatch& route_match, bool& is_path_found) const
+	{
+		const Node& current = m_nodes[node];
+
+		if (index == segments.size())
+		{
+			unsigned int methods = get_endpoint_methods(current.endpoints);
+			if (methods != 0)
+			{
+				is_path_found = true;
+				route_match.m_allowed_methods |= methods;
+				if (method != Method::UNKNOWN &&
+				    (route_match.m_handler = pick_endpoint(
+				         get_endpoints(current.endpoints, method), uri)) !=
+				        nullptr)
+				{
+					return true;
+				}
+			}
+		}
+		else
+		{
+			const std::string& segment = segments[index];
+
+			auto child = std::lower_bound(
+			    current.children.cbegin(), current.children.cend(), segment,
+			    [](const std::pair<std::string, size_t>& child_node,
+			       const std::string& child_segment) {
+				    return child_node.first < child_segment;
+			    });
+			if (child != current.children.cend() && child->first == segment &&
+			    match_from(child->second, segments, index + 1, method, uri,
+			               route_match, is_path_found))
+			{
+				return true;
+			}
+
+			if (current.parameter_child != NO_NODE && !segment.empty())
+			{
+				size_t parameter = route_match.m_number_of_parameters++;
+				route_match.m_parameter_names[parameter] =
+				    &m_nodes[current.parameter_child].parameter_name;
+				route_match.m_parameter_values[parameter] = &segment;
+
+				if (match_from(current.parameter_child, segments, index + 1,
+				               method, uri, route_match, is_path_found))
+				{
+					return true;
+				}
+				--route_match.m_number_of_parameters;
+			}
+		}
+
+		unsigned int prefix_methods =
+		    get_endpoint_methods(current.prefix_endpoints);
+		if (prefix_methods != 0)
+		{
+			is_path_found = true;
+			route_match.m_allowed_methods |= prefix_methods;
+			if (method != Method::UNKNOWN &&
+			    (route_match.m_handler = pick_endpoint(
+			         get_endpoints(current.prefix_endpoints, method), uri)) !=
+			        nullptr)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+} // namespace HTTP
@@ -0,0 +1,184 @@
+#include "Scoreboard.hpp"
+#include "Logger.hpp"
+
+#include <atomic>
+#include <stdexcept>
+
+#include <sys/mman.h>
+
+namespace
+{
+	static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+	              "scoreboard atomics must be lock-free to work across "
+	              "processes");
+
+	/**
+	 * One worker's status, on its own cache line so that workers counting
+	 * requests don't contend.
+	 */
+	struct alignas(64) Slot
+	{
+		std::atomic<int32_t> state;
+		std::atomic<int32_t> pid;
+		std::atomic<uint64_t> number_of_requests;
+	};
+
+	Slot* slots = nullptr;
+	size_t number_of_slots = 0;
+
+	// Slot of this worker process, if attached.
+	Slot* attached_slot = nullptr;
+
+	Scoreboard::State load_state(const Slot& slot)
+	{
+		return static_cast<Scoreboard::State>(
+		    slot.state.load(std::memory_order_acquire));
+	}
+
+	void store_state(Slot& slot, Scoreboard::State state)
+	{
+		slot.state.store(static_cast<int32_t>(state),
+		                 std::memory_order_release);
+	}
+} // namespace
+
+namespace Scoreboard
+{
+	void create(size_t number_of_slots_to_map)
+	{
+		destroy();
+
+		if (number_of_slots_to_map == 0)
+		{
+			return;
+		}
+
+		// Anonymous shared memory is zero-filled, i.e. every slot is EMPTY.
+		void* memory = mmap(nullptr, number_of_slots_to_map * sizeof(Slot),
+		                    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+		                    -1, 0);
+		if (memory == MAP_FAILED)
+		{
+			Logger::error("scoreboard mmap() error", errno);
+			throw std::runtime_error("scoreboard mmap() error");
+		}
+
+		slots = static_cast<Slot*>(memory);
+		number_of_slots = number_of_slots_to_map;
+	}
+
+	void destroy()
+	{
+		if (slots != nullptr)
+		{
+			munmap(slots, number_of_slots * sizeof(Slot));
+		}
+		slots = nullptr;
+		number_of_slots = 0;
+		attached_slot = nullptr;
+	}
+
+	int claim_slot()
+	{
+		for (size_t i = 0; i < number_of_slots; ++i)
+		{
+			int32_t expected = static_cast<int32_t>(State::EMPTY);
+			if (slots[i].state.compare_exchange_strong(
+			        expected, static_cast<int32_t>(State::STARTING)))
+			{
+				slots[i].pid.store(0, std::memory_order_relaxed);
+				slots[i].number_of_requests.store(0,
+				                                  std::memory_order_relaxed);
+				return static_cast<int>(i);
+			}
+		}
+		return -1;
+	}
+
+	void set_pid(size_t slot, pid_t pid)
+	{
+		if (slot < number_of_slots)
+		{
+			slots[slot].pid.store(pid, std::memory_order_relaxed);
+		}
+	}
+
+	pid_t get_pid(size_t slot)
+	{
+		return slot < number_of_slots
+		           ? slots[slot].pid.load(std::memory_order_relaxed)
+		           : 0;
+	}
+
+	void release(pid_t pid)
+	{
+		for (size_t i = 0; i < number_of_slots; ++i)
+		{
+			if (slots[i].pid.load(std::memory_order_relaxed) == pid)
+			{
+				slots[i].pid.store(0, std::memory_order_relaxed);
+				store_state(slots[i], State::EMPTY);
+			}
+		}
+	}
+
+	void attach(size_t slot)
+	{
+		attached_slot = slot < number_of_slots ? &slots[slot] : nullptr;
+	}
+
+	void set_state(State state)
+	{
+		if (attached_slot != nullptr)
+		{
+			store_state(*attached_slot, state);
+		}
+	}
+
+	void count_request()
+	{
+		if (attached_slot != nullptr)
+		{
+			// only this process writes the slot, so load and store suffice
+			attached_slot->number_of_requests.store(
+			    attached_slot->number_of_requests.load(
+			        std::memory_order_relaxed) +
+			        1,
+			    std::memory_order_relaxed);
+		}
+	}
+
+	size_t get_number_of_slots() { return number_of_slots; }
+
+	size_t get_number_of_workers(State state)
+	{
+		size_t number_of_workers = 0;
+		for (size_t i = 0; i < number_of_slots; ++i)
+		{
+			number_of_workers += load_state(slots[i]) == state ? 1 : 0;
+		}
+		return number_of_workers;
+	}
+
+	uint64_t get_number_of_requests()
+	{
+		uint64_t number_of_requests = 0;
+		for (size_t i = 0; i < number_of_slots; ++i)
+		{
+			number_of_requests +=
+			    slots[i].number_of_requests.load(std::memory_order_relaxed);
+		}
+		return number_of_requests;
+	}
+
+	bool is_ready()
+	{
+		if (number_of_slots == 0)
+		{
+			return true;
+		}
+
+		return get_number_of_workers(State::READY) != 0 &&
+		       get_number_of_workers(State::STARTING) == 0;
+	}
+} // namespace Scoreboard
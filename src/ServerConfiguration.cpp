@@ -1,6 +1,7 @@
 #include "ServerConfiguration.hpp"
 #include "Logger.hpp"
 
+#include <cstdlib>
 #include <cstring>
 #include <error.h>
 #include <sys/stat.h>
@@ -36,6 +37,30 @@ namespace
 		output_file << file_content;
 		output_file.close();
 	}
+
+	/**
+	 * Read a non-negative integer from an environment variable.
+	 *
+	 * @return
+	 *      The integer, or @b default_value if the variable isn't set to
+	 *      one.
+	 */
+	size_t read_size_from_environment(const char* name, size_t default_value)
+	{
+		const char* value = getenv(name);
+		if (value == nullptr)
+		{
+			return default_value;
+		}
+
+		char* end = nullptr;
+		unsigned long long size = strtoull(value, &end, 10);
+		if (end == value || *end != '\0' || *value == '-')
+		{
+			return default_value;
+		}
+		return static_cast<size_t>(size);
+	}
 } // namespace
 
 namespace
@@ -56,6 +81,9 @@ namespace
 
 	const std::string html_directory_path = {asset_directory_path + "html/"};
 
+	const std::string error_page_directory_path = {html_directory_path +
+	                                               "error/"};
+
 	const std::string js_directory_path = {asset_directory_path + "js/"};
 
 	const std::string image_directory_path = {asset_directory_path + "image/"};
@@ -66,6 +94,31 @@ namespace
 
 	const std::string database_file_path = {data_storage_directory_path +
 	                                        "data.db"};
+
+	const size_t default_local_cache_mb = 32;
+
+	const size_t default_local_cache_shards = 8;
+
+	const size_t default_shared_cache_mb = 64;
+
+	const std::string default_cache_policy = {"tinylfu"};
+
+	const size_t default_search_cache_ttl = 600;
+
+	const size_t default_search_cache_stale_ttl = 3600;
+
+	const size_t default_negative_cache_ttl = 30;
+
+	const std::string default_vocabulary_filter_path = {
+	    data_storage_directory_path + "vocabulary.filter"};
+
+	const std::string default_database_profile = {"read_only"};
+
+	const size_t default_database_cache_mb = 8;
+
+	const size_t default_search_threads = 2;
+
+	const std::string default_redis_uri = {"tcp://127.0.0.1:6379"};
 } // namespace
 
 namespace
@@ -158,7 +211,73 @@ ServerConfiguration::ServerConfiguration()
     , m_resource_root_directory_path{resource_directory_path}
     , m_database_path{database_file_path}
     , m_log_directory_path{log_directory_path}
+    , m_server_name{"Bitate"}
+    , m_host_name{"www.bitate.com"}
+    , m_error_page_directory_path{error_page_directory_path}
+    , m_local_cache_capacity{read_size_from_environment(
+                                 "WORD_FINDER_LOCAL_CACHE_MB",
+                                 default_local_cache_mb) *
+                             1024 * 1024}
+    , m_local_cache_shards{read_size_from_environment(
+          "WORD_FINDER_LOCAL_CACHE_SHARDS", default_local_cache_shards)}
+    , m_shared_cache_capacity{read_size_from_environment(
+                                  "WORD_FINDER_SHARED_CACHE_MB",
+                                  default_shared_cache_mb) *
+                              1024 * 1024}
+    , m_cache_policy{default_cache_policy}
+    , m_search_cache_ttl{read_size_from_environment(
+          "WORD_FINDER_SEARCH_CACHE_TTL", default_search_cache_ttl)}
+    , m_search_cache_stale_ttl{read_size_from_environment(
+          "WORD_FINDER_SEARCH_CACHE_STALE", default_search_cache_stale_ttl)}
+    , m_negative_cache_ttl{read_size_from_environment(
+          "WORD_FINDER_NEGATIVE_CACHE_TTL", default_negative_cache_ttl)}
+    , m_vocabulary_filter_path{default_vocabulary_filter_path}
+    , m_database_profile{default_database_profile}
+    , m_database_cache_capacity{read_size_from_environment(
+                                    "WORD_FINDER_DATABASE_CACHE_MB",
+                                    default_database_cache_mb) *
+                                1024 * 1024}
+    , m_search_threads{read_size_from_environment(
+          "WORD_FINDER_SEARCH_THREADS", default_search_threads)}
+    , m_redis_uri{default_redis_uri}
 {
+	const char* cpu_isa = getenv("WORD_FINDER_CPU_ISA");
+	if (cpu_isa != nullptr)
+	{
+		m_cpu_isa = cpu_isa;
+	}
+
+	const char* shared_cache_path = getenv("WORD_FINDER_SHARED_CACHE_PATH");
+	if (shared_cache_path != nullptr)
+	{
+		m_shared_cache_path = shared_cache_path;
+	}
+
+	const char* cache_policy = getenv("WORD_FINDER_CACHE_POLICY");
+	if (cache_policy != nullptr)
+	{
+		m_cache_policy = cache_policy;
+	}
+
+	const char* vocabulary_filter_path =
+	    getenv("WORD_FINDER_VOCABULARY_FILTER_PATH");
+	if (vocabulary_filter_path != nullptr)
+	{
+		m_vocabulary_filter_path = vocabulary_filter_path;
+	}
+
+	const char* database_profile = getenv("WORD_FINDER_DATABASE_PROFILE");
+	if (database_profile != nullptr)
+	{
+		m_database_profile = database_profile;
+	}
+
+	const char* redis_uri = getenv("WORD_FINDER_REDIS_URI");
+	if (redis_uri != nullptr)
+	{
+		m_redis_uri = redis_uri;
+	}
+
 	create_folder_if_not_exist(root_directory_path);
 	create_folder_if_not_exist(resource_directory_path);
 	create_folder_if_not_exist(log_directory_path);
@@ -200,6 +319,170 @@ std::string ServerConfiguration::get_database_path() const
 	return m_database_path;
 }
 
+std::string ServerConfiguration::get_cpu_isa() const { return m_cpu_isa; }
+
+void ServerConfiguration::set_cpu_isa(const std::string& cpu_isa)
+{
+	m_cpu_isa = cpu_isa;
+}
+
+std::string ServerConfiguration::get_server_name() const
+{
+	return m_server_name;
+}
+
+void ServerConfiguration::set_server_name(const std::string& server_name)
+{
+	m_server_name = server_name;
+}
+
+std::string ServerConfiguration::get_host_name() const { return m_host_name; }
+
+void ServerConfiguration::set_host_name(const std::string& host_name)
+{
+	m_host_name = host_name;
+}
+
+std::string ServerConfiguration::get_error_page_directory_path() const
+{
+	return m_error_page_directory_path;
+}
+
+void ServerConfiguration::set_error_page_directory_path(
+    const std::string& directory_path)
+{
+	m_error_page_directory_path = directory_path;
+}
+
+size_t ServerConfiguration::get_local_cache_capacity() const
+{
+	return m_local_cache_capacity;
+}
+
+void ServerConfiguration::set_local_cache_capacity(size_t capacity_in_bytes)
+{
+	m_local_cache_capacity = capacity_in_bytes;
+}
+
+size_t ServerConfiguration::get_local_cache_shards() const
+{
+	return m_local_cache_shards;
+}
+
+void ServerConfiguration::set_local_cache_shards(size_t number_of_shards)
+{
+	m_local_cache_shards = number_of_shards;
+}
+
+size_t ServerConfiguration::get_shared_cache_capacity() const
+{
+	return m_shared_cache_capacity;
+}
+
+void ServerConfiguration::set_shared_cache_capacity(size_t capacity_in_bytes)
+{
+	m_shared_cache_capacity = capacity_in_bytes;
+}
+
+std::string ServerConfiguration::get_shared_cache_path() const
+{
+	return m_shared_cache_path;
+}
+
+void ServerConfiguration::set_shared_cache_path(const std::string& file_path)
+{
+	m_shared_cache_path = file_path;
+}
+
+std::string ServerConfiguration::get_cache_policy() const
+{
+	return m_cache_policy;
+}
+
+void ServerConfiguration::set_cache_policy(const std::string& policy_name)
+{
+	m_cache_policy = policy_name;
+}
+
+size_t ServerConfiguration::get_search_cache_ttl() const
+{
+	return m_search_cache_ttl;
+}
+
+void ServerConfiguration::set_search_cache_ttl(size_t seconds)
+{
+	m_search_cache_ttl = seconds;
+}
+
+size_t ServerConfiguration::get_search_cache_stale_ttl() const
+{
+	return m_search_cache_stale_ttl;
+}
+
+void ServerConfiguration::set_search_cache_stale_ttl(size_t seconds)
+{
+	m_search_cache_stale_ttl = seconds;
+}
+
+size_t ServerConfiguration::get_negative_cache_ttl() const
+{
+	return m_negative_cache_ttl;
+}
+
+void ServerConfiguration::set_negative_cache_ttl(size_t seconds)
+{
+	m_negative_cache_ttl = seconds;
+}
+
+std::string ServerConfiguration::get_vocabulary_filter_path() const
+{
+	return m_vocabulary_filter_path;
+}
+
+void ServerConfiguration::set_vocabulary_filter_path(
+    const std::string& file_path)
+{
+	m_vocabulary_filter_path = file_path;
+}
+
+std::string ServerConfiguration::get_database_profile() const
+{
+	return m_database_profile;
+}
+
+void ServerConfiguration::set_database_profile(const std::string& profile_name)
+{
+	m_database_profile = profile_name;
+}
+
+size_t ServerConfiguration::get_database_cache_capacity() const
+{
+	return m_database_cache_capacity;
+}
+
+void ServerConfiguration::set_database_cache_capacity(
+    size_t capacity_in_bytes)
+{
+	m_database_cache_capacity = capacity_in_bytes;
+}
+
+size_t ServerConfiguration::get_search_threads() const
+{
+	return m_search_threads;
+}
+
+void ServerConfiguration::set_search_threads(size_t number_of_threads)
+{
+	m_search_threads = number_of_threads;
+}
+
+std::string ServerConfiguration::get_redis_uri() const { return m_redis_uri; }
+
+void ServerConfiguration::set_redis_uri(const std::string& redis_uri)
+{
+	m_redis_uri = redis_uri;
+}
+
 ServerConfiguration* ServerConfiguration::m_instance = 0;
 
 ServerConfiguration* ServerConfiguration::instance()
@@ -1,181 +1,341 @@
 #include "Sha1.hpp"
+#include "CpuDispatch.hpp"
 
+#include <algorithm>
 #include <cstring>
-#include <iomanip>
-#include <sstream>
+
+#if defined(CPU_DISPATCH_X86)
+#include <immintrin.h>
+#endif
 
 namespace
 {
-	uint32_t circular_rotate_left(uint32_t word, unsigned short n_bits)
+	constexpr uint32_t INITIAL_STATE[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE,
+	                                       0x10325476, 0xC3D2E1F0};
+
+	constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+	inline uint32_t circular_rotate_left(uint32_t word, unsigned n_bits)
 	{
 		return (word << n_bits) | (word >> (32 - n_bits));
 	}
-} // namespace
 
-namespace Sha1
-{
-	std::string sha1_encrypt(const std::string& data)
+	inline uint32_t load_big_endian(const uint8_t* bytes)
 	{
-		std::vector<uint8_t> data_as_vector(data.length());
-		if (!data_as_vector.empty())
+		return (uint32_t{bytes[0]} << 24) | (uint32_t{bytes[1]} << 16) |
+		       (uint32_t{bytes[2]} << 8) | uint32_t{bytes[3]};
+	}
+
+	/**
+	 * Compress whole 64-byte blocks into the state.
+	 *
+	 * This is the pseudocode found in the Wikipedia page for SHA-1
+	 * (https://en.wikipedia.org/wiki/SHA-1), with the message schedule kept
+	 * in a 16-word ring instead of 80 words and one loop per round function,
+	 * so that the compiler can unroll each of them without branches.
+	 */
+	void compress_blocks_scalar(uint32_t* state, const uint8_t* blocks,
+	                            size_t count)
+	{
+		for (; count > 0; --count, blocks += 64)
 		{
-			(void)memcpy(data_as_vector.data(), data.c_str(),
-			             data_as_vector.size());
+			uint32_t w[16];
+			for (size_t i = 0; i < 16; ++i)
+			{
+				w[i] = load_big_endian(blocks + i * 4);
+			}
+
+			uint32_t a = state[0];
+			uint32_t b = state[1];
+			uint32_t c = state[2];
+			uint32_t d = state[3];
+			uint32_t e = state[4];
+
+			auto schedule = [&w](size_t i) {
+				if (i >= 16)
+				{
+					w[i & 15] = circular_rotate_left(
+					    w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^
+					        w[i & 15],
+					    1);
+				}
+				return w[i & 15];
+			};
+
+			auto round = [&](uint32_t f, uint32_t k, uint32_t word) {
+				uint32_t temp = circular_rotate_left(a, 5) + f + e + k + word;
+				e = d;
+				d = c;
+				c = circular_rotate_left(b, 30);
+				b = a;
+				a = temp;
+			};
+
+			for (size_t i = 0; i < 20; ++i)
+			{
+				round(d ^ (b & (c ^ d)), 0x5A827999, schedule(i));
+			}
+			for (size_t i = 20; i < 40; ++i)
+			{
+				round(b ^ c ^ d, 0x6ED9EBA1, schedule(i));
+			}
+			for (size_t i = 40; i < 60; ++i)
+			{
+				round((b & c) | (d & (b | c)), 0x8F1BBCDC, schedule(i));
+			}
+			for (size_t i = 60; i < 80; ++i)
+			{
+				round(b ^ c ^ d, 0xCA62C1D6, schedule(i));
+			}
+
+			state[0] += a;
+			state[1] += b;
+			state[2] += c;
+			state[3] += d;
+			state[4] += e;
 		}
-		return sha1_encrypt(data_as_vector);
 	}
 
-	std::string sha1_encrypt(const std::vector<uint8_t>& data)
+#if defined(CPU_DISPATCH_X86)
+	/**
+	 * Four rounds with the SHA extensions, interleaved with the message
+	 * schedule of the following rounds. @b message is the current group of
+	 * four message words; the next three groups are updated in place.
+	 *
+	 * Based on the Intel SHA extensions white paper and Jeffrey Walton's
+	 * public domain sha1-x86.c.
+	 */
+	template <int FUNCTION>
+	CPU_DISPATCH_TARGET("sha,sse4.1,ssse3") inline void
+	quad_round_ni(__m128i& abcd, __m128i& e, __m128i& e_next,
+	              const __m128i& message, __m128i& message_1,
+	              __m128i& message_2, __m128i& message_3)
+	{
+		e = _mm_sha1nexte_epu32(e, message);
+		e_next = abcd;
+		message_1 = _mm_sha1msg2_epu32(message_1, message);
+		abcd = _mm_sha1rnds4_epu32(abcd, e, FUNCTION);
+		message_3 = _mm_sha1msg1_epu32(message_3, message);
+		message_2 = _mm_xor_si128(message_2, message);
+	}
+
+	CPU_DISPATCH_TARGET("sha,sse4.1,ssse3") void
+	compress_blocks_ni(uint32_t* state, const uint8_t* blocks, size_t count)
 	{
-		const auto message_digest = sha1_encrypt_into_bytes(data);
-		std::ostringstream digest_string_builder;
-		digest_string_builder << std::hex << std::setfill('0');
-		for (auto digest_byte : message_digest)
+		const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607ULL,
+		                                         0x08090a0b0c0d0e0fULL);
+
+		__m128i abcd = _mm_shuffle_epi32(
+		    _mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+		__m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+		__m128i e1;
+
+		for (; count > 0; --count, blocks += 64)
 		{
-			digest_string_builder << std::setw(2) << (int)digest_byte;
+			const __m128i abcd_save = abcd;
+			const __m128i e0_save = e0;
+
+			__m128i m0 = _mm_shuffle_epi8(
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks)),
+			    byte_swap);
+			__m128i m1 = _mm_shuffle_epi8(
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16)),
+			    byte_swap);
+			__m128i m2 = _mm_shuffle_epi8(
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 32)),
+			    byte_swap);
+			__m128i m3 = _mm_shuffle_epi8(
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 48)),
+			    byte_swap);
+
+			// rounds 0-11 start the message schedule
+			e0 = _mm_add_epi32(e0, m0);
+			e1 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+			e1 = _mm_sha1nexte_epu32(e1, m1);
+			e0 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+			m0 = _mm_sha1msg1_epu32(m0, m1);
+
+			e0 = _mm_sha1nexte_epu32(e0, m2);
+			e1 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+			m1 = _mm_sha1msg1_epu32(m1, m2);
+			m0 = _mm_xor_si128(m0, m2);
+
+			// rounds 12-79; the schedule updates of the last rounds are unused
+			quad_round_ni<0>(abcd, e1, e0, m3, m0, m1, m2);
+			quad_round_ni<0>(abcd, e0, e1, m0, m1, m2, m3);
+			quad_round_ni<1>(abcd, e1, e0, m1, m2, m3, m0);
+			quad_round_ni<1>(abcd, e0, e1, m2, m3, m0, m1);
+			quad_round_ni<1>(abcd, e1, e0, m3, m0, m1, m2);
+			quad_round_ni<1>(abcd, e0, e1, m0, m1, m2, m3);
+			quad_round_ni<1>(abcd, e1, e0, m1, m2, m3, m0);
+			quad_round_ni<2>(abcd, e0, e1, m2, m3, m0, m1);
+			quad_round_ni<2>(abcd, e1, e0, m3, m0, m1, m2);
+			quad_round_ni<2>(abcd, e0, e1, m0, m1, m2, m3);
+			quad_round_ni<2>(abcd, e1, e0, m1, m2, m3, m0);
+			quad_round_ni<2>(abcd, e0, e1, m2, m3, m0, m1);
+			quad_round_ni<3>(abcd, e1, e0, m3, m0, m1, m2);
+			quad_round_ni<3>(abcd, e0, e1, m0, m1, m2, m3);
+			quad_round_ni<3>(abcd, e1, e0, m1, m2, m3, m0);
+			quad_round_ni<3>(abcd, e0, e1, m2, m3, m0, m1);
+			quad_round_ni<3>(abcd, e1, e0, m3, m0, m1, m2);
+
+			e0 = _mm_sha1nexte_epu32(e0, e0_save);
+			abcd = _mm_add_epi32(abcd, abcd_save);
 		}
-		return digest_string_builder.str();
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state),
+		                 _mm_shuffle_epi32(abcd, 0x1B));
+		state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
 	}
 
-	std::vector<uint8_t> sha1_encrypt_into_bytes(const std::string& data)
+#endif
+
+	using CompressBlocks = void (*)(uint32_t*, const uint8_t*, size_t);
+
+	/**
+	 * Get the SHA extensions kernel when CpuDispatch enables them.
+	 */
+	CompressBlocks get_compress_blocks()
 	{
-		// convert given data string to data bytes vector.
-		std::vector<uint8_t> raw_bytes;
-		for (auto character : data)
+#if defined(CPU_DISPATCH_X86)
+		if (CpuDispatch::has_sha_extensions())
 		{
-			raw_bytes.push_back(character);
+			return compress_blocks_ni;
 		}
-		return sha1_encrypt_into_bytes(raw_bytes); // return type is wrong!!!
+#endif
+		return compress_blocks_scalar;
 	}
+} // namespace
 
-	std::vector<uint8_t>
-	sha1_encrypt_into_bytes(const std::vector<uint8_t>& data)
+namespace Sha1
+{
+	Hasher::Hasher() { init(); }
+
+	void Hasher::init()
+	{
+		(void)memcpy(m_state, INITIAL_STATE, sizeof(m_state));
+		m_block_size = 0;
+		m_message_size = 0;
+	}
+
+	void Hasher::update(const void* data, size_t size)
 	{
-		// This a straightforward implementation of the pseudocode found in the
-		// Wikipedia page for SHA-1 (https://en.wikipedia.org/wiki/SHA-1).
-		uint8_t chunk[64]; // 512-bit chunk
-		uint32_t w[80];    // 5*16*32 = 80 * 32 (extend words from 16 to 80)
-		uint32_t h0 = 0x67452301;
-		uint32_t h1 = 0xEFCDAB89;
-		uint32_t h2 = 0x98BADCFE;
-		uint32_t h3 = 0x10325476;
-		uint32_t h4 = 0xC3D2E1F0;
-		uint64_t ml = (uint64_t)data.size() * 8; // message length
-		// why +9 ?
-		// offset at most equals to ( data.size() + 8 ) bytes.
-		// offset is the position of byte. 64*8 = 512
-		for (size_t offset = 0; offset < data.size() + 9; offset += 64)
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		m_message_size += size;
+
+		// top up the pending partial block first
+		if (m_block_size > 0)
 		{
-			if (offset + 64 <= data.size())
-			{
-				(void)memcpy(chunk, &data[offset], 64);
-			}
-			else
-			{
-				// offset + 64 > data.size(), which means the last block is less
-				// than 512-bit. In this case, we need to add padding.
+			size_t taken = std::min(size, sizeof(m_block) - m_block_size);
+			(void)memcpy(m_block + m_block_size, bytes, taken);
+			m_block_size += taken;
+			bytes += taken;
+			size -= taken;
 
-				(void)memset(chunk, 0, 64); // Set 512-bit to '0's
-				// First, add original data to chunk buffer.
-				if (offset < data.size())
-				{
-					(void)memcpy(chunk, &data[offset], data.size() - offset);
-				}
-				// Second, add '1000 0000'.
-				if (offset <= data.size())
-				{
-					chunk[data.size() - offset] = 0x80;
-				}
-				// Finally, if padding is greater than or equal to 8*9=72 bit,
-				// add original message length to the last 8 byte of
-				// chunk/message.
-				if (offset + 64 - data.size() >= 9)
-				{
-					// set message length to last 64-bit of the last
-					// block(512-bit); cast uint64_t to uint8_t is reserver the
-					// rightmost byte?
-					chunk[56] = (uint8_t)(ml >> 56);
-					chunk[57] = (uint8_t)(ml >> 48);
-					chunk[58] = (uint8_t)(ml >> 40);
-					chunk[59] = (uint8_t)(ml >> 32);
-					chunk[60] = (uint8_t)(ml >> 24);
-					chunk[61] = (uint8_t)(ml >> 16);
-					chunk[62] = (uint8_t)(ml >> 8);
-					chunk[63] = (uint8_t)ml;
-				}
-			}
-			for (size_t i = 0; i < 16; ++i)
-			{
-				w[i] = (((uint32_t)chunk[i * 4 + 0] << 24) |
-				        ((uint32_t)chunk[i * 4 + 1] << 16) |
-				        ((uint32_t)chunk[i * 4 + 2] << 8) |
-				        (uint32_t)chunk[i * 4 + 3]);
-			}
-			for (size_t i = 16; i < 80; ++i)
-			{
-				w[i] = circular_rotate_left(
-				    w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
-			}
-			uint32_t a = h0;
-			uint32_t b = h1;
-			uint32_t c = h2;
-			uint32_t d = h3;
-			uint32_t e = h4;
-			for (size_t i = 0; i < 80; ++i)
+			if (m_block_size < sizeof(m_block))
 			{
-				uint32_t f, k;
-				if (i < 20)
-				{
-					f = (b & c) | ((~b) & d);
-					k = 0x5A827999;
-				}
-				else if (i < 40)
-				{
-					f = b ^ c ^ d;
-					k = 0x6ED9EBA1;
-				}
-				else if (i < 60)
-				{
-					f = (b & c) | (b & d) | (c & d);
-					k = 0x8F1BBCDC;
-				}
-				else
-				{
-					f = b ^ c ^ d;
-					k = 0xCA62C1D6;
-				}
-				uint32_t temp = circular_rotate_left(a, 5) + f + e + k + w[i];
-				e = d;
-				d = c;
-				c = circular_rotate_left(b, 30);
-				b = a;
-				a = temp;
+				return;
 			}
-			h0 += a;
-			h1 += b;
-			h2 += c;
-			h3 += d;
-			h4 += e;
+			get_compress_blocks()(m_state, m_block, 1);
+			m_block_size = 0;
+		}
+
+		// then compress whole blocks straight from the caller's buffer
+		size_t blocks = size / 64;
+		if (blocks > 0)
+		{
+			get_compress_blocks()(m_state, bytes, blocks);
+			bytes += blocks * 64;
+			size -= blocks * 64;
+		}
+
+		if (size > 0)
+		{
+			(void)memcpy(m_block, bytes, size);
+			m_block_size = size;
+		}
+	}
+
+	void Hasher::final(uint8_t* digest)
+	{
+		/**
+		 * Append '1000 0000', zeros up to the last 8 bytes of a block, and
+		 * the message length in bits as a big-endian 64-bit integer.
+		 */
+		const uint64_t message_bits = m_message_size * 8;
+
+		m_block[m_block_size++] = 0x80;
+		if (m_block_size > 56)
+		{
+			(void)memset(m_block + m_block_size, 0, 64 - m_block_size);
+			get_compress_blocks()(m_state, m_block, 1);
+			m_block_size = 0;
+		}
+		(void)memset(m_block + m_block_size, 0, 56 - m_block_size);
+		for (int i = 0; i < 8; ++i)
+		{
+			m_block[56 + i] =
+			    static_cast<uint8_t>(message_bits >> (56 - 8 * i));
+		}
+		get_compress_blocks()(m_state, m_block, 1);
+
+		for (int i = 0; i < 5; ++i)
+		{
+			digest[i * 4] = static_cast<uint8_t>(m_state[i] >> 24);
+			digest[i * 4 + 1] = static_cast<uint8_t>(m_state[i] >> 16);
+			digest[i * 4 + 2] = static_cast<uint8_t>(m_state[i] >> 8);
+			digest[i * 4 + 3] = static_cast<uint8_t>(m_state[i]);
+		}
+	}
+
+	void sha1_digest(const void* data, size_t size, uint8_t* digest)
+	{
+		Hasher hasher;
+		hasher.update(data, size);
+		hasher.final(digest);
+	}
+
+	std::string digest_to_hex_string(const uint8_t* digest)
+	{
+		std::string hex_string(DIGEST_SIZE * 2, '\0');
+		for (size_t i = 0; i < DIGEST_SIZE; ++i)
+		{
+			hex_string[i * 2] = HEX_DIGITS[digest[i] >> 4];
+			hex_string[i * 2 + 1] = HEX_DIGITS[digest[i] & 0xF];
 		}
-		return {
-		    /**
-		     * Return Message Digest.
-		     * 5x32 = 160-bit
-		     */
-		    (uint8_t)((h0 >> 24) & 0xff), (uint8_t)((h0 >> 16) & 0xff),
-		    (uint8_t)((h0 >> 8) & 0xff),  (uint8_t)(h0 & 0xff),
-
-		    (uint8_t)((h1 >> 24) & 0xff), (uint8_t)((h1 >> 16) & 0xff),
-		    (uint8_t)((h1 >> 8) & 0xff),  (uint8_t)(h1 & 0xff),
-
-		    (uint8_t)((h2 >> 24) & 0xff), (uint8_t)((h2 >> 16) & 0xff),
-		    (uint8_t)((h2 >> 8) & 0xff),  (uint8_t)(h2 & 0xff),
-
-		    (uint8_t)((h3 >> 24) & 0xff), (uint8_t)((h3 >> 16) & 0xff),
-		    (uint8_t)((h3 >> 8) & 0xff),  (uint8_t)(h3 & 0xff),
-
-		    (uint8_t)((h4 >> 24) & 0xff), (uint8_t)((h4 >> 16) & 0xff),
-		    (uint8_t)((h4 >> 8) & 0xff),  (uint8_t)(h4 & 0xff),
-		};
+		return hex_string;
+	}
+
+	std::string sha1_encrypt(const std::string& data)
+	{
+		uint8_t digest[DIGEST_SIZE];
+		sha1_digest(data.data(), data.size(), digest);
+		return digest_to_hex_string(digest);
+	}
+
+	std::string sha1_encrypt(const std::vector<uint8_t>& data)
+	{
+		uint8_t digest[DIGEST_SIZE];
+		sha1_digest(data.data(), data.size(), digest);
+		return digest_to_hex_string(digest);
+	}
+
+	std::vector<uint8_t> sha1_encrypt_into_bytes(const std::string& data)
+	{
+		std::vector<uint8_t> digest(DIGEST_SIZE);
+		sha1_digest(data.data(), data.size(), digest.data());
+		return digest;
+	}
+
+	std::vector<uint8_t>
+	sha1_encrypt_into_bytes(const std::vector<uint8_t>& data)
+	{
+		std::vector<uint8_t> digest(DIGEST_SIZE);
+		sha1_digest(data.data(), data.size(), digest.data());
+		return digest;
 	}
-} // namespace Sha1
\ No newline at end of file
+} // namespace Sha1
@@ -0,0 +1,893 @@
+#include "SharedCache.hpp"
+#include "Logger.hpp"
+#include "Timer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+	static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+	              "shared cache atomics must be lock-free to work across "
+	              "processes");
+
+	// "WFSHCACH", identifies a cache file.
+	constexpr uint64_t MAGIC = 0x5746534843414348;
+
+	// Bumped whenever the layout changes, to discard older cache files.
+	constexpr uint32_t VERSION = 4;
+
+	// Chunk sizes of the slab classes; each gets an equal share of memory.
+	constexpr size_t CHUNK_SIZES[] = {1024, 4096, 16384, 65536, 262144};
+	constexpr size_t NUMBER_OF_CLASSES =
+	    sizeof(CHUNK_SIZES) / sizeof(CHUNK_SIZES[0]);
+
+	// Buckets probed for a key past its home bucket.
+	constexpr size_t MAX_PROBES = 8;
+
+	// Attempts to read a bucket or chunk a writer keeps changing.
+	constexpr int MAX_READ_ATTEMPTS = 4;
+
+	// Keys being computed at once; a power of 2.
+	constexpr size_t NUMBER_OF_LEASES = 256;
+
+	struct SlabClass
+	{
+		uint64_t chunk_size;
+		uint64_t number_of_chunks;
+
+		// Offset of the first chunk in the region.
+		uint64_t offset;
+
+		// Next chunk to hand out, modulo number_of_chunks.
+		std::atomic<uint64_t> hand;
+	};
+
+	struct RegionHeader
+	{
+		uint64_t magic;
+		uint32_t version;
+		uint32_t number_of_buckets;
+		uint64_t region_size;
+		SlabClass classes[NUMBER_OF_CLASSES];
+	};
+
+	/**
+	 * A key hash and where its entry is, see encode_location(). A hash of
+	 * 0 marks a bucket never used, which ends a probe sequence; erased
+	 * entries keep their hash with location 0.
+	 */
+	struct Bucket
+	{
+		std::atomic<uint32_t> sequence;
+		uint32_t reserved;
+		std::atomic<uint64_t> key_hash;
+		std::atomic<uint64_t> location;
+	};
+
+	/**
+	 * A claim on computing a key, packed into one word so that its holder
+	 * and deadline change together: the high half holds the upper bits of
+	 * the key hash, 0 marking a free lease, and the low half the coarse
+	 * monotonic milliseconds it expires at, modulo 2^32.
+	 */
+	struct Lease
+	{
+		std::atomic<uint64_t> claim;
+	};
+
+	/**
+	 * Header of a chunk, followed by the key and the value. Its fields and
+	 * bytes are only valid while the sequence doesn't change.
+	 */
+	struct ChunkHeader
+	{
+		std::atomic<uint32_t> sequence;
+		uint32_t key_length;
+		uint32_t value_length;
+		uint32_t reserved;
+		uint64_t key_hash;
+	};
+
+	// The region of this process, if any.
+	char* region = nullptr;
+	size_t region_size = 0;
+	RegionHeader* header = nullptr;
+	Lease* leases = nullptr;
+	Bucket* buckets = nullptr;
+	size_t bucket_mask = 0;
+
+	// Null unless admission is filtered with TinyLFU.
+	std::unique_ptr<HTTP::FrequencySketch> sketch;
+
+	SharedCache::Statistics statistics;
+
+	size_t align_to_cache_line(size_t size) { return (size + 63) & ~63ULL; }
+
+	/**
+	 * A region holds the header, the leases, the frequency sketch, the
+	 * buckets and then the chunks. The sketch is sized for as many entries
+	 * as the buckets are laid out for at most, half of them.
+	 */
+	size_t get_sketch_offset()
+	{
+		return align_to_cache_line(sizeof(RegionHeader)) +
+		       align_to_cache_line(NUMBER_OF_LEASES * sizeof(Lease));
+	}
+
+	size_t get_buckets_offset(size_t number_of_buckets)
+	{
+		size_t sketch_size =
+		    HTTP::FrequencySketch::get_table_size(number_of_buckets / 2);
+		return get_sketch_offset() +
+		       align_to_cache_line(sketch_size * sizeof(uint64_t));
+	}
+
+	/**
+	 * FNV-1a, which is stable across builds unlike std::hash, so that cache
+	 * files stay valid.
+	 */
+	uint64_t hash_key(const std::string& key)
+	{
+		uint64_t hash = 0xcbf29ce484222325ULL;
+		for (char character : key)
+		{
+			hash ^= static_cast<unsigned char>(character);
+			hash *= 0x100000001b3ULL;
+		}
+
+		// 0 marks unused buckets
+		return hash == 0 ? 1 : hash;
+	}
+
+	/**
+	 * Get the part of a key hash a lease holds, never 0.
+	 */
+	uint32_t get_lease_tag(uint64_t key_hash)
+	{
+		uint32_t tag = static_cast<uint32_t>(key_hash >> 32);
+		return tag == 0 ? 1 : tag;
+	}
+
+	uint64_t make_claim(uint64_t key_hash, uint32_t deadline)
+	{
+		return static_cast<uint64_t>(get_lease_tag(key_hash)) << 32 | deadline;
+	}
+
+	uint32_t get_claim_holder(uint64_t claim)
+	{
+		return static_cast<uint32_t>(claim >> 32);
+	}
+
+	/**
+	 * Whether a claim is held and its deadline is after @b now, comparing
+	 * the times modulo 2^32 like TCP sequence numbers.
+	 */
+	bool is_claim_held(uint64_t claim, uint32_t now)
+	{
+		return get_claim_holder(claim) != 0 &&
+		       static_cast<int32_t>(static_cast<uint32_t>(claim) - now) > 0;
+	}
+
+	/**
+	 * Pack a slab class, chunk index and chunk sequence into 64 bits.
+	 * Written sequences are never 0, so neither is a location.
+	 */
+	uint64_t encode_location(size_t slab_class, uint64_t chunk,
+	                         uint32_t sequence)
+	{
+		return (static_cast<uint64_t>(slab_class) << 56) | (chunk << 32) |
+		       sequence;
+	}
+
+	ChunkHeader* decode_location(uint64_t location, uint32_t& sequence)
+	{
+		size_t slab_class = static_cast<size_t>(location >> 56);
+		uint64_t chunk = (location >> 32) & 0xFFFFFF;
+		sequence = static_cast<uint32_t>(location);
+
+		if (location == 0 || slab_class >= NUMBER_OF_CLASSES ||
+		    chunk >= header->classes[slab_class].number_of_chunks)
+		{
+			return nullptr;
+		}
+
+		const SlabClass& chunks = header->classes[slab_class];
+		return reinterpret_cast<ChunkHeader*>(
+		    region + chunks.offset + chunk * chunks.chunk_size);
+	}
+
+	/**
+	 * Lay out a region for @b capacity_in_bytes of chunks into @b layout.
+	 */
+	void lay_out(size_t capacity_in_bytes, RegionHeader& layout)
+	{
+		uint64_t number_of_chunks = 0;
+		for (size_t i = 0; i < NUMBER_OF_CLASSES; ++i)
+		{
+			layout.classes[i].chunk_size = CHUNK_SIZES[i];
+			layout.classes[i].number_of_chunks = std::min<uint64_t>(
+			    capacity_in_bytes / NUMBER_OF_CLASSES / CHUNK_SIZES[i],
+			    0xFFFFFF);
+			number_of_chunks += layout.classes[i].number_of_chunks;
+		}
+
+		// at most half full, so probe sequences stay short
+		uint64_t number_of_buckets = 64;
+		while (number_of_buckets < 2 * number_of_chunks)
+		{
+			number_of_buckets *= 2;
+		}
+
+		layout.magic = MAGIC;
+		layout.version = VERSION;
+		layout.number_of_buckets = static_cast<uint32_t>(number_of_buckets);
+
+		size_t offset = get_buckets_offset(number_of_buckets) +
+		                align_to_cache_line(number_of_buckets * sizeof(Bucket));
+		for (size_t i = 0; i < NUMBER_OF_CLASSES; ++i)
+		{
+			layout.classes[i].offset = offset;
+			offset += layout.classes[i].number_of_chunks *
+			          layout.classes[i].chunk_size;
+		}
+		layout.region_size = offset;
+	}
+
+	bool is_same_layout(const RegionHeader& existing,
+	                    const RegionHeader& layout)
+	{
+		if (existing.magic != layout.magic ||
+		    existing.version != layout.version ||
+		    existing.number_of_buckets != layout.number_of_buckets ||
+		    existing.region_size != layout.region_size)
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < NUMBER_OF_CLASSES; ++i)
+		{
+			const SlabClass& existing_class = existing.classes[i];
+			const SlabClass& layout_class = layout.classes[i];
+			if (existing_class.chunk_size != layout_class.chunk_size ||
+			    existing_class.number_of_chunks !=
+			        layout_class.number_of_chunks ||
+			    existing_class.offset != layout_class.offset)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void write_header(const RegionHeader& layout)
+	{
+		header->magic = layout.magic;
+		header->version = layout.version;
+		header->number_of_buckets = layout.number_of_buckets;
+		header->region_size = layout.region_size;
+		for (size_t i = 0; i < NUMBER_OF_CLASSES; ++i)
+		{
+			header->classes[i].chunk_size = layout.classes[i].chunk_size;
+			header->classes[i].number_of_chunks =
+			    layout.classes[i].number_of_chunks;
+			header->classes[i].offset = layout.classes[i].offset;
+			header->classes[i].hand.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * Release the locks of writers that died while holding them. The
+	 * released chunks get a new sequence, which turns their entries into
+	 * misses.
+	 */
+	void release_abandoned_locks()
+	{
+		for (size_t i = 0; i <= bucket_mask; ++i)
+		{
+			uint32_t sequence =
+			    buckets[i].sequence.load(std::memory_order_relaxed);
+			if (sequence & 1)
+			{
+				buckets[i].sequence.store(sequence + 1,
+				                          std::memory_order_relaxed);
+			}
+		}
+
+		for (size_t slab_class = 0; slab_class < NUMBER_OF_CLASSES;
+		     ++slab_class)
+		{
+			const SlabClass& chunks = header->classes[slab_class];
+			for (uint64_t chunk = 0; chunk < chunks.number_of_chunks; ++chunk)
+			{
+				auto chunk_header = reinterpret_cast<ChunkHeader*>(
+				    region + chunks.offset + chunk * chunks.chunk_size);
+				uint32_t sequence =
+				    chunk_header->sequence.load(std::memory_order_relaxed);
+				if (sequence & 1)
+				{
+					chunk_header->sequence.store(sequence + 1,
+					                             std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// deadlines are meaningless after a reboot
+		for (size_t i = 0; i < NUMBER_OF_LEASES; ++i)
+		{
+			leases[i].claim.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * Read a bucket consistently.
+	 *
+	 * @return
+	 *      False if writers kept changing it.
+	 */
+	bool read_bucket(const Bucket& bucket, uint64_t& key_hash,
+	                 uint64_t& location)
+	{
+		for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt)
+		{
+			uint32_t sequence = bucket.sequence.load(std::memory_order_acquire);
+			if (sequence & 1)
+			{
+				continue;
+			}
+
+			key_hash = bucket.key_hash.load(std::memory_order_relaxed);
+			location = bucket.location.load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (bucket.sequence.load(std::memory_order_relaxed) == sequence)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Claim a bucket or chunk for writing.
+	 *
+	 * @param[out] sequence
+	 *      The sequence before the claim, to be advanced by 2 on release.
+	 *
+	 * @return
+	 *      False if another writer holds it.
+	 */
+	bool lock(std::atomic<uint32_t>& lock_sequence, uint32_t& sequence)
+	{
+		sequence = lock_sequence.load(std::memory_order_relaxed);
+		if ((sequence & 1) ||
+		    !lock_sequence.compare_exchange_strong(sequence, sequence + 1,
+		                                           std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		// keep the writes that follow after the odd sequence
+		std::atomic_thread_fence(std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Whether the chunk of @b location still holds the entry it was
+	 * written with.
+	 */
+	bool is_live(uint64_t location)
+	{
+		uint32_t sequence = 0;
+		ChunkHeader* chunk = decode_location(location, sequence);
+		return chunk != nullptr &&
+		       chunk->sequence.load(std::memory_order_relaxed) == sequence;
+	}
+
+	/**
+	 * Copy out the value of @b key from the chunk of @b location.
+	 *
+	 * @return
+	 *      False if the chunk has been reused or holds another key.
+	 */
+	bool read_chunk(uint64_t location, uint64_t key_hash,
+	                const std::string& key, std::string& value)
+	{
+		uint32_t written_sequence = 0;
+		ChunkHeader* chunk = decode_location(location, written_sequence);
+		if (chunk == nullptr)
+		{
+			return false;
+		}
+
+		if (chunk->sequence.load(std::memory_order_acquire) !=
+		    written_sequence)
+		{
+			return false;
+		}
+
+		// Fields may be torn by a writer reusing the chunk, so check them
+		// before copying and check the sequence after.
+		const size_t chunk_capacity =
+		    header->classes[location >> 56].chunk_size - sizeof(ChunkHeader);
+		const char* key_bytes = reinterpret_cast<const char*>(chunk + 1);
+		size_t key_length = chunk->key_length;
+		size_t value_length = chunk->value_length;
+		if (chunk->key_hash != key_hash || key_length != key.size() ||
+		    key_length + value_length > chunk_capacity ||
+		    std::memcmp(key_bytes, key.data(), key_length) != 0)
+		{
+			return false;
+		}
+
+		value.assign(key_bytes + key_length, value_length);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return chunk->sequence.load(std::memory_order_relaxed) ==
+		       written_sequence;
+	}
+
+	/**
+	 * Whether a bucket of @b key_hash refers to the entry at @b location.
+	 */
+	bool is_indexed(uint64_t key_hash, uint64_t location)
+	{
+		for (size_t probe = 0; probe < MAX_PROBES; ++probe)
+		{
+			uint64_t bucket_hash = 0;
+			uint64_t bucket_location = 0;
+			if (!read_bucket(buckets[(key_hash + probe) & bucket_mask],
+			                 bucket_hash, bucket_location))
+			{
+				continue;
+			}
+
+			if (bucket_hash == 0)
+			{
+				break;
+			}
+
+			if (bucket_hash == key_hash && bucket_location == location)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Whether an entry of @b key_hash may replace the one in a chunk: if
+	 * the chunk holds no entry of another key that is still indexed, or if
+	 * TinyLFU finds the new key used more often.
+	 */
+	bool is_admitted(uint64_t key_hash, size_t slab_class, uint64_t chunk_index,
+	                 const ChunkHeader& chunk)
+	{
+		uint32_t sequence = chunk.sequence.load(std::memory_order_acquire);
+		uint64_t victim_hash = chunk.key_hash;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (sequence == 0 || (sequence & 1) ||
+		    chunk.sequence.load(std::memory_order_relaxed) != sequence ||
+		    victim_hash == key_hash)
+		{
+			return true;
+		}
+
+		if (!is_indexed(victim_hash,
+		                encode_location(slab_class, chunk_index, sequence)))
+		{
+			return true;
+		}
+
+		return sketch->admit(key_hash, victim_hash);
+	}
+
+	/**
+	 * Write an entry into the next chunk of the smallest class that fits.
+	 *
+	 * @return
+	 *      Location of the entry, or 0 if it can't be written or isn't
+	 *      admitted.
+	 */
+	uint64_t write_chunk(uint64_t key_hash, const std::string& key,
+	                     const std::string& value)
+	{
+		const size_t entry_size =
+		    sizeof(ChunkHeader) + key.size() + value.size();
+
+		size_t slab_class = 0;
+		while (slab_class < NUMBER_OF_CLASSES &&
+		       (header->classes[slab_class].chunk_size < entry_size ||
+		        header->classes[slab_class].number_of_chunks == 0))
+		{
+			++slab_class;
+		}
+		if (slab_class == NUMBER_OF_CLASSES)
+		{
+			return 0;
+		}
+
+		SlabClass& chunks = header->classes[slab_class];
+		uint64_t chunk_index =
+		    chunks.hand.fetch_add(1, std::memory_order_relaxed) %
+		    chunks.number_of_chunks;
+		auto chunk = reinterpret_cast<ChunkHeader*>(
+		    region + chunks.offset + chunk_index * chunks.chunk_size);
+
+		// a rejected entry leaves the chunk to be judged again next round
+		if (sketch != nullptr &&
+		    !is_admitted(key_hash, slab_class, chunk_index, *chunk))
+		{
+			return 0;
+		}
+
+		uint32_t sequence = 0;
+		if (!lock(chunk->sequence, sequence))
+		{
+			return 0;
+		}
+
+		chunk->key_length = static_cast<uint32_t>(key.size());
+		chunk->value_length = static_cast<uint32_t>(value.size());
+		chunk->key_hash = key_hash;
+		char* bytes = reinterpret_cast<char*>(chunk + 1);
+		std::memcpy(bytes, key.data(), key.size());
+		std::memcpy(bytes + key.size(), value.data(), value.size());
+
+		// skip 0 on wrap-around, which would make a null location
+		uint32_t written_sequence = sequence + 2 == 0 ? 2 : sequence + 2;
+		chunk->sequence.store(written_sequence, std::memory_order_release);
+
+		return encode_location(slab_class, chunk_index, written_sequence);
+	}
+
+	/**
+	 * Pick the bucket of a key: the one holding it, else the first never
+	 * used, else the first whose entry is gone, else the home bucket.
+	 */
+	Bucket& find_bucket_to_write(uint64_t key_hash)
+	{
+		Bucket* reusable_bucket = nullptr;
+		for (size_t probe = 0; probe < MAX_PROBES; ++probe)
+		{
+			Bucket& bucket = buckets[(key_hash + probe) & bucket_mask];
+
+			uint64_t bucket_hash = 0;
+			uint64_t location = 0;
+			if (!read_bucket(bucket, bucket_hash, location))
+			{
+				continue;
+			}
+
+			if (bucket_hash == key_hash || bucket_hash == 0)
+			{
+				return bucket;
+			}
+
+			if (reusable_bucket == nullptr && !is_live(location))
+			{
+				reusable_bucket = &bucket;
+			}
+		}
+
+		return reusable_bucket != nullptr ? *reusable_bucket
+		                                  : buckets[key_hash & bucket_mask];
+	}
+
+	/**
+	 * Write a bucket.
+	 *
+	 * @return
+	 *      False if another writer holds it.
+	 */
+	bool write_bucket(Bucket& bucket, uint64_t key_hash, uint64_t location)
+	{
+		uint32_t sequence = 0;
+		if (!lock(bucket.sequence, sequence))
+		{
+			return false;
+		}
+
+		bucket.key_hash.store(key_hash, std::memory_order_relaxed);
+		bucket.location.store(location, std::memory_order_relaxed);
+		bucket.sequence.store(sequence + 2, std::memory_order_release);
+		return true;
+	}
+} // namespace
+
+namespace SharedCache
+{
+	void create(size_t capacity_in_bytes, const std::string& file_path,
+	            HTTP::CachePolicy policy)
+	{
+		destroy();
+
+		RegionHeader layout;
+		lay_out(capacity_in_bytes, layout);
+
+		bool is_reused = false;
+		void* memory = MAP_FAILED;
+		if (file_path.empty())
+		{
+			// Anonymous shared memory is zero-filled, i.e. empty.
+			memory = mmap(nullptr, layout.region_size, PROT_READ | PROT_WRITE,
+			              MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		}
+		else
+		{
+			int fd = open(file_path.c_str(), O_RDWR | O_CREAT, 0600);
+			if (fd == -1)
+			{
+				Logger::error("shared cache open() error: " + file_path, errno);
+				throw std::runtime_error("shared cache open() error");
+			}
+
+			struct stat file_status;
+			bool is_same_size = fstat(fd, &file_status) == 0 &&
+			                    static_cast<uint64_t>(file_status.st_size) ==
+			                        layout.region_size;
+
+			// truncating first zero-fills the file
+			if ((!is_same_size && ftruncate(fd, 0) == -1) ||
+			    ftruncate(fd, static_cast<off_t>(layout.region_size)) == -1)
+			{
+				Logger::error("shared cache ftruncate() error", errno);
+				close(fd);
+				throw std::runtime_error("shared cache ftruncate() error");
+			}
+
+			memory = mmap(nullptr, layout.region_size, PROT_READ | PROT_WRITE,
+			              MAP_SHARED, fd, 0);
+			close(fd);
+
+			is_reused = is_same_size;
+		}
+
+		if (memory == MAP_FAILED)
+		{
+			Logger::error("shared cache mmap() error", errno);
+			throw std::runtime_error("shared cache mmap() error");
+		}
+
+		region = static_cast<char*>(memory);
+		region_size = layout.region_size;
+		header = reinterpret_cast<RegionHeader*>(region);
+		leases = reinterpret_cast<Lease*>(
+		    region + align_to_cache_line(sizeof(RegionHeader)));
+		buckets = reinterpret_cast<Bucket*>(
+		    region + get_buckets_offset(layout.number_of_buckets));
+		bucket_mask = layout.number_of_buckets - 1;
+		statistics = Statistics();
+		statistics.capacity_in_bytes = capacity_in_bytes;
+		if (policy == HTTP::CachePolicy::TINY_LFU)
+		{
+			// a reused region keeps the frequencies of its entries
+			sketch.reset(new HTTP::FrequencySketch(
+			    reinterpret_cast<std::atomic<uint64_t>*>(region +
+			                                             get_sketch_offset()),
+			    layout.number_of_buckets / 2));
+		}
+
+		if (is_reused && is_same_layout(*header, layout))
+		{
+			release_abandoned_locks();
+			Logger::info("shared cache reuses entries of " + file_path);
+		}
+		else
+		{
+			if (is_reused)
+			{
+				std::memset(region, 0, region_size);
+			}
+			write_header(layout);
+		}
+	}
+
+	void destroy()
+	{
+		if (region != nullptr)
+		{
+			munmap(region, region_size);
+		}
+		region = nullptr;
+		region_size = 0;
+		header = nullptr;
+		leases = nullptr;
+		buckets = nullptr;
+		bucket_mask = 0;
+		sketch.reset();
+		statistics = Statistics();
+	}
+
+	bool is_enabled() { return region != nullptr; }
+
+	HTTP::CachePolicy get_policy()
+	{
+		return sketch != nullptr ? HTTP::CachePolicy::TINY_LFU
+		                         : HTTP::CachePolicy::LRU;
+	}
+
+	bool get(const std::string& key, std::string& value)
+	{
+		if (region == nullptr)
+		{
+			return false;
+		}
+
+		uint64_t key_hash = hash_key(key);
+		if (sketch != nullptr)
+		{
+			sketch->increment(key_hash);
+		}
+
+		for (size_t probe = 0; probe < MAX_PROBES; ++probe)
+		{
+			const Bucket& bucket = buckets[(key_hash + probe) & bucket_mask];
+
+			uint64_t bucket_hash = 0;
+			uint64_t location = 0;
+			if (!read_bucket(bucket, bucket_hash, location))
+			{
+				continue;
+			}
+
+			if (bucket_hash == 0)
+			{
+				break;
+			}
+
+			if (bucket_hash == key_hash &&
+			    read_chunk(location, key_hash, key, value))
+			{
+				++statistics.hits;
+				return true;
+			}
+		}
+
+		value.clear();
+		++statistics.misses;
+		return false;
+	}
+
+	bool insert(const std::string& key, const std::string& value)
+	{
+		if (region == nullptr)
+		{
+			return false;
+		}
+
+		uint64_t key_hash = hash_key(key);
+		uint64_t location = write_chunk(key_hash, key, value);
+		if (location == 0 ||
+		    !write_bucket(find_bucket_to_write(key_hash), key_hash, location))
+		{
+			++statistics.rejections;
+			return false;
+		}
+
+		++statistics.insertions;
+		return true;
+	}
+
+	bool erase(const std::string& key)
+	{
+		if (region == nullptr)
+		{
+			return false;
+		}
+
+		uint64_t key_hash = hash_key(key);
+		bool is_erased = false;
+		for (size_t probe = 0; probe < MAX_PROBES; ++probe)
+		{
+			Bucket& bucket = buckets[(key_hash + probe) & bucket_mask];
+
+			uint64_t bucket_hash = 0;
+			uint64_t location = 0;
+			if (!read_bucket(bucket, bucket_hash, location))
+			{
+				continue;
+			}
+
+			if (bucket_hash == 0)
+			{
+				break;
+			}
+
+			if (bucket_hash == key_hash && location != 0)
+			{
+				is_erased = is_live(location) || is_erased;
+				write_bucket(bucket, key_hash, 0);
+			}
+		}
+		return is_erased;
+	}
+
+	bool acquire_lease(const std::string& key, int64_t timeout_ms)
+	{
+		if (region == nullptr)
+		{
+			return true;
+		}
+
+		uint64_t key_hash = hash_key(key);
+		Lease& lease = leases[key_hash & (NUMBER_OF_LEASES - 1)];
+		uint32_t now = static_cast<uint32_t>(
+		    Timer::get_coarse_monotonic_milliseconds());
+
+		uint64_t claim = lease.claim.load(std::memory_order_acquire);
+		if (is_claim_held(claim, now))
+		{
+			return get_claim_holder(claim) != get_lease_tag(key_hash);
+		}
+
+		// free or expired; whoever swaps first holds it, deadline included
+		if (!lease.claim.compare_exchange_strong(
+		        claim,
+		        make_claim(key_hash, now + static_cast<uint32_t>(timeout_ms)),
+		        std::memory_order_acq_rel))
+		{
+			return !is_claim_held(claim, now) ||
+			       get_claim_holder(claim) != get_lease_tag(key_hash);
+		}
+		return true;
+	}
+
+	bool is_leased(const std::string& key)
+	{
+		if (region == nullptr)
+		{
+			return false;
+		}
+
+		uint64_t key_hash = hash_key(key);
+		const Lease& lease = leases[key_hash & (NUMBER_OF_LEASES - 1)];
+		uint64_t claim = lease.claim.load(std::memory_order_acquire);
+		return is_claim_held(claim,
+		                     static_cast<uint32_t>(
+		                         Timer::get_coarse_monotonic_milliseconds())) &&
+		       get_claim_holder(claim) == get_lease_tag(key_hash);
+	}
+
+	void release_lease(const std::string& key)
+	{
+		if (region == nullptr)
+		{
+			return;
+		}
+
+		uint64_t key_hash = hash_key(key);
+		Lease& lease = leases[key_hash & (NUMBER_OF_LEASES - 1)];
+		uint64_t claim = lease.claim.load(std::memory_order_relaxed);
+		if (get_claim_holder(claim) == get_lease_tag(key_hash))
+		{
+			lease.claim.compare_exchange_strong(claim, 0,
+			                                    std::memory_order_release);
+		}
+	}
+
+	Statistics get_statistics() { return statistics; }
+
+	size_t get_number_of_entries()
+	{
+		size_t number_of_entries = 0;
+		for (size_t i = 0; region != nullptr && i <= bucket_mask; ++i)
+		{
+			uint64_t key_hash = 0;
+			uint64_t location = 0;
+			if (read_bucket(buckets[i], key_hash, location) &&
+			    is_live(location))
+			{
+				++number_of_entries;
+			}
+		}
+		return number_of_entries;
+	}
+} // namespace SharedCache
@@ -0,0 +1,51 @@
+#include "SingleFlight.hpp"
+
+#include <utility>
+
+namespace HTTP
+{
+	bool SingleFlight::join(const std::string& key, Callback callback)
+	{
+		std::vector<Callback>& callbacks = m_flights[key];
+		callbacks.push_back(std::move(callback));
+
+		if (callbacks.size() > 1)
+		{
+			++m_statistics.coalesced;
+			return false;
+		}
+
+		++m_statistics.flights;
+		return true;
+	}
+
+	void SingleFlight::land(const std::string& key, bool is_found,
+	                        const std::string& value)
+	{
+		auto flight = m_flights.find(key);
+		if (flight == m_flights.end())
+		{
+			return;
+		}
+
+		// callbacks may join the key again, or free what @b value refers to
+		std::vector<Callback> callbacks = std::move(flight->second);
+		m_flights.erase(flight);
+		const std::string result = is_found ? value : std::string();
+
+		for (const Callback& callback : callbacks)
+		{
+			callback(is_found, result);
+		}
+	}
+
+	bool SingleFlight::is_in_flight(const std::string& key) const
+	{
+		return m_flights.find(key) != m_flights.end();
+	}
+
+	SingleFlight::Statistics SingleFlight::get_statistics() const
+	{
+		return m_statistics;
+	}
+} // namespace HTTP
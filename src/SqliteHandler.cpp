@@ -1,116 +1,446 @@
 #include "SqliteHandler.hpp"
 #include "Cache.hpp"
+#include "CacheEntry.hpp"
 #include "Compressor.hpp"
+#include "DatabaseImage.hpp"
+#include "QueryNormalizer.hpp"
+#include "StatusHandler.hpp"
+#include "Timer.hpp"
 
+#include <algorithm>
 #include <stdexcept>
+
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #define get_uri connection->get_request()->get_request_uri()
 #define get_response connection->get_response()
 
 namespace
 {
-	std::string parse_content_type(const std::string& request_uri_path)
+	// How often the generation of the news is read, in milliseconds.
+	constexpr int64_t GENERATION_POLL_INTERVAL_MS = 1000;
+
+	// Searches that may wait for a search thread before the event loop
+	// runs them itself.
+	constexpr size_t SEARCH_QUEUE_CAPACITY = 64;
+
+	const char* const CREATE_USER_TABLE =
+	    "CREATE TABLE IF NOT EXISTS user_table("
+	    "user_name varchar(15),"
+	    "user_password text,"
+	    "user_age int,"
+	    "user_email text"
+	    ")";
+
+	const char* const SEARCH_NEWS =
+	    "SELECT snippet(news_index, 0, '<mark>', '</mark>', '...', 32), url,"
+	    "    publisher FROM news_index WHERE news_index MATCH :keyword"
+	    "    ORDER BY rank LIMIT 100";
+
+	/**
+	 * A counter bumped with every change to the news, in the transaction
+	 * of the change.
+	 */
+	const char* const CREATE_GENERATION_TABLE =
+	    "CREATE TABLE IF NOT EXISTS cache_generation(value INTEGER NOT NULL);"
+	    "INSERT INTO cache_generation SELECT 0"
+	    "    WHERE NOT EXISTS (SELECT * FROM cache_generation);";
+
+	const char* const CREATE_GENERATION_TRIGGERS =
+	    "CREATE TRIGGER IF NOT EXISTS bump_generation_after_insert_news"
+	    "    AFTER INSERT ON news"
+	    "    BEGIN UPDATE cache_generation SET value = value + 1; END;"
+	    "CREATE TRIGGER IF NOT EXISTS bump_generation_after_update_news"
+	    "    AFTER UPDATE ON news"
+	    "    BEGIN UPDATE cache_generation SET value = value + 1; END;"
+	    "CREATE TRIGGER IF NOT EXISTS bump_generation_after_delete_news"
+	    "    AFTER DELETE ON news"
+	    "    BEGIN UPDATE cache_generation SET value = value + 1; END;";
+
+	/**
+	 * The terms of the news index, in the temp schema so that the
+	 * database isn't written to.
+	 */
+	const char* const CREATE_VOCABULARY_TABLE =
+	    "CREATE VIRTUAL TABLE IF NOT EXISTS temp.news_vocabulary"
+	    "    USING fts5vocab(main, news_index, row);";
+
+	/**
+	 * Ask the kernel to read the whole file ahead, so that the first
+	 * searches of a worker don't wait for the disk page by page.
+	 */
+	void read_ahead(const std::string& file_path)
 	{
-		if (request_uri_path == "/")
+		int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd == -1)
 		{
-			return std::string("text/html");
+			return;
 		}
+		posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+		close(fd);
+	}
 
-		std::smatch match_result;
-
-		auto regex = std::regex("\\.([0-9a-zA-Z]+)$");
-
-		std::string file_extention;
-
-		if (std::regex_search(request_uri_path, match_result, regex))
-		{
-			file_extention = match_result[1].str();
-		}
-		else
+	/**
+	 * Open the news file read-only, without a mutex as connections aren't
+	 * shared between threads.
+	 *
+	 * @param[in] is_immutable
+	 *      Whether SQLite may assume that the file never changes, and skip
+	 *      locking it.
+	 *
+	 * @return
+	 *      Null if it can't be opened.
+	 */
+	sqlite3* open_file_for_reading(const std::string& database_path,
+	                               bool is_immutable)
+	{
+		std::string file_name = database_path;
+		int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+		if (is_immutable)
 		{
-			return std::string{};
+			file_name = "file:";
+			for (char c : database_path)
+			{
+				// the rest of the path is taken as is
+				if (c == '%' || c == '?' || c == '#')
+				{
+					char escaped[4]; // NOLINT
+					snprintf(escaped, sizeof(escaped), "%%%02X",
+					         static_cast<unsigned char>(c));
+					file_name += escaped;
+				}
+				else
+				{
+					file_name += c;
+				}
+			}
+			file_name += "?immutable=1";
+			flags |= SQLITE_OPEN_URI;
 		}
 
-		if (file_extention == "txt")
+		sqlite3* connection = nullptr;
+		if (sqlite3_open_v2(file_name.c_str(), &connection, flags, nullptr) !=
+		    SQLITE_OK)
 		{
-			return "text/plain";
+			Logger::error("can't open database for reading because " +
+			              std::string(sqlite3_errmsg(connection)));
+			sqlite3_close(connection);
+			return nullptr;
 		}
-		else if (file_extention == "html" || file_extention == "htm")
+		return connection;
+	}
+
+	/**
+	 * Open the news for searching only, from the DatabaseImage in the
+	 * "memory" profile, mapping the whole database and keeping temporary
+	 * tables in memory.
+	 *
+	 * @return
+	 *      Null if it can't be opened.
+	 */
+	sqlite3* open_for_reading(const std::string& database_path,
+	                          const std::string& profile)
+	{
+		sqlite3* connection = nullptr;
+		size_t database_size = 0;
+		if (profile == "memory" && DatabaseImage::is_loaded())
 		{
-			return "text/html";
+			connection = DatabaseImage::open();
+			database_size = DatabaseImage::get_size();
 		}
-		else if (file_extention == "css")
+		else
 		{
-			return "text/css";
+			if (profile == "memory")
+			{
+				Logger::info("no database image, searching the file");
+			}
+
+			connection = open_file_for_reading(database_path,
+			                                   profile == "immutable");
+			struct stat file_status;
+			if (stat(database_path.c_str(), &file_status) == 0)
+			{
+				database_size = static_cast<size_t>(file_status.st_size);
+			}
+			read_ahead(database_path);
 		}
-		else if (file_extention == "jpeg" || file_extention == "jpg")
+		if (connection == nullptr)
 		{
-			return "image/jpg";
+			return nullptr;
 		}
-		else if (file_extention == "png")
+
+		// the vocabulary table is created before query_only forbids it,
+		// even in the temp schema; an image mapped by SQLite is read in
+		// place rather than copied into its cache
+		const std::string pragmas =
+		    "PRAGMA mmap_size = " + std::to_string(database_size) + ";"
+		    "PRAGMA cache_size = -" +
+		    std::to_string(ServerConfiguration::instance()
+		                       ->get_database_cache_capacity() /
+		                   1024) +
+		    ";"
+		    "PRAGMA temp_store = MEMORY;" +
+		    CREATE_VOCABULARY_TABLE + "PRAGMA query_only = ON;";
+		if (sqlite3_exec(connection, pragmas.c_str(), nullptr, nullptr,
+		                 nullptr) != SQLITE_OK)
 		{
-			return "image/png";
+			Logger::warn("can not configure the database for reading "
+			             "because " +
+			             std::string(sqlite3_errmsg(connection)));
 		}
-		else if (file_extention == "gif")
+		return connection;
+	}
+
+	/**
+	 * Open the news for a search thread, like the searches of the event
+	 * loop are.
+	 *
+	 * @return
+	 *      Null if it can't be opened.
+	 */
+	sqlite3* open_search_connection(const std::string& database_path,
+	                                const std::string& profile)
+	{
+		if (profile != "read_write")
 		{
-			return "image/gif";
+			return open_for_reading(database_path, profile);
 		}
-		else if (file_extention == "svg")
+
+		sqlite3* connection = nullptr;
+		if (sqlite3_open_v2(database_path.c_str(), &connection,
+		                    SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX,
+		                    nullptr) != SQLITE_OK)
 		{
-			return "image/svg+xml";
+			Logger::error("can't open database for searching because " +
+			              std::string(sqlite3_errmsg(connection)));
+			sqlite3_close(connection);
+			return nullptr;
 		}
-		else if (file_extention == "ico")
+		return connection;
+	}
+
+	/**
+	 * Search the news for @b keyword with the statements of
+	 * @b statement_cache, on whichever thread uses its connection.
+	 */
+	std::vector<Sentence> run_search(HTTP::StatementCache& statement_cache,
+	                                 const std::string& keyword)
+	{
+		sqlite3_stmt* statement = statement_cache.get(SEARCH_NEWS);
+		if (statement == nullptr)
 		{
-			return "image/x-icon";
+			Logger::error("cannot prepare statement for keyword: " + keyword);
+			return {};
 		}
-		else if (file_extention == "json")
+
+		if (sqlite3_bind_text(statement,
+		                      sqlite3_bind_parameter_index(statement,
+		                                                   ":keyword"),
+		                      keyword.c_str(), -1,
+		                      SQLITE_TRANSIENT) != SQLITE_OK)
 		{
-			return "application/json";
+			Logger::error("cannot bind keyword: " + keyword +
+			              " to statement");
+			return {};
 		}
-		else if (file_extention == "pdf")
+
+		std::vector<Sentence> fetched_result;
+		while (sqlite3_step(statement) == SQLITE_ROW)
 		{
-			return "application/pdf";
+			Sentence sentence;
+			for (int i = 0; i < sqlite3_column_count(statement); ++i)
+			{
+				if (i == 0)
+				{
+					sentence.set_body(
+					    std::string(reinterpret_cast<const char*>(
+					        sqlite3_column_text(statement, i))));
+				}
+				else if (i == 1)
+				{
+					sentence.set_url(
+					    std::string(reinterpret_cast<const char*>(
+					        sqlite3_column_text(statement, i))));
+				}
+				else if (i == 2)
+				{
+					sentence.set_publisher(
+					    std::string(reinterpret_cast<const char*>(
+					        sqlite3_column_text(statement, i))));
+				}
+				else
+				{
+					break;
+				}
+			}
+			fetched_result.push_back(sentence);
 		}
-		else if (file_extention == "js")
+
+		sqlite3_reset(statement);
+		return fetched_result;
+	}
+
+	/**
+	 * Whether the news index splits text like the VocabularyFilter
+	 * splits queries, i.e. with the default tokenizer.
+	 */
+	bool has_default_tokenizer(sqlite3* connection)
+	{
+		sqlite3_stmt* statement = nullptr;
+		if (sqlite3_prepare_v2(connection,
+		                       "SELECT sql FROM sqlite_master "
+		                       "WHERE name = 'news_index'",
+		                       -1, &statement, nullptr) != SQLITE_OK)
 		{
-			return "application/javascript";
+			return false;
 		}
-		else if (file_extention == "wasm")
+
+		bool is_default = false;
+		if (sqlite3_step(statement) == SQLITE_ROW)
 		{
-			return "application/wasm";
+			std::string sql = reinterpret_cast<const char*>(
+			    sqlite3_column_text(statement, 0));
+			std::transform(sql.begin(), sql.end(), sql.begin(), ::tolower);
+			is_default = sql.find("tokenize") == std::string::npos;
 		}
-		else if (file_extention == "xml")
+		sqlite3_finalize(statement);
+		return is_default;
+	}
+
+	/**
+	 * @return
+	 *      The normalized "q" parameter of the request, empty without a
+	 *      query.
+	 */
+	std::string get_keyword(const std::shared_ptr<HTTP::Connection>& connection)
+	{
+		if (!connection->get_request()->has_query())
 		{
-			return "application/xml";
+			return "";
 		}
-		else if (file_extention == "xhtml")
+		return QueryNormalizer::normalize(get_uri->get_query_paramters()["q"]);
+	}
+
+	/**
+	 * Build the cache key of a search, which depends on nothing but the
+	 * keyword: variants of a query and other parameters share the entry.
+	 */
+	std::string make_search_key(
+	    const std::shared_ptr<HTTP::Connection>& connection,
+	    const std::string& keyword)
+	{
+		return HTTP::CacheEntry::make_key(*get_uri, {{"q", keyword}});
+	}
+
+	/**
+	 * Serialize a search result page for every content coding clients may
+	 * ask for, into one cache entry.
+	 */
+	std::string make_cache_entry(const std::string& page)
+	{
+		const std::string content_type = "text/html";
+		StatusHandler::PrebuiltResponse identity =
+		    StatusHandler::prebuild_response(200, content_type, page,
+		                                     {{"Vary", "Accept-Encoding"}});
+
+		std::vector<HTTP::CacheEntry::Variant> variants(1);
+		variants[0].encoding = HTTP::ContentEncoding::IDENTITY;
+		variants[0].message = identity.message.data();
+		variants[0].length = identity.message.size();
+		variants[0].date_offset = identity.date_offset;
+
+		StatusHandler::PrebuiltResponse deflate;
+		std::string compressed_page = Compressor::compress(page);
+		if (!compressed_page.empty())
 		{
-			return "application/xhtml+xml";
+			deflate = StatusHandler::prebuild_response(
+			    200, content_type, compressed_page,
+			    {{"Content-Encoding", "deflate"},
+			     {"Vary", "Accept-Encoding"}});
+
+			HTTP::CacheEntry::Variant variant;
+			variant.encoding = HTTP::ContentEncoding::DEFLATE;
+			variant.message = deflate.message.data();
+			variant.length = deflate.message.size();
+			variant.date_offset = deflate.date_offset;
+			variants.push_back(variant);
 		}
 
-		return std::string{};
+		return HTTP::CacheEntry::encode(variants);
+	}
+
+	/**
+	 * Find the variant of a cache entry in @b encoding, falling back to
+	 * the identity one.
+	 *
+	 * @return
+	 *      False if @b cache_entry is malformed.
+	 */
+	bool find_cache_variant(const std::string& cache_entry,
+	                        HTTP::ContentEncoding encoding,
+	                        HTTP::CacheEntry::Variant& variant)
+	{
+		return HTTP::CacheEntry::find_variant(cache_entry, encoding,
+		                                      variant) ||
+		       HTTP::CacheEntry::find_variant(
+		           cache_entry, HTTP::ContentEncoding::IDENTITY, variant);
 	}
 
-	std::string formalize_resource_path(const std::string& resource_path)
+	/**
+	 * Render the result page of a search into a cache entry.
+	 *
+	 * @return
+	 *      The cache entry, empty if nothing matches.
+	 */
+	std::string render_cache_entry(std::vector<Sentence>& sentences)
 	{
-		if (resource_path == "/")
+		if (sentences.empty())
 		{
-			return std::string{};
+			return "";
 		}
 
-		if (resource_path[0] == '/')
+		std::string buffer = {"<!DOCTYPE html>"
+		                      "<html lang=\"en\">"
+		                      "<head>"
+		                      "<meta charset=\"utf-8\">"
+		                      "<title>Query Result</title>"
+		                      "<style>"
+		                      ".publisher {"
+		                      "position: absolute;"
+		                      "right: 50px"
+		                      "}"
+		                      "</style>"
+		                      "</head>"
+		                      "<body>"
+		                      "<div>"
+		                      "<a href=\"/\">Search Again</a>"
+		                      "</div>"
+		                      "<ul>"};
+
+		for (auto& sentence : sentences)
 		{
-			return resource_path.substr(1);
+			if (sentence.get_url().empty())
+			{
+				sentence.set_url("http://101.200.88.170/");
+			}
+			if (sentence.get_publisher().empty())
+			{
+				sentence.set_publisher("Unknown");
+			}
+
+			buffer += "<li>" + sentence.get_body() + "</li>";
+			buffer += "<a class='publisher' href=" + sentence.get_url() +
+			          ">" + sentence.get_publisher() + "</a>";
+			buffer += "<br>";
 		}
 
-		return resource_path;
-	}
+		buffer += {"</ul>"
+		           "</body>"
+		           "</html>"};
 
-	bool is_resource_exists(const std::string& resource_path)
-	{
-		struct stat resource_buffer;
-		return stat(resource_path.c_str(), &resource_buffer) == 0;
+		return make_cache_entry(buffer);
 	}
 } // namespace
 
@@ -124,81 +454,144 @@ UserInfo::UserInfo(std::string name, std::string password, std::string age,
 }
 
 SqliteHandler::SqliteHandler()
-    : m_cache{new HTTP::Cache(16)}
-    , m_resource_root_directory_path{
-          ServerConfiguration::instance()->get_resource_directory_path()}
+    : SqliteHandler(std::make_shared<HTTP::Cache>(16))
+{
+}
+
+SqliteHandler::SqliteHandler(std::shared_ptr<HTTP::Cache> cache,
+                             const HTTP::Freshness& freshness)
+    : m_statement_cache{std::make_shared<HTTP::StatementCache>()}
+    , m_cache{std::move(cache)}
+    , m_freshness{freshness}
 {
-	if (sqlite3_open(
-	        ServerConfiguration::instance()->get_database_path().c_str(),
-	        &m_connection) != SQLITE_OK)
+	const std::string database_path =
+	    ServerConfiguration::instance()->get_database_path();
+	const std::string profile =
+	    ServerConfiguration::instance()->get_database_profile();
+	const bool is_read_only = profile == "read_only" ||
+	                          profile == "immutable" || profile == "memory";
+	if (!is_read_only && profile != "read_write")
+	{
+		Logger::warn("unknown database profile: " + profile);
+	}
+
+	// the connection for writes, in read-only profiles
+	if (sqlite3_open(database_path.c_str(), &m_connection) != SQLITE_OK)
 	{
 		Logger::error("can't connect to database based on given path: " +
-		              ServerConfiguration::instance()->get_database_path());
+		              database_path);
 		throw std::runtime_error(
 		    "can't connect to database based on given path: " +
-		    ServerConfiguration::instance()->get_database_path());
+		    database_path);
 	}
 
-	std::string create_user_table{"CREATE TABLE IF NOT EXISTS user_table("
-	                              "user_name varchar(15),"
-	                              "user_password text,"
-	                              "user_age int,"
-	                              "user_email text"
-	                              ")"};
+	// run once, so not worth caching
+	if (sqlite3_exec(m_connection, CREATE_USER_TABLE, nullptr, nullptr,
+	                 nullptr) != SQLITE_OK)
+	{
+		Logger::error("can not execute statement because " +
+		              std::string(sqlite3_errmsg(m_connection)));
+	}
 
-	if (!prepare_statement(create_user_table))
+	// cached results are only as current as the generation they were
+	// searched at
+	if (sqlite3_exec(m_connection, CREATE_GENERATION_TABLE, nullptr, nullptr,
+	                 nullptr) != SQLITE_OK ||
+	    sqlite3_exec(m_connection, CREATE_GENERATION_TRIGGERS, nullptr,
+	                 nullptr, nullptr) != SQLITE_OK)
 	{
-		Logger::error("Can create user table within database.");
+		Logger::warn("can not track the generation of the news because " +
+		             std::string(sqlite3_errmsg(m_connection)));
 	}
 
-	if (sqlite3_step(m_statement) != SQLITE_DONE)
+	// searches don't write, so they go through a connection tuned for
+	// reading
+	if (is_read_only)
 	{
-		Logger::error("can not execute statement because " +
-		              std::string(sqlite3_errmsg(m_connection)));
+		m_write_connection = m_connection;
+		m_connection = open_for_reading(database_path, profile);
+		if (m_connection == nullptr)
+		{
+			sqlite3_close(m_write_connection);
+			throw std::runtime_error(
+			    "can't open database for reading based on given path: " +
+			    database_path);
+		}
+		m_write_statement_cache.attach(m_write_connection);
 	}
+	m_statement_cache->attach(m_connection);
 
-	sqlite3_reset(m_statement);
+	if (sqlite3_prepare_v2(m_connection, "SELECT value FROM cache_generation",
+	                       -1, &m_generation_statement,
+	                       nullptr) != SQLITE_OK)
+	{
+		m_generation_statement = nullptr;
+	}
 
-	if (sqlite3_step(m_statement) != SQLITE_DONE)
+	m_vocabulary_filter_path =
+	    ServerConfiguration::instance()->get_vocabulary_filter_path();
+	if (!m_vocabulary_filter_path.empty() &&
+	    !has_default_tokenizer(m_connection))
 	{
-		Logger::error("can not execute statement because " +
-		              std::string(sqlite3_errmsg(m_connection)));
+		Logger::info("no vocabulary filter for the tokenizer of the news");
+		m_vocabulary_filter_path.clear();
 	}
 
-	sqlite3_reset(m_statement);
-}
+	m_generation_read_at = Timer::get_coarse_monotonic_milliseconds() -
+	                       GENERATION_POLL_INTERVAL_MS;
+	refresh_generation();
 
-SqliteHandler::~SqliteHandler()
-{
-	if (m_statement)
+	// searches wait for SQLite on threads of their own, rather than
+	// stalling every connection of the event loop
+	const size_t number_of_search_threads =
+	    ServerConfiguration::instance()->get_search_threads();
+	for (size_t i = 0; i < number_of_search_threads; ++i)
 	{
-		sqlite3_finalize(m_statement);
+		sqlite3* search_connection =
+		    open_search_connection(database_path, profile);
+		if (search_connection == nullptr)
+		{
+			break;
+		}
+		auto statement_cache = std::make_shared<HTTP::StatementCache>();
+		statement_cache->attach(search_connection);
+		m_search_contexts.push_back(
+		    SearchContext{search_connection, std::move(statement_cache)});
 	}
-	if (m_connection)
+	if (!m_search_contexts.empty())
 	{
-		sqlite3_close(m_connection);
+		m_search_pool.reset(new HTTP::ThreadPool(m_search_contexts.size(),
+		                                         SEARCH_QUEUE_CAPACITY));
 	}
-
-	sqlite3_shutdown();
 }
 
-SqliteHandler::SqliteHandler(const SqliteHandler& other)
+SqliteHandler::~SqliteHandler()
 {
-	if (this != &other)
+	// the threads may still be searching their connections
+	m_search_pool.reset();
+	for (SearchContext& search_context : m_search_contexts)
 	{
-		m_connection = other.m_connection;
-		m_statement = other.m_statement;
+		search_context.statement_cache->attach(nullptr);
+		sqlite3_close(search_context.connection);
 	}
-}
 
-SqliteHandler& SqliteHandler::operator=(const SqliteHandler& other)
-{
-	if (this != &other)
+	// a connection with statements left can't be closed
+	m_statement_cache->attach(nullptr);
+	m_write_statement_cache.attach(nullptr);
+	if (m_generation_statement)
 	{
-		m_connection = other.m_connection;
-		m_statement = other.m_statement;
+		sqlite3_finalize(m_generation_statement);
 	}
-	return *this;
+	if (m_connection)
+	{
+		sqlite3_close(m_connection);
+	}
+	if (m_write_connection)
+	{
+		sqlite3_close(m_write_connection);
+	}
+
+	sqlite3_shutdown();
 }
 
 bool SqliteHandler::has_table(const std::string& table_name)
@@ -268,7 +661,7 @@ bool SqliteHandler::add_new_user(const UserInfo& user_info)
 	std::string statement = "INSERT INTO user_table VALUES(:user_name, "
 	                        ":user_password, :user_age, :user_email)";
 
-	if (!prepare_statement(statement))
+	if (!prepare_statement(statement, true))
 	{
 		return false;
 	}
@@ -383,6 +776,7 @@ SqliteHandler::fetch_user_info(const std::string& user_name,
 		fetch_result.push_back(single_user_info);
 	}
 
+	sqlite3_reset(m_statement);
 	return fetch_result;
 }
 
@@ -400,7 +794,7 @@ bool SqliteHandler::delete_user(const UserInfo& user_info)
 	                      "user_age = :user_age AND "
 	                      "user_email = :user_email"};
 
-	if (!prepare_statement(statement))
+	if (!prepare_statement(statement, true))
 	{
 		return false;
 	}
@@ -436,19 +830,14 @@ bool SqliteHandler::delete_user(const UserInfo& user_info)
 	return true;
 }
 
-bool SqliteHandler::prepare_statement(const std::string& statement)
+bool SqliteHandler::prepare_statement(const std::string& statement,
+                                      bool is_write)
 {
-	int result = 0;
-	result = sqlite3_prepare_v2(m_connection, statement.c_str(), -1,
-	                            &m_statement, nullptr);
-	if (result != SQLITE_OK)
-	{
-		Logger::error("Error in preparing statement because " +
-		              std::string(sqlite3_errmsg(m_connection)));
-		sqlite3_reset(m_statement);
-		return false;
-	}
-	return true;
+	HTTP::StatementCache& statement_cache =
+	    is_write && m_write_connection != nullptr ? m_write_statement_cache
+	                                              : *m_statement_cache;
+	m_statement = statement_cache.get(statement);
+	return m_statement != nullptr;
 }
 
 bool SqliteHandler::bind_text_data(const std::string& placeholder,
@@ -461,8 +850,9 @@ bool SqliteHandler::bind_text_data(const std::string& placeholder,
 	                                data.c_str(), -1, SQLITE_TRANSIENT)) !=
 	    SQLITE_OK)
 	{
-		Logger::error("Error in binding data because " +
-		              std::string(sqlite3_errmsg(m_connection)));
+		Logger::error(
+		    "Error in binding data because " +
+		    std::string(sqlite3_errmsg(sqlite3_db_handle(m_statement))));
 		sqlite3_reset(m_statement);
 		return false;
 	}
@@ -474,177 +864,297 @@ std::vector<Sentence> SqliteHandler::search_sentence(const std::string& keyword)
 	if (keyword.empty())
 		return {};
 
-	std::string statement{"SELECT snippet(news_index, 0, '<mark>', '</mark>', "
-	                      "'...', 32), url, publisher FROM news_index WHERE "
-	                      "news_index MATCH :keyword ORDER BY rank LIMIT 100"};
-
-	if (!prepare_statement(statement))
+	// a word that occurs nowhere in the news can't match
+	if (!m_vocabulary_filter.may_match(keyword))
 	{
-		Logger::error("cannot prepare statement for keyword: " + keyword);
+		Logger::debug("unknown term in query: " + keyword);
 		return {};
 	}
 
-	if (!bind_text_data(":keyword", keyword))
+	return run_search(*m_statement_cache, keyword);
+}
+
+void SqliteHandler::attach(int epoll_fd)
+{
+	if (m_search_pool)
 	{
-		Logger::error("cannot bind keyword: " + keyword + " to statement");
-		return {};
+		m_search_pool->attach(epoll_fd);
 	}
+}
 
-	std::vector<Sentence> fetched_result;
-	while (sqlite3_step(m_statement) == SQLITE_ROW)
+bool SqliteHandler::handle_events(int fd, uint32_t events)
+{
+	return m_search_pool && m_search_pool->handle_events(fd, events);
+}
+
+std::vector<std::shared_ptr<const HTTP::StatementCache>>
+SqliteHandler::get_statement_caches() const
+{
+	std::vector<std::shared_ptr<const HTTP::StatementCache>> statement_caches{
+	    m_statement_cache};
+	for (const SearchContext& search_context : m_search_contexts)
 	{
-		Sentence sentence;
-		for (int i = 0; i < sqlite3_column_count(m_statement); ++i)
-		{
-			if (i == 0)
-			{
-				sentence.set_body(std::string(reinterpret_cast<const char*>(
-				    sqlite3_column_text(m_statement, i))));
-			}
-			else if (i == 1)
-			{
-				sentence.set_url(std::string(reinterpret_cast<const char*>(
-				    sqlite3_column_text(m_statement, i))));
-			}
-			else if (i == 2)
-			{
-				sentence.set_publisher(
-				    std::string(reinterpret_cast<const char*>(
-				        sqlite3_column_text(m_statement, i))));
-			}
-			else
-			{
-				break;
-			}
-		}
-		fetched_result.push_back(sentence);
+		statement_caches.push_back(search_context.statement_cache);
 	}
-
-	return fetched_result;
+	return statement_caches;
 }
 
 bool SqliteHandler::fetch_resource(std::shared_ptr<HTTP::Connection> connection)
 {
-	std::string buffer;
+	// one entry per resource holds a response for each content coding
+	HTTP::ContentEncoding encoding = HTTP::CacheEntry::negotiate_encoding(
+	    connection->get_request()->get_header("Accept-Encoding"));
+	const std::string keyword = get_keyword(connection);
+	std::string cache_key = make_search_key(connection, keyword);
+
+	refresh_generation();
+	if (m_cache->is_known_missing(cache_key))
+	{
+		Logger::debug("negative cache hit: " + get_uri->get_query());
+		return false;
+	}
 
-	std::string cache_lookup_result =
-	    m_cache->get(connection->get_request()->get_request_uri_string());
+	std::string cache_entry = m_cache->get(cache_key);
 
 	// if cache hit, don't query databse.
-	if (!cache_lookup_result.empty())
+	if (!cache_entry.empty())
 	{
 		Logger::debug("cache hit: " + get_uri->get_query());
 
-		get_response->deserialize(cache_lookup_result);
+		return send_cache_entry(connection, std::move(cache_entry), encoding);
+	}
 
-		return true;
+	cache_entry = build_cache_entry(keyword);
+	if (cache_entry.empty())
+	{
+		m_cache->insert_missing(cache_key);
+		return false;
 	}
 
-	if (connection->get_request()->has_query())
+	m_cache->insert(cache_key, cache_entry, m_freshness);
+	return send_cache_entry(connection, std::move(cache_entry), encoding);
+}
+
+void SqliteHandler::fetch_resource_async(
+    std::shared_ptr<HTTP::Connection> connection, FetchCallback callback)
+{
+	HTTP::ContentEncoding encoding = HTTP::CacheEntry::negotiate_encoding(
+	    connection->get_request()->get_header("Accept-Encoding"));
+	const std::string keyword = get_keyword(connection);
+	std::string cache_key = make_search_key(connection, keyword);
+
+	HTTP::SingleFlight::Callback answer =
+	    [this, connection, encoding, callback](bool is_found,
+	                                           const std::string& cache_entry) {
+		    callback(is_found &&
+		             send_cache_entry(connection, cache_entry, encoding));
+	    };
+
+	refresh_generation();
+	if (m_cache->is_known_missing(cache_key))
 	{
-		Logger::info("user query: " + get_uri->get_query_paramters()["q"]);
+		Logger::debug("negative cache hit: " + get_uri->get_query());
+		callback(false);
+		return;
+	}
 
-		auto sentences = search_sentence(get_uri->get_query_paramters()["q"]);
+	// a stampede on one key costs a single lookup and search
+	if (!m_single_flight.join(cache_key, std::move(answer)))
+	{
+		return;
+	}
 
-		if (sentences.empty())
+	// Redis misses are looked up here once it replies
+	m_cache->get(cache_key, [this, connection, keyword, cache_key](
+	                            HTTP::Cache::Lookup lookup,
+	                            const std::string& cache_entry) {
+		if (lookup == HTTP::Cache::Lookup::HIT)
 		{
-			return false;
+			Logger::debug("cache hit: " + get_uri->get_query());
+			m_single_flight.land(cache_key, true, cache_entry);
+			return;
 		}
 
-		buffer = {"<!DOCTYPE html>"
-		          "<html lang=\"en\">"
-		          "<head>"
-		          "<meta charset=\"utf-8\">"
-		          "<title>Query Result</title>"
-		          "<style>"
-		          ".publisher {"
-		          "position: absolute;"
-		          "right: 50px"
-		          "}"
-		          "</style>"
-		          "</head>"
-		          "<body>"
-		          "<div>"
-		          "<a href=\"/\">Search Again</a>"
-		          "</div>"
-		          "<ul>"};
-
-		int i = 0;
-		for (auto& sentence : sentences)
+		if (lookup == HTTP::Cache::Lookup::REVALIDATE)
 		{
-			if (sentence.get_url().empty())
-			{
-				sentence.set_url("http://101.200.88.170/");
-			}
-			if (sentence.get_publisher().empty())
-			{
-				sentence.set_publisher("Unknown");
-			}
-
-			buffer += "<li>" + sentence.get_body() + "</li>";
-			buffer += "<a class='publisher' href=" + sentence.get_url() + ">" +
-			          sentence.get_publisher() + "</a>";
-			buffer += "<br>";
+			Logger::debug("cache revalidate: " + get_uri->get_query());
+			m_single_flight.land(cache_key, true, cache_entry);
 		}
 
-		buffer += {"</ul>"
-		           "</body>"
-		           "</html>"};
+		auto insert_result =
+		    [this, cache_key, lookup](const std::string& new_cache_entry) {
+			    if (new_cache_entry.empty())
+			    {
+				    // don't serve the stale page of a search without results
+				    if (lookup == HTTP::Cache::Lookup::REVALIDATE)
+				    {
+					    m_cache->erase(cache_key);
+				    }
+				    m_cache->insert_missing(cache_key);
+				    if (lookup == HTTP::Cache::Lookup::MISS)
+				    {
+					    m_single_flight.land(cache_key, false,
+					                         new_cache_entry);
+				    }
+				    return;
+			    }
+
+			    m_cache->insert(cache_key, new_cache_entry, m_freshness);
+			    if (lookup == HTTP::Cache::Lookup::MISS)
+			    {
+				    m_single_flight.land(cache_key, true, new_cache_entry);
+			    }
+		    };
+		build_cache_entry_async(keyword, insert_result);
+	});
+}
 
-		get_response->set_content_type("text/html");
+std::string SqliteHandler::build_cache_entry(const std::string& keyword)
+{
+	if (keyword.empty())
+	{
+		return "";
 	}
-	else // client requests files
+
+	Logger::info("user query: " + keyword);
+
+	auto sentences = search_sentence(keyword);
+	return render_cache_entry(sentences);
+}
+
+void SqliteHandler::build_cache_entry_async(
+    const std::string& keyword,
+    const std::function<void(const std::string&)>& callback)
+{
+	// the vocabulary filter is reloaded on the event loop, so is only
+	// read there
+	if (!m_search_pool || keyword.empty() ||
+	    !m_vocabulary_filter.may_match(keyword))
 	{
-		std::string resource_absolute_path;
+		callback(build_cache_entry(keyword));
+		return;
+	}
 
-		if (get_uri->get_path_string() == "/")
-		{
-			resource_absolute_path =
-			    m_resource_root_directory_path + "index.html";
-		}
-		else
-		{
-			resource_absolute_path =
-			    m_resource_root_directory_path +
-			    formalize_resource_path(get_uri->get_path_string());
-		}
+	Logger::info("user query: " + keyword);
+
+	// written by the search thread before the loop is woken
+	auto cache_entry = std::make_shared<std::string>();
+	if (m_search_pool->submit(
+	        [this, keyword, cache_entry](size_t thread_index) {
+		        auto sentences = run_search(
+		            *m_search_contexts[thread_index].statement_cache, keyword);
+		        *cache_entry = render_cache_entry(sentences);
+	        },
+	        [cache_entry, callback]() { callback(*cache_entry); }))
+	{
+		return;
+	}
 
-		if (!is_resource_exists(resource_absolute_path))
-		{
-			Logger::info("resource [" + resource_absolute_path +
-			             "] doesn't exist.");
-			return false;
-		}
+	// every thread is busy and the queue is full
+	auto sentences = run_search(*m_statement_cache, keyword);
+	callback(render_cache_entry(sentences));
+}
 
-		std::ifstream resource(resource_absolute_path, std::ios_base::binary);
-		if (!resource.is_open())
-			return false;
+bool SqliteHandler::send_cache_entry(
+    const std::shared_ptr<HTTP::Connection>& connection,
+    const std::string& cache_entry, HTTP::ContentEncoding encoding)
+{
+	HTTP::CacheEntry::Variant variant;
+	if (!find_cache_variant(cache_entry, encoding, variant))
+	{
+		Logger::error("malformed cache entry: " + get_uri->get_query());
+		return false;
+	}
 
-		resource.seekg(0, std::ios_base::end);
-		auto resource_size = resource.tellg();
-		resource.seekg(0);
+	get_response->clear_up();
+	get_response->set_status(200);
+	get_response->set_serialized_message(variant.message, variant.length,
+	                                     variant.date_offset);
+	return true;
+}
 
-		buffer.resize(static_cast<size_t>(resource_size));
+bool SqliteHandler::send_cache_entry(
+    const std::shared_ptr<HTTP::Connection>& connection,
+    std::string&& cache_entry, HTTP::ContentEncoding encoding)
+{
+	HTTP::CacheEntry::Variant variant;
+	if (!find_cache_variant(cache_entry, encoding, variant))
+	{
+		Logger::error("malformed cache entry: " + get_uri->get_query());
+		return false;
+	}
 
-		resource.read(&buffer[0], static_cast<std::streamsize>(resource_size));
+	size_t offset = static_cast<size_t>(variant.message - cache_entry.data());
+	get_response->clear_up();
+	get_response->set_status(200);
+	get_response->set_serialized_message(std::move(cache_entry), offset,
+	                                     variant.length, variant.date_offset);
+	return true;
+}
 
-		get_response->set_content_type(
-		    parse_content_type(get_uri->get_path_string()));
+void SqliteHandler::refresh_generation()
+{
+	int64_t now = Timer::get_coarse_monotonic_milliseconds();
+	if (now - m_generation_read_at < GENERATION_POLL_INTERVAL_MS)
+	{
+		return;
 	}
+	m_generation_read_at = now;
 
-	// if client requests compressed data
-	if (connection->get_request()
-	        ->get_header("Accept-Encoding")
-	        .find("deflate") != std::string::npos)
+	if (m_generation_statement != nullptr)
 	{
-		buffer = Compressor::compress(buffer);
-		get_response->add_header("Content-Encoding", "deflate");
+		if (sqlite3_step(m_generation_statement) == SQLITE_ROW)
+		{
+			m_cache->set_generation(static_cast<uint64_t>(
+			    sqlite3_column_int64(m_generation_statement, 0)));
+		}
+		sqlite3_reset(m_generation_statement);
 	}
 
-	get_response->set_body(buffer);
+	refresh_vocabulary_filter();
+}
 
-	m_cache->insert(connection->get_request()->get_request_uri_string(),
-	                get_response->serialize_headers() + buffer);
+void SqliteHandler::refresh_vocabulary_filter()
+{
+	if (m_vocabulary_filter_path.empty())
+	{
+		return;
+	}
 
-	return true;
+	m_vocabulary_filter.load(m_vocabulary_filter_path,
+	                         m_cache->get_generation(),
+	                         [this](std::vector<uint64_t>& term_hashes) {
+		                         return read_vocabulary(term_hashes);
+	                         });
+}
+
+bool SqliteHandler::read_vocabulary(std::vector<uint64_t>& term_hashes)
+{
+	sqlite3_stmt* statement = nullptr;
+	if (sqlite3_exec(m_connection, CREATE_VOCABULARY_TABLE, nullptr, nullptr,
+	                 nullptr) != SQLITE_OK ||
+	    sqlite3_prepare_v2(m_connection,
+	                       "SELECT term FROM temp.news_vocabulary", -1,
+	                       &statement, nullptr) != SQLITE_OK)
+	{
+		Logger::warn("can not read the vocabulary of the news because " +
+		             std::string(sqlite3_errmsg(m_connection)));
+		return false;
+	}
+
+	int result = 0;
+	while ((result = sqlite3_step(statement)) == SQLITE_ROW)
+	{
+		term_hashes.push_back(HTTP::VocabularyFilter::hash_term(
+		    reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)),
+		    static_cast<size_t>(sqlite3_column_bytes(statement, 0))));
+	}
+	if (result != SQLITE_DONE)
+	{
+		Logger::warn("can not read the vocabulary of the news because " +
+		             std::string(sqlite3_errmsg(m_connection)));
+	}
+
+	sqlite3_finalize(statement);
+	return result == SQLITE_DONE;
 }
@@ -0,0 +1,102 @@
+#include "StatementCache.hpp"
+#include "Logger.hpp"
+
+#include <chrono>
+
+namespace HTTP
+{
+	StatementCache::StatementCache(size_t capacity)
+	    : m_capacity{capacity != 0 ? capacity : 1}
+	{
+	}
+
+	StatementCache::~StatementCache() { clear(); }
+
+	void StatementCache::attach(sqlite3* connection)
+	{
+		clear();
+		m_connection = connection;
+	}
+
+	sqlite3_stmt* StatementCache::get(const std::string& sql)
+	{
+		auto found = m_index.find(sql);
+		if (found != m_index.end())
+		{
+			m_hits.fetch_add(1, std::memory_order_relaxed);
+			m_entries.splice(m_entries.begin(), m_entries, found->second);
+
+			sqlite3_stmt* statement = found->second->second;
+			sqlite3_reset(statement);
+			sqlite3_clear_bindings(statement);
+			return statement;
+		}
+
+		m_misses.fetch_add(1, std::memory_order_relaxed);
+		if (m_connection == nullptr)
+		{
+			return nullptr;
+		}
+
+		// kept until evicted, which persistent statements are meant for
+		sqlite3_stmt* statement = nullptr;
+		auto start = std::chrono::steady_clock::now();
+		int result =
+		    sqlite3_prepare_v3(m_connection, sql.c_str(), -1,
+		                       SQLITE_PREPARE_PERSISTENT, &statement, nullptr);
+		m_prepare_microseconds.fetch_add(
+		    static_cast<uint64_t>(
+		        std::chrono::duration_cast<std::chrono::microseconds>(
+		            std::chrono::steady_clock::now() - start)
+		            .count()),
+		    std::memory_order_relaxed);
+		if (result != SQLITE_OK || statement == nullptr)
+		{
+			Logger::error("Error in preparing statement because " +
+			              std::string(sqlite3_errmsg(m_connection)));
+			sqlite3_finalize(statement);
+			return nullptr;
+		}
+
+		if (m_entries.size() == m_capacity)
+		{
+			m_evictions.fetch_add(1, std::memory_order_relaxed);
+			sqlite3_finalize(m_entries.back().second);
+			m_index.erase(m_entries.back().first);
+			m_entries.pop_back();
+		}
+
+		m_entries.emplace_front(sql, statement);
+		m_index[sql] = m_entries.begin();
+		m_number_of_statements.store(m_entries.size(),
+		                             std::memory_order_relaxed);
+		return statement;
+	}
+
+	void StatementCache::clear()
+	{
+		for (Entry& entry : m_entries)
+		{
+			sqlite3_finalize(entry.second);
+		}
+		m_entries.clear();
+		m_index.clear();
+		m_number_of_statements.store(0, std::memory_order_relaxed);
+	}
+
+	size_t StatementCache::get_number_of_statements() const
+	{
+		return m_number_of_statements.load(std::memory_order_relaxed);
+	}
+
+	StatementCache::Statistics StatementCache::get_statistics() const
+	{
+		Statistics statistics;
+		statistics.hits = m_hits.load(std::memory_order_relaxed);
+		statistics.misses = m_misses.load(std::memory_order_relaxed);
+		statistics.evictions = m_evictions.load(std::memory_order_relaxed);
+		statistics.prepare_microseconds =
+		    m_prepare_microseconds.load(std::memory_order_relaxed);
+		return statistics;
+	}
+} // namespace HTTP
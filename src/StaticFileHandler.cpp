@@ -0,0 +1,359 @@
+#include "StaticFileHandler.hpp"
+#include "CacheEntry.hpp"
+#include "Compressor.hpp"
+#include "Logger.hpp"
+#include "ServerConfiguration.hpp"
+#include "Sha1.hpp"
+
+#include <fstream>
+#include <regex>
+#include <vector>
+
+#define get_uri connection->get_request()->get_request_uri()
+#define get_response connection->get_response()
+
+namespace
+{
+	std::string parse_content_type(const std::string& request_uri_path)
+	{
+		if (request_uri_path == "/")
+		{
+			return std::string("text/html");
+		}
+
+		std::smatch match_result;
+
+		auto regex = std::regex("\\.([0-9a-zA-Z]+)$");
+
+		std::string file_extention;
+
+		if (std::regex_search(request_uri_path, match_result, regex))
+		{
+			file_extention = match_result[1].str();
+		}
+		else
+		{
+			return std::string{};
+		}
+
+		if (file_extention == "txt")
+		{
+			return "text/plain";
+		}
+		else if (file_extention == "html" || file_extention == "htm")
+		{
+			return "text/html";
+		}
+		else if (file_extention == "css")
+		{
+			return "text/css";
+		}
+		else if (file_extention == "jpeg" || file_extention == "jpg")
+		{
+			return "image/jpg";
+		}
+		else if (file_extention == "png")
+		{
+			return "image/png";
+		}
+		else if (file_extention == "gif")
+		{
+			return "image/gif";
+		}
+		else if (file_extention == "svg")
+		{
+			return "image/svg+xml";
+		}
+		else if (file_extention == "ico")
+		{
+			return "image/x-icon";
+		}
+		else if (file_extention == "json")
+		{
+			return "application/json";
+		}
+		else if (file_extention == "pdf")
+		{
+			return "application/pdf";
+		}
+		else if (file_extention == "js")
+		{
+			return "application/javascript";
+		}
+		else if (file_extention == "wasm")
+		{
+			return "application/wasm";
+		}
+		else if (file_extention == "xml")
+		{
+			return "application/xml";
+		}
+		else if (file_extention == "xhtml")
+		{
+			return "application/xhtml+xml";
+		}
+
+		return std::string{};
+	}
+
+	std::string formalize_resource_path(const std::string& resource_path)
+	{
+		if (resource_path == "/")
+		{
+			return std::string{};
+		}
+
+		if (resource_path[0] == '/')
+		{
+			return resource_path.substr(1);
+		}
+
+		return resource_path;
+	}
+
+	/**
+	 * Hash a file chunk by chunk, so that tagging it takes a fixed buffer
+	 * however large it is.
+	 *
+	 * @param[in] resource_path
+	 *      Path of the file.
+	 *
+	 * @param[out] etag
+	 *      Strong entity tag: the quoted SHA-1 digest of the content.
+	 *
+	 * @return
+	 *      True if succeeds.
+	 */
+	bool hash_resource(const std::string& resource_path, std::string& etag)
+	{
+		constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+		std::ifstream resource(resource_path, std::ios_base::binary);
+		if (!resource.is_open())
+		{
+			return false;
+		}
+
+		Sha1::Hasher hasher;
+		std::vector<char> chunk(CHUNK_SIZE);
+		while (resource)
+		{
+			resource.read(chunk.data(),
+			              static_cast<std::streamsize>(CHUNK_SIZE));
+			hasher.update(chunk.data(),
+			              static_cast<size_t>(resource.gcount()));
+		}
+		if (resource.bad())
+		{
+			return false;
+		}
+
+		uint8_t digest[Sha1::DIGEST_SIZE];
+		hasher.final(digest);
+		etag = '"' + Sha1::digest_to_hex_string(digest) + '"';
+		return true;
+	}
+
+	/**
+	 * Read a whole file.
+	 *
+	 * @param[in] size
+	 *      Size of the file.
+	 *
+	 * @return
+	 *      True if succeeds.
+	 */
+	bool read_resource(const std::string& resource_path, size_t size,
+	                   std::string& content)
+	{
+		std::ifstream resource(resource_path, std::ios_base::binary);
+		if (!resource.is_open())
+		{
+			return false;
+		}
+
+		content.resize(size);
+		resource.read(&content[0], static_cast<std::streamsize>(size));
+		content.resize(static_cast<size_t>(resource.gcount()));
+		return !resource.bad();
+	}
+
+	/**
+	 * Tag the representation of a file in a content coding: the deflated
+	 * one gets its own entity tag, as its bytes differ.
+	 */
+	std::string get_coded_etag(const std::string& etag,
+	                           HTTP::ContentEncoding encoding)
+	{
+		if (encoding != HTTP::ContentEncoding::DEFLATE)
+		{
+			return etag;
+		}
+		return etag.substr(0, etag.size() - 1) + "-deflate\"";
+	}
+
+	/**
+	 * Whether an If-None-Match header value is "*" or lists @b etag, with
+	 * the weak comparison it calls for: "W/" prefixes don't matter.
+	 */
+	bool is_etag_matched(const std::string& if_none_match,
+	                     const std::string& etag)
+	{
+		size_t begin = 0;
+		while (begin < if_none_match.size())
+		{
+			size_t end = if_none_match.find(',', begin);
+			if (end == std::string::npos)
+			{
+				end = if_none_match.size();
+			}
+
+			size_t first = if_none_match.find_first_not_of(" \t", begin);
+			size_t last = if_none_match.find_last_not_of(" \t", end - 1);
+			if (first < end && last != std::string::npos && last >= first)
+			{
+				std::string candidate =
+				    if_none_match.substr(first, last - first + 1);
+				if (candidate.compare(0, 2, "W/") == 0)
+				{
+					candidate.erase(0, 2);
+				}
+				if (candidate == "*" || candidate == etag)
+				{
+					return true;
+				}
+			}
+
+			begin = end + 1;
+		}
+		return false;
+	}
+} // namespace
+
+StaticFileHandler::StaticFileHandler()
+    : StaticFileHandler(
+          ServerConfiguration::instance()->get_resource_directory_path())
+{
+}
+
+StaticFileHandler::StaticFileHandler(std::string resource_root_directory_path)
+    : m_resource_root_directory_path{std::move(resource_root_directory_path)}
+{
+}
+
+bool StaticFileHandler::fetch_resource(
+    std::shared_ptr<HTTP::Connection> connection)
+{
+	// never serve anything outside of the resource directory
+	for (const auto& segment : get_uri->get_path_segments())
+	{
+		if (segment == "..")
+		{
+			return false;
+		}
+	}
+
+	std::string resource_absolute_path;
+
+	if (get_uri->get_path_string() == "/")
+	{
+		resource_absolute_path = m_resource_root_directory_path + "index.html";
+	}
+	else
+	{
+		resource_absolute_path =
+		    m_resource_root_directory_path +
+		    formalize_resource_path(get_uri->get_path_string());
+	}
+
+	struct stat file_status;
+	if (stat(resource_absolute_path.c_str(), &file_status) != 0 ||
+	    !S_ISREG(file_status.st_mode))
+	{
+		Logger::info("resource [" + resource_absolute_path +
+		             "] doesn't exist.");
+		return false;
+	}
+
+	std::string etag;
+	if (!get_etag(resource_absolute_path, file_status, etag))
+		return false;
+
+	HTTP::ContentEncoding encoding = HTTP::CacheEntry::negotiate_encoding(
+	    connection->get_request()->get_header("Accept-Encoding"));
+	bool is_deflated = encoding == HTTP::ContentEncoding::DEFLATE;
+	etag = get_coded_etag(etag, encoding);
+
+	get_response->add_header("ETag", etag);
+	get_response->add_header("Vary", "Accept-Encoding");
+
+	// the client's copy is current, so the file isn't even read
+	if (is_etag_matched(
+	        connection->get_request()->get_header("If-None-Match"), etag))
+	{
+		get_response->set_status(304);
+		return true;
+	}
+
+	// HEAD only needs the headers, so the file isn't read either; the
+	// length of its deflated content isn't known without compressing it
+	if (is_head_request(connection))
+	{
+		get_response->set_content_type(
+		    parse_content_type(get_uri->get_path_string()));
+		if (is_deflated)
+		{
+			get_response->add_header("Content-Encoding", "deflate");
+		}
+		else
+		{
+			get_response->set_content_length(
+			    static_cast<size_t>(file_status.st_size));
+		}
+		return true;
+	}
+
+	std::string buffer;
+	if (!read_resource(resource_absolute_path,
+	                   static_cast<size_t>(file_status.st_size), buffer))
+		return false;
+
+	get_response->set_content_type(
+	    parse_content_type(get_uri->get_path_string()));
+
+	// if client requests compressed data
+	if (is_deflated)
+	{
+		buffer = Compressor::compress(buffer);
+		get_response->add_header("Content-Encoding", "deflate");
+	}
+
+	get_response->set_body(std::move(buffer));
+
+	return true;
+}
+
+bool StaticFileHandler::get_etag(const std::string& resource_path,
+                                 const struct stat& file_status,
+                                 std::string& etag)
+{
+	const int64_t modified_at =
+	    static_cast<int64_t>(file_status.st_mtim.tv_sec) * 1000000000 +
+	    file_status.st_mtim.tv_nsec;
+
+	auto cached_etag = m_etags.find(resource_path);
+	if (cached_etag != m_etags.end() &&
+	    cached_etag->second.modified_at == modified_at &&
+	    cached_etag->second.size == file_status.st_size)
+	{
+		etag = cached_etag->second.etag;
+		return true;
+	}
+
+	if (!hash_resource(resource_path, etag))
+	{
+		return false;
+	}
+	m_etags[resource_path] = CachedEtag{modified_at, file_status.st_size, etag};
+	return true;
+}
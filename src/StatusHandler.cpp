@@ -1,29 +1,53 @@
 #include "StatusHandler.hpp"
 #include "ServerConfiguration.hpp"
 
+#include <algorithm>
 #include <cstdarg>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
 
 #define add_header(header_name, header_value)                                  \
 	response->add_header(header_name, header_value)
 
 #define add_body(body_content_string) response->set_body(body_content_string)
 
-namespace StatusHandler
+namespace
 {
-	void handle_status_code(const std::shared_ptr<Message::Response>& response,
-	                        int status_code, const std::string& additional_info)
+	/**
+	 * Same length as every HTTP Date, overwritten when a template is sent.
+	 */
+	const std::string DATE_PLACEHOLDER = "Thu, 01 Jan 1970 00:00:00 GMT";
+
+	using StatusHandler::PrebuiltResponse;
+
+	// Sorted by status code.
+	std::vector<PrebuiltResponse> prebuilt_responses;
+
+	bool is_prebuilt = false;
+
+	/**
+	 * Add the headers and body of a status code to response message.
+	 *
+	 * @param[in] date
+	 * 		Value of the Date header.
+	 */
+	void fill_response(const std::shared_ptr<Message::Response>& response,
+	                   int status_code, const std::string& additional_info,
+	                   const std::string& date)
 	{
 		response->set_status(status_code);
 		response->set_reason_phrase(status_code);
 
 		// The Date header MUST be sent if the server is capable of generating
 		// accurate date.
-		add_header("Date", Timer::get_current_http_time());
+		add_header("Date", date);
 
 		// Generally, a server should have the Server header despite the status.
-		add_header("Server", "Bitate");
+		add_header("Server", ServerConfiguration::instance()->get_server_name());
 
-		add_header("Host", "www.bitate.com");
+		add_header("Host", ServerConfiguration::instance()->get_host_name());
 
 		/**
 		 * The handling logic of status codes is based on
@@ -113,14 +137,8 @@ namespace StatusHandler
 
 		case 304: // Not Modified
 		{
-			// TODO: HTTP 304
-			add_header("Cache-Control", "");
-			add_header("Content-Location", "");
-			add_header("Date", "");
-			add_header("ETag", "");
-			add_header("Expires", "");
-			add_header("Last-Modified", "");
-			add_header("Vary", "");
+			// The handler adds the validators, e.g. ETag, that the 200
+			// response would have had.
 			break;
 		}
 
@@ -192,7 +210,11 @@ namespace StatusHandler
 
 		case 405: // Method Not Allowed
 		{
-			add_header("Allow", "GET");
+			// the methods of the requested resource; left out of templates
+			if (!additional_info.empty())
+			{
+				add_header("Allow", additional_info);
+			}
 			add_body("<html>"
 			         "<head>"
 			         "<title>"
@@ -339,4 +361,140 @@ namespace StatusHandler
 		}
 		}
 	}
+
+	/**
+	 * Read a custom error page.
+	 *
+	 * @param[out] body
+	 * 		Content of the page.
+	 *
+	 * @return
+	 * 		True if the configuration has a page for @b status_code.
+	 */
+	bool read_error_page(int status_code, std::string& body)
+	{
+		std::ifstream page(
+		    ServerConfiguration::instance()->get_error_page_directory_path() +
+		        std::to_string(status_code) + ".html",
+		    std::ios::binary);
+		if (!page.is_open())
+		{
+			return false;
+		}
+
+		std::ostringstream content;
+		content << page.rdbuf();
+		body = content.str();
+		return true;
+	}
+
+	const PrebuiltResponse* find_prebuilt_response(int status_code)
+	{
+		if (!is_prebuilt)
+		{
+			StatusHandler::prebuild_responses();
+		}
+
+		auto position = std::lower_bound(
+		    prebuilt_responses.cbegin(), prebuilt_responses.cend(),
+		    status_code,
+		    [](const PrebuiltResponse& prebuilt_response, int code) {
+			    return prebuilt_response.status_code < code;
+		    });
+		if (position == prebuilt_responses.cend() ||
+		    position->status_code != status_code)
+		{
+			return nullptr;
+		}
+		return &*position;
+	}
+
+	PrebuiltResponse
+	serialize_response(int status_code,
+	                   const std::shared_ptr<Message::Response>& response)
+	{
+		PrebuiltResponse prebuilt_response;
+		prebuilt_response.status_code = status_code;
+		prebuilt_response.message = response->generate_response();
+		prebuilt_response.date_offset =
+		    prebuilt_response.message.find("Date: " + DATE_PLACEHOLDER) +
+		    std::strlen("Date: ");
+		return prebuilt_response;
+	}
+} // namespace
+
+namespace StatusHandler
+{
+	void handle_status_code(const std::shared_ptr<Message::Response>& response,
+	                        int status_code, const std::string& additional_info)
+	{
+		if (additional_info.empty())
+		{
+			const PrebuiltResponse* prebuilt_response =
+			    find_prebuilt_response(status_code);
+			if (prebuilt_response != nullptr)
+			{
+				use_prebuilt_response(response, *prebuilt_response);
+				return;
+			}
+		}
+
+		fill_response(response, status_code, additional_info,
+		              Timer::get_cached_http_time());
+	}
+
+	void prebuild_responses()
+	{
+		prebuilt_responses.clear();
+
+		Message::Response status_lines;
+		for (int status_code = 400; status_code < 600; ++status_code)
+		{
+			if (status_lines.get_status_code_reason_string(status_code).empty())
+			{
+				continue;
+			}
+
+			auto response = std::make_shared<Message::Response>();
+			fill_response(response, status_code, "", DATE_PLACEHOLDER);
+
+			std::string body;
+			if (read_error_page(status_code, body))
+			{
+				response->set_body(std::move(body));
+				response->set_content_type("text/html");
+			}
+
+			prebuilt_responses.push_back(
+			    serialize_response(status_code, response));
+		}
+
+		is_prebuilt = true;
+	}
+
+	PrebuiltResponse
+	prebuild_response(int status_code, const std::string& content_type,
+	                  const std::string& body,
+	                  const std::map<std::string, std::string>& headers)
+	{
+		auto response = std::make_shared<Message::Response>();
+		fill_response(response, status_code, "", DATE_PLACEHOLDER);
+		response->set_body(body);
+		response->set_content_type(content_type);
+		for (const auto& header : headers)
+		{
+			add_header(header.first, header.second);
+		}
+		return serialize_response(status_code, response);
+	}
+
+	void use_prebuilt_response(
+	    const std::shared_ptr<Message::Response>& response,
+	    const PrebuiltResponse& prebuilt_response)
+	{
+		response->clear_up();
+		response->set_status(prebuilt_response.status_code);
+		response->set_prebuilt_message(prebuilt_response.message,
+		                               prebuilt_response.date_offset);
+	}
 } // namespace StatusHandler
@@ -0,0 +1,142 @@
+#include "ThreadPool.hpp"
+#include "Logger.hpp"
+
+#include <stdexcept>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace HTTP
+{
+	ThreadPool::ThreadPool(size_t number_of_threads, size_t queue_capacity)
+	    : m_queue_capacity{queue_capacity}
+	{
+		m_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (m_event_fd == -1)
+		{
+			Logger::error("thread pool eventfd() error", errno);
+			throw std::runtime_error("thread pool eventfd() error");
+		}
+
+		m_threads.reserve(number_of_threads);
+		for (size_t i = 0; i < number_of_threads; ++i)
+		{
+			m_threads.emplace_back(&ThreadPool::run, this, i);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_is_stopping = true;
+			m_jobs.clear();
+		}
+		m_has_jobs.notify_all();
+		for (std::thread& thread : m_threads)
+		{
+			thread.join();
+		}
+		close(m_event_fd);
+	}
+
+	void ThreadPool::attach(int epoll_fd)
+	{
+		epoll_event event;
+		event.data.fd = m_event_fd;
+		event.events = EPOLLIN;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, m_event_fd, &event) == -1)
+		{
+			Logger::error("thread pool epoll add error", errno);
+			throw std::runtime_error("thread pool epoll add error");
+		}
+		m_is_attached = true;
+	}
+
+	bool ThreadPool::submit(Task task, Completion completion)
+	{
+		if (!m_is_attached || m_threads.empty())
+		{
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_jobs.size() >= m_queue_capacity)
+			{
+				return false;
+			}
+			m_jobs.push_back(Job{std::move(task), std::move(completion)});
+		}
+		m_has_jobs.notify_one();
+		return true;
+	}
+
+	bool ThreadPool::handle_events(int fd, uint32_t)
+	{
+		if (fd != m_event_fd)
+		{
+			return false;
+		}
+
+		uint64_t number_of_signals = 0;
+		if (read(m_event_fd, &number_of_signals, sizeof(number_of_signals)) ==
+		    -1)
+		{
+			return true;
+		}
+
+		std::vector<Completion> completions;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			completions.swap(m_completions);
+		}
+		for (Completion& completion : completions)
+		{
+			completion();
+		}
+		return true;
+	}
+
+	int ThreadPool::get_fd() const { return m_event_fd; }
+
+	size_t ThreadPool::get_number_of_threads() const
+	{
+		return m_threads.size();
+	}
+
+	void ThreadPool::run(size_t thread_index)
+	{
+		for (;;)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_has_jobs.wait(lock, [this]() {
+					return m_is_stopping || !m_jobs.empty();
+				});
+				if (m_is_stopping)
+				{
+					return;
+				}
+				job = std::move(m_jobs.front());
+				m_jobs.pop_front();
+			}
+
+			job.task(thread_index);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_completions.push_back(std::move(job.completion));
+			}
+
+			// the counter only has to become non-zero to wake the loop
+			uint64_t signal = 1;
+			if (write(m_event_fd, &signal, sizeof(signal)) == -1)
+			{
+				Logger::error("thread pool eventfd write error", errno);
+			}
+		}
+	}
+} // namespace HTTP
@@ -107,7 +107,7 @@ bool Uri::parse_port(std::string& authority)
 		// whether the given m_port string is integer string.
 		for (const auto& number : port_string)
 		{
-			if (std::isdigit(number) == 0)
+			if (!Rfc3986::DIGIT.is_contains(number))
 			{
 				m_has_port = false;
 				return false;
@@ -185,59 +185,57 @@ bool Uri::parse_path(std::string& uri, std::string& remains)
 {
 	m_path.clear();
 
+	// The path is terminated by the first question "?", "#", or
+	// by the end of the Uri.
+	std::string query_and_fragment;
+	auto path_end_delimiter = uri.find_first_of("?#");
+	if (path_end_delimiter != std::string::npos)
+	{
+		query_and_fragment = uri.substr(path_end_delimiter);
+		uri.erase(path_end_delimiter);
+	}
+
 	if (uri == "/")
 	{
 		m_is_relative_path = false;
 		m_path.emplace_back("");
 		uri.clear();
-		remains = "";
+		remains = query_and_fragment;
 		return true;
 	}
 
 	if (!uri.empty())
 	{
-		// The path is terminated by the first question "?", "#", or
-		// by the end of the Uri.
-		auto path_end_delimiter = uri.find_first_of("?#");
+		// strip beginning slash of m_path string
+		auto begin_slash_position = uri.find_first_of('/');
+		if (begin_slash_position == 0)
+		{
+			m_is_relative_path = false;
+			uri = uri.substr(1);
+		}
+		else
+		{
+			m_is_relative_path = true;
+		}
 
-		// path string without query or fragment
-		if (path_end_delimiter == std::string::npos)
+		for (;;)
 		{
-			// strip beginning slash of m_path string
-			auto begin_slash_position = uri.find_first_of('/');
-			if (begin_slash_position == 0)
+			auto path_elelment_delimiter = uri.find('/');
+			if (path_elelment_delimiter != std::string::npos)
 			{
-				m_is_relative_path = false;
-				uri = uri.substr(1);
+				m_path.emplace_back(uri.begin(),
+				                    uri.begin() + path_elelment_delimiter);
+				uri = uri.substr(path_elelment_delimiter + 1);
 			}
-			else
+			else // no "/" found
 			{
-				m_is_relative_path = true;
+				m_path.push_back(uri);
+				uri.clear();
+				break;
 			}
-
-			for (;;)
-			{
-				auto path_elelment_delimiter = uri.find('/');
-				if (path_elelment_delimiter != std::string::npos)
-				{
-					m_path.emplace_back(uri.begin(),
-					                    uri.begin() + path_elelment_delimiter);
-					uri = uri.substr(path_elelment_delimiter + 1);
-				}
-				else // no "/" found
-				{
-					m_path.push_back(uri);
-					uri.clear();
-					break;
-				}
-			}
-
-			remains = "";
-			return true;
 		}
 
-		remains = uri.substr(path_end_delimiter);
-
+		remains = query_and_fragment;
 		return true;
 	}
 
@@ -254,8 +252,8 @@ bool Uri::parse_path(std::string& uri, std::string& remains)
 		// If host doesn't exist and path is empty,
 		// The path is relative path
 		m_is_relative_path = true;
-		remains = uri;
 	}
+	remains = query_and_fragment;
 
 	return true;
 }
@@ -326,6 +324,11 @@ std::string Uri::get_host() { return m_host; }
 
 std::vector<std::string> Uri::get_path() { return m_path; }
 
+const std::vector<std::string>& Uri::get_path_segments() const
+{
+	return m_path;
+}
+
 std::string Uri::get_path_string()
 {
 	if (m_path[0].empty())
@@ -378,12 +381,19 @@ bool Uri::has_fragment() const { return m_has_fragment; }
 
 bool Uri::parse_from_string(const std::string& uri)
 {
-	PercentEncoding percent_encoding;
-	std::string decoded_uri_string = percent_encoding.decode(uri);
+	// Most request uris carry no escapes; parse those without a copy.
+	std::string decoded_uri_string;
+	const std::string* parsed_uri = &uri;
+	if (PercentEncoding::needs_decoding(uri))
+	{
+		decoded_uri_string = uri;
+		PercentEncoding::decode_in_place(decoded_uri_string);
+		parsed_uri = &decoded_uri_string;
+	}
 
 	std::string uri_without_scheme;
 
-	if (!parse_scheme(decoded_uri_string, uri_without_scheme))
+	if (!parse_scheme(*parsed_uri, uri_without_scheme))
 	{
 		return false;
 	}
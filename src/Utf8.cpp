@@ -1,8 +1,14 @@
 #include "Utf8.hpp"
+#include "CpuDispatch.hpp"
 
+#include <algorithm>
 #include <stddef.h>
 #include <vector>
 
+#if defined(CPU_DISPATCH_X86)
+#include <immintrin.h>
+#endif
+
 namespace
 {
 	/**
@@ -50,6 +56,129 @@ namespace
 		return answer;
 	}
 
+	/**
+	 * Byte classes of the validating automaton below:
+	 *
+	 *   0: 00..7F  ASCII
+	 *   1: 80..8F  continuation
+	 *   2: 90..9F  continuation
+	 *   3: A0..BF  continuation
+	 *   4: C0, C1, F5..FF  never valid
+	 *   5: C2..DF  lead of a 2-byte sequence
+	 *   6: E0      lead of a 3-byte sequence, A0..BF must follow
+	 *   7: E1..EC, EE, EF  lead of a 3-byte sequence
+	 *   8: ED      lead of a 3-byte sequence, 80..9F must follow
+	 *   9: F0      lead of a 4-byte sequence, 90..BF must follow
+	 *  10: F1..F3  lead of a 4-byte sequence
+	 *  11: F4      lead of a 4-byte sequence, 80..8F must follow
+	 *
+	 * The restricted second bytes rule out overlong encodings, surrogates
+	 * and code points after U+10FFFF.
+	 */
+	constexpr uint8_t BYTE_CLASSES[256] = {
+	    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+	    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	    4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+	    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+	    6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 7,
+	    9, 10, 10, 10, 11, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	};
+
+	constexpr size_t NUMBER_OF_BYTE_CLASSES = 12;
+
+	// States of the validating automaton.
+	constexpr uint8_t ACCEPT = 0;
+	constexpr uint8_t REJECT = 1;
+
+	/**
+	 * Next state by current state and byte class. States 2..8 wait for
+	 * continuation bytes: 2 needs one more, 3 needs two, 6 needs three, and
+	 * 4, 5, 7, 8 need a restricted second byte after E0, ED, F0, F4.
+	 */
+	constexpr uint8_t TRANSITIONS[9][NUMBER_OF_BYTE_CLASSES] = {
+	    {0, 1, 1, 1, 1, 2, 4, 3, 5, 7, 6, 8}, // ACCEPT
+	    {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}, // REJECT
+	    {1, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1}, // one continuation left
+	    {1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1}, // two continuations left
+	    {1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1}, // after E0
+	    {1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1}, // after ED
+	    {1, 3, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1}, // three continuations left
+	    {1, 1, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1}, // after F0
+	    {1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}, // after F4
+	};
+
+	size_t skip_ascii_scalar(const uint8_t* data, size_t size)
+	{
+		size_t i = 0;
+		while (i < size && data[i] < 0x80)
+		{
+			++i;
+		}
+		return i;
+	}
+
+#if defined(CPU_DISPATCH_X86)
+	/**
+	 * Length of the ASCII prefix of the given bytes, 16 bytes at a time.
+	 */
+	CPU_DISPATCH_TARGET("sse2")
+	size_t skip_ascii_sse2(const uint8_t* data, size_t size)
+	{
+		size_t i = 0;
+		for (; i + 16 <= size; i += 16)
+		{
+			int mask = _mm_movemask_epi8(
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+			if (mask != 0)
+			{
+				return i + static_cast<size_t>(__builtin_ctz(mask));
+			}
+		}
+		return i + skip_ascii_scalar(data + i, size - i);
+	}
+
+	/**
+	 * Length of the ASCII prefix of the given bytes, 32 bytes at a time.
+	 */
+	CPU_DISPATCH_TARGET("avx2")
+	size_t skip_ascii_avx2(const uint8_t* data, size_t size)
+	{
+		size_t i = 0;
+		for (; i + 32 <= size; i += 32)
+		{
+			int mask = _mm256_movemask_epi8(
+			    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+			if (mask != 0)
+			{
+				_mm256_zeroupper();
+				return i + static_cast<size_t>(__builtin_ctz(mask));
+			}
+		}
+		_mm256_zeroupper();
+		return i + skip_ascii_sse2(data + i, size - i);
+	}
+#endif
+
+	using SkipAscii = size_t (*)(const uint8_t*, size_t);
+
+#if defined(CPU_DISPATCH_X86)
+	constexpr CpuDispatch::Kernel<SkipAscii> skip_ascii_kernel{
+	    skip_ascii_scalar, skip_ascii_sse2, nullptr, nullptr,
+	    skip_ascii_avx2};
+#else
+	constexpr CpuDispatch::Kernel<SkipAscii> skip_ascii_kernel{
+	    skip_ascii_scalar};
+#endif
 } // namespace
 
 namespace Utf8
@@ -60,6 +189,188 @@ namespace Utf8
 		return std::vector<UnicodeCodePoint>(ascii.begin(), ascii.end());
 	}
 
+	bool IsValid(const char* data, size_t size)
+	{
+		const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+		const SkipAscii skip_ascii = skip_ascii_kernel.get();
+		size_t i = skip_ascii(bytes, size);
+
+		uint8_t state = ACCEPT;
+		while (i < size)
+		{
+			state = TRANSITIONS[state][BYTE_CLASSES[bytes[i++]]];
+			if (state == REJECT)
+			{
+				return false;
+			}
+
+			// back on a character boundary: skip the next ASCII run in bulk
+			if (state == ACCEPT && i < size && bytes[i] < 0x80)
+			{
+				i += skip_ascii(bytes + i, size - i);
+			}
+		}
+
+		return state == ACCEPT;
+	}
+
+	bool IsValid(const std::string& encoding)
+	{
+		return IsValid(encoding.data(), encoding.size());
+	}
+
+	UnicodeCodePoint FoldCase(UnicodeCodePoint code_point)
+	{
+		// ranges where upper and lower case letters alternate
+		auto fold_pair = [code_point](UnicodeCodePoint first,
+		                              UnicodeCodePoint last) {
+			return code_point >= first && code_point <= last &&
+			       (code_point - first) % 2 == 0;
+		};
+
+		if (code_point < 0x80)
+		{
+			return code_point >= 'A' && code_point <= 'Z' ? code_point + 32
+			                                              : code_point;
+		}
+
+		// Latin-1 Supplement, Latin Extended-A
+		if (code_point >= 0xC0 && code_point <= 0xDE && code_point != 0xD7)
+		{
+			return code_point + 32;
+		}
+		if (code_point == 0xB5)
+		{
+			return 0x3BC;
+		}
+		if (fold_pair(0x100, 0x12F) || fold_pair(0x132, 0x137) ||
+		    fold_pair(0x14A, 0x177) || fold_pair(0x139, 0x148) ||
+		    fold_pair(0x179, 0x17E))
+		{
+			return code_point + 1;
+		}
+		if (code_point == 0x178)
+		{
+			return 0xFF;
+		}
+		if (code_point == 0x17F)
+		{
+			return 's';
+		}
+
+		// Greek
+		if ((code_point >= 0x391 && code_point <= 0x3A1) ||
+		    (code_point >= 0x3A3 && code_point <= 0x3AB))
+		{
+			return code_point + 32;
+		}
+		if (code_point == 0x386)
+		{
+			return 0x3AC;
+		}
+		if (code_point >= 0x388 && code_point <= 0x38A)
+		{
+			return code_point + 37;
+		}
+		if (code_point == 0x38C)
+		{
+			return 0x3CC;
+		}
+		if (code_point == 0x38E || code_point == 0x38F)
+		{
+			return code_point + 63;
+		}
+		if (code_point == 0x3C2)
+		{
+			return 0x3C3;
+		}
+
+		// Cyrillic
+		if (code_point >= 0x400 && code_point <= 0x40F)
+		{
+			return code_point + 80;
+		}
+		if (code_point >= 0x410 && code_point <= 0x42F)
+		{
+			return code_point + 32;
+		}
+		if (fold_pair(0x460, 0x481) || fold_pair(0x48A, 0x4BF) ||
+		    fold_pair(0x4C1, 0x4CE) || fold_pair(0x4D0, 0x52F))
+		{
+			return code_point + 1;
+		}
+		if (code_point == 0x4C0)
+		{
+			return 0x4CF;
+		}
+
+		// Latin Extended Additional
+		if (fold_pair(0x1E00, 0x1E95) || fold_pair(0x1EA0, 0x1EFF))
+		{
+			return code_point + 1;
+		}
+		if (code_point == 0x1E9E)
+		{
+			return 0xDF;
+		}
+
+		// Halfwidth and Fullwidth Forms
+		if (code_point >= 0xFF21 && code_point <= 0xFF3A)
+		{
+			return code_point + 32;
+		}
+
+		return code_point;
+	}
+
+	unsigned GetCombiningClass(UnicodeCodePoint code_point)
+	{
+		if (code_point < 0x300 || code_point > 0x36F)
+		{
+			return 0;
+		}
+
+		// classes of U+0300 through U+036F, from UnicodeData.txt
+		static const uint8_t COMBINING_CLASSES[0x70] = {
+		    230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230,
+		    230, 230, 230, 230, 230, 230, 230, 230, 232, 220, 220, 220, 220,
+		    232, 216, 220, 220, 220, 220, 220, 202, 202, 220, 220, 220, 220,
+		    202, 202, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220,
+		    1, 1, 1, 1, 1, 220, 220, 220, 220, 230, 230, 230, 230,
+		    230, 230, 230, 230, 240, 230, 220, 220, 220, 230, 230, 230, 220,
+		    220, 0, 230, 230, 230, 220, 220, 220, 220, 230, 232, 220, 220,
+		    230, 233, 234, 234, 233, 234, 234, 233, 230, 230, 230, 230, 230,
+		    230, 230, 230, 230, 230, 230, 230, 230};
+		return COMBINING_CLASSES[code_point - 0x300];
+	}
+
+	void OrderCanonically(std::vector<UnicodeCodePoint>& code_points)
+	{
+		auto is_before = [](UnicodeCodePoint first, UnicodeCodePoint second) {
+			return GetCombiningClass(first) < GetCombiningClass(second);
+		};
+
+		size_t i = 0;
+		while (i < code_points.size())
+		{
+			if (GetCombiningClass(code_points[i]) == 0)
+			{
+				++i;
+				continue;
+			}
+
+			size_t end = i + 1;
+			while (end < code_points.size() &&
+			       GetCombiningClass(code_points[end]) != 0)
+			{
+				++end;
+			}
+			std::stable_sort(code_points.begin() + i,
+			                 code_points.begin() + end, is_before);
+			i = end;
+		}
+	}
+
 	/**
 	 * This contains the private properties of a Utf8 instance.
 	 */
@@ -237,6 +548,13 @@ namespace Utf8
 
 	bool Utf8::IsValidEncoding(const std::string& encoding, bool final)
 	{
+		// Nothing held from earlier calls: validate without decoding.
+		if (final && impl_->numBytesRemainingToDecode == 0 &&
+		    impl_->isValidEncoding)
+		{
+			return IsValid(encoding);
+		}
+
 		(void)Decode(encoding);
 		auto wasValidEncoding = impl_->isValidEncoding;
 		if (final)
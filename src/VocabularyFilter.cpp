@@ -0,0 +1,403 @@
+#include "VocabularyFilter.hpp"
+#include "Logger.hpp"
+
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+	// "WFVOCABF", identifies a filter file.
+	constexpr uint64_t MAGIC = 0x5746564f43414246;
+
+	// Bumped whenever the layout or the hashing changes.
+	constexpr uint32_t VERSION = 1;
+
+	// About 1% false positives with 10 bits per term, fewer with more.
+	constexpr uint64_t BITS_PER_TERM = 10;
+	constexpr uint32_t NUMBER_OF_PROBES = 7;
+	constexpr uint64_t MIN_NUMBER_OF_BITS = 4096;
+
+	struct FileHeader
+	{
+		uint64_t magic;
+		uint32_t version;
+		uint32_t number_of_probes;
+		uint64_t generation;
+		uint64_t number_of_bits;
+		uint64_t number_of_terms;
+	};
+
+	/**
+	 * Spread the bits of a hash, as FNV-1a barely changes the high ones of
+	 * short terms.
+	 */
+	uint64_t mix(uint64_t hash)
+	{
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 33;
+		hash *= 0xc4ceb9fe1a85ec53ULL;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	/**
+	 * The bit of the probe of a term, by double hashing.
+	 */
+	uint64_t get_probe(uint64_t term_hash, uint32_t probe, uint64_t bit_mask)
+	{
+		uint64_t step = mix(term_hash ^ 0x9e3779b97f4a7c15ULL) | 1;
+		return (term_hash + probe * step) & bit_mask;
+	}
+
+	bool write_all(int fd, const char* data, size_t length)
+	{
+		while (length != 0)
+		{
+			ssize_t written = ::write(fd, data, length);
+			if (written == -1 && errno == EINTR)
+			{
+				continue;
+			}
+			if (written <= 0)
+			{
+				return false;
+			}
+			data += written;
+			length -= static_cast<size_t>(written);
+		}
+		return true;
+	}
+
+	/**
+	 * Whether a bareword of a query is an FTS5 operator.
+	 */
+	bool is_operator(const std::string& bareword)
+	{
+		return bareword == "AND" || bareword == "OR" || bareword == "NOT" ||
+		       bareword == "NEAR";
+	}
+} // namespace
+
+namespace HTTP
+{
+	VocabularyFilter::~VocabularyFilter() { close(); }
+
+	uint64_t VocabularyFilter::hash_term(const char* term, size_t length)
+	{
+		uint64_t hash = 0xcbf29ce484222325ULL;
+		for (size_t i = 0; i < length; ++i)
+		{
+			hash ^= static_cast<unsigned char>(term[i]);
+			hash *= 0x100000001b3ULL;
+		}
+		return mix(hash);
+	}
+
+	bool VocabularyFilter::write(const std::string& file_path,
+	                             uint64_t generation,
+	                             const std::vector<uint64_t>& term_hashes)
+	{
+		uint64_t number_of_bits = MIN_NUMBER_OF_BITS;
+		while (number_of_bits < BITS_PER_TERM * term_hashes.size())
+		{
+			number_of_bits *= 2;
+		}
+
+		std::vector<uint64_t> words(number_of_bits / 64);
+		for (uint64_t term_hash : term_hashes)
+		{
+			for (uint32_t probe = 0; probe < NUMBER_OF_PROBES; ++probe)
+			{
+				uint64_t bit = get_probe(term_hash, probe, number_of_bits - 1);
+				words[bit / 64] |= 1ULL << (bit % 64);
+			}
+		}
+
+		FileHeader header{};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.number_of_probes = NUMBER_OF_PROBES;
+		header.generation = generation;
+		header.number_of_bits = number_of_bits;
+		header.number_of_terms = term_hashes.size();
+
+		// readers see the old filter or the new one, never half of it
+		const std::string temporary_path =
+		    file_path + "." + std::to_string(getpid());
+		int fd = ::open(temporary_path.c_str(),
+		                O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (fd == -1)
+		{
+			Logger::error("vocabulary filter open() error: " + temporary_path,
+			              errno);
+			return false;
+		}
+
+		bool is_written =
+		    write_all(fd, reinterpret_cast<const char*>(&header),
+		              sizeof(header)) &&
+		    write_all(fd, reinterpret_cast<const char*>(words.data()),
+		              words.size() * sizeof(uint64_t));
+		::close(fd);
+
+		if (!is_written ||
+		    rename(temporary_path.c_str(), file_path.c_str()) == -1)
+		{
+			Logger::error("vocabulary filter write error: " + file_path,
+			              errno);
+			unlink(temporary_path.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	bool VocabularyFilter::load(const std::string& file_path,
+	                            uint64_t generation,
+	                            const TermReader& read_terms)
+	{
+		if (is_open() && m_generation == generation)
+		{
+			return true;
+		}
+
+		if (open(file_path) && m_generation == generation)
+		{
+			return true;
+		}
+		close();
+
+		// building fails the same way until the data changes
+		if (m_has_failed && m_failed_generation == generation)
+		{
+			return false;
+		}
+
+		// one process builds it, the others try again later
+		const std::string lock_path = file_path + ".lock";
+		int lock_fd =
+		    ::open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (lock_fd == -1)
+		{
+			Logger::error("vocabulary filter open() error: " + lock_path,
+			              errno);
+			return false;
+		}
+		if (flock(lock_fd, LOCK_EX | LOCK_NB) == -1)
+		{
+			::close(lock_fd);
+			return false;
+		}
+
+		// it may have been built while this process was checking
+		if (!open(file_path) || m_generation != generation)
+		{
+			close();
+
+			std::vector<uint64_t> term_hashes;
+			if (read_terms(term_hashes) &&
+			    write(file_path, generation, term_hashes))
+			{
+				Logger::info("vocabulary filter of " +
+				             std::to_string(term_hashes.size()) +
+				             " terms built for generation " +
+				             std::to_string(generation));
+				open(file_path);
+			}
+			else
+			{
+				m_has_failed = true;
+				m_failed_generation = generation;
+			}
+		}
+
+		::close(lock_fd);
+		return is_open();
+	}
+
+	bool VocabularyFilter::open(const std::string& file_path)
+	{
+		close();
+
+		int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd == -1)
+		{
+			return false;
+		}
+
+		struct stat file_status;
+		if (fstat(fd, &file_status) == -1 ||
+		    static_cast<size_t>(file_status.st_size) < sizeof(FileHeader))
+		{
+			::close(fd);
+			return false;
+		}
+
+		size_t region_size = static_cast<size_t>(file_status.st_size);
+		void* region =
+		    mmap(nullptr, region_size, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (region == MAP_FAILED)
+		{
+			Logger::error("vocabulary filter mmap() error", errno);
+			return false;
+		}
+
+		FileHeader header;
+		std::memcpy(&header, region, sizeof(header));
+		uint64_t number_of_bits = header.number_of_bits;
+		if (header.magic != MAGIC || header.version != VERSION ||
+		    number_of_bits < 64 || (number_of_bits & (number_of_bits - 1)) ||
+		    region_size != sizeof(header) + number_of_bits / 8)
+		{
+			munmap(region, region_size);
+			return false;
+		}
+
+		m_region = region;
+		m_region_size = region_size;
+		m_words = reinterpret_cast<const uint64_t*>(
+		    static_cast<const char*>(region) + sizeof(header));
+		m_bit_mask = number_of_bits - 1;
+		m_number_of_probes = header.number_of_probes;
+		m_generation = header.generation;
+		return true;
+	}
+
+	void VocabularyFilter::close()
+	{
+		if (m_region != nullptr)
+		{
+			munmap(m_region, m_region_size);
+		}
+		m_region = nullptr;
+		m_region_size = 0;
+		m_words = nullptr;
+	}
+
+	bool VocabularyFilter::is_open() const { return m_region != nullptr; }
+
+	uint64_t VocabularyFilter::get_generation() const { return m_generation; }
+
+	bool VocabularyFilter::may_contain(const std::string& term) const
+	{
+		if (!is_open())
+		{
+			return true;
+		}
+
+		uint64_t term_hash = hash_term(term.data(), term.size());
+		for (uint32_t probe = 0; probe < m_number_of_probes; ++probe)
+		{
+			uint64_t bit = get_probe(term_hash, probe, m_bit_mask);
+			if ((m_words[bit / 64] & (1ULL << (bit % 64))) == 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool VocabularyFilter::may_match(const std::string& query) const
+	{
+		std::vector<std::string> terms;
+		if (!is_open() || !get_required_terms(query, terms))
+		{
+			return true;
+		}
+
+		for (const std::string& term : terms)
+		{
+			if (!may_contain(term))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool VocabularyFilter::get_required_terms(const std::string& query,
+	                                          std::vector<std::string>& terms)
+	{
+		// unicode61 indexes runs of letters and digits, folded to lowercase
+		bool is_in_string = false;
+		std::string bareword;
+		std::string term;
+		auto end_term = [&terms, &term]() {
+			if (!term.empty())
+			{
+				terms.push_back(term);
+				term.clear();
+			}
+		};
+
+		for (size_t i = 0; i <= query.size(); ++i)
+		{
+			unsigned char character =
+			    i < query.size() ? static_cast<unsigned char>(query[i]) : ' ';
+			if (character >= 0x80)
+			{
+				return false;
+			}
+
+			if (std::isalnum(character) ||
+			    (!is_in_string && character == '_'))
+			{
+				if (!is_in_string)
+				{
+					bareword += static_cast<char>(character);
+				}
+				if (character == '_')
+				{
+					end_term();
+					continue;
+				}
+				term += static_cast<char>(std::tolower(character));
+				continue;
+			}
+
+			// the operators of FTS5 are uppercase barewords; AND requires
+			// both sides like a space, the others needn't
+			if (!bareword.empty())
+			{
+				if (is_operator(bareword))
+				{
+					if (bareword != "AND")
+					{
+						return false;
+					}
+					term.clear();
+				}
+				bareword.clear();
+			}
+			end_term();
+
+			if (character == '"')
+			{
+				// "" within a string is an escaped quote
+				if (is_in_string && i + 1 < query.size() && query[i + 1] == '"')
+				{
+					++i;
+					continue;
+				}
+				is_in_string = !is_in_string;
+				continue;
+			}
+
+			// column filters, prefixes, groups and the like
+			if (!is_in_string && !std::isspace(character))
+			{
+				return false;
+			}
+		}
+
+		return !is_in_string && !terms.empty();
+	}
+} // namespace HTTP
@@ -1,8 +1,17 @@
 #include "Worker.hpp"
+#include "CpuDispatch.hpp"
 #include "Logger.hpp"
+#include "MetricsHandler.hpp"
+#include "Scoreboard.hpp"
 #include "SqliteHandler.hpp"
+#include "StaticFileHandler.hpp"
 #include "StatusHandler.hpp"
+#include "Timer.hpp"
 #include "UnixDomainHelper.hpp"
+#include "Utf8.hpp"
+
+#include <algorithm>
+#include <iterator>
 
 #include <fcntl.h>
 #include <sys/epoll.h>
@@ -34,6 +43,11 @@ namespace
 	 * Maximum sending/receiving buffer size in byte
 	 */
 	constexpr size_t MAXIMUM_BUFFER_SIZE = 8192;
+
+	/**
+	 * Path of health check probes.
+	 */
+	constexpr char HEALTH_CHECK_PATH[] = "healthz";
 } // namespace
 
 Worker::Worker(const int worker_socket)
@@ -41,9 +55,40 @@ Worker::Worker(const int worker_socket)
     , m_worker_socket{worker_socket}
     , m_worker_socket_handler{new WorkerSocket()}
     , m_connection{std::make_shared<HTTP::Connection>()}
-    , m_resource_handler{new SqliteHandler()}
     , m_server_socket{new WorkerSocket()}
 {
+	const std::string cpu_isa = ServerConfiguration::instance()->get_cpu_isa();
+	if (!CpuDispatch::force_isa(cpu_isa))
+	{
+		Logger::warn("unknown cpu instruction set: " + cpu_isa);
+	}
+	Logger::info(std::string("string kernels use cpu instruction set: ") +
+	             CpuDispatch::get_isa_name(CpuDispatch::get_active_isa()));
+
+	// serialize error responses before the first request needs one
+	StatusHandler::prebuild_responses();
+	m_alive_response =
+	    StatusHandler::prebuild_response(200, "text/plain", "ok");
+	m_not_ready_response =
+	    StatusHandler::prebuild_response(503, "text/plain", "starting");
+
+	// "/?q=" searches, "/metrics" reports on the search cache and every
+	// other path is a file
+	m_cache = std::make_shared<HTTP::Cache>(16);
+	HTTP::Freshness search_freshness;
+	search_freshness.time_to_live = static_cast<uint32_t>(
+	    ServerConfiguration::instance()->get_search_cache_ttl());
+	search_freshness.stale_while_revalidate = static_cast<uint32_t>(
+	    ServerConfiguration::instance()->get_search_cache_stale_ttl());
+	m_search_handler =
+	    std::make_shared<SqliteHandler>(m_cache, search_freshness);
+	m_router.add_route(HTTP::Method::GET, "/", m_search_handler, "q");
+	m_router.add_route(HTTP::Method::GET, "/metrics",
+	                   std::make_shared<MetricsHandler>(
+	                       m_cache, m_search_handler->get_statement_caches()));
+	m_router.add_route(HTTP::Method::GET, "/*",
+	                   std::make_shared<StaticFileHandler>());
+
 	m_epfd = epoll_create(EPOLL_INTEREST_LIST_SIZE);
 	if (m_epfd == -1)
 	{
@@ -60,6 +105,9 @@ Worker::Worker(const int worker_socket)
 		Logger::error("worker epoll add error", errno);
 		throw std::runtime_error("worker epoll add error");
 	}
+
+	m_cache->attach(m_epfd);
+	m_search_handler->attach(m_epfd);
 }
 
 Worker::~Worker() { close(m_epfd); }
@@ -69,10 +117,21 @@ void Worker::event_loop()
 	int sum = 0;
 	struct epoll_event triggered_events[EPOLL_TRIGGERED_EVENTS_MAX_SIZE] = {0};
 
+	Scoreboard::set_state(Scoreboard::State::READY);
+
 	for (;;)
 	{
-		switch (sum = epoll_wait(m_epfd, triggered_events,
-		                         EPOLL_TRIGGERED_EVENTS_MAX_SIZE, -1))
+		// the Redis commands of the last batch leave in one write
+		m_cache->flush();
+
+		sum = epoll_wait(m_epfd, triggered_events,
+		                 EPOLL_TRIGGERED_EVENTS_MAX_SIZE,
+		                 m_cache->get_poll_timeout());
+
+		// one clock read serves every response and log line of the batch
+		Timer::tick();
+
+		switch (sum)
 		{
 		case -1:
 		{
@@ -90,10 +149,24 @@ void Worker::event_loop()
 				int triggered_fd = triggered_events[i].data.fd;
 				uint32_t triggered_event = triggered_events[i].events;
 
+				// Redis replies resume the requests waiting for them
+				if (m_cache->handle_events(triggered_fd, triggered_event))
+				{
+					continue;
+				}
+
+				// and so do searches done on the search threads
+				if (m_search_handler->handle_events(triggered_fd,
+				                                    triggered_event))
+				{
+					continue;
+				}
+
 				if (triggered_event & EPOLLRDHUP)
 				{
 					epoll_ctl(m_epfd, EPOLL_CTL_DEL, triggered_fd, nullptr);
 					close(triggered_fd);
+					m_active_requests.erase(triggered_fd);
 					continue;
 				}
 
@@ -123,22 +196,7 @@ void Worker::event_loop()
 				if ((triggered_event & EPOLLIN) &&
 				    (triggered_fd != m_worker_socket))
 				{
-					if (m_worker_socket_handler->read_from(triggered_fd))
-					{
-						request_core_handler(m_worker_socket_handler
-						                         ->get_receive_buffer_string());
-
-						m_server_socket->write_to(
-						    triggered_fd, get_response->generate_response());
-
-						get_request->clear_up();
-						get_response->clear_up();
-					}
-					else
-					{
-						epoll_ctl(m_epfd, EPOLL_CTL_DEL, triggered_fd, nullptr);
-					}
-
+					receive_request(triggered_fd);
 					continue;
 				}
 
@@ -154,6 +212,92 @@ void Worker::event_loop()
 	}
 }
 
+void Worker::receive_request(int client_socket)
+{
+	if (!m_worker_socket_handler->read_from(client_socket))
+	{
+		epoll_ctl(m_epfd, EPOLL_CTL_DEL, client_socket, nullptr);
+		m_active_requests.erase(client_socket);
+		return;
+	}
+
+	std::string raw_request_string =
+	    m_worker_socket_handler->get_receive_buffer_string();
+
+	// responses go out in the order of the requests
+	auto active_request = m_active_requests.find(client_socket);
+	if (active_request != m_active_requests.end())
+	{
+		active_request->second.backlog.push_back(
+		    std::move(raw_request_string));
+		return;
+	}
+
+	start_request(client_socket, raw_request_string);
+}
+
+void Worker::start_request(int client_socket,
+                           const std::string& raw_request_string)
+{
+	if (m_idle_connections.empty())
+	{
+		m_connection = std::make_shared<HTTP::Connection>();
+	}
+	else
+	{
+		m_connection = std::move(m_idle_connections.back());
+		m_idle_connections.pop_back();
+	}
+
+	uint64_t request_id = ++m_last_request_id;
+	ActiveRequest& active_request = m_active_requests[client_socket];
+	active_request.request_id = request_id;
+	active_request.connection = m_connection;
+
+	request_core_handler(raw_request_string,
+	                     [this, client_socket, request_id]() {
+		                     finish_request(client_socket, request_id);
+	                     });
+}
+
+void Worker::finish_request(int client_socket, uint64_t request_id)
+{
+	auto active_request = m_active_requests.find(client_socket);
+	if (active_request == m_active_requests.end() ||
+	    active_request->second.request_id != request_id)
+	{
+		// the client hung up while Redis was asked
+		return;
+	}
+
+	m_connection = std::move(active_request->second.connection);
+	std::deque<std::string> backlog =
+	    std::move(active_request->second.backlog);
+	m_active_requests.erase(active_request);
+
+	m_server_socket->write_to(client_socket, get_response->generate_response());
+
+	get_request->clear_up();
+	get_response->clear_up();
+	m_idle_connections.push_back(m_connection);
+
+	while (!backlog.empty())
+	{
+		std::string raw_request_string = std::move(backlog.front());
+		backlog.pop_front();
+		start_request(client_socket, raw_request_string);
+
+		// the rest waits behind a request that isn't answered yet
+		active_request = m_active_requests.find(client_socket);
+		if (active_request != m_active_requests.end())
+		{
+			std::move(backlog.begin(), backlog.end(),
+			          std::back_inserter(active_request->second.backlog));
+			return;
+		}
+	}
+}
+
 bool Worker::parse_request(const std::string& raw_request_string)
 {
 	get_request->set_raw_request(raw_request_string);
@@ -174,34 +318,42 @@ void Worker::set_raw_request(const std::string& raw_request)
 
 bool Worker::handle_post_request()
 {
-	PercentEncoding percent_encoding;
-
 	/**
-	 * Append an additional '&', so that each name=value pair has a trailing '&'
+	 * Split application/x-www-form-urlencoded body into name=value pairs
+	 * first, then decode each part in place, so that an encoded '&' or '='
+	 * inside a value doesn't split it.
 	 */
-	std::string body_buffer =
-	    percent_encoding.decode(get_request->get_body()) + '&';
+	std::string body_buffer = get_request->get_body();
 
-	while (!body_buffer.empty())
+	size_t pair_begin = 0;
+	while (pair_begin < body_buffer.size())
 	{
-		if (body_buffer.find_first_of('&') != std::string::npos)
+		size_t pair_end = body_buffer.find('&', pair_begin);
+		if (pair_end == std::string::npos)
 		{
-			if (body_buffer.find_first_of('=') != std::string::npos)
-			{
-				std::string name =
-				    body_buffer.substr(0, body_buffer.find_first_of('='));
+			pair_end = body_buffer.size();
+		}
 
-				std::string value =
-				    body_buffer.substr(body_buffer.find_first_of('=') + 1,
-				                       body_buffer.find_first_of('&') -
-				                           body_buffer.find_first_of('=') - 1);
+		size_t equal_sign = body_buffer.find('=', pair_begin);
+		if (equal_sign < pair_end)
+		{
+			std::string name =
+			    body_buffer.substr(pair_begin, equal_sign - pair_begin);
+			std::string value =
+			    body_buffer.substr(equal_sign + 1, pair_end - equal_sign - 1);
 
-				post_data_map[std::move(name)] = std::move(value);
+			PercentEncoding::decode_in_place(name, true);
+			PercentEncoding::decode_in_place(value, true);
 
-				body_buffer =
-				    body_buffer.substr(body_buffer.find_first_of('&') + 1);
+			if (!Utf8::IsValid(name) || !Utf8::IsValid(value))
+			{
+				return false;
 			}
+
+			post_data_map[std::move(name)] = std::move(value);
 		}
+
+		pair_begin = pair_end + 1;
 	}
 
 	// TODO: decouple POST request processing logic from Worker
@@ -209,7 +361,56 @@ bool Worker::handle_post_request()
 	return true;
 }
 
-void Worker::request_core_handler(const std::string& raw_request_string)
+void Worker::request_core_handler(const std::string& raw_request_string,
+                                  const std::function<void()>& on_answered)
+{
+	Scoreboard::count_request();
+
+	std::shared_ptr<HTTP::Connection> connection = m_connection;
+	std::function<void()> finish = [this, connection, on_answered]() {
+		m_connection = connection;
+
+		// HEAD is answered with the headers a GET would get; handlers
+		// skip the body, but cached and status responses still carry one
+		if (get_request->get_method() == HTTP::Method::HEAD)
+		{
+			get_response->omit_body();
+		}
+		on_answered();
+	};
+
+	if (answer_request(raw_request_string, finish))
+	{
+		finish();
+	}
+}
+
+bool Worker::answer_health_check()
+{
+	HTTP::Method method = get_request->get_method();
+	if (method != HTTP::Method::GET && method != HTTP::Method::HEAD)
+	{
+		return false;
+	}
+
+	const std::shared_ptr<Uri> uri = get_request->get_request_uri();
+	const std::vector<std::string>& segments = uri->get_path_segments();
+	if (segments.size() != 1 || segments[0] != HEALTH_CHECK_PATH)
+	{
+		return false;
+	}
+
+	bool is_readiness_probe =
+	    uri->has_query() && uri->get_query_paramters().count("ready") != 0;
+	StatusHandler::use_prebuilt_response(
+	    get_response, is_readiness_probe && !Scoreboard::is_ready()
+	                      ? m_not_ready_response
+	                      : m_alive_response);
+	return true;
+}
+
+bool Worker::answer_request(const std::string& raw_request_string,
+                            const std::function<void()>& on_answered)
 {
 	if (!parse_request(raw_request_string))
 	{
@@ -217,38 +418,65 @@ void Worker::request_core_handler(const std::string& raw_request_string)
 		    "worker parse request error with original request being: \n" +
 		    raw_request_string);
 		StatusHandler::handle_status_code(get_response, 400); // NOLINT
-		return;
+		return true;
 	}
 
-	if (get_request->get_request_method() == "GET")
+	if (answer_health_check())
 	{
-		if (!m_resource_handler->fetch_resource(m_connection))
-		{
-			StatusHandler::handle_status_code(get_response, 404);
-		}
-		else
-		{
-			StatusHandler::handle_status_code(get_response, 200);
-		}
+		return true;
+	}
 
-		return;
+	// Malformed text must not reach the full-text search.
+	if (get_request->has_query() &&
+	    !Utf8::IsValid(get_request->get_request_uri()->get_query()))
+	{
+		Logger::info("reject query that isn't valid UTF-8");
+		StatusHandler::handle_status_code(get_response, 400); // NOLINT
+		return true;
 	}
 
-	if (get_request->get_request_method() == "POST")
+	if (get_request->get_method() == HTTP::Method::UNKNOWN)
 	{
 		StatusHandler::handle_status_code(get_response, 501);
-		return;
+		return true;
 	}
 
-	if (get_request->get_request_method() == "PUT")
+	HTTP::RouteMatch& route_match = m_connection->get_route_match();
+	switch (m_router.route(get_request->get_method(),
+	                       *get_request->get_request_uri(), route_match))
 	{
-		StatusHandler::handle_status_code(get_response, 501);
-		return;
+	case HTTP::Router::Result::FOUND:
+	{
+		// the handler may answer from the event loop once Redis replies,
+		// with other requests handled meanwhile
+		std::shared_ptr<HTTP::Connection> connection = m_connection;
+		route_match.get_handler()->fetch_resource_async(
+		    m_connection, [this, connection, on_answered](bool is_fetched) {
+			    m_connection = connection;
+
+			    // a handler may answer with another status, e.g. 304
+			    int status_code = get_response->get_status_code();
+			    StatusHandler::handle_status_code(
+			        get_response,
+			        !is_fetched ? 404 : status_code != 0 ? status_code : 200);
+			    on_answered();
+		    });
+		return false;
 	}
 
-	if (get_request->get_request_method() == "HEAD")
+	case HTTP::Router::Result::METHOD_NOT_ALLOWED:
 	{
-		StatusHandler::handle_status_code(get_response, 501);
-		return;
+		StatusHandler::handle_status_code(get_response, 405,
+		                                  route_match.get_allowed_methods());
+		break;
 	}
+
+	case HTTP::Router::Result::NOT_FOUND:
+	{
+		StatusHandler::handle_status_code(get_response, 404);
+		break;
+	}
+	}
+
+	return true;
 }
\ No newline at end of file
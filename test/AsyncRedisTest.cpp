@@ -0,0 +1,349 @@
+#include "AsyncRedis.hpp"
+
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <map>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+	/**
+	 * Stand-in for redis-server in a child process, answering GET, SET and
+	 * DEL from a map per database of SELECT, 0 to 15, and +OK to everything
+	 * else.
+	 */
+	class FakeRedisServer
+	{
+	public:
+		FakeRedisServer()
+		{
+			int listening_socket = socket(AF_INET, SOCK_STREAM, 0);
+			sockaddr_in address{};
+			address.sin_family = AF_INET;
+			address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			socklen_t address_length = sizeof(address);
+			bind(listening_socket, reinterpret_cast<sockaddr*>(&address),
+			     sizeof(address));
+			listen(listening_socket, 4);
+			getsockname(listening_socket,
+			            reinterpret_cast<sockaddr*>(&address),
+			            &address_length);
+			m_port = ntohs(address.sin_port);
+
+			m_pid = fork();
+			if (m_pid == 0)
+			{
+				serve(listening_socket);
+				_exit(0);
+			}
+			close(listening_socket);
+		}
+
+		~FakeRedisServer()
+		{
+			kill(m_pid, SIGKILL);
+			waitpid(m_pid, nullptr, 0);
+		}
+
+		std::string get_uri() const
+		{
+			return "tcp://127.0.0.1:" + std::to_string(m_port);
+		}
+
+	private:
+		/**
+		 * Parse one command, an array of bulk strings, at @b position.
+		 */
+		static bool parse_command(const std::string& buffer, size_t& position,
+		                          std::vector<std::string>& arguments)
+		{
+			size_t cursor = position;
+			size_t line_end = buffer.find("\r\n", cursor);
+			if (line_end == std::string::npos)
+			{
+				return false;
+			}
+
+			size_t count = std::stoul(buffer.substr(cursor + 1));
+			cursor = line_end + 2;
+			arguments.clear();
+			for (size_t i = 0; i < count; ++i)
+			{
+				line_end = buffer.find("\r\n", cursor);
+				if (line_end == std::string::npos)
+				{
+					return false;
+				}
+				size_t length = std::stoul(buffer.substr(cursor + 1));
+				cursor = line_end + 2;
+				if (buffer.size() < cursor + length + 2)
+				{
+					return false;
+				}
+				arguments.push_back(buffer.substr(cursor, length));
+				cursor += length + 2;
+			}
+
+			position = cursor;
+			return true;
+		}
+
+		static void serve(int listening_socket)
+		{
+			std::map<std::string, std::string> databases[16];
+			for (;;)
+			{
+				int client = accept(listening_socket, nullptr, nullptr);
+				std::map<std::string, std::string>* values = &databases[0];
+				std::string input;
+				char chunk[4096];
+				ssize_t received = 0;
+				while ((received = read(client, chunk, sizeof(chunk))) > 0)
+				{
+					input.append(chunk, static_cast<size_t>(received));
+
+					std::string output;
+					std::vector<std::string> arguments;
+					size_t position = 0;
+					while (parse_command(input, position, arguments))
+					{
+						if (arguments[0] == "GET")
+						{
+							auto value = values->find(arguments[1]);
+							output += value == values->end()
+							              ? "$-1\r\n"
+							              : "$" +
+							                    std::to_string(
+							                        value->second.size()) +
+							                    "\r\n" + value->second +
+							                    "\r\n";
+						}
+						else if (arguments[0] == "SET" &&
+						         (arguments.size() == 3 ||
+						          (arguments.size() == 5 &&
+						           arguments[3] == "EX")))
+						{
+							(*values)[arguments[1]] = arguments[2];
+							output += "+OK\r\n";
+						}
+						else if (arguments[0] == "DEL")
+						{
+							output += values->erase(arguments[1]) == 1
+							              ? ":1\r\n"
+							              : ":0\r\n";
+						}
+						else if (arguments[0] == "SELECT")
+						{
+							size_t index = std::stoul(arguments[1]);
+							if (index < 16)
+							{
+								values = &databases[index];
+								output += "+OK\r\n";
+							}
+							else
+							{
+								output += "-ERR DB index is out of range\r\n";
+							}
+						}
+						else
+						{
+							output += "+OK\r\n";
+						}
+					}
+					input.erase(0, position);
+					write(client, output.data(), output.size());
+				}
+				close(client);
+			}
+		}
+
+		pid_t m_pid = -1;
+		int m_port = 0;
+	};
+
+	struct Lookup
+	{
+		bool is_done = false;
+		bool is_found = false;
+		std::string value;
+	};
+
+	HTTP::AsyncRedis::GetCallback record(Lookup& lookup)
+	{
+		return [&lookup](bool is_found, const std::string& value) {
+			lookup.is_done = true;
+			lookup.is_found = is_found;
+			lookup.value = value;
+		};
+	}
+
+	/**
+	 * Run an event loop for the client until @b lookup is done.
+	 */
+	void wait_for(HTTP::AsyncRedis& redis, int epoll_fd, const Lookup& lookup)
+	{
+		redis.flush();
+		for (int i = 0; i < 100 && !lookup.is_done; ++i)
+		{
+			epoll_event events[4];
+			int count = epoll_wait(epoll_fd, events, 4, 50);
+			for (int j = 0; j < count; ++j)
+			{
+				if (events[j].data.fd == redis.get_fd())
+				{
+					redis.handle_events(events[j].events);
+				}
+			}
+			redis.check_timeout();
+			redis.flush();
+		}
+	}
+} // namespace
+
+TEST(async_redis_tests, pipelined_lookups)
+{
+	FakeRedisServer server;
+	int epoll_fd = epoll_create1(0);
+
+	HTTP::AsyncRedis redis(server.get_uri());
+	redis.attach(epoll_fd);
+	ASSERT_TRUE(redis.is_usable());
+
+	const std::string binary_value("x\0\r\ny", 5);
+	Lookup first;
+	Lookup binary;
+	Lookup missing;
+	redis.set("/?q=fly", "result");
+	redis.set("binary", binary_value, 60);
+	redis.get("/?q=fly", record(first));
+	redis.get("binary", record(binary));
+	redis.get("missing", record(missing));
+	EXPECT_FALSE(first.is_done);
+
+	wait_for(redis, epoll_fd, missing);
+	ASSERT_TRUE(first.is_done && binary.is_done && missing.is_done);
+	EXPECT_TRUE(first.is_found);
+	EXPECT_EQ(first.value, "result");
+	EXPECT_TRUE(binary.is_found);
+	EXPECT_EQ(binary.value, binary_value);
+	EXPECT_FALSE(missing.is_found);
+
+	// five commands left in a single write
+	HTTP::AsyncRedis::Statistics statistics = redis.get_statistics();
+	EXPECT_EQ(statistics.commands, 5);
+	EXPECT_EQ(statistics.replies, 5);
+	EXPECT_EQ(statistics.writes, 1);
+	EXPECT_EQ(statistics.errors, 0);
+
+	Lookup erased;
+	redis.del("/?q=fly");
+	redis.get("/?q=fly", record(erased));
+	wait_for(redis, epoll_fd, erased);
+	EXPECT_TRUE(erased.is_done);
+	EXPECT_FALSE(erased.is_found);
+
+	close(epoll_fd);
+}
+
+TEST(async_redis_tests, database_of_uri_is_selected)
+{
+	FakeRedisServer server;
+	int epoll_fd = epoll_create1(0);
+
+	HTTP::AsyncRedis selected(server.get_uri() + "/1");
+	selected.attach(epoll_fd);
+	Lookup stored;
+	selected.set("/?q=fly", "result");
+	selected.get("/?q=fly", record(stored));
+	wait_for(selected, epoll_fd, stored);
+	EXPECT_TRUE(stored.is_found);
+	EXPECT_EQ(selected.get_statistics().commands, 3);
+
+	// the default database doesn't have it
+	HTTP::AsyncRedis unselected(server.get_uri());
+	unselected.attach(epoll_fd);
+	Lookup missing;
+	unselected.get("/?q=fly", record(missing));
+	wait_for(unselected, epoll_fd, missing);
+	EXPECT_TRUE(missing.is_done);
+	EXPECT_FALSE(missing.is_found);
+
+	// nothing is read from another database than the one asked for
+	HTTP::AsyncRedis out_of_range(server.get_uri() + "/16");
+	out_of_range.attach(epoll_fd);
+	Lookup refused;
+	out_of_range.get("/?q=fly", record(refused));
+	wait_for(out_of_range, epoll_fd, refused);
+	EXPECT_TRUE(refused.is_done);
+	EXPECT_FALSE(refused.is_found);
+	EXPECT_EQ(out_of_range.get_statistics().errors, 1);
+
+	HTTP::AsyncRedis malformed(server.get_uri() + "/one");
+	malformed.attach(epoll_fd);
+	EXPECT_FALSE(malformed.is_usable());
+
+	close(epoll_fd);
+}
+
+TEST(async_redis_tests, unreachable_server_misses_and_backs_off)
+{
+	// a port nothing listens on
+	int unused_socket = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t address_length = sizeof(address);
+	bind(unused_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+	getsockname(unused_socket, reinterpret_cast<sockaddr*>(&address),
+	            &address_length);
+	close(unused_socket);
+
+	int epoll_fd = epoll_create1(0);
+	HTTP::AsyncRedis redis("tcp://127.0.0.1:" +
+	                       std::to_string(ntohs(address.sin_port)));
+	redis.attach(epoll_fd);
+
+	Lookup lookup;
+	redis.get("/?q=fly", record(lookup));
+	wait_for(redis, epoll_fd, lookup);
+	EXPECT_TRUE(lookup.is_done);
+	EXPECT_FALSE(lookup.is_found);
+	EXPECT_EQ(redis.get_statistics().errors, 1);
+
+	// skipped while backing off
+	EXPECT_FALSE(redis.is_usable());
+	Lookup skipped;
+	redis.get("/?q=fly", record(skipped));
+	EXPECT_TRUE(skipped.is_done);
+	EXPECT_FALSE(skipped.is_found);
+
+	close(epoll_fd);
+}
+
+TEST(async_redis_tests, unusable_without_event_loop)
+{
+	HTTP::AsyncRedis redis("tcp://127.0.0.1:6379");
+	EXPECT_FALSE(redis.is_usable());
+
+	Lookup lookup;
+	redis.get("/?q=fly", record(lookup));
+	EXPECT_TRUE(lookup.is_done);
+	EXPECT_FALSE(lookup.is_found);
+
+	redis.set("/?q=fly", "result");
+	EXPECT_EQ(redis.get_statistics().commands, 0);
+	EXPECT_EQ(redis.get_statistics().dropped_commands, 2);
+
+	int epoll_fd = epoll_create1(0);
+	HTTP::AsyncRedis invalid("http://127.0.0.1");
+	invalid.attach(epoll_fd);
+	EXPECT_FALSE(invalid.is_usable());
+	close(epoll_fd);
+}
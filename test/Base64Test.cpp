@@ -1,4 +1,5 @@
 #include "Base64.hpp"
+#include "CpuDispatch.hpp"
 
 #include <gtest/gtest.h>
 #include <vector>
@@ -85,4 +86,125 @@ TEST(base64_tests, encode_hex_string_test)
 	std::string expected_string = "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=";
 
 	ASSERT_EQ(Base64::encode_hex_string(hex_string, true), expected_string);
-}
\ No newline at end of file
+}
+
+namespace
+{
+	// Bit-by-bit reference encoder to check the vector kernels against.
+	std::string reference_encode(const std::string& input, const char* table,
+	                             bool has_padding)
+	{
+		std::string output;
+		uint32_t buffer = 0;
+		int bits = 0;
+		for (unsigned char byte : input)
+		{
+			buffer = (buffer << 8) | byte;
+			bits += 8;
+			while (bits >= 6)
+			{
+				output += table[(buffer >> (bits - 6)) & 0x3f];
+				bits -= 6;
+			}
+		}
+		if (bits > 0)
+		{
+			output += table[(buffer << (6 - bits)) & 0x3f];
+		}
+		while (has_padding && output.size() % 4 != 0)
+		{
+			output += '=';
+		}
+		return output;
+	}
+} // namespace
+
+TEST(base64_tests, long_input_round_trip_test)
+{
+	const char* table =
+	    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	const char* url_table =
+	    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+	// every kernel the CPU can run
+	for (size_t i = 0; i < CpuDispatch::NUMBER_OF_ISAS; ++i)
+	{
+		auto isa = static_cast<CpuDispatch::Isa>(i);
+		if (isa > CpuDispatch::get_detected_isa())
+		{
+			break;
+		}
+		CpuDispatch::force_isa(isa);
+
+		// cover every tail length of the 12-, 24-, 16- and 32-wide kernels
+		std::string input;
+		for (size_t size = 0; size < 300; ++size)
+		{
+			input += static_cast<char>((size * 167 + 13) & 0xff);
+
+			std::string encoded = Base64::encode(input);
+			ASSERT_EQ(encoded, reference_encode(input, table, true))
+			    << CpuDispatch::get_isa_name(isa) << ", size: " << size;
+			ASSERT_EQ(Base64::decode(encoded), input)
+			    << CpuDispatch::get_isa_name(isa) << ", size: " << size;
+
+			std::string url_encoded = Base64::encode_url(input, false);
+			ASSERT_EQ(url_encoded, reference_encode(input, url_table, false))
+			    << CpuDispatch::get_isa_name(isa) << ", size: " << size;
+			ASSERT_EQ(Base64::decode_url(url_encoded, false), input)
+			    << CpuDispatch::get_isa_name(isa) << ", size: " << size;
+		}
+	}
+	CpuDispatch::force_isa("");
+}
+
+TEST(base64_tests, encode_and_decode_into_buffer_test)
+{
+	const std::string input = "Aladdin:open sesame";
+	ASSERT_EQ(Base64::encoded_length(input.size()), 28);
+	ASSERT_EQ(Base64::encoded_length(input.size(), false), 26);
+
+	char encoded[28];
+	ASSERT_EQ(Base64::encode_into(input.data(), input.size(), encoded), 28);
+	ASSERT_EQ(std::string(encoded, 28), "QWxhZGRpbjpvcGVuIHNlc2FtZQ==");
+
+	uint8_t decoded[21];
+	ASSERT_EQ(Base64::decoded_length(28), 21);
+	size_t decoded_size = 0;
+	ASSERT_TRUE(Base64::decode_into(encoded, 28, decoded, decoded_size));
+	ASSERT_EQ(std::string(reinterpret_cast<char*>(decoded), decoded_size),
+	          input);
+
+	// padding is optional
+	ASSERT_TRUE(Base64::decode_into(encoded, 26, decoded, decoded_size));
+	ASSERT_EQ(decoded_size, input.size());
+}
+
+TEST(base64_tests, decode_invalid_input_test)
+{
+	uint8_t decoded[64];
+	size_t decoded_size = 0;
+
+	ASSERT_FALSE(Base64::decode_into("Zm9v!mFy", 8, decoded, decoded_size));
+	ASSERT_FALSE(Base64::decode_into("Zm9vY", 5, decoded, decoded_size));
+	ASSERT_FALSE(Base64::decode_into("Zm_v", 4, decoded, decoded_size));
+	ASSERT_FALSE(Base64::decode_into("Zm+v", 4, decoded, decoded_size, true));
+
+	// padding is checked against what the caller expects
+	ASSERT_EQ(Base64::decode("Zm9vYg"), "");
+	ASSERT_EQ(Base64::decode("Zm9vYg", false), "foob");
+	ASSERT_EQ(Base64::decode_url("Zm9vYg==", false), "");
+	ASSERT_EQ(Base64::decode_url("Zm9vYg=="), "foob");
+
+	// invalid characters inside a vector-sized block and in the tail
+	std::string encoded = Base64::encode(std::string(60, 'x'));
+	for (size_t position = 0; position < encoded.size() - 2; ++position)
+	{
+		std::string corrupted = encoded;
+		corrupted[position] = '.';
+		ASSERT_FALSE(Base64::decode_into(corrupted.data(), corrupted.size(),
+		                                 decoded, decoded_size))
+		    << "position: " << position;
+		ASSERT_EQ(Base64::decode(corrupted), "");
+	}
+}
@@ -0,0 +1,103 @@
+#include "CacheEntry.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+	HTTP::CacheEntry::Variant make_variant(HTTP::ContentEncoding encoding,
+	                                       const std::string& message)
+	{
+		HTTP::CacheEntry::Variant variant;
+		variant.encoding = encoding;
+		variant.message = message.data();
+		variant.length = message.size();
+		variant.date_offset = message.find("Date: ") + 6;
+		return variant;
+	}
+} // namespace
+
+TEST(cache_entry_tests, find_variants)
+{
+	const std::string identity = "HTTP/1.1 200 OK\r\n"
+	                             "Date: Thu, 01 Jan 1970 00:00:00 GMT\r\n"
+	                             "\r\n"
+	                             "hello";
+	const std::string deflate = "HTTP/1.1 200 OK\r\n"
+	                            "Content-Encoding: deflate\r\n"
+	                            "Date: Thu, 01 Jan 1970 00:00:00 GMT\r\n"
+	                            "\r\n"
+	                            "x\x9c\0\0";
+	std::string entry = HTTP::CacheEntry::encode(
+	    {make_variant(HTTP::ContentEncoding::IDENTITY, identity),
+	     make_variant(HTTP::ContentEncoding::DEFLATE, deflate)});
+
+	HTTP::CacheEntry::Variant variant;
+	ASSERT_TRUE(HTTP::CacheEntry::find_variant(
+	    entry, HTTP::ContentEncoding::DEFLATE, variant));
+	EXPECT_EQ(std::string(variant.message, variant.length), deflate);
+	EXPECT_EQ(variant.date_offset, deflate.find("Date: ") + 6);
+
+	ASSERT_TRUE(HTTP::CacheEntry::find_variant(
+	    entry, HTTP::ContentEncoding::IDENTITY, variant));
+	EXPECT_EQ(std::string(variant.message, variant.length), identity);
+}
+
+TEST(cache_entry_tests, reject_malformed_entries)
+{
+	const std::string identity = "HTTP/1.1 200 OK\r\n"
+	                             "Date: Thu, 01 Jan 1970 00:00:00 GMT\r\n"
+	                             "\r\n";
+	std::string entry = HTTP::CacheEntry::encode(
+	    {make_variant(HTTP::ContentEncoding::IDENTITY, identity)});
+
+	HTTP::CacheEntry::Variant variant;
+	EXPECT_FALSE(HTTP::CacheEntry::find_variant(
+	    entry, HTTP::ContentEncoding::DEFLATE, variant));
+
+	// truncated
+	EXPECT_FALSE(HTTP::CacheEntry::find_variant(
+	    entry.substr(0, entry.size() - 1), HTTP::ContentEncoding::IDENTITY,
+	    variant));
+
+	// the old header-delimited format
+	EXPECT_FALSE(HTTP::CacheEntry::find_variant(
+	    "Content-Type:text/html\n\n\n\n\n<html></html>",
+	    HTTP::ContentEncoding::IDENTITY, variant));
+	EXPECT_FALSE(HTTP::CacheEntry::find_variant(
+	    "", HTTP::ContentEncoding::IDENTITY, variant));
+}
+
+TEST(cache_entry_tests, normalize_keys)
+{
+	Uri first;
+	Uri second;
+	Uri third;
+	ASSERT_TRUE(first.parse_from_string("/?q=fly&page=2"));
+	ASSERT_TRUE(second.parse_from_string("/?page=2&q=%66ly"));
+	ASSERT_TRUE(third.parse_from_string("/?q=fly&page=3"));
+
+	EXPECT_EQ(HTTP::CacheEntry::make_key(first),
+	          HTTP::CacheEntry::make_key(second));
+	EXPECT_NE(HTTP::CacheEntry::make_key(first),
+	          HTTP::CacheEntry::make_key(third));
+
+	// only the parameters a resource depends on
+	EXPECT_EQ(HTTP::CacheEntry::make_key(first, {{"q", "fly"}}),
+	          HTTP::CacheEntry::make_key(third, {{"q", "fly"}}));
+	EXPECT_NE(HTTP::CacheEntry::make_key(first, {{"q", "fly"}}),
+	          HTTP::CacheEntry::make_key(first));
+}
+
+TEST(cache_entry_tests, negotiate_encoding)
+{
+	using HTTP::ContentEncoding;
+	using HTTP::CacheEntry::negotiate_encoding;
+
+	EXPECT_EQ(negotiate_encoding(""), ContentEncoding::IDENTITY);
+	EXPECT_EQ(negotiate_encoding("gzip"), ContentEncoding::IDENTITY);
+	EXPECT_EQ(negotiate_encoding("gzip, deflate, br"),
+	          ContentEncoding::DEFLATE);
+	EXPECT_EQ(negotiate_encoding("Deflate;q=0.5"), ContentEncoding::DEFLATE);
+	EXPECT_EQ(negotiate_encoding("deflate;q=0"), ContentEncoding::IDENTITY);
+	EXPECT_EQ(negotiate_encoding("*"), ContentEncoding::DEFLATE);
+}
@@ -1,7 +1,23 @@
 #include "Cache.hpp"
+#include "ServerConfiguration.hpp"
+#include "SharedCache.hpp"
+#include "Timer.hpp"
 
 #include <gtest/gtest.h>
 
+namespace
+{
+	// Seconds the fake clock is ahead of the real one.
+	time_t clock_offset = 0;
+
+	int read_shifted_clock(clockid_t clock_id, timespec* time)
+	{
+		int result = clock_gettime(clock_id, time);
+		time->tv_sec += clock_offset;
+		return result;
+	}
+} // namespace
+
 TEST(cache_tests, cache_test)
 {
 	HTTP::Cache cache;
@@ -11,4 +27,228 @@ TEST(cache_tests, cache_test)
 	EXPECT_TRUE(cache.insert(key, value));
 	EXPECT_EQ(cache.get(key), value);
 	EXPECT_TRUE(cache.erase(key));
-}
\ No newline at end of file
+}
+
+TEST(cache_tests, local_cache_without_redis_test)
+{
+	ServerConfiguration* configuration = ServerConfiguration::instance();
+	const std::string previous_redis_uri = configuration->get_redis_uri();
+	configuration->set_redis_uri("");
+
+	HTTP::Cache cache;
+	EXPECT_FALSE(cache.has_redis());
+
+	std::string key = "/home/bitate/?q=";
+	EXPECT_EQ(cache.get(key), "");
+	EXPECT_TRUE(cache.insert(key, "demo"));
+	EXPECT_EQ(cache.get(key), "demo");
+	EXPECT_TRUE(cache.erase(key));
+
+	HTTP::LocalCache::Statistics statistics = cache.get_statistics();
+	EXPECT_EQ(statistics.hits, 1);
+	EXPECT_EQ(statistics.misses, 1);
+	EXPECT_EQ(statistics.number_of_entries, 0);
+
+	configuration->set_redis_uri(previous_redis_uri);
+}
+
+TEST(cache_tests, asynchronous_lookup_without_event_loop_test)
+{
+	HTTP::Cache cache;
+
+	std::string key = "/home/bitate/?q=async";
+	bool is_done = false;
+	bool is_hit = true;
+	cache.get(key,
+	          [&](HTTP::Cache::Lookup lookup, const std::string&) {
+		          is_done = true;
+		          is_hit = lookup == HTTP::Cache::Lookup::HIT;
+	          });
+
+	// without an event loop, Redis is never waited for
+	EXPECT_TRUE(is_done);
+	EXPECT_FALSE(is_hit);
+
+	EXPECT_TRUE(cache.insert(key, "demo"));
+	std::string value;
+	cache.get(key,
+	          [&](HTTP::Cache::Lookup, const std::string& resource) {
+		          value = resource;
+	          });
+	EXPECT_EQ(value, "demo");
+	EXPECT_TRUE(cache.erase(key));
+}
+
+TEST(cache_tests, wait_for_resource_leased_by_another_worker_test)
+{
+	SharedCache::create(1 << 20);
+	HTTP::Cache cache;
+
+	// another worker is computing it
+	std::string key = "/home/bitate/?q=leased";
+	ASSERT_TRUE(SharedCache::acquire_lease(key, 60000));
+
+	bool is_done = false;
+	std::string value;
+	cache.get(key,
+	          [&](HTTP::Cache::Lookup, const std::string& resource) {
+		          is_done = true;
+		          value = resource;
+	          });
+	EXPECT_FALSE(is_done);
+	EXPECT_EQ(cache.get_number_of_lease_waits(), 1);
+	EXPECT_NE(cache.get_poll_timeout(), -1);
+
+	cache.flush();
+	EXPECT_FALSE(is_done);
+
+	// which inserts it, ending the lease
+	HTTP::Cache other_worker_cache;
+	other_worker_cache.insert(key, "demo");
+	cache.flush();
+	EXPECT_TRUE(is_done);
+	EXPECT_EQ(value, "demo");
+
+	// a miss leases the resource to the caller until it is inserted
+	std::string other_key = "/home/bitate/?q=missing";
+	bool is_hit = true;
+	cache.get(other_key,
+	          [&](HTTP::Cache::Lookup lookup, const std::string&) {
+		          is_hit = lookup == HTTP::Cache::Lookup::HIT;
+	          });
+	EXPECT_FALSE(is_hit);
+	EXPECT_TRUE(SharedCache::is_leased(other_key));
+	cache.release(other_key);
+	EXPECT_FALSE(SharedCache::is_leased(other_key));
+
+	cache.erase(key);
+	SharedCache::destroy();
+}
+
+TEST(cache_tests, stale_while_revalidate_test)
+{
+	SharedCache::create(1 << 20);
+	HTTP::Cache cache;
+
+	HTTP::Cache::Lookup last_lookup = HTTP::Cache::Lookup::MISS;
+	std::string value;
+	auto look_up = [&](HTTP::Cache::Lookup lookup,
+	                   const std::string& resource) {
+		last_lookup = lookup;
+		value = resource;
+	};
+
+	HTTP::Freshness freshness;
+	freshness.time_to_live = 60;
+	freshness.stale_while_revalidate = 60;
+	std::string key = "/home/bitate/?q=stale";
+	ASSERT_TRUE(cache.insert(key, "old", freshness));
+	cache.get(key, look_up);
+	EXPECT_EQ(last_lookup, HTTP::Cache::Lookup::HIT);
+
+	// news were added: the old result is served while one lookup
+	// searches again
+	cache.set_generation(1);
+	EXPECT_EQ(cache.get(key), "");
+	cache.get(key, look_up);
+	EXPECT_EQ(last_lookup, HTTP::Cache::Lookup::REVALIDATE);
+	EXPECT_EQ(value, "old");
+	cache.get(key, look_up);
+	EXPECT_EQ(last_lookup, HTTP::Cache::Lookup::HIT);
+	EXPECT_EQ(value, "old");
+	EXPECT_EQ(cache.get_number_of_stale_hits(), 2);
+	EXPECT_EQ(cache.get_number_of_revalidations(), 1);
+
+	ASSERT_TRUE(cache.insert(key, "new", freshness));
+	EXPECT_FALSE(SharedCache::is_leased(key));
+	cache.get(key, look_up);
+	EXPECT_EQ(last_lookup, HTTP::Cache::Lookup::HIT);
+	EXPECT_EQ(value, "new");
+
+	// results of a later generation are fresh, those without a stale
+	// window are misses once outdated
+	cache.set_generation(0);
+	EXPECT_EQ(cache.get(key), "new");
+	ASSERT_TRUE(cache.insert(key, "new", HTTP::Freshness()));
+	cache.set_generation(1);
+	cache.get(key, look_up);
+	EXPECT_EQ(last_lookup, HTTP::Cache::Lookup::MISS);
+	cache.release(key);
+
+	cache.erase(key);
+	SharedCache::destroy();
+}
+
+TEST(cache_tests, stale_window_starts_at_new_generation_test)
+{
+	SharedCache::create(1 << 20);
+	HTTP::Cache cache;
+	Timer::set_time_source(read_shifted_clock);
+	clock_offset = 0;
+
+	HTTP::Cache::Lookup last_lookup = HTTP::Cache::Lookup::MISS;
+	auto look_up = [&](HTTP::Cache::Lookup lookup, const std::string&) {
+		last_lookup = lookup;
+	};
+
+	// served until the generation changes, then stale for 60 seconds
+	HTTP::Freshness freshness;
+	freshness.stale_while_revalidate = 60;
+	std::string key = "/home/bitate/?q=outdated";
+	ASSERT_TRUE(cache.insert(key, "old", freshness));
+
+	clock_offset = 600;
+	cache.set_generation(1);
+	cache.get(key, look_up);
+	EXPECT_EQ(last_lookup, HTTP::Cache::Lookup::REVALIDATE);
+	cache.release(key);
+
+	clock_offset = 650;
+	cache.get(key, look_up);
+	EXPECT_EQ(last_lookup, HTTP::Cache::Lookup::REVALIDATE);
+	cache.release(key);
+
+	clock_offset = 670;
+	cache.get(key, look_up);
+	EXPECT_EQ(last_lookup, HTTP::Cache::Lookup::MISS);
+	cache.release(key);
+
+	Timer::set_time_source(nullptr);
+	cache.erase(key);
+	SharedCache::destroy();
+}
+
+TEST(cache_tests, negative_cache_test)
+{
+	SharedCache::create(1 << 20);
+	HTTP::Cache cache;
+
+	// a search without results ends its lease and isn't searched again
+	std::string key = "/home/bitate/?q=nothing";
+	bool is_missed = false;
+	cache.get(key, [&](HTTP::Cache::Lookup lookup,
+	                   const std::string&) {
+		is_missed = lookup == HTTP::Cache::Lookup::MISS;
+	});
+	ASSERT_TRUE(is_missed);
+	EXPECT_FALSE(cache.is_known_missing(key));
+	cache.insert_missing(key);
+	EXPECT_FALSE(SharedCache::is_leased(key));
+	EXPECT_TRUE(cache.is_known_missing(key));
+
+	// news may have it
+	cache.set_generation(1);
+	EXPECT_FALSE(cache.is_known_missing(key));
+
+	cache.insert_missing(key);
+	ASSERT_TRUE(cache.insert(key, "found"));
+	EXPECT_FALSE(cache.is_known_missing(key));
+
+	HTTP::NegativeCache::Statistics statistics =
+	    cache.get_negative_statistics();
+	EXPECT_EQ(statistics.hits, 1);
+	EXPECT_EQ(statistics.insertions, 2);
+
+	cache.erase(key);
+	SharedCache::destroy();
+}
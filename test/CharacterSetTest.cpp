@@ -75,4 +75,49 @@ TEST(character_set_tests, construct_a_list_of_character_sets)
 	{
 		ASSERT_TRUE(character_set_3.is_contains(character));
 	}
-}
\ No newline at end of file
+}
+
+TEST(character_set_tests, constexpr_character_set_test)
+{
+	constexpr CharacterSet character_set =
+	    CharacterSet('a', 'c') | CharacterSet::from_characters("$%");
+
+	static_assert(character_set.is_contains('b'), "range member");
+	static_assert(character_set.is_contains('%'), "listed member");
+	static_assert(!character_set.is_contains('d'), "not a member");
+
+	ASSERT_TRUE(character_set == (CharacterSet{'a', 'b', 'c', '$', '%'}));
+}
+
+TEST(character_set_tests, high_bytes_test)
+{
+	CharacterSet character_set('\x80', '\xff');
+
+	ASSERT_TRUE(character_set.is_contains('\x80'));
+	ASSERT_TRUE(character_set.is_contains('\xff'));
+	ASSERT_FALSE(character_set.is_contains('\x7f'));
+	ASSERT_EQ(character_set.get_character_set().size(), 128);
+}
+
+TEST(character_set_tests, rfc3986_character_classes_test)
+{
+	for (char character : std::string{":/?#[]@!$&'()*+,;="})
+	{
+		ASSERT_TRUE(Rfc3986::RESERVED.is_contains(character));
+		ASSERT_FALSE(Rfc3986::UNRESERVED.is_contains(character));
+	}
+
+	for (char character : std::string{"azAZ09-._~"})
+	{
+		ASSERT_TRUE(Rfc3986::UNRESERVED.is_contains(character));
+		ASSERT_TRUE(Rfc3986::PCHAR.is_contains(character));
+	}
+
+	ASSERT_TRUE(Rfc3986::PCHAR.is_contains(':'));
+	ASSERT_FALSE(Rfc3986::PCHAR.is_contains('/'));
+	ASSERT_TRUE(Rfc3986::QUERY.is_contains('/'));
+	ASSERT_TRUE(Rfc3986::QUERY.is_contains('?'));
+	ASSERT_FALSE(Rfc3986::QUERY.is_contains('#'));
+	ASSERT_FALSE(Rfc3986::QUERY.is_contains(' '));
+	ASSERT_FALSE(Rfc3986::QUERY.is_contains('%'));
+}
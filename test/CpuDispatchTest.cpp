@@ -0,0 +1,67 @@
+#include "CpuDispatch.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+	int scalar_variant() { return 0; }
+	int ssse3_variant() { return 2; }
+	int avx2_variant() { return 4; }
+} // namespace
+
+TEST(cpu_dispatch_tests, force_isa_test)
+{
+	const CpuDispatch::Isa detected_isa = CpuDispatch::get_detected_isa();
+	ASSERT_EQ(CpuDispatch::get_active_isa(), detected_isa);
+
+	CpuDispatch::force_isa(CpuDispatch::Isa::SCALAR);
+	ASSERT_EQ(CpuDispatch::get_active_isa(), CpuDispatch::Isa::SCALAR);
+	ASSERT_FALSE(CpuDispatch::has_sha_extensions());
+
+	// forcing a wider level than the CPU has is clamped
+	CpuDispatch::force_isa(CpuDispatch::Isa::AVX2);
+	ASSERT_EQ(CpuDispatch::get_active_isa(), detected_isa);
+
+	ASSERT_TRUE(CpuDispatch::force_isa("sse2"));
+	ASSERT_LE(CpuDispatch::get_active_isa(), CpuDispatch::Isa::SSE2);
+	ASSERT_FALSE(CpuDispatch::force_isa("avx512"));
+	ASSERT_LE(CpuDispatch::get_active_isa(), CpuDispatch::Isa::SSE2);
+
+	ASSERT_TRUE(CpuDispatch::force_isa(""));
+	ASSERT_EQ(CpuDispatch::get_active_isa(), detected_isa);
+}
+
+TEST(cpu_dispatch_tests, isa_name_test)
+{
+	for (size_t i = 0; i < CpuDispatch::NUMBER_OF_ISAS; ++i)
+	{
+		auto isa = static_cast<CpuDispatch::Isa>(i);
+		ASSERT_TRUE(CpuDispatch::force_isa(CpuDispatch::get_isa_name(isa)));
+	}
+	ASSERT_STREQ(CpuDispatch::get_isa_name(CpuDispatch::Isa::SSE42),
+	             "sse4.2");
+
+	CpuDispatch::force_isa("");
+}
+
+TEST(cpu_dispatch_tests, kernel_fallback_test)
+{
+	constexpr CpuDispatch::Kernel<int (*)()> kernel{
+	    scalar_variant, nullptr, ssse3_variant, nullptr, avx2_variant};
+
+	const int expected_variants[CpuDispatch::NUMBER_OF_ISAS] = {0, 0, 2, 2, 4};
+	for (size_t i = 0; i < CpuDispatch::NUMBER_OF_ISAS; ++i)
+	{
+		auto isa = static_cast<CpuDispatch::Isa>(i);
+		if (isa > CpuDispatch::get_detected_isa())
+		{
+			break;
+		}
+
+		CpuDispatch::force_isa(isa);
+		ASSERT_EQ(kernel.get()(), expected_variants[i])
+		    << CpuDispatch::get_isa_name(isa);
+	}
+
+	CpuDispatch::force_isa("");
+}
@@ -0,0 +1,84 @@
+#include "DatabaseImage.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+	const std::string FILE_PATH = "/tmp/database_image_test.db";
+
+	void create_database()
+	{
+		std::remove(FILE_PATH.c_str());
+		sqlite3* connection = nullptr;
+		sqlite3_open(FILE_PATH.c_str(), &connection);
+		sqlite3_exec(connection,
+		             "PRAGMA journal_mode = WAL;"
+		             "CREATE TABLE word(value TEXT);"
+		             "INSERT INTO word VALUES('fly'), ('bee');",
+		             nullptr, nullptr, nullptr);
+		sqlite3_close(connection);
+	}
+
+	int count_words(sqlite3* connection)
+	{
+		sqlite3_stmt* statement = nullptr;
+		sqlite3_prepare_v2(connection, "SELECT count(*) FROM word", -1,
+		                   &statement, nullptr);
+		int count = -1;
+		if (sqlite3_step(statement) == SQLITE_ROW)
+		{
+			count = sqlite3_column_int(statement, 0);
+		}
+		sqlite3_finalize(statement);
+		return count;
+	}
+} // namespace
+
+TEST(database_image_tests, search_image)
+{
+	create_database();
+	EXPECT_EQ(DatabaseImage::open(), nullptr);
+	ASSERT_TRUE(DatabaseImage::create(FILE_PATH));
+	EXPECT_TRUE(DatabaseImage::is_loaded());
+	EXPECT_GT(DatabaseImage::get_size(), 0);
+
+	sqlite3* connection = DatabaseImage::open();
+	ASSERT_NE(connection, nullptr);
+	EXPECT_EQ(count_words(connection), 2);
+	EXPECT_NE(sqlite3_exec(connection, "INSERT INTO word VALUES('ant')",
+	                       nullptr, nullptr, nullptr),
+	          SQLITE_OK);
+	sqlite3_close(connection);
+
+	// a snapshot of the file
+	sqlite3* file = nullptr;
+	sqlite3_open(FILE_PATH.c_str(), &file);
+	sqlite3_exec(file, "INSERT INTO word VALUES('ant')", nullptr, nullptr,
+	             nullptr);
+	sqlite3_close(file);
+
+	pid_t pid = fork();
+	if (pid == 0)
+	{
+		sqlite3* child_connection = DatabaseImage::open();
+		_exit(count_words(child_connection) == 2 ? 0 : 1);
+	}
+	int status = 0;
+	ASSERT_EQ(waitpid(pid, &status, 0), pid);
+	EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+	DatabaseImage::destroy();
+	EXPECT_FALSE(DatabaseImage::is_loaded());
+	EXPECT_EQ(DatabaseImage::get_size(), 0);
+	EXPECT_FALSE(DatabaseImage::create("/tmp/no_such_directory/news.db"));
+
+	std::remove(FILE_PATH.c_str());
+	std::remove((FILE_PATH + "-wal").c_str());
+	std::remove((FILE_PATH + "-shm").c_str());
+}
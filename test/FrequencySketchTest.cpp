@@ -0,0 +1,71 @@
+#include "FrequencySketch.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(frequency_sketch_tests, estimate_and_admit)
+{
+	HTTP::FrequencySketch sketch(1000);
+	EXPECT_EQ(sketch.estimate(1), 0);
+
+	for (int i = 0; i < 5; ++i)
+	{
+		sketch.increment(1);
+	}
+	sketch.increment(2);
+
+	EXPECT_EQ(sketch.estimate(1), 5);
+	EXPECT_EQ(sketch.estimate(2), 1);
+	EXPECT_TRUE(sketch.admit(1, 2));
+	EXPECT_FALSE(sketch.admit(2, 1));
+
+	// ties keep the victim
+	EXPECT_FALSE(sketch.admit(2, 2));
+
+	// counters saturate
+	for (int i = 0; i < 20; ++i)
+	{
+		sketch.increment(1);
+	}
+	EXPECT_EQ(sketch.estimate(1), 15);
+}
+
+TEST(frequency_sketch_tests, popular_keys_fade_out)
+{
+	HTTP::FrequencySketch sketch(64);
+	for (int i = 0; i < 8; ++i)
+	{
+		sketch.increment(1);
+	}
+
+	// ten accesses per word of counters halve them all
+	for (uint64_t key_hash = 100; key_hash < 100 + 632; ++key_hash)
+	{
+		sketch.increment(key_hash);
+	}
+	EXPECT_GE(sketch.estimate(1), 4);
+	EXPECT_LT(sketch.estimate(1), 8);
+}
+
+TEST(frequency_sketch_tests, shared_table)
+{
+	std::vector<std::atomic<uint64_t>> table(
+	    HTTP::FrequencySketch::get_table_size(1000));
+	HTTP::FrequencySketch first(table.data(), 1000);
+	HTTP::FrequencySketch second(table.data(), 1000);
+
+	first.increment(7);
+	second.increment(7);
+	EXPECT_EQ(first.estimate(7), 2);
+	EXPECT_EQ(second.estimate(7), 2);
+}
+
+TEST(frequency_sketch_tests, policy_names)
+{
+	EXPECT_EQ(HTTP::to_cache_policy("lru"), HTTP::CachePolicy::LRU);
+	EXPECT_EQ(HTTP::to_cache_policy("tinylfu"), HTTP::CachePolicy::TINY_LFU);
+	EXPECT_STREQ(HTTP::get_cache_policy_name(HTTP::CachePolicy::LRU), "lru");
+	EXPECT_STREQ(HTTP::get_cache_policy_name(HTTP::CachePolicy::TINY_LFU),
+	             "tinylfu");
+}
@@ -0,0 +1,142 @@
+#include "LocalCache.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+	// Size charged for an entry of a one-byte key and @b value_size bytes.
+	size_t entry_size(size_t value_size)
+	{
+		HTTP::LocalCache cache(1 << 20, 1);
+		cache.insert("k", std::string(value_size, 'v'));
+		return cache.get_statistics().size_in_bytes;
+	}
+} // namespace
+
+TEST(local_cache_tests, get_insert_erase)
+{
+	HTTP::LocalCache cache(1 << 20, 4);
+
+	std::string value;
+	EXPECT_FALSE(cache.get("/?q=fly", value));
+	EXPECT_TRUE(cache.insert("/?q=fly", "result"));
+	EXPECT_TRUE(cache.get("/?q=fly", value));
+	EXPECT_EQ(value, "result");
+
+	EXPECT_TRUE(cache.insert("/?q=fly", "new result"));
+	EXPECT_TRUE(cache.get("/?q=fly", value));
+	EXPECT_EQ(value, "new result");
+
+	EXPECT_TRUE(cache.erase("/?q=fly"));
+	EXPECT_FALSE(cache.erase("/?q=fly"));
+	EXPECT_FALSE(cache.get("/?q=fly", value));
+
+	HTTP::LocalCache::Statistics statistics = cache.get_statistics();
+	EXPECT_EQ(statistics.hits, 2);
+	EXPECT_EQ(statistics.misses, 2);
+	EXPECT_EQ(statistics.evictions, 0);
+	EXPECT_EQ(statistics.size_in_bytes, 0);
+	EXPECT_EQ(statistics.number_of_entries, 0);
+}
+
+TEST(local_cache_tests, bounded_size)
+{
+	const size_t size = entry_size(100);
+	HTTP::LocalCache cache(size * 10, 1);
+
+	for (int i = 0; i < 100; ++i)
+	{
+		std::string key(1, static_cast<char>(i));
+		ASSERT_TRUE(cache.insert(key, std::string(100, 'v')));
+		ASSERT_LE(cache.get_statistics().size_in_bytes, size * 10);
+	}
+
+	HTTP::LocalCache::Statistics statistics = cache.get_statistics();
+	EXPECT_EQ(statistics.number_of_entries, 10);
+	EXPECT_EQ(statistics.evictions, 90);
+
+	// larger than the capacity
+	EXPECT_FALSE(cache.insert("large", std::string(size * 10, 'v')));
+}
+
+TEST(local_cache_tests, second_chance_for_hits)
+{
+	const size_t size = entry_size(0);
+	HTTP::LocalCache cache(size * 3, 1);
+
+	cache.insert("a", "");
+	cache.insert("b", "");
+	cache.insert("c", "");
+
+	std::string value;
+	ASSERT_TRUE(cache.get("a", value));
+
+	// "a" was referenced, so "b" goes first, then "c"
+	cache.insert("d", "");
+	EXPECT_TRUE(cache.get("a", value));
+	EXPECT_FALSE(cache.get("b", value));
+	EXPECT_TRUE(cache.get("c", value));
+	EXPECT_TRUE(cache.get("d", value));
+}
+
+TEST(local_cache_tests, clear)
+{
+	HTTP::LocalCache cache(1 << 20, 8);
+	for (int i = 0; i < 100; ++i)
+	{
+		cache.insert(std::to_string(i), "value");
+	}
+	cache.clear();
+
+	std::string value;
+	EXPECT_FALSE(cache.get("1", value));
+	EXPECT_EQ(cache.get_statistics().number_of_entries, 0);
+	EXPECT_EQ(cache.get_statistics().size_in_bytes, 0);
+	EXPECT_TRUE(cache.insert("1", "value"));
+}
+
+TEST(local_cache_tests, tiny_lfu_resists_scans)
+{
+	const size_t size = entry_size(4000);
+	HTTP::LocalCache lru(size * 100, 1, HTTP::CachePolicy::LRU);
+	HTTP::LocalCache tiny_lfu(size * 100, 1, HTTP::CachePolicy::TINY_LFU);
+
+	std::string value;
+	auto look_up = [&value](HTTP::LocalCache& cache, const std::string& key) {
+		if (!cache.get(key, value))
+		{
+			cache.insert(key, std::string(4000, 'v'));
+		}
+	};
+
+	// popular queries, between scans of one-off ones larger than the cache
+	for (HTTP::LocalCache* cache : {&lru, &tiny_lfu})
+	{
+		for (int round = 0; round < 5; ++round)
+		{
+			for (int i = 0; i < 50; ++i)
+			{
+				look_up(*cache, "hot" + std::to_string(i));
+			}
+			for (int i = 0; i < 200; ++i)
+			{
+				look_up(*cache, "scan" + std::to_string(round * 200 + i));
+			}
+		}
+	}
+
+	int lru_hits = 0;
+	int tiny_lfu_hits = 0;
+	for (int i = 0; i < 50; ++i)
+	{
+		std::string key = "hot" + std::to_string(i);
+		lru_hits += lru.get(key, value) ? 1 : 0;
+		tiny_lfu_hits += tiny_lfu.get(key, value) ? 1 : 0;
+	}
+
+	EXPECT_EQ(lru_hits, 0);
+	EXPECT_GE(tiny_lfu_hits, 45);
+	EXPECT_EQ(lru.get_statistics().rejections, 0);
+	EXPECT_GT(tiny_lfu.get_statistics().rejections, 0);
+	EXPECT_LE(tiny_lfu.get_statistics().size_in_bytes, size * 100);
+}
@@ -0,0 +1,82 @@
+#include "NegativeCache.hpp"
+#include "Timer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace
+{
+	// Seconds the fake clock is ahead of the real one.
+	time_t clock_offset = 0;
+
+	int read_shifted_clock(clockid_t clock_id, timespec* time)
+	{
+		int result = clock_gettime(clock_id, time);
+		time->tv_sec += clock_offset;
+		return result;
+	}
+} // namespace
+
+TEST(negative_cache_tests, insert_erase_clear)
+{
+	HTTP::NegativeCache cache(64, 60 * 1000);
+	EXPECT_FALSE(cache.contains("/?q=flyy"));
+
+	cache.insert("/?q=flyy");
+	cache.insert("/?q=asdf");
+	EXPECT_TRUE(cache.contains("/?q=flyy"));
+	EXPECT_TRUE(cache.contains("/?q=asdf"));
+	EXPECT_FALSE(cache.contains("/?q=fly"));
+
+	cache.erase("/?q=flyy");
+	EXPECT_FALSE(cache.contains("/?q=flyy"));
+	EXPECT_TRUE(cache.contains("/?q=asdf"));
+
+	cache.clear();
+	EXPECT_FALSE(cache.contains("/?q=asdf"));
+
+	HTTP::NegativeCache::Statistics statistics = cache.get_statistics();
+	EXPECT_EQ(statistics.hits, 3);
+	EXPECT_EQ(statistics.insertions, 2);
+	EXPECT_EQ(statistics.evictions, 0);
+}
+
+TEST(negative_cache_tests, entries_expire)
+{
+	Timer::set_time_source(read_shifted_clock);
+	clock_offset = 0;
+
+	HTTP::NegativeCache cache(64, 60 * 1000);
+	cache.insert("/?q=flyy");
+	EXPECT_TRUE(cache.contains("/?q=flyy"));
+
+	clock_offset = 30;
+	EXPECT_TRUE(cache.contains("/?q=flyy"));
+
+	clock_offset = 61;
+	EXPECT_FALSE(cache.contains("/?q=flyy"));
+
+	HTTP::NegativeCache disabled(64, 0);
+	disabled.insert("/?q=flyy");
+	EXPECT_FALSE(disabled.contains("/?q=flyy"));
+
+	Timer::set_time_source(nullptr);
+}
+
+TEST(negative_cache_tests, bounded_size)
+{
+	HTTP::NegativeCache cache(64, 60 * 1000);
+	for (int i = 0; i < 1000; ++i)
+	{
+		cache.insert("/?q=typo" + std::to_string(i));
+	}
+
+	int number_of_remembered = 0;
+	for (int i = 0; i < 1000; ++i)
+	{
+		number_of_remembered += cache.contains("/?q=typo" + std::to_string(i));
+	}
+	EXPECT_EQ(number_of_remembered, 64);
+	EXPECT_EQ(cache.get_statistics().evictions, 1000 - 64);
+}
@@ -1,4 +1,5 @@
 #include "PercentEncoding.hpp"
+#include "CpuDispatch.hpp"
 
 #include <gtest/gtest.h>
 
@@ -61,3 +62,57 @@ TEST(encode_tests, encode_ascii_character_set_test)
 	std::string encodedString4 = "tel%3A%2B1-816-555-1212";
 	ASSERT_EQ(percent_encode.encode(decodedString4), encodedString4);
 }
+
+TEST(decode_tests, decode_without_escapes_test)
+{
+	std::string clean = "/?q=a+clean+query+with+no+escapes+at+all";
+
+	ASSERT_FALSE(PercentEncoding::needs_decoding(clean));
+	ASSERT_TRUE(PercentEncoding::needs_decoding(clean, true));
+
+	std::string decoded = clean;
+	PercentEncoding::decode_in_place(decoded);
+	ASSERT_EQ(decoded, clean);
+
+	PercentEncoding::decode_in_place(decoded, true);
+	ASSERT_EQ(decoded, "/?q=a clean query with no escapes at all");
+}
+
+TEST(decode_tests, decode_in_place_test)
+{
+	std::string encoded = "name=%E4%BD%A0%e5%a5%bd+world&x=100%25";
+	PercentEncoding::decode_in_place(encoded, true);
+	ASSERT_EQ(encoded, "name=\xE4\xBD\xA0\xE5\xA5\xBD world&x=100%");
+
+	// escapes at every offset of the 16- and 32-byte vector scans
+	for (size_t i = 0; i < CpuDispatch::NUMBER_OF_ISAS; ++i)
+	{
+		auto isa = static_cast<CpuDispatch::Isa>(i);
+		if (isa > CpuDispatch::get_detected_isa())
+		{
+			break;
+		}
+		CpuDispatch::force_isa(isa);
+
+		for (size_t prefix = 0; prefix < 70; ++prefix)
+		{
+			std::string text = std::string(prefix, 'a') + "%2F" +
+			                   std::string(prefix, 'b') + "%3a";
+			PercentEncoding::decode_in_place(text);
+			ASSERT_EQ(text, std::string(prefix, 'a') + "/" +
+			                    std::string(prefix, 'b') + ":")
+			    << CpuDispatch::get_isa_name(isa);
+		}
+	}
+	CpuDispatch::force_isa("");
+}
+
+TEST(decode_tests, decode_malformed_escape_test)
+{
+	PercentEncoding percent_encode;
+
+	ASSERT_EQ(percent_encode.decode("100%"), "100%");
+	ASSERT_EQ(percent_encode.decode("%4"), "%4");
+	ASSERT_EQ(percent_encode.decode("%G1%41"), "%G1A");
+	ASSERT_EQ(percent_encode.decode("%%41"), "%A");
+}
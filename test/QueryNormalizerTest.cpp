@@ -0,0 +1,40 @@
+#include "QueryNormalizer.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(query_normalizer_tests, variants_of_a_query)
+{
+	EXPECT_EQ(QueryNormalizer::normalize("fly"), "fly");
+	EXPECT_EQ(QueryNormalizer::normalize("Fly"), "fly");
+	EXPECT_EQ(QueryNormalizer::normalize(" FLY  "), "fly");
+	EXPECT_EQ(QueryNormalizer::normalize("fruit \t\n fly"), "fruit fly");
+	EXPECT_EQ(QueryNormalizer::normalize("fruit\xE3\x80\x80" "fly"),
+	          "fruit fly");
+	EXPECT_EQ(QueryNormalizer::normalize(""), "");
+	EXPECT_EQ(QueryNormalizer::normalize("   "), "");
+}
+
+TEST(query_normalizer_tests, unicode)
+{
+	EXPECT_EQ(QueryNormalizer::normalize("CAF\xC3\x89"), "caf\xC3\xA9");
+	EXPECT_EQ(QueryNormalizer::normalize("\xD0\x9C\xD0\xB8\xD1\x80"),
+	          "\xD0\xBC\xD0\xB8\xD1\x80"); // Мир
+	EXPECT_EQ(QueryNormalizer::normalize("\xE6\x97\xA5\xE6\x9C\xAC"),
+	          "\xE6\x97\xA5\xE6\x9C\xAC"); // 日本
+
+	// q with a circumflex and a dot below, either way round
+	EXPECT_EQ(QueryNormalizer::normalize("q\xCC\x82\xCC\xA3"),
+	          QueryNormalizer::normalize("Q\xCC\xA3\xCC\x82"));
+}
+
+TEST(query_normalizer_tests, keep_fts5_operators)
+{
+	EXPECT_EQ(QueryNormalizer::normalize("Fly OR Bee"), "fly OR bee");
+	EXPECT_EQ(QueryNormalizer::normalize("fly  NOT bee"), "fly NOT bee");
+	EXPECT_EQ(QueryNormalizer::normalize("NEAR(Fly Bee)"), "NEAR(fly bee)");
+	EXPECT_EQ(QueryNormalizer::normalize("Body:Fly*"), "body:fly*");
+
+	// within strings they are words
+	EXPECT_EQ(QueryNormalizer::normalize("\"Fly OR Bee\""), "\"fly or bee\"");
+	EXPECT_EQ(QueryNormalizer::normalize("ORDER"), "order");
+}
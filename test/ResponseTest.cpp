@@ -83,46 +83,135 @@ TEST(response_tests, map_status_code_to_reaseon_phrase)
 	          "HTTP Version Not Supported");
 }
 
-TEST(response_tests, response_header_serialization_test)
+TEST(response_tests, prebuilt_status_line)
 {
 	Message::Response response;
 
-	ASSERT_TRUE(response.add_header("Date", "Mon, 27 Jul 2009 12:28:53 GMT"));
-	ASSERT_TRUE(response.add_header("Accept-Ranges", "bytes"));
-	ASSERT_TRUE(response.add_header("Content-Length", "51"));
-	ASSERT_TRUE(response.add_header("Content-Type", "text/plain"));
+	ASSERT_TRUE(response.set_status(404));
+	ASSERT_EQ(response.get_reason_phrase(), "Not Found");
+	ASSERT_EQ(response.generate_response(), "HTTP/1.1 404 Not Found\r\n\r\n");
+
+	ASSERT_TRUE(response.set_status(511));
+	ASSERT_EQ(response.generate_response(),
+	          "HTTP/1.1 511 Network Authentication Required\r\n\r\n");
+}
+
+TEST(response_tests, unknown_status_code)
+{
+	Message::Response response;
 
-	std::string expected_result{"Accept-Ranges:bytes\n"
-	                            "Content-Length:51\n"
-	                            "Content-Type:text/plain\n"
-	                            "\n\n\n\n"};
+	ASSERT_EQ(response.get_status_code_reason_string(299), "");
+	ASSERT_FALSE(response.set_reason_phrase(299));
 
-	ASSERT_EQ(response.serialize_headers(), expected_result);
+	ASSERT_TRUE(response.set_status(299));
+	ASSERT_EQ(response.get_status_code(), 299);
+	ASSERT_EQ(response.get_reason_phrase(), "");
+	ASSERT_EQ(response.generate_response(), "HTTP/1.1 299 \r\n\r\n");
 }
 
-TEST(response_tests, response_header_serialization_empty_header_test)
+TEST(response_tests, status_line_of_other_protocol_version)
 {
 	Message::Response response;
 
-	std::string expected_result{"\n\n\n\n"};
+	ASSERT_TRUE(response.set_protocol_version("HTTP/1.0"));
+	ASSERT_TRUE(response.set_status(200));
+	ASSERT_EQ(response.generate_response(), "HTTP/1.0 200 OK\r\n\r\n");
+}
+
+TEST(response_tests, content_length_of_body)
+{
+	Message::Response response;
 
-	ASSERT_EQ(response.serialize_headers(), expected_result);
+	for (size_t size : {0, 1, 9, 10, 99, 100, 101, 999, 1000, 12345, 1000000})
+	{
+		response.set_body(std::string(size, 'x'));
+		ASSERT_EQ(response.get_header("Content-Length"), std::to_string(size));
+	}
 }
 
-TEST(response_tests, response_header_deserialization_test)
+TEST(response_tests, reuse_output_buffer)
 {
 	Message::Response response;
 
-	std::string serialzied_message{"Accept-Ranges:bytes\n"
-	                               "Content-Length:51\n"
-	                               "Content-Type:text/plain\n"
-	                               "\n\n\n\n"
-	                               "<html>this is body of response.</html>"};
+	response.set_status(200);
+	response.add_header("Content-Type", "text/plain");
+	response.set_body(std::string(10000, 'a'));
+	const std::string& first = response.generate_response();
+	ASSERT_EQ(first.size(), 10000 + 68);
+	const char* buffer = first.data();
+
+	response.clear_up();
+	response.set_status(204);
+	const std::string& second = response.generate_response();
+	ASSERT_EQ(second, "HTTP/1.1 204 No Content\r\n\r\n");
+	ASSERT_EQ(second.data(), buffer);
+}
 
-	response.deserialize(serialzied_message);
+TEST(response_tests, omit_body)
+{
+	Message::Response response;
 
-	ASSERT_EQ(response.get_header("Content-Length"), "38");
-	ASSERT_EQ(response.get_header("Accept-Ranges"), "bytes");
-	ASSERT_EQ(response.get_header("Content-Type"), "text/plain");
-	ASSERT_EQ(response.get_body(), "<html>this is body of response.</html>");
-}
\ No newline at end of file
+	response.set_status(200);
+	response.set_body("hello");
+	response.omit_body();
+	ASSERT_EQ(response.generate_response(),
+	          "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n");
+
+	const std::string prebuilt_message =
+	    "HTTP/1.1 200 OK\r\n"
+	    "Content-Length: 5\r\n"
+	    "Date: Thu, 01 Jan 1970 00:00:00 GMT\r\n"
+	    "\r\n"
+	    "hello";
+	response.clear_up();
+	response.set_prebuilt_message(prebuilt_message, 42);
+	response.omit_body();
+	ASSERT_EQ(response.generate_response(),
+	          "HTTP/1.1 200 OK\r\n"
+	          "Content-Length: 5\r\n"
+	          "Date: " +
+	              Timer::get_cached_http_time() +
+	              "\r\n"
+	              "\r\n");
+
+	response.clear_up();
+	response.set_status(204);
+	ASSERT_EQ(response.generate_response(), "HTTP/1.1 204 No Content\r\n\r\n");
+}
+
+TEST(response_tests, serialized_message)
+{
+	Message::Response response;
+
+	const std::string message = "HTTP/1.1 200 OK\r\n"
+	                            "Content-Length: 5\r\n"
+	                            "Date: Thu, 01 Jan 1970 00:00:00 GMT\r\n"
+	                            "\r\n"
+	                            "hello";
+	const std::string expected_headers =
+	    "HTTP/1.1 200 OK\r\n"
+	    "Content-Length: 5\r\n"
+	    "Date: " +
+	    Timer::get_cached_http_time() + "\r\n\r\n";
+
+	// the message needn't outlive the call
+	std::string copy = message;
+	response.set_serialized_message(copy.data(), copy.size(), 42);
+	copy.assign(copy.size(), 'x');
+	ASSERT_EQ(response.generate_response(), expected_headers + "hello");
+
+	response.clear_up();
+	response.set_serialized_message(message.data(), message.size(), 42);
+	response.omit_body();
+	ASSERT_EQ(response.generate_response(), expected_headers);
+
+	// a message handed over with the buffer it is part of
+	response.clear_up();
+	response.set_serialized_message("prefix" + message + "suffix", 6,
+	                                message.size(), 42);
+	ASSERT_EQ(response.generate_response(), expected_headers + "hello");
+
+	response.clear_up();
+	response.set_status(204);
+	ASSERT_EQ(response.generate_response(), "HTTP/1.1 204 No Content\r\n\r\n");
+}
@@ -0,0 +1,215 @@
+#include "IResourceHandler.hpp"
+#include "Router.hpp"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+namespace
+{
+	/**
+	 * A handler that only identifies itself.
+	 */
+	class NamedHandler : public IResourceHandler
+	{
+	public:
+		explicit NamedHandler(std::string name) : m_name(std::move(name)) {}
+
+		bool fetch_resource(std::shared_ptr<HTTP::Connection>) override
+		{
+			return true;
+		}
+
+		const std::string& get_name() const { return m_name; }
+
+	private:
+		std::string m_name;
+	};
+
+	/**
+	 * Route a request and get the name of the handler it reached.
+	 *
+	 * @return
+	 *      Handler name, or "404"/"405" if none matched.
+	 */
+	std::string route(const HTTP::Router& router, HTTP::Method method,
+	                  const std::string& uri_string,
+	                  HTTP::RouteMatch& route_match)
+	{
+		Uri uri;
+		EXPECT_TRUE(uri.parse_from_string(uri_string));
+
+		switch (router.route(method, uri, route_match))
+		{
+		case HTTP::Router::Result::FOUND:
+			return static_cast<NamedHandler*>(route_match.get_handler())
+			    ->get_name();
+		case HTTP::Router::Result::METHOD_NOT_ALLOWED:
+			return "405";
+		case HTTP::Router::Result::NOT_FOUND:
+			return "404";
+		}
+		return "";
+	}
+
+	std::string route(const HTTP::Router& router, HTTP::Method method,
+	                  const std::string& uri_string)
+	{
+		HTTP::RouteMatch route_match;
+		return route(router, method, uri_string, route_match);
+	}
+
+	std::shared_ptr<IResourceHandler> make_handler(const std::string& name)
+	{
+		return std::make_shared<NamedHandler>(name);
+	}
+} // namespace
+
+TEST(method_tests, intern_method_names)
+{
+	ASSERT_EQ(HTTP::to_method("GET"), HTTP::Method::GET);
+	ASSERT_EQ(HTTP::to_method("HEAD"), HTTP::Method::HEAD);
+	ASSERT_EQ(HTTP::to_method("POST"), HTTP::Method::POST);
+	ASSERT_EQ(HTTP::to_method("PATCH"), HTTP::Method::PATCH);
+	ASSERT_EQ(HTTP::to_method("get"), HTTP::Method::UNKNOWN);
+	ASSERT_EQ(HTTP::to_method(""), HTTP::Method::UNKNOWN);
+	ASSERT_EQ(HTTP::to_method("GETS"), HTTP::Method::UNKNOWN);
+
+	ASSERT_STREQ(HTTP::get_method_name(HTTP::Method::DELETE), "DELETE");
+	ASSERT_STREQ(HTTP::get_method_name(HTTP::Method::UNKNOWN), "");
+}
+
+TEST(router_tests, exact_routes)
+{
+	HTTP::Router router;
+	router.add_route(HTTP::Method::GET, "/healthz", make_handler("health"));
+	router.add_route(HTTP::Method::GET, "/api/status", make_handler("status"));
+
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/healthz"), "health");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/api/status"), "status");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/api"), "404");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/api/status/more"), "404");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/"), "404");
+}
+
+TEST(router_tests, prefix_routes)
+{
+	HTTP::Router router;
+	router.add_route(HTTP::Method::GET, "/*", make_handler("static"));
+	router.add_route(HTTP::Method::GET, "/assets/*", make_handler("assets"));
+
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/"), "static");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/index.html"), "static");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/assets"), "assets");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/assets/css/a.css"),
+	          "assets");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/assetsx/a.css"), "static");
+}
+
+TEST(router_tests, parameterised_routes)
+{
+	HTTP::Router router;
+	router.add_route(HTTP::Method::GET, "/api/sentences/:id",
+	                 make_handler("sentence"));
+	router.add_route(HTTP::Method::GET, "/api/sentences/latest",
+	                 make_handler("latest"));
+	router.add_route(HTTP::Method::GET, "/api/:collection/:id/words",
+	                 make_handler("words"));
+
+	HTTP::RouteMatch route_match;
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/api/sentences/42",
+	                route_match),
+	          "sentence");
+	ASSERT_NE(route_match.get_parameter("id"), nullptr);
+	ASSERT_EQ(*route_match.get_parameter("id"), "42");
+	ASSERT_EQ(route_match.get_parameter("collection"), nullptr);
+
+	// exact segments take precedence over parameters
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/api/sentences/latest",
+	                route_match),
+	          "latest");
+	ASSERT_EQ(route_match.get_parameter("id"), nullptr);
+
+	// a failed exact branch falls back to the parameter one
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/api/sentences/7/words",
+	                route_match),
+	          "words");
+	ASSERT_EQ(*route_match.get_parameter("collection"), "sentences");
+	ASSERT_EQ(*route_match.get_parameter("id"), "7");
+
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/api/sentences"), "404");
+}
+
+TEST(router_tests, query_parameter_routes)
+{
+	HTTP::Router router;
+	router.add_route(HTTP::Method::GET, "/*", make_handler("static"));
+	router.add_route(HTTP::Method::GET, "/", make_handler("search"), "q");
+
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/?q=fly"), "search");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/?page=2"), "static");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/"), "static");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/index.html?q=fly"),
+	          "static");
+}
+
+TEST(router_tests, method_not_allowed)
+{
+	HTTP::Router router;
+	router.add_route(HTTP::Method::GET, "/healthz", make_handler("health"));
+	router.add_route(HTTP::Method::POST, "/api/sentences",
+	                 make_handler("create"));
+
+	ASSERT_EQ(route(router, HTTP::Method::POST, "/healthz"), "405");
+	ASSERT_EQ(route(router, HTTP::Method::UNKNOWN, "/healthz"), "405");
+	ASSERT_EQ(route(router, HTTP::Method::POST, "/api/sentences"), "create");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/api/sentences"), "405");
+	ASSERT_EQ(route(router, HTTP::Method::POST, "/missing"), "404");
+
+	HTTP::RouteMatch route_match;
+	ASSERT_EQ(route(router, HTTP::Method::POST, "/healthz", route_match),
+	          "405");
+	ASSERT_EQ(route_match.get_allowed_methods(), "GET, HEAD");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/api/sentences", route_match),
+	          "405");
+	ASSERT_EQ(route_match.get_allowed_methods(), "POST");
+}
+
+TEST(router_tests, head_falls_back_to_get)
+{
+	HTTP::Router router;
+	router.add_route(HTTP::Method::GET, "/", make_handler("index"));
+	router.add_route(HTTP::Method::GET, "/*", make_handler("static"));
+	router.add_route(HTTP::Method::HEAD, "/ping", make_handler("ping"));
+	router.add_route(HTTP::Method::POST, "/api", make_handler("create"));
+
+	ASSERT_EQ(route(router, HTTP::Method::HEAD, "/"), "index");
+	ASSERT_EQ(route(router, HTTP::Method::HEAD, "/a.css"), "static");
+	ASSERT_EQ(route(router, HTTP::Method::HEAD, "/ping"), "ping");
+	ASSERT_EQ(route(router, HTTP::Method::GET, "/ping"), "static");
+	ASSERT_EQ(route(router, HTTP::Method::HEAD, "/api"), "static");
+}
+
+TEST(router_tests, reject_malformed_routes)
+{
+	HTTP::Router router;
+	auto handler = make_handler("handler");
+	router.add_route(HTTP::Method::GET, "/a/:id", handler);
+
+	EXPECT_THROW(router.add_route(HTTP::Method::GET, "", handler),
+	             std::runtime_error);
+	EXPECT_THROW(router.add_route(HTTP::Method::GET, "a", handler),
+	             std::runtime_error);
+	EXPECT_THROW(router.add_route(HTTP::Method::GET, "/*/a", handler),
+	             std::runtime_error);
+	EXPECT_THROW(router.add_route(HTTP::Method::GET, "/b/:", handler),
+	             std::runtime_error);
+	EXPECT_THROW(router.add_route(HTTP::Method::GET, "/a/:name", handler),
+	             std::runtime_error);
+	EXPECT_THROW(router.add_route(HTTP::Method::GET, "/a/:id", handler),
+	             std::runtime_error);
+	EXPECT_THROW(router.add_route(HTTP::Method::UNKNOWN, "/c", handler),
+	             std::runtime_error);
+	EXPECT_THROW(router.add_route(HTTP::Method::GET, "/c", nullptr),
+	             std::runtime_error);
+}
@@ -0,0 +1,73 @@
+#include "Scoreboard.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+TEST(scoreboard_tests, ready_without_scoreboard)
+{
+	Scoreboard::destroy();
+
+	ASSERT_EQ(Scoreboard::get_number_of_slots(), 0);
+	ASSERT_TRUE(Scoreboard::is_ready());
+
+	// workers run on their own report nowhere
+	Scoreboard::set_state(Scoreboard::State::READY);
+	Scoreboard::count_request();
+	ASSERT_EQ(Scoreboard::get_number_of_requests(), 0);
+}
+
+TEST(scoreboard_tests, claim_and_release_slots)
+{
+	Scoreboard::create(2);
+
+	ASSERT_EQ(Scoreboard::claim_slot(), 0);
+	ASSERT_EQ(Scoreboard::claim_slot(), 1);
+	ASSERT_EQ(Scoreboard::claim_slot(), -1);
+	ASSERT_EQ(Scoreboard::get_number_of_workers(Scoreboard::State::STARTING),
+	          2);
+	ASSERT_FALSE(Scoreboard::is_ready());
+
+	Scoreboard::set_pid(1, 4242);
+	ASSERT_EQ(Scoreboard::get_pid(1), 4242);
+	Scoreboard::release(4242);
+	ASSERT_EQ(Scoreboard::get_pid(1), 0);
+	ASSERT_EQ(Scoreboard::get_number_of_workers(Scoreboard::State::EMPTY), 1);
+	ASSERT_EQ(Scoreboard::claim_slot(), 1);
+
+	Scoreboard::destroy();
+}
+
+TEST(scoreboard_tests, workers_report_across_processes)
+{
+	Scoreboard::create(2);
+
+	int slot = Scoreboard::claim_slot();
+	ASSERT_EQ(slot, 0);
+
+	pid_t pid = fork();
+	ASSERT_NE(pid, -1);
+	if (pid == 0)
+	{
+		Scoreboard::attach(static_cast<size_t>(slot));
+		Scoreboard::count_request();
+		Scoreboard::count_request();
+		Scoreboard::set_state(Scoreboard::State::READY);
+		_exit(0);
+	}
+	Scoreboard::set_pid(static_cast<size_t>(slot), pid);
+
+	int status = 0;
+	ASSERT_EQ(waitpid(pid, &status, 0), pid);
+
+	ASSERT_EQ(Scoreboard::get_number_of_workers(Scoreboard::State::READY), 1);
+	ASSERT_EQ(Scoreboard::get_number_of_requests(), 2);
+	ASSERT_TRUE(Scoreboard::is_ready());
+
+	Scoreboard::release(pid);
+	ASSERT_FALSE(Scoreboard::is_ready());
+
+	Scoreboard::destroy();
+}
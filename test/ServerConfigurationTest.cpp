@@ -12,4 +12,37 @@ TEST(server_configuration_tests, default_configuration_test)
 	          "/home/word-finder/logs/");
 	EXPECT_EQ(ServerConfiguration::instance()->get_database_path(),
 	          "/var/lib/word-finder/data.db");
-}
\ No newline at end of file
+	EXPECT_EQ(ServerConfiguration::instance()->get_database_profile(),
+	          "read_only");
+	EXPECT_EQ(ServerConfiguration::instance()->get_database_cache_capacity(),
+	          8 * 1024 * 1024);
+	EXPECT_EQ(ServerConfiguration::instance()->get_search_threads(), 2);
+}
+
+TEST(server_configuration_tests, default_response_configuration_test)
+{
+	EXPECT_EQ(ServerConfiguration::instance()->get_server_name(), "Bitate");
+	EXPECT_EQ(ServerConfiguration::instance()->get_host_name(),
+	          "www.bitate.com");
+	EXPECT_EQ(ServerConfiguration::instance()->get_error_page_directory_path(),
+	          "/home/word-finder/resource/assets/html/error/");
+}
+
+TEST(server_configuration_tests, default_cache_configuration_test)
+{
+	EXPECT_EQ(ServerConfiguration::instance()->get_local_cache_capacity(),
+	          32 * 1024 * 1024);
+	EXPECT_EQ(ServerConfiguration::instance()->get_local_cache_shards(), 8);
+	EXPECT_EQ(ServerConfiguration::instance()->get_redis_uri(),
+	          "tcp://127.0.0.1:6379");
+	EXPECT_EQ(ServerConfiguration::instance()->get_shared_cache_capacity(),
+	          64 * 1024 * 1024);
+	EXPECT_EQ(ServerConfiguration::instance()->get_shared_cache_path(), "");
+	EXPECT_EQ(ServerConfiguration::instance()->get_cache_policy(), "tinylfu");
+	EXPECT_EQ(ServerConfiguration::instance()->get_search_cache_ttl(), 600);
+	EXPECT_EQ(ServerConfiguration::instance()->get_search_cache_stale_ttl(),
+	          3600);
+	EXPECT_EQ(ServerConfiguration::instance()->get_negative_cache_ttl(), 30);
+	EXPECT_EQ(ServerConfiguration::instance()->get_vocabulary_filter_path(),
+	          "/var/lib/word-finder/vocabulary.filter");
+}
@@ -1,5 +1,7 @@
 #include "Sha1.hpp"
+#include "CpuDispatch.hpp"
 
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <string>
 #include <vector>
@@ -31,4 +33,84 @@ TEST(sha1_tests, sha1_encode_test)
 		    << "Error at index: " << index;
 		++index;
 	}
-}
\ No newline at end of file
+}
+
+TEST(sha1_tests, streaming_hasher_test)
+{
+	std::string message;
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		message += static_cast<char>((i * 31 + 7) & 0xff);
+	}
+	const std::string expected_digest = Sha1::sha1_encrypt(message);
+
+	// every split point and piece size hashes to the same digest
+	for (size_t piece_size = 1; piece_size < 150; piece_size += 7)
+	{
+		Sha1::Hasher hasher;
+		for (size_t offset = 0; offset < message.size(); offset += piece_size)
+		{
+			hasher.update(message.data() + offset,
+			              std::min(piece_size, message.size() - offset));
+		}
+
+		uint8_t digest[Sha1::DIGEST_SIZE];
+		hasher.final(digest);
+		ASSERT_EQ(Sha1::digest_to_hex_string(digest), expected_digest)
+		    << "piece size: " << piece_size;
+	}
+
+	// padding crosses into an extra block for lengths 56-63 modulo 64
+	for (size_t size = 50; size < 140; ++size)
+	{
+		Sha1::Hasher hasher;
+		hasher.update(message.data(), size / 2);
+		hasher.update(message.data() + size / 2, size - size / 2);
+
+		uint8_t digest[Sha1::DIGEST_SIZE];
+		hasher.final(digest);
+		ASSERT_EQ(Sha1::digest_to_hex_string(digest),
+		          Sha1::sha1_encrypt(message.substr(0, size)))
+		    << "size: " << size;
+	}
+}
+
+TEST(sha1_tests, raw_digest_test)
+{
+	uint8_t digest[Sha1::DIGEST_SIZE];
+	Sha1::sha1_digest("abc", 3, digest);
+
+	const uint8_t expected_digest[Sha1::DIGEST_SIZE] = {
+	    0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+	    0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d};
+	ASSERT_EQ(std::vector<uint8_t>(digest, digest + Sha1::DIGEST_SIZE),
+	          std::vector<uint8_t>(expected_digest,
+	                               expected_digest + Sha1::DIGEST_SIZE));
+
+	Sha1::Hasher hasher;
+	hasher.update("ab", 2);
+	hasher.final(digest);
+	hasher.init();
+	hasher.update("abc", 3);
+	hasher.final(digest);
+	ASSERT_EQ(Sha1::sha1_encrypt_into_bytes(std::string("abc")),
+	          std::vector<uint8_t>(digest, digest + Sha1::DIGEST_SIZE));
+}
+
+TEST(sha1_tests, every_isa_test)
+{
+	for (size_t i = 0; i < CpuDispatch::NUMBER_OF_ISAS; ++i)
+	{
+		auto isa = static_cast<CpuDispatch::Isa>(i);
+		if (isa > CpuDispatch::get_detected_isa())
+		{
+			break;
+		}
+		CpuDispatch::force_isa(isa);
+
+		ASSERT_EQ(Sha1::sha1_encrypt(std::string(1000000, 'a')),
+		          "34aa973cd4c4daa4f61eeb2bdbad27316534016f")
+		    << CpuDispatch::get_isa_name(isa);
+	}
+	CpuDispatch::force_isa("");
+}
@@ -0,0 +1,284 @@
+#include "SharedCache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+	/**
+	 * A value that can be told apart from the values of other keys and
+	 * from torn writes.
+	 */
+	std::string make_value(const std::string& key, size_t size)
+	{
+		std::string value = key + ":";
+		while (value.size() < size)
+		{
+			value += key;
+		}
+		value.resize(size);
+		return value;
+	}
+} // namespace
+
+TEST(shared_cache_tests, disabled_without_cache)
+{
+	SharedCache::destroy();
+
+	std::string value;
+	EXPECT_FALSE(SharedCache::is_enabled());
+	EXPECT_FALSE(SharedCache::insert("/?q=fly", "result"));
+	EXPECT_FALSE(SharedCache::get("/?q=fly", value));
+	EXPECT_FALSE(SharedCache::erase("/?q=fly"));
+
+	// nothing to wait for
+	EXPECT_TRUE(SharedCache::acquire_lease("/?q=fly", 1000));
+	EXPECT_FALSE(SharedCache::is_leased("/?q=fly"));
+}
+
+TEST(shared_cache_tests, get_insert_erase)
+{
+	SharedCache::create(1 << 20);
+
+	std::string value;
+	EXPECT_FALSE(SharedCache::get("/?q=fly", value));
+	EXPECT_TRUE(SharedCache::insert("/?q=fly", "result"));
+	EXPECT_TRUE(SharedCache::get("/?q=fly", value));
+	EXPECT_EQ(value, "result");
+
+	// replaced by a value of another size class
+	EXPECT_TRUE(SharedCache::insert("/?q=fly", std::string(5000, 'x')));
+	EXPECT_TRUE(SharedCache::get("/?q=fly", value));
+	EXPECT_EQ(value, std::string(5000, 'x'));
+	EXPECT_EQ(SharedCache::get_number_of_entries(), 1);
+
+	EXPECT_TRUE(SharedCache::erase("/?q=fly"));
+	EXPECT_FALSE(SharedCache::erase("/?q=fly"));
+	EXPECT_FALSE(SharedCache::get("/?q=fly", value));
+	EXPECT_EQ(SharedCache::get_number_of_entries(), 0);
+
+	// larger than the largest chunk
+	EXPECT_FALSE(SharedCache::insert("/large", std::string(1 << 20, 'x')));
+
+	SharedCache::Statistics statistics = SharedCache::get_statistics();
+	EXPECT_EQ(statistics.hits, 2);
+	EXPECT_EQ(statistics.misses, 2);
+	EXPECT_EQ(statistics.insertions, 2);
+	EXPECT_EQ(statistics.rejections, 1);
+
+	SharedCache::destroy();
+}
+
+TEST(shared_cache_tests, evict_oldest_entries)
+{
+	SharedCache::create(5 * 4 * 1024);
+
+	// the 1 KiB class has 4 chunks
+	for (int i = 0; i < 6; ++i)
+	{
+		ASSERT_TRUE(SharedCache::insert(std::to_string(i), "value"));
+	}
+
+	std::string value;
+	EXPECT_FALSE(SharedCache::get("0", value));
+	EXPECT_FALSE(SharedCache::get("1", value));
+	for (int i = 2; i < 6; ++i)
+	{
+		EXPECT_TRUE(SharedCache::get(std::to_string(i), value));
+	}
+
+	SharedCache::destroy();
+}
+
+TEST(shared_cache_tests, tiny_lfu_admits_frequent_keys)
+{
+	SharedCache::create(5 * 4 * 1024, "", HTTP::CachePolicy::TINY_LFU);
+	EXPECT_EQ(SharedCache::get_policy(), HTTP::CachePolicy::TINY_LFU);
+
+	// the 1 KiB class has 4 chunks, filled with keys looked up twice
+	std::string value;
+	for (int i = 0; i < 4; ++i)
+	{
+		std::string key = std::to_string(i);
+		EXPECT_FALSE(SharedCache::get(key, value));
+		ASSERT_TRUE(SharedCache::insert(key, "value"));
+		EXPECT_TRUE(SharedCache::get(key, value));
+	}
+
+	// a one-off key doesn't replace them
+	EXPECT_FALSE(SharedCache::get("cold", value));
+	EXPECT_FALSE(SharedCache::insert("cold", "value"));
+	EXPECT_TRUE(SharedCache::get("0", value));
+	EXPECT_EQ(SharedCache::get_statistics().rejections, 1);
+
+	// a key looked up more often does
+	for (int i = 0; i < 4; ++i)
+	{
+		EXPECT_FALSE(SharedCache::get("hot", value));
+	}
+	EXPECT_TRUE(SharedCache::insert("hot", "value"));
+	EXPECT_TRUE(SharedCache::get("hot", value));
+	EXPECT_EQ(SharedCache::get_number_of_entries(), 4);
+
+	SharedCache::destroy();
+	EXPECT_EQ(SharedCache::get_policy(), HTTP::CachePolicy::LRU);
+}
+
+TEST(shared_cache_tests, shared_across_processes)
+{
+	SharedCache::create(1 << 20);
+
+	pid_t pid = fork();
+	ASSERT_NE(pid, -1);
+	if (pid == 0)
+	{
+		bool is_inserted = SharedCache::insert("/?q=child", "from child");
+		_exit(is_inserted ? 0 : 1);
+	}
+
+	int status = 0;
+	ASSERT_EQ(waitpid(pid, &status, 0), pid);
+	ASSERT_EQ(WEXITSTATUS(status), 0);
+
+	std::string value;
+	EXPECT_TRUE(SharedCache::get("/?q=child", value));
+	EXPECT_EQ(value, "from child");
+
+	SharedCache::destroy();
+}
+
+TEST(shared_cache_tests, leases_across_processes)
+{
+	SharedCache::create(1 << 20);
+
+	pid_t pid = fork();
+	ASSERT_NE(pid, -1);
+	if (pid == 0)
+	{
+		bool is_acquired = SharedCache::acquire_lease("/?q=fly", 60000);
+		_exit(is_acquired ? 0 : 1);
+	}
+
+	int status = 0;
+	ASSERT_EQ(waitpid(pid, &status, 0), pid);
+	ASSERT_EQ(WEXITSTATUS(status), 0);
+
+	// the child computes the value, so others wait
+	EXPECT_TRUE(SharedCache::is_leased("/?q=fly"));
+	EXPECT_FALSE(SharedCache::acquire_lease("/?q=fly", 60000));
+	EXPECT_FALSE(SharedCache::is_leased("/?q=bee"));
+
+	SharedCache::release_lease("/?q=fly");
+	EXPECT_FALSE(SharedCache::is_leased("/?q=fly"));
+	EXPECT_TRUE(SharedCache::acquire_lease("/?q=fly", 60000));
+	SharedCache::release_lease("/?q=fly");
+
+	// an expired lease is taken over
+	EXPECT_TRUE(SharedCache::acquire_lease("/?q=fly", 0));
+	EXPECT_FALSE(SharedCache::is_leased("/?q=fly"));
+	EXPECT_TRUE(SharedCache::acquire_lease("/?q=fly", 60000));
+
+	SharedCache::destroy();
+}
+
+TEST(shared_cache_tests, expired_lease_taken_over_once)
+{
+	SharedCache::create(1 << 20);
+	EXPECT_TRUE(SharedCache::acquire_lease("/?q=fly", 0));
+
+	// holder and deadline change together, so one process wins the race
+	const int number_of_children = 8;
+	for (int i = 0; i < number_of_children; ++i)
+	{
+		pid_t pid = fork();
+		ASSERT_NE(pid, -1);
+		if (pid == 0)
+		{
+			bool is_acquired = SharedCache::acquire_lease("/?q=fly", 60000);
+			_exit(is_acquired ? 0 : 1);
+		}
+	}
+
+	int number_of_holders = 0;
+	for (int i = 0; i < number_of_children; ++i)
+	{
+		int status = 0;
+		ASSERT_NE(wait(&status), -1);
+		number_of_holders += WEXITSTATUS(status) == 0 ? 1 : 0;
+	}
+	EXPECT_EQ(number_of_holders, 1);
+	EXPECT_TRUE(SharedCache::is_leased("/?q=fly"));
+
+	SharedCache::destroy();
+}
+
+TEST(shared_cache_tests, concurrent_writers_never_tear_values)
+{
+	SharedCache::create(64 * 1024);
+
+	const int number_of_writers = 2;
+	pid_t writers[number_of_writers];
+	for (int writer = 0; writer < number_of_writers; ++writer)
+	{
+		writers[writer] = fork();
+		ASSERT_NE(writers[writer], -1);
+		if (writers[writer] == 0)
+		{
+			for (int i = 0; i < 20000; ++i)
+			{
+				std::string key = std::to_string((i * 7 + writer) % 50);
+				SharedCache::insert(key, make_value(key, 200 + i % 700));
+			}
+			_exit(0);
+		}
+	}
+
+	size_t number_of_hits = 0;
+	for (int i = 0; i < 20000; ++i)
+	{
+		std::string key = std::to_string(i % 50);
+		std::string value;
+		if (SharedCache::get(key, value))
+		{
+			++number_of_hits;
+			ASSERT_EQ(value, make_value(key, value.size()));
+		}
+	}
+
+	for (pid_t writer : writers)
+	{
+		int status = 0;
+		ASSERT_EQ(waitpid(writer, &status, 0), writer);
+	}
+	EXPECT_GT(number_of_hits + SharedCache::get_number_of_entries(), 0);
+
+	SharedCache::destroy();
+}
+
+TEST(shared_cache_tests, file_backed_cache_survives_restarts)
+{
+	const std::string file_path = "/tmp/shared_cache_test.cache";
+	std::remove(file_path.c_str());
+
+	SharedCache::create(1 << 20, file_path);
+	ASSERT_TRUE(SharedCache::insert("/?q=warm", "kept"));
+	SharedCache::destroy();
+
+	std::string value;
+	SharedCache::create(1 << 20, file_path);
+	EXPECT_TRUE(SharedCache::get("/?q=warm", value));
+	EXPECT_EQ(value, "kept");
+	SharedCache::destroy();
+
+	// another capacity discards the entries
+	SharedCache::create(2 << 20, file_path);
+	EXPECT_FALSE(SharedCache::get("/?q=warm", value));
+	SharedCache::destroy();
+
+	std::remove(file_path.c_str());
+}
@@ -0,0 +1,58 @@
+#include "SingleFlight.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(single_flight_tests, coalesce_identical_keys)
+{
+	HTTP::SingleFlight single_flight;
+	std::vector<std::string> results;
+	auto record = [&results](bool is_found, const std::string& value) {
+		results.push_back(is_found ? value : "miss");
+	};
+
+	EXPECT_TRUE(single_flight.join("/?q=fly", record));
+	EXPECT_FALSE(single_flight.join("/?q=fly", record));
+	EXPECT_FALSE(single_flight.join("/?q=fly", record));
+	EXPECT_TRUE(single_flight.join("/?q=bee", record));
+	EXPECT_TRUE(results.empty());
+
+	single_flight.land("/?q=fly", true, "result");
+	EXPECT_EQ(results, std::vector<std::string>(3, "result"));
+	EXPECT_FALSE(single_flight.is_in_flight("/?q=fly"));
+	EXPECT_TRUE(single_flight.is_in_flight("/?q=bee"));
+
+	single_flight.land("/?q=bee", false, "");
+	EXPECT_EQ(results.back(), "miss");
+
+	HTTP::SingleFlight::Statistics statistics = single_flight.get_statistics();
+	EXPECT_EQ(statistics.flights, 2);
+	EXPECT_EQ(statistics.coalesced, 2);
+}
+
+TEST(single_flight_tests, join_again_while_landing)
+{
+	HTTP::SingleFlight single_flight;
+	std::string value = "result";
+	bool is_rejoined = false;
+
+	EXPECT_TRUE(single_flight.join(
+	    "/?q=fly", [&](bool, const std::string&) {
+		    // the flight is over, so this starts the next one
+		    is_rejoined = single_flight.join(
+		        "/?q=fly", [](bool, const std::string&) {});
+		    value.clear();
+	    }));
+
+	std::string second_result;
+	EXPECT_FALSE(single_flight.join(
+	    "/?q=fly", [&](bool, const std::string& result) {
+		    second_result = result;
+	    }));
+
+	single_flight.land("/?q=fly", true, value);
+	EXPECT_TRUE(is_rejoined);
+	EXPECT_EQ(second_result, "result");
+	EXPECT_TRUE(single_flight.is_in_flight("/?q=fly"));
+}
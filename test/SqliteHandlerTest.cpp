@@ -1,9 +1,14 @@
+#include "Connection.hpp"
+#include "DatabaseImage.hpp"
 #include "SqliteHandler.hpp"
 
 #include <algorithm>
 #include <gtest/gtest.h>
 #include <iostream>
 
+#include <sys/epoll.h>
+#include <unistd.h>
+
 TEST(sqlite3_tests, has_table_test)
 {
 	SqliteHandler sqlite_handler;
@@ -111,4 +116,102 @@ TEST(sqlite3_tests, search_news_titles_test)
 
 	EXPECT_EQ(sentences.size(), 100);
 	EXPECT_TRUE(sentences[0].get_body().find("fly") != std::string::npos);
-}
\ No newline at end of file
+}
+
+TEST(sqlite3_tests, database_profiles_test)
+{
+	for (const std::string profile : {"read_write", "read_only", "immutable"})
+	{
+		ServerConfiguration::instance()->set_database_profile(profile);
+		SqliteHandler sqlite_handler;
+
+		EXPECT_FALSE(sqlite_handler.search_sentence("fly").empty()) << profile;
+
+		// writes go through a connection of their own
+		UserInfo user_info{"Ann", "1234567890", "20", "ann@gmail.com"};
+		EXPECT_TRUE(sqlite_handler.add_new_user(user_info)) << profile;
+		EXPECT_TRUE(sqlite_handler.delete_user(user_info)) << profile;
+	}
+
+	ASSERT_TRUE(DatabaseImage::create(
+	    ServerConfiguration::instance()->get_database_path()));
+	ServerConfiguration::instance()->set_database_profile("memory");
+	{
+		SqliteHandler sqlite_handler;
+		EXPECT_FALSE(sqlite_handler.search_sentence("fly").empty());
+	}
+	DatabaseImage::destroy();
+	ServerConfiguration::instance()->set_database_profile("read_only");
+}
+
+TEST(sqlite3_tests, search_threads_test)
+{
+	int epoll_fd = epoll_create1(0);
+	SqliteHandler sqlite_handler;
+	sqlite_handler.attach(epoll_fd);
+
+	// the event loop's statements, and those of each search thread
+	auto statement_caches = sqlite_handler.get_statement_caches();
+	ASSERT_EQ(statement_caches.size(),
+	          1 + ServerConfiguration::instance()->get_search_threads());
+
+	auto connection = std::make_shared<HTTP::Connection>();
+	connection->get_request()->set_raw_request(
+	    "GET /?q=fly HTTP/1.1\r\nHost: localhost\r\n\r\n");
+	ASSERT_TRUE(connection->get_request()->parse_raw_request());
+
+	int number_of_answers = 0;
+	bool is_found = false;
+	sqlite_handler.fetch_resource_async(
+	    connection, [&number_of_answers, &is_found](bool is_fetched) {
+		    ++number_of_answers;
+		    is_found = is_fetched;
+	    });
+
+	// answered once the loop is woken
+	EXPECT_EQ(number_of_answers, 0);
+	epoll_event event;
+	for (int i = 0; i < 100 && number_of_answers == 0; ++i)
+	{
+		if (epoll_wait(epoll_fd, &event, 1, 10) == 1)
+		{
+			EXPECT_TRUE(
+			    sqlite_handler.handle_events(event.data.fd, event.events));
+		}
+	}
+	EXPECT_EQ(number_of_answers, 1);
+	EXPECT_TRUE(is_found);
+	EXPECT_EQ(statement_caches[0]->get_statistics().misses, 0);
+	close(epoll_fd);
+}
+
+TEST(sqlite3_tests, head_request_test)
+{
+	SqliteHandler sqlite_handler;
+	auto statement_cache = sqlite_handler.get_statement_caches()[0];
+
+	auto fetch = [&sqlite_handler](const std::string& request_line) {
+		auto connection = std::make_shared<HTTP::Connection>();
+		connection->get_request()->set_raw_request(
+		    request_line + " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+		EXPECT_TRUE(connection->get_request()->parse_raw_request());
+
+		bool is_found = false;
+		sqlite_handler.fetch_resource_async(
+		    connection,
+		    [&is_found](bool is_fetched) { is_found = is_fetched; });
+		return is_found;
+	};
+
+	// HEAD searches like GET, so both find the same
+	EXPECT_FALSE(fetch("HEAD /?q=xqzvjw"));
+	EXPECT_TRUE(fetch("HEAD /?q=fly"));
+
+	// and caches the page for the GET that follows
+	uint64_t lookups = statement_cache->get_statistics().hits +
+	                   statement_cache->get_statistics().misses;
+	EXPECT_TRUE(fetch("GET /?q=fly"));
+	EXPECT_EQ(statement_cache->get_statistics().hits +
+	              statement_cache->get_statistics().misses,
+	          lookups);
+}
@@ -0,0 +1,79 @@
+#include "StatementCache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace
+{
+	sqlite3* open_database()
+	{
+		sqlite3* connection = nullptr;
+		sqlite3_open(":memory:", &connection);
+		sqlite3_exec(connection,
+		             "CREATE TABLE word(value TEXT);"
+		             "INSERT INTO word VALUES('fly'), ('bee');",
+		             nullptr, nullptr, nullptr);
+		return connection;
+	}
+
+	int count_words(sqlite3_stmt* statement, const std::string& value)
+	{
+		sqlite3_bind_text(statement, 1, value.c_str(), -1, SQLITE_TRANSIENT);
+		sqlite3_step(statement);
+		return sqlite3_column_int(statement, 0);
+	}
+} // namespace
+
+TEST(statement_cache_tests, reuse_statements)
+{
+	sqlite3* connection = open_database();
+	HTTP::StatementCache cache;
+	cache.attach(connection);
+
+	const std::string sql = "SELECT count(*) FROM word WHERE value = ?";
+	sqlite3_stmt* statement = cache.get(sql);
+	ASSERT_NE(statement, nullptr);
+	EXPECT_EQ(count_words(statement, "fly"), 1);
+
+	// reset and unbound, even though it wasn't reset after use
+	EXPECT_EQ(cache.get(sql), statement);
+	EXPECT_EQ(sqlite3_step(statement), SQLITE_ROW);
+	EXPECT_EQ(sqlite3_column_int(statement, 0), 0);
+	EXPECT_EQ(count_words(cache.get(sql), "bee"), 1);
+
+	EXPECT_EQ(cache.get("SELECT * FROM no_such_table"), nullptr);
+
+	HTTP::StatementCache::Statistics statistics = cache.get_statistics();
+	EXPECT_EQ(statistics.hits, 2);
+	EXPECT_EQ(statistics.misses, 2);
+	EXPECT_EQ(cache.get_number_of_statements(), 1);
+
+	// nothing is left to keep the connection open
+	cache.clear();
+	EXPECT_EQ(sqlite3_close(connection), SQLITE_OK);
+}
+
+TEST(statement_cache_tests, evict_least_recently_used)
+{
+	sqlite3* connection = open_database();
+	HTTP::StatementCache cache(2);
+	cache.attach(connection);
+
+	sqlite3_stmt* first = cache.get("SELECT 1");
+	cache.get("SELECT 2");
+	EXPECT_EQ(cache.get("SELECT 1"), first);
+	cache.get("SELECT 3");
+	EXPECT_EQ(cache.get_number_of_statements(), 2);
+	EXPECT_EQ(cache.get("SELECT 1"), first);
+
+	HTTP::StatementCache::Statistics statistics = cache.get_statistics();
+	EXPECT_EQ(statistics.hits, 2);
+	EXPECT_EQ(statistics.misses, 3);
+	EXPECT_EQ(statistics.evictions, 1);
+
+	cache.attach(nullptr);
+	EXPECT_EQ(cache.get_number_of_statements(), 0);
+	EXPECT_EQ(cache.get("SELECT 1"), nullptr);
+	EXPECT_EQ(sqlite3_close(connection), SQLITE_OK);
+}
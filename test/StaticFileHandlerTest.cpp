@@ -0,0 +1,96 @@
+#include "StaticFileHandler.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+	const std::string DIRECTORY_PATH = "/tmp/static_file_handler_test/";
+
+	std::shared_ptr<HTTP::Connection>
+	make_connection(const std::string& raw_request)
+	{
+		auto connection = std::make_shared<HTTP::Connection>();
+		connection->get_request()->set_raw_request(raw_request);
+		EXPECT_TRUE(connection->get_request()->parse_raw_request());
+		return connection;
+	}
+} // namespace
+
+TEST(static_file_handler_tests, not_modified_test)
+{
+	mkdir(DIRECTORY_PATH.c_str(), S_IRWXU);
+	std::ofstream(DIRECTORY_PATH + "page.txt") << "first version";
+	StaticFileHandler handler(DIRECTORY_PATH);
+
+	auto connection = make_connection("GET /page.txt HTTP/1.1\r\n"
+	                                  "Host: localhost\r\n\r\n");
+	ASSERT_TRUE(handler.fetch_resource(connection));
+	const std::string etag = connection->get_response()->get_header("ETag");
+	ASSERT_EQ(etag.size(), 42);
+	EXPECT_EQ(connection->get_response()->get_body(), "first version");
+
+	// a matching tag, weak or in a list, leaves the body out
+	for (const std::string& if_none_match :
+	     {etag, "W/" + etag, "\"other\", " + etag, std::string("*")})
+	{
+		connection = make_connection("GET /page.txt HTTP/1.1\r\n"
+		                             "Host: localhost\r\n"
+		                             "If-None-Match: " +
+		                             if_none_match + "\r\n\r\n");
+		ASSERT_TRUE(handler.fetch_resource(connection)) << if_none_match;
+		EXPECT_EQ(connection->get_response()->get_status_code(), 304);
+		EXPECT_EQ(connection->get_response()->get_header("ETag"), etag);
+		EXPECT_EQ(connection->get_response()->get_body(), "");
+	}
+
+	// HEAD gets the headers of the file, without reading it
+	connection = make_connection("HEAD /page.txt HTTP/1.1\r\n"
+	                             "Host: localhost\r\n\r\n");
+	ASSERT_TRUE(handler.fetch_resource(connection));
+	EXPECT_EQ(connection->get_response()->get_header("ETag"), etag);
+	EXPECT_EQ(connection->get_response()->get_header("Content-Length"), "13");
+	EXPECT_EQ(connection->get_response()->get_body(), "");
+
+	// the deflated representation is tagged apart, unless refused
+	connection = make_connection("GET /page.txt HTTP/1.1\r\n"
+	                             "Host: localhost\r\n"
+	                             "Accept-Encoding: deflate\r\n"
+	                             "If-None-Match: " +
+	                             etag + "\r\n\r\n");
+	ASSERT_TRUE(handler.fetch_resource(connection));
+	EXPECT_NE(connection->get_response()->get_status_code(), 304);
+	EXPECT_EQ(connection->get_response()->get_header("ETag"),
+	          etag.substr(0, 41) + "-deflate\"");
+	EXPECT_EQ(connection->get_response()->get_header("Content-Encoding"),
+	          "deflate");
+	EXPECT_EQ(connection->get_response()->get_header("Vary"),
+	          "Accept-Encoding");
+
+	connection = make_connection("GET /page.txt HTTP/1.1\r\n"
+	                             "Host: localhost\r\n"
+	                             "Accept-Encoding: deflate;q=0\r\n\r\n");
+	ASSERT_TRUE(handler.fetch_resource(connection));
+	EXPECT_EQ(connection->get_response()->get_header("ETag"), etag);
+	EXPECT_EQ(connection->get_response()->get_header("Content-Encoding"), "");
+
+	// the tag follows the file
+	std::ofstream(DIRECTORY_PATH + "page.txt") << "second, longer version";
+	connection = make_connection("GET /page.txt HTTP/1.1\r\n"
+	                             "Host: localhost\r\n"
+	                             "If-None-Match: " +
+	                             etag + "\r\n\r\n");
+	ASSERT_TRUE(handler.fetch_resource(connection));
+	EXPECT_NE(connection->get_response()->get_status_code(), 304);
+	EXPECT_NE(connection->get_response()->get_header("ETag"), etag);
+	EXPECT_EQ(connection->get_response()->get_body(),
+	          "second, longer version");
+
+	std::remove((DIRECTORY_PATH + "page.txt").c_str());
+	rmdir(DIRECTORY_PATH.c_str());
+}
@@ -1,8 +1,15 @@
 #include "StatusHandler.hpp"
+#include "ServerConfiguration.hpp"
 
 #include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #define new_response_ptr                                                       \
 	std::shared_ptr<Message::Response> response =                              \
 	    std::make_shared<Message::Response>()
@@ -189,11 +196,8 @@ TEST(status_handler_tests, status_code_304_test)
 	                              "Server: Bitate\r\n"
 	                              "\r\n"};
 
-	// TODO: HTTP 304 test
-	// ASSERT_EQ(
-	//     weed_out_http_date_header(response->generate_response()),
-	//     expected_response
-	// );
+	ASSERT_EQ(weed_out_http_date_header(response->generate_response()),
+	          expected_response);
 }
 
 TEST(status_handler_tests, status_code_400_test)
@@ -250,11 +254,11 @@ TEST(status_handler_tests, status_code_404_test)
 TEST(status_handler_tests, status_code_405_test)
 {
 	new_response_ptr;
-	StatusHandler::handle_status_code(response, 405);
+	StatusHandler::handle_status_code(response, 405, "GET, HEAD");
 
 	std::string expected_response{
 	    "HTTP/1.1 405 Method Not Allowed\r\n"
-	    "Allow: GET\r\n"
+	    "Allow: GET, HEAD\r\n"
 	    "Content-Length: 222\r\n"
 	    "Content-Type: text/html\r\n"
 	    "Date: Thu, 12 Nov 2020 13:41:37 GMT\r\n"
@@ -280,4 +284,86 @@ TEST(status_handler_tests, status_code_405_test)
 
 	ASSERT_EQ(weed_out_http_date_header(response->generate_response()),
 	          weed_out_http_date_header(expected_response));
-}
\ No newline at end of file
+}
+
+TEST(status_handler_tests, prebuilt_response_gets_current_date)
+{
+	new_response_ptr;
+	StatusHandler::handle_status_code(response, 404);
+
+	ASSERT_EQ(response->get_status_code(), 404);
+
+	const std::string& message = response->generate_response();
+	ASSERT_NE(message.find("Date: " + Timer::get_cached_http_time() + "\r\n"),
+	          std::string::npos);
+	ASSERT_EQ(message.find("1970"), std::string::npos);
+}
+
+TEST(status_handler_tests, prebuilt_response_reuses_output_buffer)
+{
+	new_response_ptr;
+	StatusHandler::handle_status_code(response, 500);
+	const std::string& first = response->generate_response();
+	const std::string expected = first;
+	const char* buffer = first.data();
+
+	response->clear_up();
+	StatusHandler::handle_status_code(response, 500);
+	ASSERT_EQ(response->generate_response(), expected);
+	ASSERT_EQ(response->generate_response().data(), buffer);
+}
+
+TEST(status_handler_tests, prebuild_custom_response)
+{
+	const StatusHandler::PrebuiltResponse health_response =
+	    StatusHandler::prebuild_response(200, "text/plain", "ok");
+
+	new_response_ptr;
+	StatusHandler::use_prebuilt_response(response, health_response);
+	ASSERT_EQ(response->get_status_code(), 200);
+
+	std::string expected_response{"HTTP/1.1 200 OK\r\n"
+	                              "Content-Length: 2\r\n"
+	                              "Content-Type: text/plain\r\n"
+	                              "Date: Thu, 12 Nov 2020 13:41:37 GMT\r\n"
+	                              "Host: www.bitate.com\r\n"
+	                              "Server: Bitate\r\n"
+	                              "\r\n"
+	                              "ok"};
+	ASSERT_EQ(weed_out_http_date_header(response->generate_response()),
+	          weed_out_http_date_header(expected_response));
+}
+
+TEST(status_handler_tests, prebuilt_response_from_configuration)
+{
+	const std::string directory_path = "/tmp/status_handler_test_error/";
+	mkdir(directory_path.c_str(), S_IRWXU);
+	std::ofstream(directory_path + "404.html") << "<html>gone fishing</html>";
+
+	ServerConfiguration* configuration = ServerConfiguration::instance();
+	const std::string previous_directory_path =
+	    configuration->get_error_page_directory_path();
+	configuration->set_error_page_directory_path(directory_path);
+	configuration->set_server_name("Custom");
+	StatusHandler::prebuild_responses();
+
+	new_response_ptr;
+	StatusHandler::handle_status_code(response, 404);
+
+	std::string expected_response{"HTTP/1.1 404 Not Found\r\n"
+	                              "Content-Length: 25\r\n"
+	                              "Content-Type: text/html\r\n"
+	                              "Date: Thu, 12 Nov 2020 13:41:37 GMT\r\n"
+	                              "Host: www.bitate.com\r\n"
+	                              "Server: Custom\r\n"
+	                              "\r\n"
+	                              "<html>gone fishing</html>"};
+	EXPECT_EQ(weed_out_http_date_header(response->generate_response()),
+	          weed_out_http_date_header(expected_response));
+
+	configuration->set_error_page_directory_path(previous_directory_path);
+	configuration->set_server_name("Bitate");
+	StatusHandler::prebuild_responses();
+	std::remove((directory_path + "404.html").c_str());
+	rmdir(directory_path.c_str());
+}
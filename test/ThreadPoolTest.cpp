@@ -0,0 +1,92 @@
+#include "ThreadPool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace
+{
+	/**
+	 * Run completions from the event loop until @b number_of_completions
+	 * reaches @b expected, or a second passes.
+	 */
+	void wait_for_completions(int epoll_fd, HTTP::ThreadPool& pool,
+	                          const int& number_of_completions, int expected)
+	{
+		epoll_event event;
+		for (int i = 0; i < 100 && number_of_completions < expected; ++i)
+		{
+			if (epoll_wait(epoll_fd, &event, 1, 10) == 1)
+			{
+				EXPECT_TRUE(pool.handle_events(event.data.fd, event.events));
+			}
+		}
+	}
+} // namespace
+
+TEST(thread_pool_tests, run_tasks_off_the_event_loop)
+{
+	int epoll_fd = epoll_create1(0);
+	HTTP::ThreadPool pool(2, 16);
+	EXPECT_EQ(pool.get_number_of_threads(), 2);
+
+	// completions couldn't run before
+	EXPECT_FALSE(pool.submit([](size_t) {}, []() {}));
+	pool.attach(epoll_fd);
+	EXPECT_FALSE(pool.handle_events(epoll_fd, EPOLLIN));
+
+	const std::thread::id loop_thread = std::this_thread::get_id();
+	std::atomic<int> number_of_tasks{0};
+	int number_of_completions = 0;
+	for (int i = 0; i < 10; ++i)
+	{
+		ASSERT_TRUE(pool.submit(
+		    [&number_of_tasks, loop_thread](size_t thread_index) {
+			    EXPECT_LT(thread_index, 2);
+			    EXPECT_NE(std::this_thread::get_id(), loop_thread);
+			    ++number_of_tasks;
+		    },
+		    [&number_of_completions, loop_thread]() {
+			    EXPECT_EQ(std::this_thread::get_id(), loop_thread);
+			    ++number_of_completions;
+		    }));
+	}
+
+	wait_for_completions(epoll_fd, pool, number_of_completions, 10);
+	EXPECT_EQ(number_of_tasks, 10);
+	EXPECT_EQ(number_of_completions, 10);
+	close(epoll_fd);
+}
+
+TEST(thread_pool_tests, bounded_queue)
+{
+	int epoll_fd = epoll_create1(0);
+	HTTP::ThreadPool pool(1, 2);
+	pool.attach(epoll_fd);
+
+	// the thread waits on the first task while two more are queued
+	std::atomic<bool> is_released{false};
+	int number_of_completions = 0;
+	auto block = [&is_released](size_t) {
+		while (!is_released)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	};
+	auto complete = [&number_of_completions]() { ++number_of_completions; };
+	ASSERT_TRUE(pool.submit(block, complete));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_TRUE(pool.submit(block, complete));
+	EXPECT_TRUE(pool.submit(block, complete));
+	EXPECT_FALSE(pool.submit(block, complete));
+
+	is_released = true;
+	wait_for_completions(epoll_fd, pool, number_of_completions, 3);
+	EXPECT_EQ(number_of_completions, 3);
+	close(epoll_fd);
+}
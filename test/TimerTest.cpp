@@ -2,6 +2,20 @@
 
 #include <gtest/gtest.h>
 #include <iostream>
+#include <thread>
+
+namespace
+{
+	// Seconds the fake clock is ahead of the real one.
+	time_t clock_offset = 0;
+
+	int read_shifted_clock(clockid_t clock_id, timespec* time)
+	{
+		int result = clock_gettime(clock_id, time);
+		time->tv_sec += clock_offset;
+		return result;
+	}
+} // namespace
 
 TEST(timer_tests, get_current_GMT_time)
 {
@@ -10,4 +24,64 @@ TEST(timer_tests, get_current_GMT_time)
 	 * (not including tailing '\0' in C string)
 	 */
 	ASSERT_EQ(Timer::get_current_http_time().size(), 29);
-}
\ No newline at end of file
+}
+
+TEST(timer_tests, cached_clock_strings)
+{
+	Timer::tick();
+
+	const std::string& http_time = Timer::get_cached_http_time();
+	ASSERT_EQ(http_time.size(), 29);
+	ASSERT_EQ(http_time.substr(25), " GMT");
+
+	// "[2021-01-31 20:05:58]" and "2021-01-31"
+	const std::string& log_time = Timer::get_cached_log_time();
+	ASSERT_EQ(log_time.size(), 21);
+	ASSERT_EQ(log_time.front(), '[');
+	ASSERT_EQ(log_time.back(), ']');
+	ASSERT_EQ(log_time.substr(1, 10), Timer::get_cached_date());
+
+	// the year of the HTTP date matches the one of the log timestamp
+	ASSERT_EQ(http_time.substr(12, 4), log_time.substr(1, 4));
+}
+
+TEST(timer_tests, cached_clock_is_reused_until_next_tick)
+{
+	Timer::set_time_source(read_shifted_clock);
+	clock_offset = 0;
+	Timer::tick();
+	const std::string& http_time = Timer::get_cached_http_time();
+	const std::string before = http_time;
+	int64_t before_milliseconds = Timer::get_coarse_monotonic_milliseconds();
+
+	// a ticked clock doesn't move between ticks
+	clock_offset = 2;
+	ASSERT_EQ(Timer::get_cached_http_time(), before);
+	ASSERT_EQ(Timer::get_coarse_monotonic_milliseconds(), before_milliseconds);
+
+	Timer::tick();
+	ASSERT_EQ(&Timer::get_cached_http_time(), &http_time);
+	ASSERT_NE(Timer::get_cached_http_time(), before);
+	ASSERT_GE(Timer::get_coarse_monotonic_milliseconds(),
+	          before_milliseconds + 2000);
+
+	Timer::set_time_source(nullptr);
+}
+
+TEST(timer_tests, unticked_clock_advances_on_read)
+{
+	Timer::set_time_source(read_shifted_clock);
+	clock_offset = 0;
+
+	std::string http_time;
+	std::thread thread([&http_time]() {
+		std::string before = Timer::get_cached_http_time();
+		clock_offset = 2;
+		http_time = Timer::get_cached_http_time();
+		ASSERT_NE(http_time, before);
+	});
+	thread.join();
+
+	ASSERT_EQ(http_time.size(), 29);
+	Timer::set_time_source(nullptr);
+}
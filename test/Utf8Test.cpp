@@ -1,4 +1,5 @@
 #include "Utf8.hpp"
+#include "CpuDispatch.hpp"
 
 #include <gtest/gtest.h>
 #include <stdint.h>
@@ -170,3 +171,98 @@ TEST(Utf8Tests, IsValidEncoding)
 	EXPECT_TRUE(utf8.IsValidEncoding("A≢", false));
 	EXPECT_TRUE(utf8.IsValidEncoding("�"));
 }
+
+TEST(Utf8Tests, IsValid)
+{
+	EXPECT_TRUE(Utf8::IsValid(""));
+	EXPECT_TRUE(Utf8::IsValid("abc"));
+	EXPECT_TRUE(Utf8::IsValid("𣎴"));
+	EXPECT_TRUE(Utf8::IsValid("A≢�"));
+	EXPECT_TRUE(Utf8::IsValid("\xED\x9F\xBF"));         // U+D7FF
+	EXPECT_TRUE(Utf8::IsValid("\xEE\x80\x80"));         // U+E000
+	EXPECT_TRUE(Utf8::IsValid("\xF4\x8F\xBF\xBF"));     // U+10FFFF
+	EXPECT_FALSE(Utf8::IsValid("\x41\xE2\x89\xA2\xCE\x2E"));
+	EXPECT_FALSE(Utf8::IsValid("\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA"));
+	EXPECT_FALSE(Utf8::IsValid("\xAA"));
+	EXPECT_FALSE(Utf8::IsValid("\xC0\xAF"));             // overlong
+	EXPECT_FALSE(Utf8::IsValid("\xE0\x9F\xBF"));         // overlong
+	EXPECT_FALSE(Utf8::IsValid("\xF0\x8F\xBF\xBF"));     // overlong
+	EXPECT_FALSE(Utf8::IsValid("\xED\xA0\x80"));         // U+D800
+	EXPECT_FALSE(Utf8::IsValid("\xED\xBF\xBF"));         // U+DFFF
+	EXPECT_FALSE(Utf8::IsValid("\xF4\x90\x80\x80"));     // U+110000
+	EXPECT_FALSE(Utf8::IsValid("\xF5\x80\x80\x80"));
+	EXPECT_FALSE(Utf8::IsValid("\xFF"));
+}
+
+TEST(Utf8Tests, IsValidLongInput)
+{
+	// every kernel the CPU can run
+	for (size_t i = 0; i < CpuDispatch::NUMBER_OF_ISAS; ++i)
+	{
+		auto isa = static_cast<CpuDispatch::Isa>(i);
+		if (isa > CpuDispatch::get_detected_isa())
+		{
+			break;
+		}
+		CpuDispatch::force_isa(isa);
+
+		// Japanese text between ASCII runs of every length of the vector scan
+		for (size_t run = 0; run < 70; ++run)
+		{
+			const std::string ascii(run, 'a');
+			const std::string text = ascii + "日本語" + ascii + "𣎴" + ascii;
+			ASSERT_TRUE(Utf8::IsValid(text))
+			    << CpuDispatch::get_isa_name(isa) << ", run: " << run;
+
+			// a stray byte anywhere is caught
+			for (size_t position = 0; position < text.size(); position += 5)
+			{
+				std::string corrupted = text;
+				corrupted[position] = '\xFF';
+				ASSERT_FALSE(Utf8::IsValid(corrupted))
+				    << CpuDispatch::get_isa_name(isa) << ", run: " << run
+				    << ", position: " << position;
+			}
+
+			// a sequence truncated by the end of input is invalid
+			ASSERT_FALSE(Utf8::IsValid(ascii + "\xE6\x97"));
+		}
+	}
+	CpuDispatch::force_isa("");
+}
+
+TEST(Utf8Tests, FoldCase)
+{
+	EXPECT_EQ(Utf8::FoldCase('A'), 'a');
+	EXPECT_EQ(Utf8::FoldCase('a'), 'a');
+	EXPECT_EQ(Utf8::FoldCase('['), '[');
+	EXPECT_EQ(Utf8::FoldCase(0x00C9), 0x00E9); // É
+	EXPECT_EQ(Utf8::FoldCase(0x00D7), 0x00D7); // ×
+	EXPECT_EQ(Utf8::FoldCase(0x0141), 0x0142); // Ł
+	EXPECT_EQ(Utf8::FoldCase(0x0178), 0x00FF); // Ÿ
+	EXPECT_EQ(Utf8::FoldCase(0x03A3), 0x03C3); // Σ
+	EXPECT_EQ(Utf8::FoldCase(0x03C2), 0x03C3); // ς
+	EXPECT_EQ(Utf8::FoldCase(0x0416), 0x0436); // Ж
+	EXPECT_EQ(Utf8::FoldCase(0x0401), 0x0451); // Ё
+	EXPECT_EQ(Utf8::FoldCase(0x1E9E), 0x00DF); // ẞ
+	EXPECT_EQ(Utf8::FoldCase(0xFF21), 0xFF41); // Ａ
+	EXPECT_EQ(Utf8::FoldCase(0x65E5), 0x65E5); // 日
+}
+
+TEST(Utf8Tests, OrderCanonically)
+{
+	// dot below (220) goes before the circumflex (230) on the same base
+	std::vector<Utf8::UnicodeCodePoint> code_points{'e', 0x0302, 0x0323,
+	                                                'x', 0x0323, 0x0302};
+	Utf8::OrderCanonically(code_points);
+	EXPECT_EQ(code_points, (std::vector<Utf8::UnicodeCodePoint>{
+	                           'e', 0x0323, 0x0302, 'x', 0x0323, 0x0302}));
+
+	// marks of the same class keep their order
+	code_points = {'a', 0x0301, 0x0300};
+	Utf8::OrderCanonically(code_points);
+	EXPECT_EQ(code_points,
+	          (std::vector<Utf8::UnicodeCodePoint>{'a', 0x0301, 0x0300}));
+	EXPECT_EQ(Utf8::GetCombiningClass('a'), 0);
+	EXPECT_EQ(Utf8::GetCombiningClass(0x0327), 202);
+}
@@ -0,0 +1,105 @@
+#include "VocabularyFilter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const std::string FILE_PATH = "/tmp/vocabulary_filter_test.filter";
+
+	uint64_t hash(const std::string& term)
+	{
+		return HTTP::VocabularyFilter::hash_term(term.data(), term.size());
+	}
+} // namespace
+
+TEST(vocabulary_filter_tests, required_terms)
+{
+	std::vector<std::string> terms;
+	EXPECT_TRUE(HTTP::VocabularyFilter::get_required_terms(
+	    "Fly AND \"landed, again\" snake_case", terms));
+	EXPECT_EQ(terms, (std::vector<std::string>{"fly", "landed", "again",
+	                                           "snake", "case"}));
+
+	// other syntax, or text the tokenizer may fold differently
+	for (const char* query :
+	     {"fly OR bee", "fly NOT bee", "fl*", "body:fly", "(fly)",
+	      "caf\xc3\xa9", "\"fly", "", "  "})
+	{
+		terms.clear();
+		EXPECT_FALSE(HTTP::VocabularyFilter::get_required_terms(query, terms))
+		    << query;
+	}
+}
+
+TEST(vocabulary_filter_tests, reject_unknown_terms)
+{
+	std::vector<uint64_t> term_hashes = {hash("a"), hash("fly"),
+	                                     hash("landed"), hash("again")};
+	ASSERT_TRUE(HTTP::VocabularyFilter::write(FILE_PATH, 3, term_hashes));
+
+	HTTP::VocabularyFilter filter;
+	EXPECT_TRUE(filter.may_match("flyy"));
+	ASSERT_TRUE(filter.open(FILE_PATH));
+	EXPECT_EQ(filter.get_generation(), 3);
+
+	EXPECT_TRUE(filter.may_contain("fly"));
+	EXPECT_TRUE(filter.may_match("FLY landed"));
+	EXPECT_TRUE(filter.may_match("\"a fly\""));
+	EXPECT_FALSE(filter.may_match("flyy"));
+	EXPECT_FALSE(filter.may_match("fly AND bee"));
+
+	// can't tell
+	EXPECT_TRUE(filter.may_match("fly OR bee"));
+
+	// about 1% false positives
+	int number_of_false_positives = 0;
+	for (int i = 0; i < 10000; ++i)
+	{
+		number_of_false_positives +=
+		    filter.may_contain("unknown" + std::to_string(i));
+	}
+	EXPECT_LT(number_of_false_positives, 100);
+
+	filter.close();
+	std::remove(FILE_PATH.c_str());
+}
+
+TEST(vocabulary_filter_tests, load_builds_each_generation_once)
+{
+	std::remove(FILE_PATH.c_str());
+	int number_of_reads = 0;
+	auto read_terms = [&number_of_reads](std::vector<uint64_t>& hashes) {
+		++number_of_reads;
+		hashes.push_back(hash("fly"));
+		return true;
+	};
+
+	HTTP::VocabularyFilter first;
+	HTTP::VocabularyFilter second;
+	ASSERT_TRUE(first.load(FILE_PATH, 1, read_terms));
+	ASSERT_TRUE(second.load(FILE_PATH, 1, read_terms));
+	EXPECT_EQ(number_of_reads, 1);
+
+	// a new generation is built by the first to notice
+	ASSERT_TRUE(second.load(FILE_PATH, 2, read_terms));
+	ASSERT_TRUE(first.load(FILE_PATH, 2, read_terms));
+	EXPECT_EQ(number_of_reads, 2);
+	EXPECT_EQ(first.get_generation(), 2);
+
+	// failing to build isn't retried for the same generation
+	auto fail = [&number_of_reads](std::vector<uint64_t>&) {
+		++number_of_reads;
+		return false;
+	};
+	EXPECT_FALSE(first.load(FILE_PATH, 3, fail));
+	EXPECT_FALSE(first.load(FILE_PATH, 3, fail));
+	EXPECT_EQ(number_of_reads, 3);
+	EXPECT_TRUE(first.may_match("flyy"));
+
+	std::remove(FILE_PATH.c_str());
+	std::remove((FILE_PATH + ".lock").c_str());
+}